@@ -0,0 +1,225 @@
+#include "AssetPack.h"
+#include "Hash.h"
+#include "Lz4.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+AssetPack::AssetPack()
+{
+}
+
+AssetPack::~AssetPack()
+{
+}
+
+// Version of the asset pack format - packs with any other version are refused
+const uint32_t assetPackVersion = 1;
+// Every entry starts on a page boundary so the operating system only pages in the entries that are read
+const uint32_t assetPackAlignment = 4096;
+
+// Function which turns a path into the form it is stored under - forward slashes and no leading ./ so the same file always has the same name
+std::string AssetPack::normalisePath(const std::string &path)
+{
+	std::string normalised = path;
+	std::replace(normalised.begin(), normalised.end(), '\\', '/');
+	while (normalised.compare(0, 2, "./") == 0)
+	{
+		normalised.erase(0, 2);
+	}
+	return normalised;
+}
+
+// Function which maps an asset pack and checks its table of contents - returns false with the reason in error if it is missing or damaged
+bool AssetPack::open(const std::string &packPath, std::string &error)
+{
+	close();
+
+	if (!packFile.open(packPath))
+	{
+		error = "failed to open asset pack!";
+		return false;
+	}
+
+	// Check the header
+	AssetPackHeader header;
+	if (packFile.size() < sizeof(header))
+	{
+		close();
+		error = "asset pack is truncated!";
+		return false;
+	}
+	memcpy(&header, packFile.data(), sizeof(header));
+	if (memcmp(header.magic, "VFPK", 4) != 0 || header.version != assetPackVersion)
+	{
+		close();
+		error = "asset pack was written by a different version!";
+		return false;
+	}
+
+	// Check the table of contents and the paths lie inside the file
+	uint64_t tocSize = static_cast<uint64_t>(header.entryCount) * sizeof(AssetPackEntry);
+	if (header.tocOffset > packFile.size() || tocSize > packFile.size() - header.tocOffset || header.pathsOffset > packFile.size() || header.pathsSize > packFile.size() - header.pathsOffset)
+	{
+		close();
+		error = "asset pack is truncated!";
+		return false;
+	}
+	entries.resize(header.entryCount);
+	memcpy(entries.data(), packFile.data() + header.tocOffset, static_cast<size_t>(tocSize));
+	paths = reinterpret_cast<const char*>(packFile.data() + header.pathsOffset);
+
+	// Check every entry lies inside the file so reading one can never run off the end of the mapping
+	for (const auto& entry : entries)
+	{
+		if (entry.offset > packFile.size() || entry.storedSize > packFile.size() - entry.offset || static_cast<uint64_t>(entry.pathOffset) + entry.pathLength > header.pathsSize)
+		{
+			close();
+			error = "asset pack is truncated!";
+			return false;
+		}
+		// Uncompressed entries are read where they lie, so they must hold exactly the size they claim
+		if (!(entry.flags & ASSET_PACK_ENTRY_LZ4) && entry.size != entry.storedSize)
+		{
+			close();
+			error = "asset pack entry size does not match its stored size!";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Function which unmaps the pack
+void AssetPack::close()
+{
+	packFile.close();
+	entries.clear();
+	paths = nullptr;
+}
+
+// Function which finds the entry for a path - returns nullptr if the pack does not hold it
+// The table of contents is sorted by path hash so this is a binary search, then a check of the path itself in case two paths share a hash
+const AssetPackEntry* AssetPack::find(const std::string &path) const
+{
+	std::string normalised = normalisePath(path);
+	uint64_t pathHash = murmurHash64(normalised.data(), normalised.size());
+
+	auto entry = std::lower_bound(entries.begin(), entries.end(), pathHash, [](const AssetPackEntry &a, uint64_t hash) { return a.pathHash < hash; });
+	for (; entry != entries.end() && entry->pathHash == pathHash; ++entry)
+	{
+		if (entry->pathLength == normalised.size() && memcmp(paths + entry->pathOffset, normalised.data(), normalised.size()) == 0)
+		{
+			return &*entry;
+		}
+	}
+	return nullptr;
+}
+
+// Function which writes a new asset pack holding the files at paths - each file is LZ4 compressed when compress is set and it saves at least an eighth of its size
+// Files already compressed, such as JPEG and PNG images, stay uncompressed so they can be read straight out of the mapping
+bool AssetPack::write(const std::string &packPath, const std::vector<std::string> &paths, bool compress, std::string &error)
+{
+	// Write to a temporary file first so a half written pack is never picked up by a later run
+	std::string tempPath = packPath + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		error = "failed to write asset pack!";
+		return false;
+	}
+
+	// The header is written again at the end once the offsets are known
+	AssetPackHeader header = {};
+	memcpy(header.magic, "VFPK", 4);
+	header.version = assetPackVersion;
+	header.alignment = assetPackAlignment;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	uint64_t fileOffset = sizeof(header);
+
+	std::vector<AssetPackEntry> entries;
+	std::string packedPaths;
+	std::vector<uint8_t> compressed;
+	const char padding[assetPackAlignment] = {};
+
+	for (const auto& path : paths)
+	{
+		std::string normalised = normalisePath(path);
+		MappedFile sourceFile;
+		if (!sourceFile.open(path))
+		{
+			file.close();
+			std::remove(tempPath.c_str());
+			error = "failed to open " + path + " for the asset pack!";
+			return false;
+		}
+
+		AssetPackEntry entry = {};
+		entry.pathHash = murmurHash64(normalised.data(), normalised.size());
+		entry.contentHash = murmurHash64(sourceFile.data(), sourceFile.size());
+		entry.size = sourceFile.size();
+		entry.pathOffset = static_cast<uint32_t>(packedPaths.size());
+		entry.pathLength = static_cast<uint32_t>(normalised.size());
+		packedPaths += normalised;
+
+		// Only keep the compressed copy when it is worth the time it takes to decompress
+		const uint8_t *storedData = sourceFile.data();
+		entry.storedSize = sourceFile.size();
+		if (compress && sourceFile.size() > 0)
+		{
+			lz4Compress(sourceFile.data(), sourceFile.size(), compressed);
+			if (compressed.size() < sourceFile.size() - sourceFile.size() / 8)
+			{
+				storedData = compressed.data();
+				entry.storedSize = compressed.size();
+				entry.flags |= ASSET_PACK_ENTRY_LZ4;
+			}
+		}
+
+		// Start the entry on the next alignment boundary
+		uint64_t alignedOffset = (fileOffset + assetPackAlignment - 1) / assetPackAlignment * assetPackAlignment;
+		file.write(padding, static_cast<std::streamsize>(alignedOffset - fileOffset));
+		entry.offset = alignedOffset;
+		file.write(reinterpret_cast<const char*>(storedData), static_cast<std::streamsize>(entry.storedSize));
+		fileOffset = alignedOffset + entry.storedSize;
+		entries.push_back(entry);
+
+		std::cout << "Asset packed: " + normalised + " " + std::to_string(entry.size) + " -> " + std::to_string(entry.storedSize) + " bytes\n";
+	}
+
+	// Write the table of contents sorted by path hash so entries can be binary searched, then the paths
+	std::sort(entries.begin(), entries.end(), [](const AssetPackEntry &a, const AssetPackEntry &b) { return a.pathHash < b.pathHash; });
+	uint64_t alignedOffset = (fileOffset + 7) / 8 * 8;
+	file.write(padding, static_cast<std::streamsize>(alignedOffset - fileOffset));
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.tocOffset = alignedOffset;
+	file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(AssetPackEntry)));
+	header.pathsOffset = header.tocOffset + entries.size() * sizeof(AssetPackEntry);
+	header.pathsSize = packedPaths.size();
+	file.write(packedPaths.data(), static_cast<std::streamsize>(packedPaths.size()));
+
+	// Go back and fill in the header
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.close();
+
+	if (!file)
+	{
+		std::remove(tempPath.c_str());
+		error = "failed to write asset pack!";
+		return false;
+	}
+
+	// Replace any old pack with the new one
+	std::remove(packPath.c_str());
+	if (std::rename(tempPath.c_str(), packPath.c_str()) != 0)
+	{
+		std::remove(tempPath.c_str());
+		error = "failed to write asset pack!";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MappedFile.h"
+
+// Header at the start of every asset pack
+// The entries' data follows it, each starting on an assetPackAlignment boundary, then the table of contents sorted by path hash, then the paths themselves
+struct AssetPackHeader
+{
+	char magic[4]; // Always "VFPK"
+	uint32_t version; // Bumped whenever the layout of the pack changes
+	uint32_t entryCount;
+	uint32_t alignment; // Boundary every entry's data starts on
+	uint64_t tocOffset; // Where the table of contents starts
+	uint64_t pathsOffset; // Where the paths start - they are not null terminated
+	uint64_t pathsSize;
+};
+
+// Flags stored with each entry
+enum AssetPackEntryFlags : uint32_t
+{
+	ASSET_PACK_ENTRY_LZ4 = 1 // The data is one LZ4 block which decompresses to size bytes
+};
+
+// Struct which describes one file in the table of contents
+struct AssetPackEntry
+{
+	uint64_t pathHash; // Hash of the normalised path - the table of contents is sorted by it
+	uint64_t contentHash; // Hash of the uncompressed file - the same hash the texture and model caches are keyed on
+	uint64_t offset; // Where the data starts
+	uint64_t size; // Size of the file once uncompressed
+	uint64_t storedSize; // Size of the data in the pack
+	uint32_t pathOffset; // Where the path starts in the paths
+	uint32_t pathLength;
+	uint32_t flags;
+	uint32_t reserved;
+};
+
+// Class which reads files out of a memory mapped asset pack and writes new packs from loose files
+// Looking entries up never touches the file system - the whole pack is mapped once and uncompressed entries are used where they lie
+class AssetPack
+{
+public:
+	AssetPack();
+	~AssetPack();
+
+	bool open(const std::string &packPath, std::string &error);
+	void close();
+	bool isOpen() const { return packFile.isOpen(); }
+
+	const AssetPackEntry* find(const std::string &path) const;
+	const uint8_t* entryData(const AssetPackEntry &entry) const { return packFile.data() + entry.offset; }
+	size_t entryCount() const { return entries.size(); }
+
+	static bool write(const std::string &packPath, const std::vector<std::string> &paths, bool compress, std::string &error);
+	static std::string normalisePath(const std::string &path);
+
+private:
+	MappedFile packFile;
+	// Copy of the table of contents so it can be read without caring about its alignment in the file
+	std::vector<AssetPackEntry> entries;
+	const char *paths = nullptr;
+};
@@ -0,0 +1,212 @@
+#include "AssetRegistry.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Hash.h"
+
+AssetRegistry::AssetRegistry()
+{
+}
+
+AssetRegistry::~AssetRegistry()
+{
+}
+
+// Function which works out the key a file's contents are interned under - false if the file cannot be opened
+// Every texture or model is built from its file with the same settings for the whole run, so equal contents always give equal assets
+bool AssetRegistry::contentKey(const std::string &path, uint64_t &key) const
+{
+	AssetFile file;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(path, file))
+	{
+		return false;
+	}
+	key = contentKey(file);
+	return true;
+}
+
+// Function which works out the key the contents of a file that is already open are interned under - the file's hash is kept so it is only read once
+uint64_t AssetRegistry::contentKey(AssetFile &file) const
+{
+	// The size is hashed in too so two files only share if both match
+	uint64_t contents[2] = { file.contentHash(), static_cast<uint64_t>(file.size()) };
+	return murmurHash64(contents, sizeof(contents));
+}
+
+// Function which checks whether a texture or model with these contents has already been uploaded - safe to call from any thread
+bool AssetRegistry::contains(uint64_t key, bool model)
+{
+	if (!FrameworkSingleton::getInstance()->shareAssets)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(assetMutex);
+	const std::vector<InternedAsset> &assets = model ? models : textures;
+	return std::find_if(assets.begin(), assets.end(), [key](const InternedAsset &asset) { return asset.key == key; }) != assets.end();
+}
+
+// Function which hands out the image of a texture with these contents if one has been uploaded, adding a reference to it - false if there is none
+bool AssetRegistry::acquireTexture(uint64_t key, VkImage &textureIm, VkFormat &textureFormat)
+{
+	if (!FrameworkSingleton::getInstance()->shareAssets)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(assetMutex);
+	auto texture = std::find_if(textures.begin(), textures.end(), [key](const InternedAsset &asset) { return asset.key == key; });
+	if (texture == textures.end())
+	{
+		return false;
+	}
+	texture->references++;
+	textureIm = texture->image;
+	textureFormat = texture->format;
+	countShare(*texture);
+	return true;
+}
+
+// Function which takes ownership of a texture image that has just been uploaded - the slot it was uploaded for holds the first reference
+void AssetRegistry::addTexture(uint64_t key, VkImage textureIm, VkFormat textureFormat)
+{
+	InternedAsset texture;
+	texture.key = key;
+	texture.references = 1;
+	texture.image = textureIm;
+	texture.format = textureFormat;
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(FrameworkSingleton::getInstance()->device, textureIm, &memRequirements);
+	texture.byteSize = memRequirements.size;
+
+	std::lock_guard<std::mutex> lock(assetMutex);
+	textures.push_back(texture);
+}
+
+// Function which drops one slot's reference to a texture image and destroys it once no slot holds it
+// Images the registry does not own are destroyed straight away so callers never need to know where an image came from
+void AssetRegistry::releaseTexture(VkImage textureIm)
+{
+	std::lock_guard<std::mutex> lock(assetMutex);
+	auto texture = std::find_if(textures.begin(), textures.end(), [textureIm](const InternedAsset &asset) { return asset.image == textureIm; });
+	if (texture != textures.end())
+	{
+		if (--texture->references > 0)
+		{
+			return;
+		}
+		textures.erase(texture);
+	}
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(textureIm);
+}
+
+// Function which hands out the buffers of a model with these contents if one has been uploaded, adding a reference to them - false if there is none
+// The indices and levels of detail are copied as every slot culls and picks its own level of detail from them
+bool AssetRegistry::acquireModel(uint64_t key, std::vector<uint32_t> &modelIndices, MeshLods &modelLods, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range)
+{
+	if (!FrameworkSingleton::getInstance()->shareAssets)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(assetMutex);
+	auto model = std::find_if(models.begin(), models.end(), [key](const InternedAsset &asset) { return asset.key == key; });
+	if (model == models.end())
+	{
+		return false;
+	}
+	model->references++;
+	modelIndices = model->indices;
+	modelLods = model->lods;
+	vertexBuffer = model->vertexBuffer;
+	dequantisation = model->dequantisation;
+	indexBuffer = model->indexBuffer;
+	indexType = model->indexType;
+	range = model->range;
+	countShare(*model);
+	return true;
+}
+
+// Function which takes ownership of the buffers of a model that has just been uploaded - the slot it was uploaded for holds the first reference
+void AssetRegistry::addModel(uint64_t key, const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, VkBuffer vertexBuffer, const VertexDequantisation &dequantisation, VkBuffer indexBuffer, VkIndexType indexType, const MeshRange &range)
+{
+	InternedAsset model;
+	model.key = key;
+	model.references = 1;
+	model.vertexBuffer = vertexBuffer;
+	model.dequantisation = dequantisation;
+	model.indexBuffer = indexBuffer;
+	model.indexType = indexType;
+	model.range = range;
+	model.indices = modelIndices;
+	model.lods = modelLods;
+	// A model in the geometry buffer takes up its range of it
+	if (FrameworkSingleton::getInstance()->geometryBuffer.contains(vertexBuffer))
+	{
+		model.byteSize = static_cast<VkDeviceSize>(range.vertexCount) * FrameworkSingleton::getInstance()->geometryBuffer.vertexStride + static_cast<VkDeviceSize>(range.indexCount) * (indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+	}
+	else
+	{
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(FrameworkSingleton::getInstance()->device, vertexBuffer, &memRequirements);
+		model.byteSize = memRequirements.size;
+		vkGetBufferMemoryRequirements(FrameworkSingleton::getInstance()->device, indexBuffer, &memRequirements);
+		model.byteSize += memRequirements.size;
+	}
+
+	std::lock_guard<std::mutex> lock(assetMutex);
+	models.push_back(model);
+}
+
+// Function which drops one slot's reference to a model's buffers and destroys them once no slot holds them - or frees its range when they are the geometry buffer's
+// Buffers the registry does not own are destroyed straight away. Models in the geometry buffer share its buffers so they are told apart by their range
+void AssetRegistry::releaseModel(VkBuffer vertexBuffer, VkBuffer indexBuffer, const MeshRange &range, VkIndexType indexType)
+{
+	std::lock_guard<std::mutex> lock(assetMutex);
+	auto model = std::find_if(models.begin(), models.end(), [vertexBuffer, &range](const InternedAsset &asset) { return asset.vertexBuffer == vertexBuffer && asset.range.firstVertex == range.firstVertex; });
+	if (model != models.end())
+	{
+		if (--model->references > 0)
+		{
+			return;
+		}
+		models.erase(model);
+	}
+	FrameworkSingleton::getInstance()->geometryBuffer.releaseMesh(vertexBuffer, indexBuffer, range, indexType);
+}
+
+// Function which counts a load that was handed an asset already uploaded towards the report written on close - called with the registry locked
+void AssetRegistry::countShare(const InternedAsset &asset)
+{
+	sharedLoads++;
+	bytesSaved += asset.byteSize;
+}
+
+// Function which writes how many assets are uploaded and how much device memory sharing them has saved since the application started
+void AssetRegistry::report()
+{
+	std::lock_guard<std::mutex> lock(assetMutex);
+	VkDeviceSize bytesHeld = 0;
+	for (const auto& asset : textures)
+	{
+		bytesHeld += asset.byteSize;
+	}
+	for (const auto& asset : models)
+	{
+		bytesHeld += asset.byteSize;
+	}
+	std::cout << "Asset registry: " + std::to_string(textures.size()) + " textures and " + std::to_string(models.size()) + " models in " + std::to_string(bytesHeld / 1024) + " KB, "
+		+ std::to_string(sharedLoads) + " loads shared saving " + std::to_string(bytesSaved / 1024) + " KB\n";
+}
+
+// Function which destroys every texture and model still held, however many slots hold them - once the device is idle on close
+void AssetRegistry::cleanup()
+{
+	std::lock_guard<std::mutex> lock(assetMutex);
+	for (const auto& asset : textures)
+	{
+		FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(asset.image);
+	}
+	for (const auto& asset : models)
+	{
+		FrameworkSingleton::getInstance()->geometryBuffer.releaseMesh(asset.vertexBuffer, asset.indexBuffer, asset.range, asset.indexType);
+	}
+	textures.clear();
+	models.clear();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "VulkanManager.h"
+#include "Vertex.h"
+
+// Struct which stores one uploaded texture or model and how many slots of the scene hold it
+struct InternedAsset
+{
+	uint64_t key = 0; // Hash of the contents of the file it was loaded from
+	uint32_t references = 0;
+	VkDeviceSize byteSize = 0; // Device memory it takes up
+	// Set for a texture
+	VkImage image = VK_NULL_HANDLE;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	// Set for a model - the indices and levels of detail are kept so a slot sharing the buffers can be drawn without reading the file
+	// The vertices are not, they are only needed to fill the vertex buffer
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	VertexDequantisation dequantisation = {};
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+	VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+	MeshRange range; // Where it lies in the geometry buffer when its buffers are the shared ones
+	std::vector<uint32_t> indices;
+	MeshLods lods;
+};
+
+// Class which owns every uploaded texture image and model buffer, keyed by the hash of the file contents they were made from
+// A load of a file whose contents match an asset already uploaded returns the same handles and only adds a reference, however the file is named
+// Handles are released rather than destroyed and only freed once no slot holds them - lookups are safe from the streaming workers, everything else is for the main thread
+class AssetRegistry
+{
+public:
+	AssetRegistry();
+	~AssetRegistry();
+
+	bool contentKey(const std::string &path, uint64_t &key) const;
+	uint64_t contentKey(AssetFile &file) const;
+	bool contains(uint64_t key, bool model);
+	bool acquireTexture(uint64_t key, VkImage &textureIm, VkFormat &textureFormat);
+	void addTexture(uint64_t key, VkImage textureIm, VkFormat textureFormat);
+	void releaseTexture(VkImage textureIm);
+	bool acquireModel(uint64_t key, std::vector<uint32_t> &modelIndices, MeshLods &modelLods, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range);
+	void addModel(uint64_t key, const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, VkBuffer vertexBuffer, const VertexDequantisation &dequantisation, VkBuffer indexBuffer, VkIndexType indexType, const MeshRange &range);
+	void releaseModel(VkBuffer vertexBuffer, VkBuffer indexBuffer, const MeshRange &range, VkIndexType indexType);
+	void report();
+	void cleanup();
+
+private:
+	void countShare(const InternedAsset &asset);
+
+	std::vector<InternedAsset> textures;
+	std::vector<InternedAsset> models;
+	std::mutex assetMutex;
+	// Loads that were handed an asset already uploaded instead of uploading their own, and the device memory that saved
+	size_t sharedLoads = 0;
+	VkDeviceSize bytesSaved = 0;
+};
@@ -0,0 +1,179 @@
+#include "AssetWatcher.h"
+
+#include <algorithm>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <limits.h>
+#endif
+
+AssetWatcher::AssetWatcher()
+{
+}
+
+AssetWatcher::~AssetWatcher()
+{
+	stop();
+}
+
+#ifndef __linux__
+// Function which reads the modification time and size of a file - both are -1 when the file cannot be read, such as half way through being replaced
+// The time is read below a second so a file saved twice within a second, at the same size, is still seen to change
+static std::pair<int64_t, int64_t> fileState(const std::string &path)
+{
+#ifdef _WIN32
+	// Last write time in 100 nanosecond steps
+	WIN32_FILE_ATTRIBUTE_DATA status;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &status))
+	{
+		return { -1, -1 };
+	}
+	int64_t modified = static_cast<int64_t>((static_cast<uint64_t>(status.ftLastWriteTime.dwHighDateTime) << 32) | status.ftLastWriteTime.dwLowDateTime);
+	int64_t size = static_cast<int64_t>((static_cast<uint64_t>(status.nFileSizeHigh) << 32) | status.nFileSizeLow);
+	return { modified, size };
+#else
+	// Modification time in nanoseconds
+	struct stat status;
+	if (stat(path.c_str(), &status) != 0)
+	{
+		return { -1, -1 };
+	}
+#ifdef __APPLE__
+	int64_t modified = static_cast<int64_t>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+	int64_t modified = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+	return { modified, static_cast<int64_t>(status.st_size) };
+#endif
+}
+#endif
+
+// Function which starts watching - returns false if the operating system will not watch files for the application
+bool AssetWatcher::start()
+{
+	stop();
+#ifdef __linux__
+	// Non blocking so poll returns straight away when nothing has changed
+	inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	return inotifyDescriptor >= 0;
+#else
+	lastPoll = std::chrono::steady_clock::now();
+	return true;
+#endif
+}
+
+// Function which stops watching and forgets every file
+void AssetWatcher::stop()
+{
+#ifdef __linux__
+	if (inotifyDescriptor >= 0)
+	{
+		// Closing the descriptor removes every watch made with it
+		close(inotifyDescriptor);
+		inotifyDescriptor = -1;
+	}
+	directories.clear();
+	directoryWatches.clear();
+#else
+	reportedStates.clear();
+	polledStates.clear();
+#endif
+	paths.clear();
+}
+
+// Function which adds a file to the files being watched - the file does not have to exist yet but its folder does
+void AssetWatcher::watch(const std::string &path)
+{
+	if (std::find(paths.begin(), paths.end(), path) != paths.end())
+	{
+		return;
+	}
+	paths.push_back(path);
+
+#ifdef __linux__
+	// Files are watched through their folder so a file replaced by renaming another over it is still seen
+	// Folders are kept as the part of the path before the file name so changed paths are built the same way the files were given
+	size_t slash = path.find_last_of("/\\");
+	std::string directory = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+	if (inotifyDescriptor < 0 || std::find(directories.begin(), directories.end(), directory) != directories.end())
+	{
+		return;
+	}
+	int directoryWatch = inotify_add_watch(inotifyDescriptor, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (directoryWatch >= 0)
+	{
+		directories.push_back(directory);
+		directoryWatches.push_back(directoryWatch);
+	}
+#else
+	std::pair<int64_t, int64_t> state = fileState(path);
+	reportedStates.push_back(state);
+	polledStates.push_back(state);
+#endif
+}
+
+// Function which adds the path of every watched file that has changed since the last poll to changedPaths - each file is listed once however often it changed
+void AssetWatcher::poll(std::vector<std::string> &changedPaths)
+{
+	changedPaths.clear();
+#ifdef __linux__
+	if (inotifyDescriptor < 0)
+	{
+		return;
+	}
+
+	// Read every waiting event - each is a header followed by the name of the file inside the watched folder
+	alignas(struct inotify_event) char events[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+	for (;;)
+	{
+		ssize_t length = read(inotifyDescriptor, events, sizeof(events));
+		if (length <= 0)
+		{
+			break;
+		}
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const struct inotify_event *event = reinterpret_cast<const struct inotify_event*>(events + offset);
+			offset += sizeof(struct inotify_event) + event->len;
+
+			auto directory = std::find(directoryWatches.begin(), directoryWatches.end(), event->wd);
+			if (event->len == 0 || directory == directoryWatches.end())
+			{
+				continue;
+			}
+			std::string path = directories[directory - directoryWatches.begin()] + event->name;
+			if (std::find(paths.begin(), paths.end(), path) != paths.end() && std::find(changedPaths.begin(), changedPaths.end(), path) == changedPaths.end())
+			{
+				changedPaths.push_back(path);
+			}
+		}
+	}
+#else
+	auto now = std::chrono::steady_clock::now();
+	if (now - lastPoll < std::chrono::milliseconds(500))
+	{
+		return;
+	}
+	lastPoll = now;
+
+	// A file being written keeps changing between polls - only report it once it has held still for one
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		std::pair<int64_t, int64_t> state = fileState(paths[i]);
+		if (state != reportedStates[i] && state == polledStates[i] && state.first >= 0)
+		{
+			reportedStates[i] = state;
+			changedPaths.push_back(paths[i]);
+		}
+		polledStates[i] = state;
+	}
+#endif
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+
+// Class which watches asset files for changes made while the application runs
+// On Linux the folders holding the files are watched with inotify and a file counts as changed once whoever wrote it has closed it or renamed it into place
+// Elsewhere the sub-second modification time and size of every file are checked twice a second and a change is only reported once it has stopped changing
+class AssetWatcher
+{
+public:
+	AssetWatcher();
+	~AssetWatcher();
+
+	bool start();
+	void stop();
+	void watch(const std::string &path);
+	void poll(std::vector<std::string> &changedPaths);
+
+private:
+	// Paths of every watched file, as they were given to watch
+	std::vector<std::string> paths;
+#ifdef __linux__
+	int inotifyDescriptor = -1;
+	// Watched folders and the inotify watch of each
+	std::vector<std::string> directories;
+	std::vector<int> directoryWatches;
+#else
+	// Modification time and size of each file when it was last reported, and when it was last checked
+	std::vector<std::pair<int64_t, int64_t>> reportedStates;
+	std::vector<std::pair<int64_t, int64_t>> polledStates;
+	std::chrono::steady_clock::time_point lastPoll;
+#endif
+};
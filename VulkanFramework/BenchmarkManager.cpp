@@ -0,0 +1,917 @@
+#include "BenchmarkManager.h"
+#include "include\TinyOBJ\tiny_obj_loader.h"
+#include "include\STBIMAGE\stb_image.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Vertex.h"
+#include "VertexHashTable.h"
+#include "MeshOptimiser.h"
+#include "MeshSimplifier.h"
+#include "ObjReader.h"
+#include "GltfReader.h"
+#include "TextureCompressor.h"
+#include "MipmapGenerator.h"
+#include "MappedFile.h"
+#include "Lz4.h"
+#include "TerrainManager.h"
+#include "MeshletBuilder.h"
+#include "MeshletCuller.h"
+#include "KtxReader.h"
+
+BenchmarkManager::BenchmarkManager()
+{
+}
+
+BenchmarkManager::~BenchmarkManager()
+{
+}
+
+// Number of times each benchmark is repeated - the fastest run is reported
+const int benchmarkRepeats = 3;
+
+// Run every CPU benchmark and write the results to benchmark.csv - needs no window or GPU
+void BenchmarkManager::run()
+{
+	std::ofstream results("benchmark.csv", std::ofstream::out);
+	results << "benchmark,case,baseline ms,optimised ms,result,input" << std::endl;
+
+	vertexHashBenchmark(results);
+	objReaderBenchmark(results);
+	meshOptimiserBenchmark(results);
+	vertexPackingBenchmark(results);
+	textureCompressionBenchmark(results);
+	mipmapBenchmark(results);
+	assetPackBenchmark(results);
+	meshLodBenchmark(results);
+	terrainBenchmark(results);
+	meshletBenchmark(results);
+	gltfBenchmark(results);
+	textureBudgetBenchmark(results);
+	ktxBenchmark(results);
+}
+
+// Function which deduplicates a vertex stream the way loadModel used to - one std::unordered_map using std::hash<Vertex>
+template<typename GetVertex>
+static void dedupWithUnorderedMap(size_t indexCount, GetVertex getVertex, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+	std::unordered_map<Vertex, uint32_t> uniqueVertices = {};
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		Vertex vertex = getVertex(i);
+		if (uniqueVertices.count(vertex) == 0)
+		{
+			uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(vertex);
+		}
+		indices.push_back(uniqueVertices[vertex]);
+	}
+}
+
+// Function which deduplicates a vertex stream with the flat vertex hash table
+template<typename GetVertex>
+static void dedupWithHashTable(size_t indexCount, GetVertex getVertex, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+	VertexHashTable uniqueVertices;
+	uniqueVertices.reserveForIndexCount(indexCount);
+	indices.reserve(indexCount);
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		indices.push_back(uniqueVertices.findOrInsert(getVertex(i), vertices));
+	}
+}
+
+// Function which times both deduplication methods over the same vertex stream and writes a row of results
+template<typename GetVertex>
+static void compareDedup(std::ofstream &results, const std::string &name, size_t indexCount, GetVertex getVertex)
+{
+	double mapTime = 1e30, tableTime = 1e30;
+	std::vector<Vertex> mapVertices, tableVertices;
+	std::vector<uint32_t> mapIndices, tableIndices;
+
+	for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+	{
+		mapVertices.clear();
+		mapIndices.clear();
+		auto start = std::chrono::high_resolution_clock::now();
+		dedupWithUnorderedMap(indexCount, getVertex, mapVertices, mapIndices);
+		auto end = std::chrono::high_resolution_clock::now();
+		mapTime = std::min(mapTime, std::chrono::duration<double, std::milli>(end - start).count());
+
+		tableVertices.clear();
+		tableIndices.clear();
+		start = std::chrono::high_resolution_clock::now();
+		dedupWithHashTable(indexCount, getVertex, tableVertices, tableIndices);
+		end = std::chrono::high_resolution_clock::now();
+		tableTime = std::min(tableTime, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	// Both methods should find the same vertices in the same order
+	bool identical = mapIndices == tableIndices && mapVertices.size() == tableVertices.size() && memcmp(mapVertices.data(), tableVertices.data(), mapVertices.size() * sizeof(Vertex)) == 0;
+
+	std::cout << "vertex hash " << name << ": unordered_map " << mapTime << " ms, VertexHashTable " << tableTime << " ms, " << tableVertices.size() << " unique of " << indexCount << (identical ? "" : " - OUTPUT DIFFERS") << std::endl;
+	results << "vertex hash," << name << "," << mapTime << "," << tableTime << "," << tableVertices.size() << (identical ? "" : " (differs)") << "," << indexCount << std::endl;
+}
+
+// Benchmark which compares the old std::unordered_map deduplication against VertexHashTable on the shipped models and a large synthetic mesh
+void BenchmarkManager::vertexHashBenchmark(std::ofstream &results)
+{
+	// Shipped models - expand them into one vertex per index exactly as loadModel builds them
+	std::vector<std::string> modelPaths = { FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelChaletPath };
+	for (const auto& modelPath : modelPaths)
+	{
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string err;
+
+		// The chalet model is not shipped with the repository so skip any model that is missing
+		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, modelPath.c_str()))
+		{
+			std::cout << "vertex hash " << modelPath << ": skipped - " << err << std::endl;
+			continue;
+		}
+
+		std::vector<Vertex> vertexStream;
+		for (const auto& shape : shapes)
+		{
+			for (const auto& index : shape.mesh.indices)
+			{
+				Vertex vertex = {};
+				vertex.pos = { attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2] };
+				vertex.texCoord = { attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1] };
+				vertex.color = { 1.0f, 1.0f, 1.0f };
+				vertexStream.push_back(vertex);
+			}
+		}
+
+		compareDedup(results, modelPath, vertexStream.size(), [&](size_t i) { return vertexStream[i]; });
+	}
+
+	// Synthetic mesh of 10 million indices - a square grid of quads, two triangles each, generated on the fly so the stream itself uses no memory
+	const size_t syntheticIndexCount = 10000000;
+	const size_t gridSize = static_cast<size_t>(std::ceil(std::sqrt(syntheticIndexCount / 6.0)));
+	auto syntheticVertex = [gridSize](size_t i)
+	{
+		// Corners of the two triangles of a quad
+		static const uint32_t cornerX[6] = { 0, 1, 1, 1, 0, 0 };
+		static const uint32_t cornerY[6] = { 0, 0, 1, 1, 1, 0 };
+		size_t quad = i / 6;
+		size_t x = quad % gridSize + cornerX[i % 6];
+		size_t y = quad / gridSize + cornerY[i % 6];
+
+		Vertex vertex = {};
+		vertex.pos = { static_cast<float>(x), std::sin(x * 0.05f) * std::cos(y * 0.05f), static_cast<float>(y) };
+		vertex.texCoord = { x / static_cast<float>(gridSize), y / static_cast<float>(gridSize) };
+		vertex.color = { 1.0f, 1.0f, 1.0f };
+		return vertex;
+	};
+	compareDedup(results, "synthetic grid", syntheticIndexCount, syntheticVertex);
+}
+
+// Benchmark which reads the shipped models with tinyobj and with ObjReader and checks both give exactly the same vertex for every triangle corner
+void BenchmarkManager::objReaderBenchmark(std::ofstream &results)
+{
+	std::vector<std::string> modelPaths = { FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelChaletPath, "models/sphere.obj" };
+	for (const auto& modelPath : modelPaths)
+	{
+		double tinyobjTime = 1e30, readerTime = 1e30;
+		std::vector<Vertex> tinyobjStream, readerStream;
+		bool loaded = true;
+
+		for (int repeat = 0; repeat < benchmarkRepeats && loaded; repeat++)
+		{
+			// tinyobj - parse into shapes then expand every index into a vertex
+			tinyobjStream.clear();
+			auto start = std::chrono::high_resolution_clock::now();
+			tinyobj::attrib_t attrib;
+			std::vector<tinyobj::shape_t> shapes;
+			std::vector<tinyobj::material_t> materials;
+			std::string err;
+			if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, modelPath.c_str()))
+			{
+				loaded = false;
+				break;
+			}
+			for (const auto& shape : shapes)
+			{
+				for (const auto& index : shape.mesh.indices)
+				{
+					Vertex vertex = {};
+					vertex.pos = { attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2] };
+					vertex.texCoord = { attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1] };
+					vertex.color = { 1.0f, 1.0f, 1.0f };
+					tinyobjStream.push_back(vertex);
+				}
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+			tinyobjTime = std::min(tinyobjTime, std::chrono::duration<double, std::milli>(end - start).count());
+
+			// ObjReader - corners come straight out of the mapped file
+			readerStream.clear();
+			start = std::chrono::high_resolution_clock::now();
+			ObjReader objReader;
+			if (!objReader.open(modelPath, 1, err))
+			{
+				loaded = false;
+				break;
+			}
+			for (size_t chunk = 0; chunk < objReader.chunkCount(); chunk++)
+			{
+				objReader.readFaces(chunk, [&](const ObjCorner &corner)
+				{
+					Vertex vertex = {};
+					vertex.pos = { objReader.positions[3 * corner.position + 0], objReader.positions[3 * corner.position + 1], objReader.positions[3 * corner.position + 2] };
+					vertex.texCoord = { objReader.texCoords[2 * corner.texCoord + 0], 1.0f - objReader.texCoords[2 * corner.texCoord + 1] };
+					vertex.color = { 1.0f, 1.0f, 1.0f };
+					readerStream.push_back(vertex);
+				}, err);
+			}
+			end = std::chrono::high_resolution_clock::now();
+			readerTime = std::min(readerTime, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		// The chalet model is not shipped with the repository so skip any model that is missing
+		if (!loaded)
+		{
+			std::cout << "obj reader " << modelPath << ": skipped - could not be loaded" << std::endl;
+			continue;
+		}
+
+		bool identical = tinyobjStream.size() == readerStream.size() && memcmp(tinyobjStream.data(), readerStream.data(), tinyobjStream.size() * sizeof(Vertex)) == 0;
+
+		std::cout << "obj reader " << modelPath << ": tinyobj " << tinyobjTime << " ms, ObjReader " << readerTime << " ms, " << readerStream.size() << " corners" << (identical ? "" : " - OUTPUT DIFFERS") << std::endl;
+		results << "obj reader," << modelPath << "," << tinyobjTime << "," << readerTime << "," << (identical ? "identical" : "differs") << "," << readerStream.size() << " corners" << std::endl;
+	}
+}
+
+// Benchmark which runs the mesh optimiser on the shipped models and reports the vertex cache statistics before and after
+void BenchmarkManager::meshOptimiserBenchmark(std::ofstream &results)
+{
+	// Load the models without the cache or the optimiser so the optimiser sees the plain deduplicated order
+	bool useModelCache = FrameworkSingleton::getInstance()->useModelCache;
+	bool optimiseMeshes = FrameworkSingleton::getInstance()->optimiseMeshes;
+	FrameworkSingleton::getInstance()->useModelCache = false;
+	FrameworkSingleton::getInstance()->optimiseMeshes = false;
+
+	std::vector<std::string> modelPaths = { FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelChaletPath };
+	for (const auto& modelPath : modelPaths)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		try
+		{
+			FrameworkSingleton::getInstance()->vulkanManager.loadModel(modelPath, vertices, indices);
+		}
+		catch (const std::runtime_error &e)
+		{
+			std::cout << "mesh optimiser " << modelPath << ": skipped - " << e.what() << std::endl;
+			continue;
+		}
+
+		// Statistics are measured with a 16 entry FIFO cache and a larger 32 entry one
+		MeshOptimiser meshOptimiser;
+		VertexCacheStatistics before16 = meshOptimiser.analyseVertexCache(indices, vertices.size(), 16);
+		VertexCacheStatistics before32 = meshOptimiser.analyseVertexCache(indices, vertices.size(), 32);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		meshOptimiser.optimiseMesh(vertices, indices);
+		auto end = std::chrono::high_resolution_clock::now();
+		double optimiseTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+		VertexCacheStatistics after16 = meshOptimiser.analyseVertexCache(indices, vertices.size(), 16);
+		VertexCacheStatistics after32 = meshOptimiser.analyseVertexCache(indices, vertices.size(), 32);
+
+		std::cout << "mesh optimiser " << modelPath << ": " << optimiseTime << " ms, FIFO 16 ACMR " << before16.acmr << " -> " << after16.acmr << " ATVR " << before16.atvr << " -> " << after16.atvr
+			<< ", FIFO 32 ACMR " << before32.acmr << " -> " << after32.acmr << " ATVR " << before32.atvr << " -> " << after32.atvr << std::endl;
+		results << "mesh optimiser," << modelPath << ",," << optimiseTime << ",FIFO 16 ACMR " << before16.acmr << " -> " << after16.acmr << " ATVR " << before16.atvr << " -> " << after16.atvr
+			<< " / FIFO 32 ACMR " << before32.acmr << " -> " << after32.acmr << " ATVR " << before32.atvr << " -> " << after32.atvr << "," << indices.size() / 3 << " triangles" << std::endl;
+	}
+
+	FrameworkSingleton::getInstance()->useModelCache = useModelCache;
+	FrameworkSingleton::getInstance()->optimiseMeshes = optimiseMeshes;
+}
+
+// Benchmark which packs the scenery model into the packed vertex layout and reports the memory saved and the largest position error
+void BenchmarkManager::vertexPackingBenchmark(std::ofstream &results)
+{
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	FrameworkSingleton::getInstance()->vulkanManager.loadModel(FrameworkSingleton::getInstance()->modelSceneryPath, vertices, indices);
+
+	std::vector<PackedVertex> packedVertices;
+	VertexDequantisation dequantisation;
+	auto start = std::chrono::high_resolution_clock::now();
+	packVertices(vertices, packedVertices, dequantisation);
+	auto end = std::chrono::high_resolution_clock::now();
+	double packTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// Unpack every position the way the vertex shader does and find the largest error
+	float largestError = 0.0f;
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		glm::vec3 normalised(packedVertices[i].pos[0] / 65535.0f, packedVertices[i].pos[1] / 65535.0f, packedVertices[i].pos[2] / 65535.0f);
+		glm::vec3 position = glm::vec3(dequantisation.offset) + normalised * glm::vec3(dequantisation.scale);
+		largestError = std::max(largestError, glm::length(position - vertices[i].pos));
+	}
+
+	// Index buffers drop to 16 bits when every index fits
+	size_t indexSize = vertices.size() <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t);
+	size_t originalBytes = vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t);
+	size_t packedBytes = packedVertices.size() * sizeof(PackedVertex) + indices.size() * indexSize;
+
+	std::cout << "vertex packing " << FrameworkSingleton::getInstance()->modelSceneryPath << ": " << packTime << " ms, " << originalBytes << " -> " << packedBytes << " bytes, largest position error " << largestError << std::endl;
+	results << "vertex packing," << FrameworkSingleton::getInstance()->modelSceneryPath << ",," << packTime << "," << originalBytes << " -> " << packedBytes << " bytes (largest position error " << largestError << ")," << vertices.size() << " vertices" << std::endl;
+}
+
+// Benchmark which compresses the shipped textures to every BC format and reports the encode throughput and the PSNR of the decoded result
+void BenchmarkManager::textureCompressionBenchmark(std::ofstream &results)
+{
+	std::vector<std::string> texturePaths = { FrameworkSingleton::getInstance()->boxesTexturePath, FrameworkSingleton::getInstance()->checkedTexturePath, FrameworkSingleton::getInstance()->modelSceneryTexturePath,
+		FrameworkSingleton::getInstance()->modelChaletTexturePath, FrameworkSingleton::getInstance()->topSkyTexturePath };
+	const TextureFormat formats[] = { TEXTURE_FORMAT_BC1, TEXTURE_FORMAT_BC3, TEXTURE_FORMAT_BC7 };
+	const char* formatNames[] = { "", "BC1", "BC3", "BC7" };
+
+	for (const auto& texturePath : texturePaths)
+	{
+		int width, height, channels;
+		stbi_uc* pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		if (!pixels)
+		{
+			std::cout << "texture compression " << texturePath << ": skipped - failed to load texture image!" << std::endl;
+			continue;
+		}
+		size_t pixelCount = static_cast<size_t>(width) * height;
+		bool includeAlpha = TextureCompressor::hasAlpha(pixels, pixelCount);
+
+		for (TextureFormat format : formats)
+		{
+			TextureCompressor textureCompressor;
+			std::vector<uint8_t> blocks;
+			double compressTime = 1e30;
+			for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				textureCompressor.compress(pixels, width, height, format, blocks);
+				auto end = std::chrono::high_resolution_clock::now();
+				compressTime = std::min(compressTime, std::chrono::duration<double, std::milli>(end - start).count());
+			}
+
+			std::vector<uint8_t> decoded;
+			textureCompressor.decompress(blocks.data(), width, height, format, decoded);
+			double psnr = textureCompressor.psnr(pixels, decoded.data(), pixelCount, includeAlpha && format != TEXTURE_FORMAT_BC1);
+			double megapixelsPerSecond = pixelCount / (compressTime * 1000.0);
+
+			std::cout << "texture compression " << texturePath << " " << formatNames[format] << ": " << compressTime << " ms, " << megapixelsPerSecond << " MPix/s, PSNR " << psnr << " dB, " << pixelCount * 4 << " -> " << blocks.size() << " bytes" << std::endl;
+			results << "texture compression " << formatNames[format] << "," << texturePath << ",," << compressTime << ",PSNR " << psnr << " dB / " << megapixelsPerSecond << " MPix/s / " << pixelCount * 4 << " -> " << blocks.size() << " bytes," << width << "x" << height << (includeAlpha ? " RGBA" : " RGB") << std::endl;
+		}
+
+		stbi_image_free(pixels);
+	}
+}
+
+// Benchmark which builds the full mip chain of the largest shipped texture on the CPU
+void BenchmarkManager::mipmapBenchmark(std::ofstream &results)
+{
+	const std::string &texturePath = FrameworkSingleton::getInstance()->modelChaletTexturePath;
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (!pixels)
+	{
+		std::cout << "mipmap generation " << texturePath << ": skipped - failed to load texture image!" << std::endl;
+		return;
+	}
+
+	MipmapGenerator mipmapGenerator;
+	uint32_t levelCount = MipmapGenerator::mipLevelCount(width, height);
+	std::vector<uint8_t> levels;
+	double generateTime = 1e30;
+	for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		mipmapGenerator.generate(pixels, width, height, levelCount, levels);
+		auto end = std::chrono::high_resolution_clock::now();
+		generateTime = std::min(generateTime, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	stbi_image_free(pixels);
+
+	double megapixelsPerSecond = static_cast<double>(width) * height / (generateTime * 1000.0);
+	std::cout << "mipmap generation " << texturePath << ": " << generateTime << " ms, " << megapixelsPerSecond << " MPix/s, " << levelCount << " levels, " << levels.size() << " bytes" << std::endl;
+	results << "mipmap generation," << texturePath << ",," << generateTime << "," << levelCount << " levels / " << megapixelsPerSecond << " MPix/s / " << levels.size() << " bytes," << width << "x" << height << std::endl;
+}
+
+// Benchmark which LZ4 compresses shipped assets the way the asset pack stores them and times reading each one from a loose file against decompressing it
+void BenchmarkManager::assetPackBenchmark(std::ofstream &results)
+{
+	std::vector<std::string> assetPaths = { FrameworkSingleton::getInstance()->modelSceneryPath, "models/sphere.obj", FrameworkSingleton::getInstance()->modelChaletTexturePath, "shaders/vert.spv" };
+	for (const auto& assetPath : assetPaths)
+	{
+		MappedFile assetFile;
+		if (!assetFile.open(assetPath))
+		{
+			std::cout << "asset pack " << assetPath << ": skipped - could not be loaded" << std::endl;
+			continue;
+		}
+
+		std::vector<uint8_t> compressed;
+		auto start = std::chrono::high_resolution_clock::now();
+		lz4Compress(assetFile.data(), assetFile.size(), compressed);
+		auto end = std::chrono::high_resolution_clock::now();
+		double compressTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+		double readTime = 1e30, decompressTime = 1e30;
+		std::vector<char> readData;
+		std::vector<uint8_t> decompressed(assetFile.size());
+		bool identical = true;
+		for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+		{
+			// Loose file - read the whole file into memory the way shaders used to be read
+			start = std::chrono::high_resolution_clock::now();
+			std::ifstream file(assetPath, std::ios::ate | std::ios::binary);
+			readData.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(readData.data(), readData.size());
+			end = std::chrono::high_resolution_clock::now();
+			readTime = std::min(readTime, std::chrono::duration<double, std::milli>(end - start).count());
+
+			// Asset pack - decompress the entry out of memory
+			start = std::chrono::high_resolution_clock::now();
+			identical = lz4Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()) && identical;
+			end = std::chrono::high_resolution_clock::now();
+			decompressTime = std::min(decompressTime, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		identical = identical && memcmp(decompressed.data(), assetFile.data(), assetFile.size()) == 0;
+
+		double ratio = compressed.empty() ? 0.0 : static_cast<double>(assetFile.size()) / compressed.size();
+		double decompressSpeed = assetFile.size() / (decompressTime * 1000.0);
+		std::cout << "asset pack " << assetPath << ": read " << readTime << " ms, LZ4 decompress " << decompressTime << " ms (" << decompressSpeed << " MB/s), compress " << compressTime << " ms, ratio " << ratio << (identical ? "" : " - OUTPUT DIFFERS") << std::endl;
+		results << "asset pack," << assetPath << "," << readTime << "," << decompressTime << "," << (identical ? "identical" : "differs") << " / ratio " << ratio << "," << assetFile.size() << " bytes" << std::endl;
+	}
+}
+
+// Benchmark which generates the levels of detail of the shipped models and reports the triangles and error of each level
+void BenchmarkManager::meshLodBenchmark(std::ofstream &results)
+{
+	std::vector<std::string> modelPaths = { FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelChaletPath, "models/sphere.obj" };
+	for (const auto& modelPath : modelPaths)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		try
+		{
+			FrameworkSingleton::getInstance()->vulkanManager.loadModel(modelPath, vertices, indices);
+		}
+		catch (const std::runtime_error &e)
+		{
+			std::cout << "mesh lods " << modelPath << ": skipped - " << e.what() << std::endl;
+			continue;
+		}
+
+		MeshSimplifier meshSimplifier;
+		MeshLods lods;
+		auto start = std::chrono::high_resolution_clock::now();
+		meshSimplifier.generateLods(vertices, 0, indices, 0, FrameworkSingleton::getInstance()->meshLodCount, lods);
+		auto end = std::chrono::high_resolution_clock::now();
+		double generateTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+		// Every level has to index the shared vertices and be made of whole triangles
+		bool valid = true;
+		std::string levels;
+		for (const auto& lod : lods.levels)
+		{
+			valid = valid && lod.indexCount % 3 == 0 && lod.firstIndex + lod.indexCount <= indices.size();
+			for (uint32_t i = lod.firstIndex; valid && i < lod.firstIndex + lod.indexCount; i++)
+			{
+				valid = indices[i] < vertices.size();
+			}
+			levels += " " + std::to_string(lod.indexCount / 3) + " (" + std::to_string(lod.error / std::max(lods.boundsRadius, 1e-6f) * 100.0f) + "%)";
+		}
+
+		std::cout << "mesh lods " << modelPath << ": " << generateTime << " ms, triangles (error as % of radius)" << levels << (valid ? "" : " - INVALID INDICES") << std::endl;
+		results << "mesh lods," << modelPath << ",," << generateTime << "," << (valid ? "valid" : "invalid") << " /" << levels << "," << vertices.size() << " vertices" << std::endl;
+	}
+}
+
+// Function which times building the terrain from the scenery model and picking its patches from the target camera positions
+void BenchmarkManager::terrainBenchmark(std::ofstream &results)
+{
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	try
+	{
+		FrameworkSingleton::getInstance()->vulkanManager.loadModel(FrameworkSingleton::getInstance()->modelSceneryPath, vertices, indices);
+	}
+	catch (const std::runtime_error &e)
+	{
+		std::cout << "terrain: skipped - " << e.what() << std::endl;
+		return;
+	}
+
+	TerrainManager terrain;
+	auto start = std::chrono::high_resolution_clock::now();
+	bool built = terrain.buildHeightsFromMesh(vertices, indices, FrameworkSingleton::getInstance()->terrainResolution);
+	terrain.buildQuadtree(FrameworkSingleton::getInstance()->terrainDetailDistance);
+	auto end = std::chrono::high_resolution_clock::now();
+	double buildTime = std::chrono::duration<double, std::milli>(end - start).count();
+	if (!built)
+	{
+		std::cout << "terrain: failed to build heights" << std::endl;
+		return;
+	}
+
+	// Look at the centre from each target camera position and from close to the ground
+	std::vector<glm::vec3> cameraPositions = { glm::vec3(10.0f, 10.0f, 10.0f), glm::vec3(-10.0f, 10.0f, 10.0f), glm::vec3(-10.0f, 10.0f, -10.0f), glm::vec3(10.0f, 10.0f, -10.0f), glm::vec3(0.0f, 2.0f, 8.0f) };
+	glm::mat4 proj = glm::perspective(glm::quarter_pi<float>(), (float)FrameworkSingleton::getInstance()->WIDTH / (float)FrameworkSingleton::getInstance()->HEIGHT, 0.414f, 1000.0f);
+	std::vector<TerrainPatch> patches;
+	for (const auto& cameraPosition : cameraPositions)
+	{
+		glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		double selectTime = 1e30;
+		for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+		{
+			start = std::chrono::high_resolution_clock::now();
+			terrain.selectPatches(cameraPosition, proj * view, patches);
+			end = std::chrono::high_resolution_clock::now();
+			selectTime = std::min(selectTime, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		// Quadrant patches only draw a quarter of the grid
+		size_t drawnCells = 0;
+		for (const auto& patch : patches)
+		{
+			drawnCells += static_cast<size_t>((patch.quadrant.z - patch.quadrant.x) * (patch.quadrant.w - patch.quadrant.y));
+		}
+		std::string camera = std::to_string(cameraPosition.x) + " " + std::to_string(cameraPosition.y) + " " + std::to_string(cameraPosition.z);
+		std::cout << "terrain from " << camera << ": " << selectTime << " ms, " << patches.size() << " patches, " << drawnCells * 2 << " triangles against " << indices.size() / 3 << " for the model" << std::endl;
+		results << "terrain," << camera << ",," << selectTime << "," << patches.size() << " patches / " << drawnCells * 2 << " triangles / built in " << buildTime << " ms," << indices.size() / 3 << " model triangles" << std::endl;
+	}
+}
+
+// Function which counts the triangles of an index list that are front facing and not wholly outside one side of the view - the least any conservative culler can draw
+static size_t countNeededTriangles(const std::vector<Vertex> &vertices, const uint32_t *indices, size_t indexCount, const glm::mat4 &model, const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition)
+{
+	size_t needed = 0;
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		glm::vec3 p[3];
+		glm::vec4 clip[3];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			p[corner] = glm::vec3(model * glm::vec4(vertices[indices[i + corner]].pos, 1.0f));
+			clip[corner] = viewProjection * glm::vec4(p[corner], 1.0f);
+		}
+		// Counter clockwise triangles are the front faces - the small margin keeps triangles seen edge on from counting either way
+		glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+		if (glm::dot(p[0] - cameraPosition, normal) >= -1e-6f * glm::length(normal) * glm::length(p[0] - cameraPosition))
+		{
+			continue;
+		}
+		bool outside = false;
+		for (int axis = 0; axis < 2 && !outside; axis++)
+		{
+			outside = (clip[0][axis] < -clip[0].w && clip[1][axis] < -clip[1].w && clip[2][axis] < -clip[2].w) || (clip[0][axis] > clip[0].w && clip[1][axis] > clip[1].w && clip[2][axis] > clip[2].w);
+		}
+		outside = outside || (clip[0].z < 0.0f && clip[1].z < 0.0f && clip[2].z < 0.0f) || (clip[0].z > clip[0].w && clip[1].z > clip[1].w && clip[2].z > clip[2].w);
+		if (!outside)
+		{
+			needed++;
+		}
+	}
+	return needed;
+}
+
+// Function which times building meshlets for the models and reports how many triangles the culler skips along recorded camera paths
+void BenchmarkManager::meshletBenchmark(std::ofstream &results)
+{
+	// Camera paths sampled once per frame - a circuit of the target camera at its usual height and a low pass straight through the scene
+	const int pathFrames = 32;
+	std::vector<std::pair<std::string, std::vector<glm::vec3>>> paths(2);
+	paths[0].first = "orbit";
+	paths[1].first = "fly-through";
+	for (int frame = 0; frame < pathFrames; frame++)
+	{
+		float angle = glm::two_pi<float>() * frame / pathFrames;
+		paths[0].second.push_back(glm::vec3(14.0f * std::cos(angle), 10.0f, 14.0f * std::sin(angle)));
+		paths[1].second.push_back(glm::vec3(-1.0f, 1.5f, glm::mix(10.0f, -10.0f, frame / float(pathFrames - 1))));
+	}
+	glm::mat4 proj = glm::perspective(glm::quarter_pi<float>(), (float)FrameworkSingleton::getInstance()->WIDTH / (float)FrameworkSingleton::getInstance()->HEIGHT, 0.414f, 1000.0f);
+	proj[1][1] *= -1;
+
+	// The chalet is drawn three times its size
+	std::vector<std::pair<std::string, glm::mat4>> models = { { FrameworkSingleton::getInstance()->modelSceneryPath, glm::mat4(1.0f) }, { FrameworkSingleton::getInstance()->modelChaletPath, glm::scale(glm::vec3(3.0f, 3.0f, 3.0f)) } };
+	for (const auto& model : models)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		try
+		{
+			FrameworkSingleton::getInstance()->vulkanManager.loadModel(model.first, vertices, indices);
+		}
+		catch (const std::runtime_error &e)
+		{
+			std::cout << "meshlets " << model.first << ": skipped - " << e.what() << std::endl;
+			continue;
+		}
+
+		MeshLods lods;
+		lods.levels.assign(1, { 0, static_cast<uint32_t>(indices.size()), 0.0f });
+		auto start = std::chrono::high_resolution_clock::now();
+		MeshletBuilder().buildMeshlets(vertices, indices.data(), lods);
+		auto end = std::chrono::high_resolution_clock::now();
+		double buildTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+		// Every meshlet has to keep to the limits and together they have to cover the model once
+		bool valid = true;
+		uint32_t nextIndex = 0;
+		for (const auto& meshlet : lods.meshlets)
+		{
+			std::set<uint32_t> meshletVertices(indices.begin() + meshlet.firstIndex, indices.begin() + meshlet.firstIndex + meshlet.indexCount);
+			valid = valid && meshlet.firstIndex == nextIndex && meshlet.indexCount % 3 == 0 && meshlet.indexCount / 3 <= meshletMaxTriangles && meshletVertices.size() <= meshletMaxVertices;
+			nextIndex = meshlet.firstIndex + meshlet.indexCount;
+		}
+		valid = valid && nextIndex == indices.size();
+
+		std::vector<uint32_t> visibleIndices(indices.size());
+		for (const auto& path : paths)
+		{
+			MeshletCuller culler;
+			double copyTime = 0.0, cullTime = 0.0;
+			size_t drawnTriangles = 0, neededTriangles = 0, drawnNeededTriangles = 0;
+			for (const auto& cameraPosition : path.second)
+			{
+				// The orbit looks at the centre and the fly-through looks along its path
+				glm::vec3 target = path.first == "orbit" ? glm::vec3(0.0f) : cameraPosition + glm::vec3(0.0f, -0.2f, -1.0f);
+				glm::mat4 viewProjection = proj * glm::lookAt(cameraPosition, target, glm::vec3(0.0f, 1.0f, 0.0f));
+
+				// Baseline is copying every index, which is what drawing without culling costs the same path
+				start = std::chrono::high_resolution_clock::now();
+				memcpy(visibleIndices.data(), indices.data(), indices.size() * sizeof(uint32_t));
+				end = std::chrono::high_resolution_clock::now();
+				copyTime += std::chrono::duration<double, std::milli>(end - start).count();
+
+				start = std::chrono::high_resolution_clock::now();
+				culler.setView(model.second, viewProjection, cameraPosition);
+				uint32_t visibleCount = culler.cull(lods, 0, indices.data(), visibleIndices.data());
+				end = std::chrono::high_resolution_clock::now();
+				cullTime += std::chrono::duration<double, std::milli>(end - start).count();
+
+				// A triangle that had to be drawn but was culled would be missing from the frame
+				drawnTriangles += visibleCount / 3;
+				neededTriangles += countNeededTriangles(vertices, indices.data(), indices.size(), model.second, viewProjection, cameraPosition);
+				drawnNeededTriangles += countNeededTriangles(vertices, visibleIndices.data(), visibleCount, model.second, viewProjection, cameraPosition);
+			}
+			bool conservative = drawnNeededTriangles == neededTriangles;
+
+			float tested = static_cast<float>(std::max<size_t>(culler.testedTriangles, 1));
+			float frustumCulled = culler.frustumCulledTriangles / tested * 100.0f;
+			float coneCulled = culler.coneCulledTriangles / tested * 100.0f;
+			float needed = neededTriangles / tested * 100.0f;
+			std::cout << "meshlets " << model.first << " " << path.first << ": " << lods.meshlets.size() << " meshlets built in " << buildTime << " ms, culled " << frustumCulled << "% by frustum and " << coneCulled << "% by cone (" << needed << "% of triangles needed), " << cullTime / pathFrames << " ms a frame against " << copyTime / pathFrames << " ms to copy every index" << (valid ? "" : " - INVALID MESHLETS") << (conservative ? "" : " - VISIBLE TRIANGLES CULLED") << std::endl;
+			results << "meshlets," << model.first << " " << path.first << "," << copyTime / pathFrames << "," << cullTime / pathFrames << "," << (valid && conservative ? "valid" : "invalid") << " / " << frustumCulled << "% frustum / " << coneCulled << "% cone / " << 100.0f - needed << "% could be culled / " << drawnTriangles / pathFrames << " triangles a frame," << lods.meshlets.size() << " meshlets built in " << buildTime << " ms" << std::endl;
+		}
+	}
+}
+
+// Function which writes a model as a binary glTF file in memory - the vertices go in as they are, interleaved, with the colour as COLOR_0
+static std::vector<uint8_t> writeGlb(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices)
+{
+	size_t vertexBytes = vertices.size() * sizeof(Vertex);
+	size_t indexBytes = indices.size() * sizeof(uint32_t);
+
+	// Positions need their bounds in a valid file
+	glm::vec3 minimum = vertices.empty() ? glm::vec3(0.0f) : vertices[0].pos, maximum = minimum;
+	for (const auto& vertex : vertices)
+	{
+		minimum = glm::min(minimum, vertex.pos);
+		maximum = glm::max(maximum, vertex.pos);
+	}
+	std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+		"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"COLOR_0\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+		"\"buffers\":[{\"byteLength\":" + std::to_string(vertexBytes + indexBytes) + "}],"
+		"\"bufferViews\":[{\"buffer\":0,\"byteLength\":" + std::to_string(vertexBytes) + ",\"byteStride\":" + std::to_string(sizeof(Vertex)) + ",\"target\":34962},"
+		"{\"buffer\":0,\"byteOffset\":" + std::to_string(vertexBytes) + ",\"byteLength\":" + std::to_string(indexBytes) + ",\"target\":34963}],"
+		"\"accessors\":[{\"bufferView\":0,\"byteOffset\":" + std::to_string(offsetof(Vertex, pos)) + ",\"componentType\":5126,\"count\":" + std::to_string(vertices.size()) + ",\"type\":\"VEC3\","
+		"\"min\":[" + std::to_string(minimum.x) + "," + std::to_string(minimum.y) + "," + std::to_string(minimum.z) + "],\"max\":[" + std::to_string(maximum.x) + "," + std::to_string(maximum.y) + "," + std::to_string(maximum.z) + "]},"
+		"{\"bufferView\":0,\"byteOffset\":" + std::to_string(offsetof(Vertex, color)) + ",\"componentType\":5126,\"count\":" + std::to_string(vertices.size()) + ",\"type\":\"VEC3\"},"
+		"{\"bufferView\":0,\"byteOffset\":" + std::to_string(offsetof(Vertex, texCoord)) + ",\"componentType\":5126,\"count\":" + std::to_string(vertices.size()) + ",\"type\":\"VEC2\"},"
+		"{\"bufferView\":1,\"componentType\":5125,\"count\":" + std::to_string(indices.size()) + ",\"type\":\"SCALAR\"}]}";
+	// Chunks are padded to four bytes - JSON with spaces
+	while (json.size() % 4 != 0)
+	{
+		json += ' ';
+	}
+
+	std::vector<uint8_t> glb(12 + 8 + json.size() + 8 + vertexBytes + indexBytes);
+	auto writeUint32 = [&](size_t offset, uint32_t value)
+	{
+		memcpy(glb.data() + offset, &value, sizeof(value));
+	};
+	memcpy(glb.data(), "glTF", 4);
+	writeUint32(4, 2);
+	writeUint32(8, static_cast<uint32_t>(glb.size()));
+	writeUint32(12, static_cast<uint32_t>(json.size()));
+	memcpy(glb.data() + 16, "JSON", 4);
+	memcpy(glb.data() + 20, json.data(), json.size());
+	size_t binary = 20 + json.size();
+	writeUint32(binary, static_cast<uint32_t>(vertexBytes + indexBytes));
+	memcpy(glb.data() + binary + 4, "BIN\0", 4);
+	memcpy(glb.data() + binary + 8, vertices.data(), vertexBytes);
+	memcpy(glb.data() + binary + 8 + vertexBytes, indices.data(), indexBytes);
+	return glb;
+}
+
+// Function which times reading each model from its OBJ file against reading the same model from a binary glTF file and checks both give the same vertices and indices
+void BenchmarkManager::gltfBenchmark(std::ofstream &results)
+{
+	std::vector<std::string> modelPaths = { FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelChaletPath, "models/sphere.obj" };
+	for (const auto& modelPath : modelPaths)
+	{
+		MappedFile objFile;
+		if (!objFile.open(modelPath))
+		{
+			std::cout << "gltf " << modelPath << ": skipped - could not be loaded" << std::endl;
+			continue;
+		}
+
+		// Parse and deduplicate the OBJ file the way loadModel does without a mesh cache
+		double objTime = 1e30, gltfTime = 1e30;
+		std::vector<Vertex> objVertices, gltfVertices;
+		std::vector<uint32_t> objIndices, gltfIndices;
+		for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+		{
+			objVertices.clear();
+			objIndices.clear();
+			auto start = std::chrono::high_resolution_clock::now();
+			FrameworkSingleton::getInstance()->vulkanManager.readObjModel(objFile.data(), objFile.size(), objVertices, objIndices);
+			auto end = std::chrono::high_resolution_clock::now();
+			objTime = std::min(objTime, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		// Read the same model back out of a binary glTF file holding what the OBJ file gave
+		std::vector<uint8_t> glb = writeGlb(objVertices, objIndices);
+		for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+		{
+			gltfVertices.clear();
+			gltfIndices.clear();
+			auto start = std::chrono::high_resolution_clock::now();
+			FrameworkSingleton::getInstance()->vulkanManager.readGltfModel(glb.data(), glb.size(), gltfVertices, gltfIndices);
+			auto end = std::chrono::high_resolution_clock::now();
+			gltfTime = std::min(gltfTime, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		bool identical = objVertices.size() == gltfVertices.size() && objIndices == gltfIndices && memcmp(objVertices.data(), gltfVertices.data(), objVertices.size() * sizeof(Vertex)) == 0;
+
+		std::cout << "gltf " << modelPath << ": obj " << objTime << " ms, glb " << gltfTime << " ms, " << gltfVertices.size() << " vertices " << gltfIndices.size() / 3 << " triangles" << (identical ? "" : " - OUTPUT DIFFERS") << std::endl;
+		results << "gltf," << modelPath << "," << objTime << "," << gltfTime << "," << (identical ? "identical" : "differs") << "," << glb.size() << " bytes" << std::endl;
+	}
+}
+
+// Function which halves an RGBA8 image halvings times one pixel at a time with the same 2x2 box filter as the mip chain
+static void downscaleOnePixelAtATime(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t halvings, std::vector<uint8_t> &downscaled)
+{
+	downscaled.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+	for (uint32_t level = 1; level <= halvings; level++)
+	{
+		uint32_t sourceWidth = MipmapGenerator::levelExtent(width, level - 1), sourceHeight = MipmapGenerator::levelExtent(height, level - 1);
+		uint32_t levelWidth = MipmapGenerator::levelExtent(width, level), levelHeight = MipmapGenerator::levelExtent(height, level);
+		std::vector<uint8_t> source;
+		source.swap(downscaled);
+		downscaled.resize(static_cast<size_t>(levelWidth) * levelHeight * 4);
+		for (uint32_t y = 0; y < levelHeight; y++)
+		{
+			for (uint32_t x = 0; x < levelWidth; x++)
+			{
+				size_t row0 = static_cast<size_t>(std::min(y * 2, sourceHeight - 1)) * sourceWidth, row1 = static_cast<size_t>(std::min(y * 2 + 1, sourceHeight - 1)) * sourceWidth;
+				size_t x0 = std::min(x * 2, sourceWidth - 1), x1 = std::min(x * 2 + 1, sourceWidth - 1);
+				for (int c = 0; c < 4; c++)
+				{
+					downscaled[(static_cast<size_t>(y) * levelWidth + x) * 4 + c] = static_cast<uint8_t>((source[(row0 + x0) * 4 + c] + source[(row0 + x1) * 4 + c] + source[(row1 + x0) * 4 + c] + source[(row1 + x1) * 4 + c] + 2) >> 2);
+				}
+			}
+		}
+	}
+}
+
+// Benchmark which scales the chalet texture down to a quarter of its width and height the way the texture budget does against a pixel at a time loop,
+// then plans the scene's textures against shrinking device memory budgets
+void BenchmarkManager::textureBudgetBenchmark(std::ofstream &results)
+{
+	const std::string &texturePath = FrameworkSingleton::getInstance()->modelChaletTexturePath;
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (pixels)
+	{
+		const uint32_t halvings = 2;
+		MipmapGenerator mipmapGenerator;
+		std::vector<uint8_t> baseline, downscaled;
+		uint32_t downscaledWidth = 0, downscaledHeight = 0;
+		double baselineTime = 1e30, downscaleTime = 1e30;
+		for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			downscaleOnePixelAtATime(pixels, width, height, halvings, baseline);
+			auto end = std::chrono::high_resolution_clock::now();
+			baselineTime = std::min(baselineTime, std::chrono::duration<double, std::milli>(end - start).count());
+
+			start = std::chrono::high_resolution_clock::now();
+			mipmapGenerator.downscale(pixels, width, height, halvings, downscaled, downscaledWidth, downscaledHeight);
+			end = std::chrono::high_resolution_clock::now();
+			downscaleTime = std::min(downscaleTime, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		stbi_image_free(pixels);
+
+		bool identical = baseline == downscaled;
+		std::cout << "texture downscale " << texturePath << ": pixel at a time " << baselineTime << " ms, SIMD box filter " << downscaleTime << " ms, " << width << "x" << height << " to " << downscaledWidth << "x" << downscaledHeight << (identical ? "" : " - OUTPUT DIFFERS") << std::endl;
+		results << "texture downscale," << texturePath << "," << baselineTime << "," << downscaleTime << "," << (identical ? "identical" : "differs") << " / " << downscaledWidth << "x" << downscaledHeight << "," << width << "x" << height << std::endl;
+	}
+	else
+	{
+		std::cout << "texture downscale " << texturePath << ": skipped - failed to load texture image!" << std::endl;
+	}
+
+	// Plan at full size, then against a half and a quarter of what that takes
+	size_t savedBudget = FrameworkSingleton::getInstance()->textureMemoryBudget;
+	FrameworkSingleton::getInstance()->textureMemoryBudget = 0;
+	VkDeviceSize fullSize = FrameworkSingleton::getInstance()->vulkanManager.planTextureBudget();
+	for (VkDeviceSize budget : { fullSize, fullSize / 2, fullSize / 4 })
+	{
+		FrameworkSingleton::getInstance()->textureMemoryBudget = static_cast<size_t>(budget);
+		auto start = std::chrono::high_resolution_clock::now();
+		VkDeviceSize plannedSize = FrameworkSingleton::getInstance()->vulkanManager.planTextureBudget();
+		auto end = std::chrono::high_resolution_clock::now();
+		double planTime = std::chrono::duration<double, std::milli>(end - start).count();
+		uint32_t chaletLevels = FrameworkSingleton::getInstance()->textureBudget.levelsDropped(texturePath);
+		std::cout << "texture budget " << budget / 1024 << " KB: " << plannedSize / 1024 << " KB planned in " << planTime << " ms, chalet texture loses " << chaletLevels << " levels" << std::endl;
+		results << "texture budget," << budget / 1024 << " KB,," << planTime << "," << plannedSize / 1024 << " KB / chalet -" << chaletLevels << " levels," << fullSize / 1024 << " KB" << std::endl;
+	}
+	FrameworkSingleton::getInstance()->textureMemoryBudget = savedBudget;
+}
+
+// Benchmark which loads the largest shipped texture into a staging copy with its full mip chain - decoding the image and generating the chain
+// against mapping a KTX file of the same levels and copying them straight out of the mapping
+void BenchmarkManager::ktxBenchmark(std::ofstream &results)
+{
+	const std::string &texturePath = FrameworkSingleton::getInstance()->modelChaletTexturePath;
+	const std::string ktxPath = "benchmark.ktx2";
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (!pixels)
+	{
+		std::cout << "ktx load " << texturePath << ": skipped - failed to load texture image!" << std::endl;
+		return;
+	}
+
+	// Write the mip chain to a KTX file once, split into its levels as the file stores them
+	MipmapGenerator mipmapGenerator;
+	uint32_t levelCount = MipmapGenerator::mipLevelCount(width, height);
+	std::vector<uint8_t> chain;
+	mipmapGenerator.generate(pixels, width, height, levelCount, chain);
+	stbi_image_free(pixels);
+	std::vector<std::vector<uint8_t>> levels(levelCount);
+	size_t levelOffset = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		size_t levelSize = TextureCompressor::compressedSize(MipmapGenerator::levelExtent(width, level), MipmapGenerator::levelExtent(height, level), TEXTURE_FORMAT_RGBA8);
+		levels[level].assign(chain.begin() + levelOffset, chain.begin() + levelOffset + levelSize);
+		levelOffset += levelSize;
+	}
+	std::string error;
+	if (!KtxReader::write(ktxPath, TEXTURE_FORMAT_RGBA8, width, height, 1, levels, error))
+	{
+		std::cout << "ktx load " << texturePath << ": skipped - " << error << std::endl;
+		return;
+	}
+
+	std::vector<uint8_t> decodedStaging, ktxStaging;
+	double decodeTime = 1e30, ktxTime = 1e30;
+	for (int repeat = 0; repeat < benchmarkRepeats; repeat++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		mipmapGenerator.generate(pixels, width, height, levelCount, decodedStaging);
+		stbi_image_free(pixels);
+		auto end = std::chrono::high_resolution_clock::now();
+		decodeTime = std::min(decodeTime, std::chrono::duration<double, std::milli>(end - start).count());
+
+		start = std::chrono::high_resolution_clock::now();
+		MappedFile ktxFile;
+		KtxReader ktxReader;
+		ktxStaging.clear();
+		if (ktxFile.open(ktxPath) && ktxReader.open(ktxFile.data(), ktxFile.size(), error))
+		{
+			ktxStaging.resize(decodedStaging.size());
+			size_t stagingOffset = 0;
+			for (const auto& level : ktxReader.levels)
+			{
+				memcpy(ktxStaging.data() + stagingOffset, level.data, level.size);
+				stagingOffset += level.size;
+			}
+		}
+		end = std::chrono::high_resolution_clock::now();
+		ktxTime = std::min(ktxTime, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	remove(ktxPath.c_str());
+
+	bool identical = decodedStaging == ktxStaging;
+	std::cout << "ktx load " << texturePath << ": decode and mipmap " << decodeTime << " ms, mapped KTX copy " << ktxTime << " ms, " << levelCount << " levels, " << ktxStaging.size() << " bytes" << (identical ? "" : " - OUTPUT DIFFERS") << std::endl;
+	results << "ktx load," << texturePath << "," << decodeTime << "," << ktxTime << "," << (identical ? "identical" : "differs") << " / " << levelCount << " levels," << width << "x" << height << std::endl;
+}
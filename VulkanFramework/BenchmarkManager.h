@@ -0,0 +1,25 @@
+#pragma once
+
+#include <fstream>
+
+class BenchmarkManager
+{
+public:
+	BenchmarkManager();
+	~BenchmarkManager();
+
+	void run();
+	void vertexHashBenchmark(std::ofstream &results);
+	void objReaderBenchmark(std::ofstream &results);
+	void meshOptimiserBenchmark(std::ofstream &results);
+	void vertexPackingBenchmark(std::ofstream &results);
+	void textureCompressionBenchmark(std::ofstream &results);
+	void mipmapBenchmark(std::ofstream &results);
+	void assetPackBenchmark(std::ofstream &results);
+	void meshLodBenchmark(std::ofstream &results);
+	void terrainBenchmark(std::ofstream &results);
+	void meshletBenchmark(std::ofstream &results);
+	void gltfBenchmark(std::ofstream &results);
+	void textureBudgetBenchmark(std::ofstream &results);
+	void ktxBenchmark(std::ofstream &results);
+};
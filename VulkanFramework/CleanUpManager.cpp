@@ -12,57 +12,76 @@ CleanUpManager::~CleanUpManager()
 // Once the window is closed, deallocation of resources occurs 
 void CleanUpManager::cleanup()
 {
+	// Stop streaming and free any uploads that have not been swapped in
+	FrameworkSingleton::getInstance()->streamingManager.stop();
+	// Stop the thread pool - nothing is decoded once streaming has stopped
+	FrameworkSingleton::getInstance()->threadPool.stop();
+	// Report the device memory the scene ended up using while it is all still held
+	FrameworkSingleton::getInstance()->memoryAllocator.report();
+	FrameworkSingleton::getInstance()->geometryBuffer.report();
+	FrameworkSingleton::getInstance()->uploadContext.report();
+	FrameworkSingleton::getInstance()->stagingRing.report();
+	FrameworkSingleton::getInstance()->uniformArena.report();
+	FrameworkSingleton::getInstance()->textureBudget.report();
+	// Wait for the last uploads and free the upload context's command buffers - nothing recorded since the last frame is needed any more
+	FrameworkSingleton::getInstance()->uploadContext.cleanup();
+
 	// Clean up and destroy the Swap Chain
 	cleanupSwapChain();
 
 	// Destory the image sampler
 	vkDestroySampler(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->textureSampler, nullptr);
-	// Destroy the texture image view
-	vkDestroyImageView(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->textureImageView, nullptr);
-
-	// Destory all VkImages
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->boxesTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->modelSceneryTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->modelChaletTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->checkedTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->frontSkyTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->backSkyTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->leftSkyTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->rightSkyTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->topSkyTexture, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->bottomSkyTexture, nullptr);
-
-	// Destroy all VkImageMemory
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->boxesTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->modelSceneryTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->modelChaletTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->checkedTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->frontSkyTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->backSkyTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->leftSkyTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->rightSkyTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->topSkyTextureMemory, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->bottomSkyTextureMemory, nullptr);
+	// Destroy the texture image view - unless it is still the streaming placeholder
+	if (FrameworkSingleton::getInstance()->textureImageView != FrameworkSingleton::getInstance()->placeholderImageView)
+	{
+		vkDestroyImageView(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->textureImageView, nullptr);
+	}
+	// Destroy the streaming placeholders
+	vkDestroyImageView(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->placeholderImageView, nullptr);
+	vkDestroyImageView(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->placeholderCubeImageView, nullptr);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(FrameworkSingleton::getInstance()->placeholderTexture);
+	FrameworkSingleton::getInstance()->geometryBuffer.releaseMesh(FrameworkSingleton::getInstance()->placeholderVertexBuffer, FrameworkSingleton::getInstance()->placeholderIndexBuffer, FrameworkSingleton::getInstance()->placeholderRange, FrameworkSingleton::getInstance()->placeholderIndexType);
+
+	// Destroy every texture image and model buffer - each is held once by the asset registry however many objects share it
+	FrameworkSingleton::getInstance()->assetRegistry.report();
+	FrameworkSingleton::getInstance()->assetRegistry.cleanup();
+
+	// Destroy the texture arrays
+	for (size_t i = 0; i < FrameworkSingleton::getInstance()->textureArrays.size(); i++)
+	{
+		vkDestroyImageView(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->textureArrayViews[i], nullptr);
+		FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(FrameworkSingleton::getInstance()->textureArrays[i]);
+	}
+
+	// Destroy the heightmap terrain
+	if (FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->terrainManager.cleanup();
+	}
 
 	// Destroy the descriptor pool for the uniform buffers
 	vkDestroyDescriptorPool(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->descriptorPool, nullptr);
 	// Destroy the descriptor set layout used for the uniform buffers
 	vkDestroyDescriptorSetLayout(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->descriptorSetLayout, nullptr);
 
-	// Destroy and free the uniform buffer/memory
-	vkDestroyBuffer(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->uniformBuffer, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->uniformBufferMemory, nullptr);
-	vkDestroyBuffer(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->rotatingUniformBuffer, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->rotatingUniformBufferMemory, nullptr);
+	// Destroy and free the uniform arena and buffer/memory
+	FrameworkSingleton::getInstance()->uniformArena.cleanup();
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(FrameworkSingleton::getInstance()->lodDrawBuffer);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(FrameworkSingleton::getInstance()->visibleIndexChaletModel);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(FrameworkSingleton::getInstance()->visibleIndexSceneryModel);
 
 	// Destory the index buffer
-	vkDestroyBuffer(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->indexPlane, nullptr);
-	// Free the index buffer memory
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->indexPlaneMemory, nullptr);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(FrameworkSingleton::getInstance()->indexPlane);
+	// Destroy the shared vertex and index buffers with every mesh still in them
+	FrameworkSingleton::getInstance()->geometryBuffer.cleanup();
+	// Destroy the staging ring every upload was copied through
+	FrameworkSingleton::getInstance()->stagingRing.cleanup();
 
 	// Destroy the semaphore
 	vkDestroySemaphore(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->renderFinishedSemaphore, nullptr);
 	vkDestroySemaphore(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->imageAvailableSemaphore, nullptr);
+	// Destroy the fence the frames signal
+	vkDestroyFence(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->frameFence, nullptr);
 	// Destroy the commandpool
 	vkDestroyCommandPool(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->commandPool, nullptr);
 	// Destory the framebuffer 
@@ -84,6 +103,8 @@ void CleanUpManager::cleanup()
 	}
 	// Destory the swap chain 
 	vkDestroySwapchainKHR(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->swapChain, nullptr);
+	// Free the device memory blocks now every buffer and image is destroyed
+	FrameworkSingleton::getInstance()->memoryAllocator.cleanup();
 	// Destroy the logical device 
 	vkDestroyDevice(FrameworkSingleton::getInstance()->device, nullptr);
 	// Destroy the debug report call back which relys any error messages through the use of validation layers 
@@ -96,6 +117,8 @@ void CleanUpManager::cleanup()
 	glfwDestroyWindow(FrameworkSingleton::getInstance()->window);
 	// Terminate access to GLFW
 	glfwTerminate();
+	// Unmap the asset pack
+	FrameworkSingleton::getInstance()->fileSystem.unmount();
 }
 
 // Clean Up old version of Swap Chain
@@ -103,8 +126,7 @@ void CleanUpManager::cleanupSwapChain()
 {
 	// Destroy and free up the image(view) and memory with regards to the depth buffer
 	vkDestroyImageView(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->depthImageView, nullptr);
-	vkDestroyImage(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->depthImage, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->depthImageMemory, nullptr);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(FrameworkSingleton::getInstance()->depthImage);
 
 	// Destroy all the framebuffers associated with the Swap Chain 
 	for (size_t i = 0; i < FrameworkSingleton::getInstance()->swapChainFramebuffers.size(); i++)
@@ -119,6 +141,11 @@ void CleanUpManager::cleanupSwapChain()
 	vkDestroyPipeline(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->graphicsPipeline, nullptr);
 	vkDestroyPipeline(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->skyboxGraphicsPipeline, nullptr);
 	vkDestroyPipelineLayout(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->pipelineLayout, nullptr);
+	vkDestroyPipelineLayout(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->skyboxPipelineLayout, nullptr);
+	if (FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->terrainManager.destroyPipeline();
+	}
 	vkDestroyRenderPass(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->renderPass, nullptr);
 
 	// For all the Swap Cahin Image Views
@@ -2,6 +2,7 @@
 
 #include "include\STBIMAGE\stb_image.h"
 #include "include\TinyOBJ\tiny_obj_loader.h"
+#include "Vertex.h"
 
 FrameworkSingleton::FrameworkSingleton()
 {
@@ -27,69 +28,6 @@ FrameworkSingleton* FrameworkSingleton::getInstance()
 	return singletonInstance;
 }
 
-// Struct called vertex which stores the information for the vertex shader
-struct Vertex
-{
-	glm::vec3 pos;
-	glm::vec3 color;
-	glm::vec2 texCoord;
-
-	// Tell Vulkan how to pass this data format to the vertex shader - bind the information
-	static VkVertexInputBindingDescription getBindingDescription()
-	{
-		// Struct which contains information regarding how the data is sumbitted to the GPU and vertex shader
-		VkVertexInputBindingDescription bindingDescription = {};
-		bindingDescription.binding = 0; // Specifies the index of the binding in the array of bindings
-		bindingDescription.stride = sizeof(Vertex); // Specifies the number of bytes from one entry to the next
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Specifies the move to the next data entry after each vertex
-
-		return bindingDescription;
-	}
-
-	// Tell Vulkan the attribute description 
-	static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
-	{
-		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
-
-		// Two different attribute description, one for position
-		attributeDescriptions[0].binding = 0; // Binding parameter specifies from which binding the per-vertex data comes
-		attributeDescriptions[0].location = 0; // References the location directive of the input in the vertex shader.
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT; // Describes the type of data for the attribute - vec3
-		attributeDescriptions[0].offset = offsetof(Vertex, pos);
-		// The other for colour 
-		attributeDescriptions[1].binding = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT; // vec3
-		attributeDescriptions[1].offset = offsetof(Vertex, color);
-		// The other for the texture coordinates
-		attributeDescriptions[2].binding = 0;
-		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT; // Vec2
-		attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
-
-		return attributeDescriptions;
-	}
-
-	// Helper function used as part of the model loader to set the vertex information - Comment out when not using models
-	bool operator==(const Vertex& other) const
-	{
-		return pos == other.pos && color == other.color && texCoord == other.texCoord;
-	}
-};
-
-namespace std //- Comment out when not using models
-{
-	template<> struct hash<Vertex>
-	{
-		size_t operator()(Vertex const& vertex) const
-		{
-			return ((hash<glm::vec3>()(vertex.pos) ^
-				(hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-				(hash<glm::vec2>()(vertex.texCoord) << 1);
-		}
-	};
-}
-
 const std::vector<Vertex> cubeVertices1 =
 {
 	// Upper (original) square
@@ -36,6 +36,8 @@
 #include <unordered_map>
 
 // Include other header files
+#include "Vertex.h"
+#include "TextureCompressor.h"
 #include "camera.h"
 #include "free_camera.h"
 #include "target_camera.h"
@@ -44,8 +46,21 @@
 #include "CleanUpManager.h"
 #include "VulkanManager.h"
 #include "SceneManager.h"
+#include "BenchmarkManager.h"
+#include "StreamingManager.h"
+#include "VirtualFileSystem.h"
+#include "TerrainManager.h"
+#include "MeshletCuller.h"
+#include "AssetWatcher.h"
+#include "AssetRegistry.h"
+#include "TextureBudget.h"
+#include "MemoryAllocator.h"
+#include "GeometryBuffer.h"
+#include "StagingRing.h"
+#include "UploadContext.h"
+#include "ThreadPool.h"
+#include "UniformArena.h"
 
-struct Vertex;
 struct SwapChainSupportDetails;
 struct QueueFamilyIndices;
 struct UniformBufferObject;
@@ -94,6 +109,76 @@ public:
 	// Set model paths
 	const std::string modelSceneryPath = "models/mountains.obj"; // Scenery
 	const std::string modelChaletPath = "models/chalet.obj"; // Chalet
+	// Write deduplicated models to a .meshcache file next to the model and load from it on later runs
+	bool useModelCache = true;
+	// Reorder model triangles and vertices for the vertex cache and overdraw when they are loaded
+	bool optimiseMeshes = true;
+	// Simplify each model into meshLodCount levels of detail sharing its vertex buffer and draw the coarsest level whose error covers at most lodPixelError pixels
+	bool generateMeshLods = true;
+	unsigned int meshLodCount = 4;
+	float lodPixelError = 1.0f;
+	// Split each model level into meshlets and copy only the triangles of meshlets inside the view and facing the camera into the index buffer the model is drawn from each frame
+	bool useMeshletCulling = false;
+	// Draw the scenery as a heightmap terrain of grid patches picked by a CDLOD quadtree instead of the scenery model - build shaders/terrainVert.spv with shaders/compile.bat first
+	bool useTerrain = false;
+	// Greyscale heightmap image the terrain is built from - when empty the heights are taken from the scenery model
+	std::string terrainHeightmapPath = "";
+	// Height samples along each side of the terrain less one - rounded up to a power of two
+	unsigned int terrainResolution = 256;
+	// Width of a terrain built from a heightmap image and the height of its white pixels - a terrain built from the scenery model keeps its size
+	float terrainSize = 24.0f;
+	float terrainHeightScale = 1.5f;
+	// Distance the finest terrain patches are drawn to - each coarser level reaches twice as far, and it is lengthened if the patches are too large for it
+	float terrainDetailDistance = 2.0f;
+	// Upload vertices in the 12 byte PackedVertex layout and draw them with shaders/packedVert.spv - build it with shaders/compile.bat first
+	bool usePackedVertices = false;
+	// Block compress textures and write them to a .texcache file next to the texture so later runs upload the compressed blocks directly
+	bool compressTextures = true;
+	// Format textures are compressed to - BC1 textures with alpha are stored as BC3
+	TextureFormat textureCompressionFormat = TEXTURE_FORMAT_BC7;
+	// Generate a full mip chain for every texture - compressed textures store every level in their texture cache
+	bool generateMipmaps = true;
+	// Blit the mip chain of uncompressed textures on the GPU instead of building it on the CPU - ignored for compressed textures
+	bool generateMipmapsOnGpu = false;
+	// Top mip levels every texture loses when it is loaded - lower tiers let the same scene run on devices with less memory
+	TextureQuality textureQuality = TEXTURE_QUALITY_HIGH;
+	// Most bytes of device memory the scene's textures may take - while over it the texture least important for its size loses another top level, 0 for no budget
+	size_t textureMemoryBudget = 0;
+	// Pack textures of the same size, format and mip chain into texture arrays and draw all regular geometry with one descriptor set, picking each texture with a push constant
+	// Only used when assets are loaded up front - streamAssets is on by default and must be turned off too, as streamed textures arrive one at a time
+	// and keep their own descriptor sets. Also ignored when the device cannot index sampler arrays
+	bool useTextureArrays = false;
+	// Load textures and models on background threads after the first frame, drawing placeholders until each one arrives
+	bool streamAssets = true;
+	// Watch the shaders, textures and models for changes and rebuild only the pipelines, images and buffers made from a changed file
+	// Loose files are watched so the asset pack is not mounted - recompile shaders with shaders/compile.bat to see shader changes
+	bool useHotReload = false;
+	// Upload each texture and model once however many slots load it - a file with the same contents as one already uploaded shares its image or buffers, reference counted
+	// Shared loads and the device memory they saved are reported when the application closes
+	bool shareAssets = true;
+	// Bind buffers and images to ranges of large blocks of device memory reserved for each memory type instead of allocating memory for each one
+	// Resources larger than half a block get memory of their own - blocks are an eighth of the heap on small heaps. Usage is reported when the application closes
+	bool useMemoryAllocator = true;
+	size_t memoryBlockSize = 64 * 1024 * 1024;
+	// Pack the vertices and indices of every mesh into one shared vertex buffer and one shared index buffer so the draws bind them once
+	// Meshes that do not fit in what is left of them are given buffers of their own
+	bool useGeometryBuffer = true;
+	size_t geometryVertexBufferSize = 32 * 1024 * 1024;
+	size_t geometryIndexBufferSize = 16 * 1024 * 1024;
+	// Size of the persistently mapped buffer every upload is staged through - uploads larger than half of it are copied in chunks
+	size_t stagingRingSize = 32 * 1024 * 1024;
+	// Bytes of uniform data every object together can use in one frame - each object's data is rounded up to the device's minimum uniform buffer offset alignment
+	size_t uniformArenaSliceSize = 256 * 1024;
+	// Most bytes of streamed textures and models copied into the staging ring in one frame - one is always started even if it is larger
+	size_t streamingUploadBudget = 32 * 1024 * 1024;
+
+	// Read assets out of the asset pack instead of loose files when it exists - files the pack does not hold are still read from disk
+	bool useAssetPack = true;
+	const std::string assetPackPath = "assets.pack";
+	// Pack the models, textures, shaders and their caches into the asset pack instead of starting the application - run once with the caches built first to pack them too
+	bool buildAssetPack = false;
+	// LZ4 compress entries in the asset pack that shrink by at least an eighth
+	bool compressAssetPack = true;
 
 	// Set texture paths
 	const std::string boxesTexturePath = "textures/box.jpg"; // Boxes
@@ -108,9 +193,17 @@ public:
 	const std::string rightSkyTexturePath = "textures/skyboxes/right.png";
 	const std::string frontSkyTexturePath = "textures/skyboxes/front.png";
 	const std::string backSkyTexturePath = "textures/skyboxes/back.png";
+	// Load the skybox from this one KTX cube map when it exists instead of decoding the six face images - ignored with texture arrays, which hold the faces as layers
+	bool useSkyboxCubeMap = true;
+	const std::string skyboxCubeMapPath = "textures/skyboxes/skybox.ktx2";
+	// Write the six face images into the skybox cube map instead of starting the application - in the format textures are compressed to, with every mip level
+	bool buildSkyboxCubeMap = false;
 
 	int cameraType = 0;
 
+	// Run the CPU benchmarks and write benchmark.csv instead of starting the application
+	bool runBenchmarks = false;
+
 	int NUMBEROFSHAPES = 6;
 
 	VkImageViewType twoDImageView = VK_IMAGE_VIEW_TYPE_2D;
@@ -121,10 +214,62 @@ public:
 	VulkanManager vulkanManager;
 	CleanUpManager cleanUpManager;
 	SceneManager sceneManager;
+	BenchmarkManager benchmarkManager;
+	StreamingManager streamingManager;
+	VirtualFileSystem fileSystem;
+	TerrainManager terrainManager;
+	MeshletCuller meshletCuller;
+	AssetWatcher assetWatcher;
+	AssetRegistry assetRegistry;
+	TextureBudget textureBudget;
+	MemoryAllocator memoryAllocator;
+	GeometryBuffer geometryBuffer;
+	StagingRing stagingRing;
+	UploadContext uploadContext;
+	UniformArena uniformArena;
+	ThreadPool threadPool;
 
 	// Run method which contains all the private class members 
 	void run()
 	{
+		// Start the worker threads every parallel task is shared out across
+		threadPool.start();
+
+		// Run the benchmarks on their own - no window or GPU is needed
+		if (runBenchmarks)
+		{
+			benchmarkManager.run();
+			threadPool.stop();
+			return;
+		}
+
+		// Build the skybox cube map on its own - no window or GPU is needed
+		if (buildSkyboxCubeMap)
+		{
+			vulkanManager.buildSkyboxCubeMap();
+			threadPool.stop();
+			return;
+		}
+
+		// Build the asset pack on its own - no window or GPU is needed
+		if (buildAssetPack)
+		{
+			vulkanManager.buildAssetPack();
+			threadPool.stop();
+			return;
+		}
+
+		// Mount the asset pack if there is one - without it every asset is read from its loose file, as hot reload needs
+		if (useAssetPack && !useHotReload)
+		{
+			std::string packError;
+			std::ifstream packFile(assetPackPath);
+			if (packFile.good() && !fileSystem.mount(assetPackPath, packError))
+			{
+				std::cerr << "Asset pack not used: " + packError << std::endl;
+			}
+		}
+
 		// Setup output file
 		std::ofstream data("data.csv", std::ofstream::out);
 		// Record the start time 
@@ -185,6 +330,8 @@ public:
 	std::vector<VkImageView> swapChainImageViews;
 	// Member variable which stores the pipeline state - stores different uniform values which can be changed at drawing time to alter the behaviour of shaders without recreation
 	VkPipelineLayout pipelineLayout;
+	// Layout of the skybox pipeline - identical to pipelineLayout, so descriptor sets and push constants bound through either stay valid across both pipelines
+	VkPipelineLayout skyboxPipelineLayout;
 	// Member variable which stores the render pass - uses the colour attachtments and supasses to create a pass 
 	VkRenderPass renderPass;
 	// Member variable which stores thge graphics pipeline
@@ -197,41 +344,58 @@ public:
 	// Semaphores synchronise operations within or across command queues - check if the image is ready for rendering and signal that rendering has finished. 
 	VkSemaphore imageAvailableSemaphore;
 	VkSemaphore renderFinishedSemaphore;
+	// Fence the last frame's draw signals once it has finished - waited on before anything its command buffer binds is replaced
+	VkFence frameFence = VK_NULL_HANDLE;
 	// Vectors which contain the vertices and indices for the model
 	std::vector<Vertex> modelChaletVertices;
 	std::vector<uint32_t> modelChaletIndices;
 	std::vector<Vertex> modelSceneryVertices;
 	std::vector<uint32_t> modelSceneryIndices;
+	// Levels of detail of each model - their indices follow the full model's in the index vectors
+	MeshLods modelChaletLods;
+	MeshLods modelSceneryLods;
 	// Vertex Buffer object 
 	VkBuffer vertexBox1, vertexBox2, vertexBox3;
 	VkBuffer vertexChaletModel;
 	VkBuffer vertexSceneryModel;
 	VkBuffer vertexSkybox;
-	// Vertex Buffer memory object which holds the memory regarding the vertex buffer 
-	VkDeviceMemory vertexBox1Memory, vertexBox2Memory, vertexBox3Memory;
-	VkDeviceMemory vertexChaletModelMemory;
-	VkDeviceMemory vertexSceneryModelMemory;
-	VkDeviceMemory vertexSkyboxMemory;
+	// Transform which unpacks the positions of each vertex buffer when the packed vertex layout is used
+	VertexDequantisation dequantBox1, dequantBox2, dequantBox3;
+	VertexDequantisation dequantChaletModel;
+	VertexDequantisation dequantSceneryModel;
+	VertexDequantisation dequantSkybox;
+	// Where each mesh lies in its vertex and index buffers - the boxes share one range of indices
+	MeshRange rangeBox1, rangeBox2, rangeBox3;
+	MeshRange rangeChaletModel;
+	MeshRange rangeSceneryModel;
+	MeshRange rangeSkybox;
 	// Index buffer object
 	VkBuffer indexBox;
 	VkBuffer indexPlane;
 	VkBuffer indexChaletModel;
 	VkBuffer indexSceneryModel;
 	VkBuffer indexSkybox;
-	// Vertex Buffer memory object which holds the memory regarding the vertex buffer 
-	VkDeviceMemory indexBoxMemory;
-	VkDeviceMemory indexPlaneMemory;
-	VkDeviceMemory indexChaletModelMemory;
-	VkDeviceMemory indexSceneryModelMemory;
-	VkDeviceMemory indexSkyboxMemory;
+	// Type of each index buffer - 16 bit when every index fits, otherwise 32 bit
+	VkIndexType indexBoxType;
+	VkIndexType indexPlaneType;
+	VkIndexType indexChaletModelType;
+	VkIndexType indexSceneryModelType;
+	VkIndexType indexSkyboxType;
 	// Descriptor layout used for specifying the layout for the uniform buffers
 	VkDescriptorSetLayout descriptorSetLayout;
-	// Uniform buffer object which is used to store the uniform buffer
-	VkBuffer uniformBuffer;
-	VkBuffer rotatingUniformBuffer;
-	// Uniform buffer object memory 
-	VkDeviceMemory uniformBufferMemory;
-	VkDeviceMemory rotatingUniformBufferMemory;
+	// Offsets of the normal and rotating uniform buffer objects in the uniform arena
+	uint32_t uniformObject = 0;
+	uint32_t rotatingUniformObject = 0;
+	// Draw parameters of the level of detail chosen for each model - rewritten every frame so the draw command buffers do not have to be recorded again
+	// Like the uniform arena it has a slice for each swap chain image, so a frame never rewrites the draws the GPU may still be reading for another
+	VkBuffer lodDrawBuffer = VK_NULL_HANDLE;
+	uint32_t lodDrawSliceCount = 0;
+	// Host visible index buffers the visible meshlets of each model are copied into every frame when meshlet culling is used - a slice for each
+	// swap chain image, each sized for the full model
+	VkBuffer visibleIndexChaletModel = VK_NULL_HANDLE;
+	VkBuffer visibleIndexSceneryModel = VK_NULL_HANDLE;
+	uint32_t visibleIndexChaletModelCapacity = 0;
+	uint32_t visibleIndexSceneryModelCapacity = 0;
 	// Descriptor pool object which is used to get descriptor sets
 	VkDescriptorPool descriptorPool;
 	// Descriptor set which is gets sets from the pool
@@ -240,19 +404,37 @@ public:
 	VkDescriptorSet modelSceneryDescriptorSet;
 	VkDescriptorSet modelChaletDescriptorSet;
 	VkDescriptorSet skyboxDescriptorSet;
-	// VkImage objects which hold images information
-	VkImage boxesTexture; // Boxes
-	VkImage modelChaletTexture; // Chalet
-	VkImage modelSceneryTexture; // Scenery
-	VkImage checkedTexture; // Checked
-	VkImage frontSkyTexture, backSkyTexture, leftSkyTexture, rightSkyTexture, topSkyTexture, bottomSkyTexture; // Skybox
-	// Texture image memory 
-	// VkDevice Memory used to store the images data
-	VkDeviceMemory boxesTextureMemory; // Boxes
-	VkDeviceMemory modelChaletTextureMemory; // Chalet
-	VkDeviceMemory modelSceneryTextureMemory; // Scenery
-	VkDeviceMemory checkedTextureMemory; // Chcked
-	VkDeviceMemory frontSkyTextureMemory, backSkyTextureMemory, leftSkyTextureMemory, rightSkyTextureMemory, topSkyTextureMemory, bottomSkyTextureMemory; // Skybox
+	// Descriptor set which holds every texture array - used by every draw in place of the sets above when textures are packed into arrays
+	VkDescriptorSet textureArrayDescriptorSet = VK_NULL_HANDLE;
+	// VkImage objects which hold images information - null until a streamed texture has arrived
+	VkImage boxesTexture = VK_NULL_HANDLE; // Boxes
+	VkImage modelChaletTexture = VK_NULL_HANDLE; // Chalet
+	VkImage modelSceneryTexture = VK_NULL_HANDLE; // Scenery
+	VkImage checkedTexture = VK_NULL_HANDLE; // Checked
+	VkImage frontSkyTexture = VK_NULL_HANDLE, backSkyTexture = VK_NULL_HANDLE, leftSkyTexture = VK_NULL_HANDLE, rightSkyTexture = VK_NULL_HANDLE, topSkyTexture = VK_NULL_HANDLE, bottomSkyTexture = VK_NULL_HANDLE; // Skybox
+	VkImage skyboxCubeMap = VK_NULL_HANDLE; // Skybox when it is loaded from its cube map - the face images are left null
+	// Format each texture was uploaded in - the skybox view uses the format its six faces share, or the cube map's
+	VkFormat boxesTextureFormat; // Boxes
+	VkFormat modelChaletTextureFormat; // Chalet
+	VkFormat modelSceneryTextureFormat; // Scenery
+	VkFormat checkedTextureFormat; // Checked
+	VkFormat frontSkyTextureFormat = VK_FORMAT_UNDEFINED, backSkyTextureFormat = VK_FORMAT_UNDEFINED, leftSkyTextureFormat = VK_FORMAT_UNDEFINED, rightSkyTextureFormat = VK_FORMAT_UNDEFINED, topSkyTextureFormat = VK_FORMAT_UNDEFINED, bottomSkyTextureFormat = VK_FORMAT_UNDEFINED; // Skybox faces
+	VkFormat skyboxTextureFormat; // Skybox
+	// Set when the device supports BC compressed textures - textures are uploaded uncompressed when it does not
+	bool textureCompressionBCSupported = false;
+	// Set when uncompressed textures can be blitted with linear filtering to build their mip chain on the GPU
+	bool textureMipmapBlitSupported = false;
+	// Set when textures are packed into texture arrays - useTextureArrays was asked for, assets are loaded up front and the device can index sampler arrays
+	bool textureArraysActive = false;
+	// Set when the skybox is loaded from its cube map - useSkyboxCubeMap was asked for, the file exists and textures are not packed into arrays
+	bool skyboxCubeMapActive = false;
+	// Images holding the texture arrays and the array view of each one
+	std::vector<VkImage> textureArrays;
+	std::vector<VkImageView> textureArrayViews;
+	// Texture array and layer each texture was packed into
+	TextureLayer boxesTextureLayer, checkedTextureLayer, modelSceneryTextureLayer, modelChaletTextureLayer, skyboxTextureLayer;
+	// Largest number of mip levels of any texture - the sampler allows this many
+	uint32_t textureMipLevels = 1;
 	// Image view which holds the texture image 
 	// VkImageView which takes an image and is bound to a descriptor
 	VkImageView textureImageView;
@@ -260,12 +442,19 @@ public:
 	VkImageView modelChaletImageView;
 	VkImageView checkedImageView;
 	VkImageView skyboxImageView;
+	// Texture and mesh drawn in place of streamed textures and models until they arrive - only created when assets are streamed
+	VkImage placeholderTexture = VK_NULL_HANDLE;
+	VkImageView placeholderImageView = VK_NULL_HANDLE;
+	VkImageView placeholderCubeImageView = VK_NULL_HANDLE; // Only made when the skybox is loaded from a cube map
+	VkBuffer placeholderVertexBuffer = VK_NULL_HANDLE;
+	VertexDequantisation placeholderDequantisation;
+	VkBuffer placeholderIndexBuffer = VK_NULL_HANDLE;
+	VkIndexType placeholderIndexType;
+	MeshRange placeholderRange;
 	// Texture sampler object that handles the texture sampler information - regards to how the image is presented - ie repeat or wrapped
 	VkSampler textureSampler;
 	// Depth image - like a colour attachment and defines the fepth of the images
 	VkImage depthImage;
-	// Depth image memory
-	VkDeviceMemory depthImageMemory;
 	// Depth image view - what part of the depth image we see
 	VkImageView depthImageView;
 };
@@ -0,0 +1,202 @@
+#include "GeometryBuffer.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+
+GeometryBuffer::GeometryBuffer()
+{
+}
+
+GeometryBuffer::~GeometryBuffer()
+{
+}
+
+// Function which creates the shared vertex and index buffers, each one free range - nothing is created when the geometry buffer is not used
+void GeometryBuffer::create()
+{
+	if (!FrameworkSingleton::getInstance()->useGeometryBuffer)
+	{
+		return;
+	}
+
+	// Every vertex buffer holds the one layout chosen for the run
+	vertexStride = static_cast<uint32_t>(FrameworkSingleton::getInstance()->usePackedVertices ? sizeof(PackedVertex) : sizeof(Vertex));
+	vertexCapacity = static_cast<uint32_t>(FrameworkSingleton::getInstance()->geometryVertexBufferSize / vertexStride);
+	indexWordCapacity = static_cast<uint32_t>(FrameworkSingleton::getInstance()->geometryIndexBufferSize / sizeof(uint32_t));
+	FrameworkSingleton::getInstance()->vulkanManager.createBuffer(static_cast<VkDeviceSize>(vertexCapacity) * vertexStride, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer);
+	FrameworkSingleton::getInstance()->vulkanManager.createBuffer(static_cast<VkDeviceSize>(indexWordCapacity) * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer);
+
+	freeVertices = { { 0, vertexCapacity } };
+	freeIndexWords = { { 0, indexWordCapacity } };
+}
+
+// Function which finds room for a mesh's vertices and indices - false, with nothing taken, when the geometry buffer is not used or either does not fit
+// The mesh's data is then copied to vertexByteOffset and indexByteOffset by whoever uploads it
+bool GeometryBuffer::allocate(uint32_t vertexCount, uint32_t indexCount, VkIndexType indexType, MeshRange &range)
+{
+	if (vertexBuffer == VK_NULL_HANDLE)
+	{
+		return false;
+	}
+
+	uint32_t firstVertex, firstWord;
+	if (!allocateRange(freeVertices, vertexCount, firstVertex))
+	{
+		overflowCount++;
+		return false;
+	}
+	if (!allocateRange(freeIndexWords, indexWords(indexCount, indexType), firstWord))
+	{
+		freeRange(freeVertices, firstVertex, vertexCount);
+		overflowCount++;
+		return false;
+	}
+
+	range.firstVertex = firstVertex;
+	range.vertexCount = vertexCount;
+	// Both index types are bound at the start of the buffer so a word holds two 16 bit indices
+	range.firstIndex = indexType == VK_INDEX_TYPE_UINT16 ? firstWord * 2 : firstWord;
+	range.indexCount = indexCount;
+	meshCount++;
+	usedVertices += vertexCount;
+	usedIndexWords += indexWords(indexCount, indexType);
+	return true;
+}
+
+// Function which hands a mesh's vertices and indices back to the geometry buffer - only once nothing will draw them again
+void GeometryBuffer::free(const MeshRange &range, VkIndexType indexType)
+{
+	uint32_t firstWord = indexType == VK_INDEX_TYPE_UINT16 ? range.firstIndex / 2 : range.firstIndex;
+	freeRange(freeVertices, range.firstVertex, range.vertexCount);
+	freeRange(freeIndexWords, firstWord, indexWords(range.indexCount, indexType));
+	usedVertices -= range.vertexCount;
+	usedIndexWords -= indexWords(range.indexCount, indexType);
+}
+
+// Function which checks whether a vertex or index buffer is one of the geometry buffer's own
+bool GeometryBuffer::contains(VkBuffer buffer) const
+{
+	return buffer != VK_NULL_HANDLE && (buffer == vertexBuffer || buffer == indexBuffer);
+}
+
+// Function which lets go of a mesh once nothing draws it - its range is freed if it lies in the geometry buffer, otherwise its own buffers are destroyed
+void GeometryBuffer::releaseMesh(VkBuffer meshVertexBuffer, VkBuffer meshIndexBuffer, const MeshRange &range, VkIndexType indexType)
+{
+	if (contains(meshVertexBuffer))
+	{
+		free(range, indexType);
+		return;
+	}
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(meshVertexBuffer);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(meshIndexBuffer);
+}
+
+// Function which returns where a mesh's vertices start in the vertex buffer in bytes
+VkDeviceSize GeometryBuffer::vertexByteOffset(const MeshRange &range) const
+{
+	return static_cast<VkDeviceSize>(range.firstVertex) * vertexStride;
+}
+
+// Function which returns where a mesh's indices start in the index buffer in bytes
+VkDeviceSize GeometryBuffer::indexByteOffset(const MeshRange &range, VkIndexType indexType) const
+{
+	return static_cast<VkDeviceSize>(range.firstIndex) * (indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+}
+
+// Function which takes count elements from the smallest free range that holds them - false if none does
+bool GeometryBuffer::allocateRange(std::vector<GeometryFreeRange> &freeRanges, uint32_t count, uint32_t &first)
+{
+	// Empty meshes take nothing but still need somewhere to point
+	if (count == 0)
+	{
+		first = 0;
+		return true;
+	}
+	auto best = freeRanges.end();
+	for (auto freeRange = freeRanges.begin(); freeRange != freeRanges.end(); ++freeRange)
+	{
+		if (freeRange->count >= count && (best == freeRanges.end() || freeRange->count < best->count))
+		{
+			best = freeRange;
+		}
+	}
+	if (best == freeRanges.end())
+	{
+		return false;
+	}
+
+	// Take the start of the range so what is left stays in place
+	first = best->first;
+	best->first += count;
+	best->count -= count;
+	if (best->count == 0)
+	{
+		freeRanges.erase(best);
+	}
+	return true;
+}
+
+// Function which returns count elements to the free ranges, merging them with the free ranges either side
+void GeometryBuffer::freeRange(std::vector<GeometryFreeRange> &freeRanges, uint32_t first, uint32_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), first, [](const GeometryFreeRange &freeRange, uint32_t start) { return freeRange.first < start; });
+	bool joinsPrevious = next != freeRanges.begin() && std::prev(next)->first + std::prev(next)->count == first;
+	bool joinsNext = next != freeRanges.end() && first + count == next->first;
+	if (joinsPrevious && joinsNext)
+	{
+		std::prev(next)->count += count + next->count;
+		freeRanges.erase(next);
+	}
+	else if (joinsPrevious)
+	{
+		std::prev(next)->count += count;
+	}
+	else if (joinsNext)
+	{
+		next->first = first;
+		next->count += count;
+	}
+	else
+	{
+		GeometryFreeRange freeRange;
+		freeRange.first = first;
+		freeRange.count = count;
+		freeRanges.insert(next, freeRange);
+	}
+}
+
+// Function which returns the four byte words of the index buffer a mesh's indices take up
+uint32_t GeometryBuffer::indexWords(uint32_t indexCount, VkIndexType indexType)
+{
+	return indexType == VK_INDEX_TYPE_UINT16 ? (indexCount + 1) / 2 : indexCount;
+}
+
+// Function which writes how full the geometry buffer is and how many meshes it could not hold
+void GeometryBuffer::report()
+{
+	if (vertexBuffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	std::cout << "Geometry buffer: " + std::to_string(meshCount) + " meshes placed, " + std::to_string(static_cast<VkDeviceSize>(usedVertices) * vertexStride / 1024) + " of " + std::to_string(static_cast<VkDeviceSize>(vertexCapacity) * vertexStride / 1024) + " KB of vertices and "
+		+ std::to_string(static_cast<VkDeviceSize>(usedIndexWords) * sizeof(uint32_t) / 1024) + " of " + std::to_string(static_cast<VkDeviceSize>(indexWordCapacity) * sizeof(uint32_t) / 1024) + " KB of indices in use, "
+		+ std::to_string(overflowCount) + " given buffers of their own\n";
+}
+
+// Function which destroys the shared buffers - every mesh still in them goes with them, once the device is idle on close
+void GeometryBuffer::cleanup()
+{
+	if (vertexBuffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(vertexBuffer);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(indexBuffer);
+	vertexBuffer = VK_NULL_HANDLE;
+	indexBuffer = VK_NULL_HANDLE;
+	freeVertices.clear();
+	freeIndexWords.clear();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <cstdint>
+
+// Struct which stores where one mesh lies in its vertex and index buffers - the first vertex is passed to its draws as the vertex offset
+// so its indices count from its own vertices. Meshes given buffers of their own start at zero in both
+struct MeshRange
+{
+	uint32_t firstVertex = 0;
+	uint32_t vertexCount = 0;
+	uint32_t firstIndex = 0; // Counted in indices of the mesh's own index type
+	uint32_t indexCount = 0;
+};
+
+// Struct which stores one run of unused vertices or index words of the geometry buffer
+struct GeometryFreeRange
+{
+	uint32_t first = 0;
+	uint32_t count = 0;
+};
+
+// Struct which stores the vertex and index buffers last bound in a command buffer so draws sharing them do not bind them again
+struct GeometryBinding
+{
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+	VkIndexType indexType = VK_INDEX_TYPE_MAX_ENUM;
+};
+
+// Class which owns one device local vertex buffer and one index buffer that the vertices and indices of every mesh are packed into
+// Draws bind them once and pick their mesh with the first index and vertex offset, rather than binding buffers of their own
+// The vertex buffer is handed out in whole vertices of the layout in use. The index buffer is handed out in four byte words so 16 and 32 bit indices share it,
+// both bound at its start - a mesh keeps 16 bit indices whenever its own vertices fit them. Ranges are found best fit and merge with free neighbours when freed
+class GeometryBuffer
+{
+public:
+	GeometryBuffer();
+	~GeometryBuffer();
+
+	void create();
+	bool allocate(uint32_t vertexCount, uint32_t indexCount, VkIndexType indexType, MeshRange &range);
+	void free(const MeshRange &range, VkIndexType indexType);
+	bool contains(VkBuffer buffer) const;
+	void releaseMesh(VkBuffer meshVertexBuffer, VkBuffer meshIndexBuffer, const MeshRange &range, VkIndexType indexType);
+	VkDeviceSize vertexByteOffset(const MeshRange &range) const;
+	VkDeviceSize indexByteOffset(const MeshRange &range, VkIndexType indexType) const;
+	void report();
+	void cleanup();
+
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+	// Bytes of one vertex in the layout the vertex buffer holds - packed or full
+	uint32_t vertexStride = 0;
+
+private:
+	static bool allocateRange(std::vector<GeometryFreeRange> &freeRanges, uint32_t count, uint32_t &first);
+	static void freeRange(std::vector<GeometryFreeRange> &freeRanges, uint32_t first, uint32_t count);
+	static uint32_t indexWords(uint32_t indexCount, VkIndexType indexType);
+
+	// Free runs of each buffer in order of where they start
+	std::vector<GeometryFreeRange> freeVertices;
+	std::vector<GeometryFreeRange> freeIndexWords;
+	uint32_t vertexCapacity = 0;
+	uint32_t indexWordCapacity = 0;
+	// Meshes placed since the buffers were made and how many were given buffers of their own as they did not fit
+	uint32_t meshCount = 0;
+	uint32_t overflowCount = 0;
+	uint32_t usedVertices = 0;
+	uint32_t usedIndexWords = 0;
+};
@@ -0,0 +1,642 @@
+#include "GltfReader.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <utility>
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+GltfReader::GltfReader()
+{
+}
+
+GltfReader::~GltfReader()
+{
+}
+
+// Struct which stores one value of the JSON chunk - only what the reader needs, strings are not unescaped past the basic escapes
+struct JsonValue
+{
+	enum Type { Null, Boolean, Number, String, Array, Object };
+	Type type = Null;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> elements;
+	std::vector<std::pair<std::string, JsonValue>> members;
+
+	// Function which returns the member with the given key, or nullptr if this is not an object or has no such member
+	const JsonValue* find(const char *key) const
+	{
+		for (const auto& member : members)
+		{
+			if (member.first == key)
+			{
+				return &member.second;
+			}
+		}
+		return nullptr;
+	}
+
+	// Function which returns a member as a number, or defaultValue if it is missing or not a number
+	double numberOr(const char *key, double defaultValue) const
+	{
+		const JsonValue *value = find(key);
+		return value && value->type == Number ? value->number : defaultValue;
+	}
+
+	// Function which returns whether this is a whole number from zero up to the largest int, so it can be cast to any count, offset or index the reader keeps
+	bool isInteger() const
+	{
+		return type == Number && number >= 0.0 && number <= static_cast<double>(INT_MAX) && std::floor(number) == number;
+	}
+
+	// Function which reads a member that has to be a whole number into integer, leaving integer as it is if the member is missing
+	// Returns false if the member is negative, fractional, too large or not a number
+	template<typename T> bool integerMember(const char *key, T &integer) const
+	{
+		const JsonValue *value = find(key);
+		if (!value)
+		{
+			return true;
+		}
+		if (!value->isInteger())
+		{
+			return false;
+		}
+		integer = static_cast<T>(value->number);
+		return true;
+	}
+};
+
+// Class which parses the JSON chunk into JsonValues - nesting is limited so a malformed file cannot run the stack out
+class JsonParser
+{
+public:
+	JsonParser(const char *begin, const char *end) : cursor(begin), end(end) {}
+
+	bool parse(JsonValue &value)
+	{
+		return parseValue(value, 0) && (skipSpaces(), cursor == end);
+	}
+
+private:
+	void skipSpaces()
+	{
+		// The chunk is padded to four bytes with spaces, and some writers pad with zeros
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r' || *cursor == '\0'))
+		{
+			cursor++;
+		}
+	}
+
+	bool parseValue(JsonValue &value, int depth)
+	{
+		skipSpaces();
+		if (cursor == end || depth > 64)
+		{
+			return false;
+		}
+		switch (*cursor)
+		{
+		case '{':
+			value.type = JsonValue::Object;
+			return parseObject(value, depth);
+		case '[':
+			value.type = JsonValue::Array;
+			return parseArray(value, depth);
+		case '"':
+			value.type = JsonValue::String;
+			return parseString(value.string);
+		case 't':
+			value.type = JsonValue::Boolean;
+			value.number = 1.0;
+			return parseWord("true");
+		case 'f':
+			value.type = JsonValue::Boolean;
+			return parseWord("false");
+		case 'n':
+			return parseWord("null");
+		default:
+			value.type = JsonValue::Number;
+			return parseNumber(value.number);
+		}
+	}
+
+	bool parseObject(JsonValue &value, int depth)
+	{
+		cursor++;
+		skipSpaces();
+		if (cursor < end && *cursor == '}')
+		{
+			cursor++;
+			return true;
+		}
+		while (true)
+		{
+			std::pair<std::string, JsonValue> member;
+			skipSpaces();
+			if (cursor == end || *cursor != '"' || !parseString(member.first))
+			{
+				return false;
+			}
+			skipSpaces();
+			if (cursor == end || *cursor++ != ':' || !parseValue(member.second, depth + 1))
+			{
+				return false;
+			}
+			value.members.push_back(std::move(member));
+			skipSpaces();
+			if (cursor == end)
+			{
+				return false;
+			}
+			char separator = *cursor++;
+			if (separator == '}')
+			{
+				return true;
+			}
+			if (separator != ',')
+			{
+				return false;
+			}
+		}
+	}
+
+	bool parseArray(JsonValue &value, int depth)
+	{
+		cursor++;
+		skipSpaces();
+		if (cursor < end && *cursor == ']')
+		{
+			cursor++;
+			return true;
+		}
+		while (true)
+		{
+			value.elements.emplace_back();
+			if (!parseValue(value.elements.back(), depth + 1))
+			{
+				return false;
+			}
+			skipSpaces();
+			if (cursor == end)
+			{
+				return false;
+			}
+			char separator = *cursor++;
+			if (separator == ']')
+			{
+				return true;
+			}
+			if (separator != ',')
+			{
+				return false;
+			}
+		}
+	}
+
+	bool parseString(std::string &string)
+	{
+		cursor++;
+		while (cursor < end && *cursor != '"')
+		{
+			if (*cursor == '\\')
+			{
+				if (++cursor == end)
+				{
+					return false;
+				}
+				// Escaped unicode is kept as its escape - none of the names the reader looks for need it
+				switch (*cursor)
+				{
+				case 'n': string += '\n'; break;
+				case 't': string += '\t'; break;
+				case 'r': string += '\r'; break;
+				case 'b': string += '\b'; break;
+				case 'f': string += '\f'; break;
+				case 'u': string += "\\u"; break;
+				default: string += *cursor; break;
+				}
+				cursor++;
+			}
+			else
+			{
+				string += *cursor++;
+			}
+		}
+		if (cursor == end)
+		{
+			return false;
+		}
+		cursor++;
+		return true;
+	}
+
+	bool parseWord(const char *word)
+	{
+		size_t length = strlen(word);
+		if (static_cast<size_t>(end - cursor) < length || memcmp(cursor, word, length) != 0)
+		{
+			return false;
+		}
+		cursor += length;
+		return true;
+	}
+
+	bool parseNumber(double &number)
+	{
+		// strtod needs a terminated string so copy the number out first
+		char text[64];
+		size_t length = 0;
+		while (cursor + length < end && length < sizeof(text) - 1 && strchr("+-0123456789.eE", cursor[length]) != nullptr)
+		{
+			text[length] = cursor[length];
+			length++;
+		}
+		text[length] = '\0';
+		char *numberEnd;
+		number = strtod(text, &numberEnd);
+		if (length == 0 || numberEnd != text + length)
+		{
+			return false;
+		}
+		cursor += length;
+		return true;
+	}
+
+	const char *cursor;
+	const char *end;
+};
+
+// Function which reads a little endian 32 bit value from the file
+static uint32_t readUint32(const uint8_t *data)
+{
+	return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+// Function which returns the size in bytes of one component of an accessor, or 0 for types glTF does not allow
+static size_t componentSize(uint32_t componentType)
+{
+	switch (componentType)
+	{
+	case 5120: case gltfUnsignedByte: return 1;
+	case 5122: case gltfUnsignedShort: return 2;
+	case gltfUnsignedInt: case gltfFloat: return 4;
+	default: return 0;
+	}
+}
+
+// Function which returns the number of components of an accessor type, or 0 for matrices and unknown types
+static uint32_t typeComponents(const std::string &type)
+{
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2") return 2;
+	if (type == "VEC3") return 3;
+	if (type == "VEC4") return 4;
+	return 0;
+}
+
+// Function which returns the transform of a node relative to its parent - either its matrix or its translation, rotation and scale
+static glm::mat4 nodeTransform(const JsonValue &node)
+{
+	const JsonValue *matrix = node.find("matrix");
+	if (matrix && matrix->type == JsonValue::Array && matrix->elements.size() == 16)
+	{
+		// Stored column by column, the same order glm keeps them in
+		float values[16];
+		for (int i = 0; i < 16; i++)
+		{
+			values[i] = static_cast<float>(matrix->elements[i].number);
+		}
+		return glm::make_mat4(values);
+	}
+
+	glm::vec3 translation = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+	const JsonValue *value = node.find("translation");
+	if (value && value->elements.size() == 3)
+	{
+		translation = glm::vec3(value->elements[0].number, value->elements[1].number, value->elements[2].number);
+	}
+	value = node.find("rotation");
+	if (value && value->elements.size() == 4)
+	{
+		// glTF stores the quaternion x, y, z, w but glm's constructor takes w first
+		rotation = glm::quat(static_cast<float>(value->elements[3].number), static_cast<float>(value->elements[0].number), static_cast<float>(value->elements[1].number), static_cast<float>(value->elements[2].number));
+	}
+	value = node.find("scale");
+	if (value && value->elements.size() == 3)
+	{
+		scale = glm::vec3(value->elements[0].number, value->elements[1].number, value->elements[2].number);
+	}
+	glm::mat4 transform = glm::mat4_cast(rotation);
+	transform[0] *= scale.x;
+	transform[1] *= scale.y;
+	transform[2] *= scale.z;
+	transform[3] = glm::vec4(translation, 1.0f);
+	return transform;
+}
+
+// Function which checks the GLB container, parses its JSON chunk and works out where every accessor's elements are in the binary chunk
+// The memory is not copied so it has to stay valid while the accessors are read
+bool GltfReader::open(const uint8_t *data, size_t size, std::string &error)
+{
+	close();
+
+	// 12 byte header then the JSON chunk, which always comes first, then the optional binary chunk
+	if (data == nullptr || size < 20 || memcmp(data, "glTF", 4) != 0)
+	{
+		error = "failed to read glTF file - not a binary glTF file!";
+		return false;
+	}
+	if (readUint32(data + 4) != 2)
+	{
+		error = "failed to read glTF file - only version 2 is supported!";
+		return false;
+	}
+	size_t fileLength = std::min<size_t>(readUint32(data + 8), size);
+	size_t jsonLength = readUint32(data + 12);
+	if (readUint32(data + 16) != 0x4E4F534A || 20 + jsonLength > fileLength)
+	{
+		error = "failed to read glTF file - missing JSON chunk!";
+		return false;
+	}
+	size_t binaryChunk = 20 + ((jsonLength + 3) & ~static_cast<size_t>(3));
+	if (binaryChunk + 8 <= fileLength && readUint32(data + binaryChunk + 4) == 0x004E4942)
+	{
+		binarySize = std::min<size_t>(readUint32(data + binaryChunk), fileLength - binaryChunk - 8);
+		binaryData = data + binaryChunk + 8;
+	}
+
+	JsonValue root;
+	JsonParser parser(reinterpret_cast<const char*>(data + 20), reinterpret_cast<const char*>(data + 20 + jsonLength));
+	if (!parser.parse(root) || root.type != JsonValue::Object)
+	{
+		error = "failed to read glTF file - malformed JSON chunk!";
+		return false;
+	}
+
+	// Buffer views may only point into the binary chunk - external buffers would need a second file
+	static const JsonValue empty;
+	const JsonValue *buffers = root.find("buffers");
+	const JsonValue *bufferViews = root.find("bufferViews");
+	const JsonValue *accessorList = root.find("accessors");
+	if (buffers && (buffers->elements.size() > 1 || (buffers->elements.size() == 1 && buffers->elements[0].find("uri"))))
+	{
+		error = "failed to read glTF file - external buffers are not supported!";
+		return false;
+	}
+
+	for (const auto& accessorValue : (accessorList ? accessorList : &empty)->elements)
+	{
+		GltfAccessor accessor;
+		int viewIndex = -1;
+		size_t accessorOffset = 0;
+		if (!accessorValue.integerMember("count", accessor.count) || !accessorValue.integerMember("componentType", accessor.componentType) || !accessorValue.integerMember("bufferView", viewIndex) || !accessorValue.integerMember("byteOffset", accessorOffset))
+		{
+			error = "failed to read glTF file - accessor numbers must be whole and not negative!";
+			return false;
+		}
+		const JsonValue *type = accessorValue.find("type");
+		accessor.componentCount = type ? typeComponents(type->string) : 0;
+		const JsonValue *normalized = accessorValue.find("normalized");
+		accessor.normalized = normalized && normalized->number != 0.0;
+		size_t elementSize = componentSize(accessor.componentType) * accessor.componentCount;
+		if (accessorValue.find("sparse") || viewIndex < 0 || !bufferViews || viewIndex >= static_cast<int>(bufferViews->elements.size()))
+		{
+			// Accessors without a buffer view are all zeros - leave them empty and only fail if a mesh reads one
+			accessors.push_back(GltfAccessor());
+			continue;
+		}
+
+		// Elements are packed unless the view gives a stride
+		const JsonValue &view = bufferViews->elements[viewIndex];
+		size_t viewOffset = 0, viewLength = 0;
+		accessor.stride = elementSize;
+		if (!view.integerMember("byteOffset", viewOffset) || !view.integerMember("byteLength", viewLength) || !view.integerMember("byteStride", accessor.stride))
+		{
+			error = "failed to read glTF file - buffer view numbers must be whole and not negative!";
+			return false;
+		}
+		size_t offset = viewOffset + accessorOffset;
+		if (elementSize == 0 || viewOffset + viewLength > binarySize || (accessor.count > 0 && offset + (accessor.count - 1) * accessor.stride + elementSize > viewOffset + viewLength))
+		{
+			error = "failed to read glTF file - accessor outside its buffer!";
+			return false;
+		}
+		accessor.data = binaryData + offset;
+		accessors.push_back(accessor);
+	}
+
+	// Only triangle lists are drawn - points and lines have no faces and strips and fans would have to be unrolled
+	const JsonValue *meshList = root.find("meshes");
+	for (const auto& meshValue : (meshList ? meshList : &empty)->elements)
+	{
+		std::vector<GltfPrimitive> primitives;
+		const JsonValue *primitiveList = meshValue.find("primitives");
+		for (const auto& primitiveValue : (primitiveList ? primitiveList : &empty)->elements)
+		{
+			if (primitiveValue.numberOr("mode", 4.0) != 4.0)
+			{
+				error = "failed to read glTF file - only triangle lists are supported!";
+				return false;
+			}
+			const JsonValue *attributes = primitiveValue.find("attributes");
+			GltfPrimitive primitive;
+			if ((attributes && (!attributes->integerMember("POSITION", primitive.position) || !attributes->integerMember("TEXCOORD_0", primitive.texCoord) || !attributes->integerMember("COLOR_0", primitive.color))) ||
+				!primitiveValue.integerMember("indices", primitive.indices))
+			{
+				error = "failed to read glTF file - accessor indices must be whole and not negative!";
+				return false;
+			}
+
+			// Check every accessor the primitive reads can be turned into the framework's vertices and indices
+			auto validAccessor = [&](int index, uint32_t minimumComponents, uint32_t maximumComponents, bool allowIntegers)
+			{
+				if (index < 0)
+				{
+					return true;
+				}
+				if (index >= static_cast<int>(accessors.size()) || accessors[index].data == nullptr)
+				{
+					return false;
+				}
+				const GltfAccessor &accessor = accessors[index];
+				bool validType = accessor.componentType == gltfFloat || (allowIntegers && (accessor.componentType == gltfUnsignedByte || accessor.componentType == gltfUnsignedShort));
+				return validType && accessor.componentCount >= minimumComponents && accessor.componentCount <= maximumComponents;
+			};
+			bool validIndices = primitive.indices < 0 || (primitive.indices < static_cast<int>(accessors.size()) && accessors[primitive.indices].data != nullptr && accessors[primitive.indices].componentCount == 1 &&
+				(accessors[primitive.indices].componentType == gltfUnsignedByte || accessors[primitive.indices].componentType == gltfUnsignedShort || accessors[primitive.indices].componentType == gltfUnsignedInt));
+			if (primitive.position < 0 || !validAccessor(primitive.position, 3, 3, false) || !validAccessor(primitive.texCoord, 2, 2, true) || !validAccessor(primitive.color, 3, 4, true) || !validIndices)
+			{
+				error = "failed to read glTF file - unsupported vertex or index accessor!";
+				return false;
+			}
+
+			// Every attribute has one element per vertex so they have to agree, and every index has to point at one
+			size_t vertexCount = accessors[primitive.position].count;
+			if ((primitive.texCoord >= 0 && accessors[primitive.texCoord].count != vertexCount) || (primitive.color >= 0 && accessors[primitive.color].count != vertexCount))
+			{
+				error = "failed to read glTF file - vertex attributes differ in length!";
+				return false;
+			}
+			if (primitive.indices >= 0)
+			{
+				const GltfAccessor &indexAccessor = accessors[primitive.indices];
+				for (size_t i = 0; i < indexAccessor.count; i++)
+				{
+					if (readIndex(indexAccessor, i) >= vertexCount)
+					{
+						error = "failed to read glTF file - index out of range!";
+						return false;
+					}
+				}
+			}
+			primitives.push_back(primitive);
+		}
+		meshes.push_back(primitives);
+	}
+
+	// Walk the default scene from its roots so each mesh is placed where the file puts it - without scenes every node nobody parents is a root
+	const JsonValue *nodes = root.find("nodes");
+	const std::vector<JsonValue> &nodeList = (nodes ? nodes : &empty)->elements;
+	std::vector<std::pair<int, glm::mat4>> stack;
+	const JsonValue *scenes = root.find("scenes");
+	size_t sceneIndex = 0;
+	if (!root.integerMember("scene", sceneIndex))
+	{
+		error = "failed to read glTF file - broken node hierarchy!";
+		return false;
+	}
+	if (scenes && sceneIndex < scenes->elements.size() && scenes->elements[sceneIndex].find("nodes"))
+	{
+		for (const auto& rootNode : scenes->elements[sceneIndex].find("nodes")->elements)
+		{
+			stack.push_back({ rootNode.isInteger() ? static_cast<int>(rootNode.number) : -1, glm::mat4(1.0f) });
+		}
+	}
+	else
+	{
+		std::vector<bool> parented(nodeList.size(), false);
+		for (const auto& node : nodeList)
+		{
+			const JsonValue *children = node.find("children");
+			for (const auto& child : (children ? children : &empty)->elements)
+			{
+				if (child.isInteger() && child.number < nodeList.size())
+				{
+					parented[static_cast<size_t>(child.number)] = true;
+				}
+			}
+		}
+		for (size_t n = nodeList.size(); n-- > 0;)
+		{
+			if (!parented[n])
+			{
+				stack.push_back({ static_cast<int>(n), glm::mat4(1.0f) });
+			}
+		}
+	}
+	// A node can only be reached as many times as there are nodes unless the hierarchy loops
+	size_t visited = 0;
+	while (!stack.empty())
+	{
+		std::pair<int, glm::mat4> entry = stack.back();
+		stack.pop_back();
+		if (entry.first < 0 || entry.first >= static_cast<int>(nodeList.size()) || ++visited > nodeList.size())
+		{
+			error = "failed to read glTF file - broken node hierarchy!";
+			return false;
+		}
+		const JsonValue &node = nodeList[entry.first];
+		glm::mat4 transform = entry.second * nodeTransform(node);
+		int mesh = -1;
+		if (!node.integerMember("mesh", mesh))
+		{
+			error = "failed to read glTF file - broken node hierarchy!";
+			return false;
+		}
+		if (mesh >= 0 && mesh < static_cast<int>(meshes.size()))
+		{
+			instances.push_back({ static_cast<uint32_t>(mesh), transform });
+		}
+		const JsonValue *children = node.find("children");
+		const std::vector<JsonValue> &childList = (children ? children : &empty)->elements;
+		for (size_t c = childList.size(); c-- > 0;)
+		{
+			stack.push_back({ childList[c].isInteger() ? static_cast<int>(childList[c].number) : -1, transform });
+		}
+	}
+
+	// A file with meshes but no nodes still has something to draw
+	if (instances.empty())
+	{
+		for (size_t m = 0; m < meshes.size(); m++)
+		{
+			instances.push_back({ static_cast<uint32_t>(m), glm::mat4(1.0f) });
+		}
+	}
+
+	return true;
+}
+
+// Function which forgets the file - the memory it was read from is owned by the caller
+void GltfReader::close()
+{
+	accessors.clear();
+	meshes.clear();
+	instances.clear();
+	binaryData = nullptr;
+	binarySize = 0;
+}
+
+// Function which reads one component of an accessor element as a float
+float GltfReader::readFloat(const GltfAccessor &accessor, size_t element, uint32_t component)
+{
+	const uint8_t *data = accessor.data + element * accessor.stride;
+	switch (accessor.componentType)
+	{
+	case gltfUnsignedByte:
+		return data[component] / 255.0f;
+	case gltfUnsignedShort:
+	{
+		uint16_t value;
+		memcpy(&value, data + component * sizeof(uint16_t), sizeof(value));
+		return value / 65535.0f;
+	}
+	default:
+	{
+		float value;
+		memcpy(&value, data + component * sizeof(float), sizeof(value));
+		return value;
+	}
+	}
+}
+
+// Function which reads one index out of a SCALAR accessor of unsigned bytes, shorts or ints
+uint32_t GltfReader::readIndex(const GltfAccessor &accessor, size_t element)
+{
+	const uint8_t *data = accessor.data + element * accessor.stride;
+	switch (accessor.componentType)
+	{
+	case gltfUnsignedByte:
+		return data[0];
+	case gltfUnsignedShort:
+	{
+		uint16_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+	default:
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+// Accessor component types - the OpenGL enumerations glTF stores them as
+const uint32_t gltfUnsignedByte = 5121;
+const uint32_t gltfUnsignedShort = 5123;
+const uint32_t gltfUnsignedInt = 5125;
+const uint32_t gltfFloat = 5126;
+
+// Struct which stores where the elements of one accessor lie - data points straight into the file so nothing is copied until the elements are read
+struct GltfAccessor
+{
+	const uint8_t *data = nullptr; // First element
+	size_t count = 0;
+	size_t stride = 0; // Bytes from one element to the next
+	uint32_t componentType = 0;
+	uint32_t componentCount = 0; // 1 for SCALAR up to 4 for VEC4
+	bool normalized = false;
+};
+
+// Struct which stores the accessors one triangle list of a mesh reads - -1 when the primitive does not have the attribute
+struct GltfPrimitive
+{
+	int position = -1;
+	int texCoord = -1;
+	int color = -1;
+	int indices = -1;
+};
+
+// Struct which stores one node of the scene that draws a mesh and where it puts it
+struct GltfMeshInstance
+{
+	uint32_t mesh;
+	glm::mat4 transform;
+};
+
+// Class which reads binary glTF 2.0 (.glb) files straight from memory the file has already been mapped into
+// The JSON chunk is parsed once to find the meshes, the vertex and index data are left where they are in the binary chunk
+// Only triangle lists whose data lives in the binary chunk are read - files with external buffers, sparse accessors or other primitive modes are rejected
+class GltfReader
+{
+public:
+	GltfReader();
+	~GltfReader();
+
+	bool open(const uint8_t *data, size_t size, std::string &error);
+	void close();
+
+	// Function which reads one component of an accessor element as a float - normalized integers are scaled to 0 to 1
+	static float readFloat(const GltfAccessor &accessor, size_t element, uint32_t component);
+	// Function which reads an index out of a SCALAR accessor
+	static uint32_t readIndex(const GltfAccessor &accessor, size_t element);
+
+	std::vector<GltfAccessor> accessors;
+	// Triangle lists of every mesh in the file
+	std::vector<std::vector<GltfPrimitive>> meshes;
+	// Every node of the default scene that draws a mesh, with its transform from the scene root
+	std::vector<GltfMeshInstance> instances;
+
+private:
+	// Binary chunk every buffer view points into
+	const uint8_t *binaryData = nullptr;
+	size_t binarySize = 0;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// MurmurHash64A by Austin Appleby (public domain) - hashes eight bytes per step so it is quick enough to run over whole asset files
+inline uint64_t murmurHash64(const void* key, size_t length, uint64_t seed = 0)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+
+	uint64_t h = seed ^ (length * m);
+
+	const uint8_t* data = static_cast<const uint8_t*>(key);
+	const uint8_t* end = data + (length & ~static_cast<size_t>(7));
+
+	// Mix in the data eight bytes at a time - memcpy keeps the reads legal for unaligned input
+	while (data != end)
+	{
+		uint64_t k;
+		memcpy(&k, data, sizeof(k));
+		data += sizeof(k);
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	// Mix in the last few bytes
+	switch (length & 7)
+	{
+	case 7: h ^= uint64_t(data[6]) << 48; // fall through
+	case 6: h ^= uint64_t(data[5]) << 40; // fall through
+	case 5: h ^= uint64_t(data[4]) << 32; // fall through
+	case 4: h ^= uint64_t(data[3]) << 24; // fall through
+	case 3: h ^= uint64_t(data[2]) << 16; // fall through
+	case 2: h ^= uint64_t(data[1]) << 8; // fall through
+	case 1: h ^= uint64_t(data[0]);
+		h *= m;
+	}
+
+	// Final avalanche so every input bit affects every output bit
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
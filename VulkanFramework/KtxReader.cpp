@@ -0,0 +1,338 @@
+#include "KtxReader.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+KtxReader::KtxReader()
+{
+}
+
+KtxReader::~KtxReader()
+{
+}
+
+// Identifiers every KTX file starts with
+static const uint8_t ktx1Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const uint8_t ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// OpenGL internal formats a KTX 1 file stores the formats the framework uploads as
+const uint32_t glRgba8 = 0x8058;
+const uint32_t glCompressedRgbS3tcDxt1 = 0x83F0;
+const uint32_t glCompressedRgbaS3tcDxt5 = 0x83F3;
+const uint32_t glCompressedRgbaBptcUnorm = 0x8E8C;
+
+// Function which works out the width or height of a mip level - the same rounding as MipmapGenerator::levelExtent
+static uint32_t levelExtent(uint32_t extent, uint32_t level)
+{
+	return std::max(1u, extent >> level);
+}
+
+// Function which works out how many mip levels a full chain of this size has
+static uint32_t fullLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levels = 1;
+	while ((std::max(width, height) >> levels) > 0)
+	{
+		levels++;
+	}
+	return levels;
+}
+
+// Function which finds the texture format a KTX 2 file's VkFormat is uploaded as - false if the framework has no such format
+static bool textureFormatFromVulkan(uint32_t vkFormat, TextureFormat &format)
+{
+	for (TextureFormat candidate : { TEXTURE_FORMAT_RGBA8, TEXTURE_FORMAT_BC1, TEXTURE_FORMAT_BC3, TEXTURE_FORMAT_BC7 })
+	{
+		if (static_cast<uint32_t>(TextureCompressor::vulkanFormat(candidate)) == vkFormat)
+		{
+			format = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Function which finds the texture format a KTX 1 file's OpenGL internal format is uploaded as - false if the framework has no such format
+static bool textureFormatFromGl(uint32_t glInternalFormat, TextureFormat &format)
+{
+	switch (glInternalFormat)
+	{
+	case glRgba8:
+		format = TEXTURE_FORMAT_RGBA8;
+		return true;
+	case glCompressedRgbS3tcDxt1:
+		format = TEXTURE_FORMAT_BC1;
+		return true;
+	case glCompressedRgbaS3tcDxt5:
+		format = TEXTURE_FORMAT_BC3;
+		return true;
+	case glCompressedRgbaBptcUnorm:
+		format = TEXTURE_FORMAT_BC7;
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Function which checks whether a path names a KTX file by its extension
+bool KtxReader::isKtxPath(const std::string &path)
+{
+	return (path.size() > 4 && path.compare(path.size() - 4, 4, ".ktx") == 0) || (path.size() > 5 && path.compare(path.size() - 5, 5, ".ktx2") == 0);
+}
+
+// Function which checks the header of a KTX 1 or KTX 2 file and works out where every mip level is stored
+// The memory is not copied so it has to stay valid while the levels are read
+bool KtxReader::open(const uint8_t *data, size_t size, std::string &error)
+{
+	close();
+
+	bool ktx2 = data != nullptr && size >= sizeof(Ktx2Header) && memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) == 0;
+	bool ktx1 = data != nullptr && size >= sizeof(Ktx1Header) && memcmp(data, ktx1Identifier, sizeof(ktx1Identifier)) == 0;
+	if (!ktx1 && !ktx2)
+	{
+		error = "failed to read KTX file - not a KTX file!";
+		return false;
+	}
+
+	// Read the size and layout of the texture - both versions describe it the same way once the format is known
+	uint32_t depth, arrayElements, faceCount, levelCount;
+	Ktx1Header ktx1Header;
+	Ktx2Header ktx2Header;
+	if (ktx2)
+	{
+		memcpy(&ktx2Header, data, sizeof(ktx2Header));
+		if (ktx2Header.supercompressionScheme != 0)
+		{
+			error = "failed to read KTX file - supercompressed files are not supported!";
+			return false;
+		}
+		if (!textureFormatFromVulkan(ktx2Header.vkFormat, format))
+		{
+			error = "failed to read KTX file - unsupported format!";
+			return false;
+		}
+		width = ktx2Header.pixelWidth;
+		height = ktx2Header.pixelHeight;
+		depth = ktx2Header.pixelDepth;
+		arrayElements = ktx2Header.layerCount;
+		faceCount = ktx2Header.faceCount;
+		levelCount = ktx2Header.levelCount;
+	}
+	else
+	{
+		memcpy(&ktx1Header, data, sizeof(ktx1Header));
+		if (ktx1Header.endianness != 0x04030201)
+		{
+			error = "failed to read KTX file - files written on a big endian machine are not supported!";
+			return false;
+		}
+		if (!textureFormatFromGl(ktx1Header.glInternalFormat, format))
+		{
+			error = "failed to read KTX file - unsupported format!";
+			return false;
+		}
+		width = ktx1Header.pixelWidth;
+		height = ktx1Header.pixelHeight;
+		depth = ktx1Header.pixelDepth;
+		arrayElements = ktx1Header.numberOfArrayElements;
+		faceCount = ktx1Header.numberOfFaces;
+		levelCount = ktx1Header.numberOfMipmapLevels;
+	}
+	if (width == 0 || height == 0 || depth > 1)
+	{
+		error = "failed to read KTX file - only 2D textures are supported!";
+		return false;
+	}
+	if ((faceCount != 1 && faceCount != 6) || (faceCount == 6 && width != height) || arrayElements > 2048)
+	{
+		error = "failed to read KTX file - malformed layers or faces!";
+		return false;
+	}
+	// Files which ask for their mip chain to be generated only hold level 0 - they are uploaded with that level alone
+	levelCount = std::max(levelCount, 1u);
+	if (levelCount > fullLevelCount(width, height))
+	{
+		error = "failed to read KTX file - more mip levels than the texture has!";
+		return false;
+	}
+	cubeMap = faceCount == 6;
+	layerCount = std::max(arrayElements, 1u) * faceCount;
+
+	// Find each level - its size is checked against the size of the texture so every image of the level can be copied with one region
+	levels.resize(levelCount);
+	if (ktx2)
+	{
+		uint64_t indexOffset = sizeof(Ktx2Header);
+		if (indexOffset + static_cast<uint64_t>(levelCount) * sizeof(Ktx2LevelIndex) > size)
+		{
+			error = "failed to read KTX file - level index outside the file!";
+			close();
+			return false;
+		}
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			Ktx2LevelIndex levelIndex;
+			memcpy(&levelIndex, data + indexOffset + level * sizeof(Ktx2LevelIndex), sizeof(levelIndex));
+			uint64_t expectedSize = static_cast<uint64_t>(TextureCompressor::compressedSize(levelExtent(width, level), levelExtent(height, level), format)) * layerCount;
+			if (levelIndex.byteLength != expectedSize || levelIndex.byteOffset > size || levelIndex.byteLength > size - levelIndex.byteOffset)
+			{
+				error = "failed to read KTX file - mip level outside the file or the wrong size!";
+				close();
+				return false;
+			}
+			levels[level].data = data + levelIndex.byteOffset;
+			levels[level].size = static_cast<size_t>(levelIndex.byteLength);
+		}
+	}
+	else
+	{
+		// Each level is prefixed with its size - the size of one face for a cube map that is not an array, otherwise of the whole level
+		// Every format read has images a multiple of four bytes long so there is no cube or mip padding between them
+		uint64_t offset = sizeof(Ktx1Header) + static_cast<uint64_t>(ktx1Header.bytesOfKeyValueData);
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			uint64_t faceSize = TextureCompressor::compressedSize(levelExtent(width, level), levelExtent(height, level), format);
+			uint64_t levelSize = faceSize * layerCount;
+			uint32_t imageSize = 0;
+			if (offset + sizeof(imageSize) <= size)
+			{
+				memcpy(&imageSize, data + offset, sizeof(imageSize));
+			}
+			if (offset + sizeof(imageSize) > size || imageSize != (arrayElements == 0 && cubeMap ? faceSize : levelSize) || levelSize > size - offset - sizeof(imageSize))
+			{
+				error = "failed to read KTX file - mip level outside the file or the wrong size!";
+				close();
+				return false;
+			}
+			levels[level].data = data + offset + sizeof(imageSize);
+			levels[level].size = static_cast<size_t>(levelSize);
+			offset += sizeof(imageSize) + levelSize;
+		}
+	}
+	return true;
+}
+
+// Function which forgets the file that was read
+void KtxReader::close()
+{
+	format = TEXTURE_FORMAT_RGBA8;
+	width = 0;
+	height = 0;
+	layerCount = 1;
+	cubeMap = false;
+	levels.clear();
+}
+
+// Function which writes a KTX 2 file holding a texture's mip chain - levels holds each level largest first with every face of it one after another
+// faceCount is 6 for a cube map, whose faces are in the order +X, -X, +Y, -Y, +Z, -Z, otherwise 1
+bool KtxReader::write(const std::string &path, TextureFormat format, uint32_t width, uint32_t height, uint32_t faceCount, const std::vector<std::vector<uint8_t>> &levels, std::string &error)
+{
+	// Describe the format with a basic data format descriptor - one sample covering each channel of a pixel, or each part of a compressed block
+	// Words are the colour model, block size and bytes per block, then each sample's bit offset and length, channel, and range
+	uint32_t colourModel, blockDimensions, bytesPerBlock;
+	std::vector<std::array<uint32_t, 4>> samples;
+	switch (format)
+	{
+	case TEXTURE_FORMAT_BC1:
+		colourModel = 128; // BC1A
+		blockDimensions = 0x0303;
+		bytesPerBlock = 8;
+		samples = { { { 0u | (63u << 16) | (0u << 24), 0, 0, 0xFFFFFFFF } } };
+		break;
+	case TEXTURE_FORMAT_BC3:
+		colourModel = 130; // BC3
+		blockDimensions = 0x0303;
+		bytesPerBlock = 16;
+		samples = { { { 0u | (63u << 16) | (15u << 24), 0, 0, 0xFFFFFFFF } }, { { 64u | (63u << 16) | (0u << 24), 0, 0, 0xFFFFFFFF } } };
+		break;
+	case TEXTURE_FORMAT_BC7:
+		colourModel = 134; // BC7
+		blockDimensions = 0x0303;
+		bytesPerBlock = 16;
+		samples = { { { 0u | (127u << 16) | (0u << 24), 0, 0, 0xFFFFFFFF } } };
+		break;
+	default:
+		colourModel = 1; // RGBSDA
+		blockDimensions = 0;
+		bytesPerBlock = 4;
+		samples = { { { 0u | (7u << 16) | (0u << 24), 0, 0, 255 } }, { { 8u | (7u << 16) | (1u << 24), 0, 0, 255 } }, { { 16u | (7u << 16) | (2u << 24), 0, 0, 255 } }, { { 24u | (7u << 16) | (15u << 24), 0, 0, 255 } } };
+		break;
+	}
+	uint32_t descriptorBlockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+	std::vector<uint32_t> descriptor = {
+		4 + descriptorBlockSize, // Total size of the descriptor
+		0, // Khronos basic descriptor block
+		2u | (descriptorBlockSize << 16), // Version 2
+		colourModel | (1u << 8) | (1u << 16), // BT.709 primaries with a linear transfer function, as the textures are sampled as UNORM
+		blockDimensions,
+		bytesPerBlock,
+		0
+	};
+	for (const auto& sample : samples)
+	{
+		descriptor.insert(descriptor.end(), sample.begin(), sample.end());
+	}
+
+	// The level index and descriptor follow the header, then the levels smallest first - each starts on a block boundary, which is always a multiple of four bytes
+	Ktx2Header header = {};
+	memcpy(header.identifier, ktx2Identifier, sizeof(ktx2Identifier));
+	header.vkFormat = static_cast<uint32_t>(TextureCompressor::vulkanFormat(format));
+	header.typeSize = 1;
+	header.pixelWidth = width;
+	header.pixelHeight = height;
+	header.faceCount = faceCount;
+	header.levelCount = static_cast<uint32_t>(levels.size());
+	header.dfdByteOffset = static_cast<uint32_t>(sizeof(header) + levels.size() * sizeof(Ktx2LevelIndex));
+	header.dfdByteLength = static_cast<uint32_t>(descriptor.size() * sizeof(uint32_t));
+	std::vector<Ktx2LevelIndex> levelIndex(levels.size());
+	uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+	for (size_t level = levels.size(); level-- > 0;)
+	{
+		offset = (offset + bytesPerBlock - 1) / bytesPerBlock * bytesPerBlock;
+		levelIndex[level].byteOffset = offset;
+		levelIndex[level].byteLength = levels[level].size();
+		levelIndex[level].uncompressedByteLength = levels[level].size();
+		offset += levels[level].size();
+	}
+
+	// Write to a temporary file first so a half written texture is never picked up
+	std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		error = "failed to write KTX file!";
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(levelIndex.data()), static_cast<std::streamsize>(levelIndex.size() * sizeof(Ktx2LevelIndex)));
+	file.write(reinterpret_cast<const char*>(descriptor.data()), static_cast<std::streamsize>(descriptor.size() * sizeof(uint32_t)));
+	uint64_t fileOffset = header.dfdByteOffset + header.dfdByteLength;
+	const char padding[16] = {};
+	for (size_t level = levels.size(); level-- > 0;)
+	{
+		file.write(padding, static_cast<std::streamsize>(levelIndex[level].byteOffset - fileOffset));
+		file.write(reinterpret_cast<const char*>(levels[level].data()), static_cast<std::streamsize>(levels[level].size()));
+		fileOffset = levelIndex[level].byteOffset + levels[level].size();
+	}
+	file.close();
+
+	if (!file)
+	{
+		std::remove(tempPath.c_str());
+		error = "failed to write KTX file!";
+		return false;
+	}
+
+	// Replace any old file with the new one
+	std::remove(path.c_str());
+	if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+	{
+		std::remove(tempPath.c_str());
+		error = "failed to write KTX file!";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "TextureCompressor.h"
+
+// Header at the start of every KTX 1 file - the key/value data follows it, then each mip level prefixed with its size
+struct Ktx1Header
+{
+	uint8_t identifier[12]; // Always 0xAB "KTX 11" 0xBB "\r\n\x1A\n"
+	uint32_t endianness; // 0x04030201 when written on a little endian machine
+	uint32_t glType;
+	uint32_t glTypeSize;
+	uint32_t glFormat;
+	uint32_t glInternalFormat; // Format the pixels or blocks are stored in
+	uint32_t glBaseInternalFormat;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth; // 0 for anything but a 3D texture
+	uint32_t numberOfArrayElements; // 0 for a texture that is not an array
+	uint32_t numberOfFaces; // 6 for a cube map, otherwise 1
+	uint32_t numberOfMipmapLevels; // 0 asks for the mip chain to be generated when the file is loaded
+	uint32_t bytesOfKeyValueData;
+};
+
+// Header at the start of every KTX 2 file - the level index follows it, then the data format descriptor, key/value data and the levels themselves
+struct Ktx2Header
+{
+	uint8_t identifier[12]; // Always 0xAB "KTX 20" 0xBB "\r\n\x1A\n"
+	uint32_t vkFormat; // Format the pixels or blocks are stored in - a VkFormat
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth; // 0 for anything but a 3D texture
+	uint32_t layerCount; // 0 for a texture that is not an array
+	uint32_t faceCount; // 6 for a cube map, otherwise 1
+	uint32_t levelCount; // 0 asks for the mip chain to be generated when the file is loaded
+	uint32_t supercompressionScheme; // 0 when the levels are stored as they are uploaded
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+
+// Struct which describes where one mip level is stored in a KTX 2 file - the level index holds one for each level, largest first
+struct Ktx2LevelIndex
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+
+// Struct which stores where one mip level lies in a KTX file - every array layer and cube face of the level one after another, as they are copied to the image
+struct KtxLevel
+{
+	const uint8_t *data = nullptr;
+	size_t size = 0;
+};
+
+// Class which reads KTX 1 and KTX 2 texture containers straight from memory the file has already been mapped into and writes new KTX 2 files
+// The header is checked and every level is found in place, nothing is decoded or copied so the levels can go straight into a staging buffer
+// Only 2D textures, arrays and cube maps in a format the framework uploads are read - 3D textures and supercompressed files are rejected
+class KtxReader
+{
+public:
+	KtxReader();
+	~KtxReader();
+
+	bool open(const uint8_t *data, size_t size, std::string &error);
+	void close();
+
+	static bool isKtxPath(const std::string &path);
+	static bool write(const std::string &path, TextureFormat format, uint32_t width, uint32_t height, uint32_t faceCount, const std::vector<std::vector<uint8_t>> &levels, std::string &error);
+
+	TextureFormat format = TEXTURE_FORMAT_RGBA8;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// Array layers times cube faces - the six faces of each layer come together, in the order +X, -X, +Y, -Y, +Z, -Z
+	uint32_t layerCount = 1;
+	bool cubeMap = false;
+	// Every mip level in the file, largest first
+	std::vector<KtxLevel> levels;
+};
@@ -0,0 +1,195 @@
+#include "Lz4.h"
+
+#include <cstring>
+
+// Shortest match the format can describe
+const size_t lz4MinimumMatch = 4;
+// The last five bytes are always literals and the last match has to start at least twelve bytes before the end
+const size_t lz4LastLiterals = 5;
+const size_t lz4MatchFindLimit = 12;
+// Matches can reach at most this far back
+const size_t lz4MaximumOffset = 65535;
+// Number of bits used to index the hash table of recent four byte sequences
+const int lz4HashBits = 16;
+
+// Function which reads four bytes without caring about alignment
+static uint32_t read32(const uint8_t *source)
+{
+	uint32_t value;
+	memcpy(&value, source, sizeof(value));
+	return value;
+}
+
+// Function which hashes a four byte sequence into the hash table
+static uint32_t hashSequence(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - lz4HashBits);
+}
+
+// Function which writes the extra bytes of a literal or match length that did not fit in its four bits of the token
+static void writeLength(size_t length, std::vector<uint8_t> &compressed)
+{
+	while (length >= 255)
+	{
+		compressed.push_back(255);
+		length -= 255;
+	}
+	compressed.push_back(static_cast<uint8_t>(length));
+}
+
+// Function which writes one sequence - a run of literals, then a match unless this is the last sequence
+static void writeSequence(const uint8_t *literals, size_t literalLength, size_t offset, size_t matchLength, std::vector<uint8_t> &compressed)
+{
+	size_t matchCode = matchLength >= lz4MinimumMatch ? matchLength - lz4MinimumMatch : 0;
+	uint8_t token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+	token |= static_cast<uint8_t>(matchCode < 15 ? matchCode : 15);
+	compressed.push_back(token);
+	if (literalLength >= 15)
+	{
+		writeLength(literalLength - 15, compressed);
+	}
+	compressed.insert(compressed.end(), literals, literals + literalLength);
+
+	if (matchLength == 0)
+	{
+		return;
+	}
+	compressed.push_back(static_cast<uint8_t>(offset & 0xFF));
+	compressed.push_back(static_cast<uint8_t>(offset >> 8));
+	if (matchCode >= 15)
+	{
+		writeLength(matchCode - 15, compressed);
+	}
+}
+
+void lz4Compress(const uint8_t *source, size_t size, std::vector<uint8_t> &compressed)
+{
+	compressed.clear();
+	compressed.reserve(size + size / 255 + 16);
+
+	size_t anchor = 0;
+	if (size > lz4MatchFindLimit)
+	{
+		// Position each sequence was last seen at - positions are checked before use so stale or colliding entries are harmless
+		std::vector<uint32_t> hashTable(static_cast<size_t>(1) << lz4HashBits, 0);
+		size_t matchFindEnd = size - lz4MatchFindLimit;
+		size_t matchEnd = size - lz4LastLiterals;
+		size_t position = 0;
+
+		while (position <= matchFindEnd)
+		{
+			uint32_t sequence = read32(source + position);
+			uint32_t hash = hashSequence(sequence);
+			size_t candidate = hashTable[hash];
+			hashTable[hash] = static_cast<uint32_t>(position);
+
+			if (candidate >= position || position - candidate > lz4MaximumOffset || read32(source + candidate) != sequence)
+			{
+				position++;
+				continue;
+			}
+
+			// Extend the match as far as the data allows
+			size_t matchLength = lz4MinimumMatch;
+			while (position + matchLength < matchEnd && source[candidate + matchLength] == source[position + matchLength])
+			{
+				matchLength++;
+			}
+
+			writeSequence(source + anchor, position - anchor, position - candidate, matchLength, compressed);
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	// Everything after the last match is written as literals
+	writeSequence(source + anchor, size - anchor, 0, 0, compressed);
+}
+
+bool lz4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize)
+{
+	const uint8_t *input = source;
+	const uint8_t *inputEnd = source + sourceSize;
+	uint8_t *output = destination;
+	uint8_t *outputEnd = destination + destinationSize;
+
+	while (input < inputEnd)
+	{
+		uint8_t token = *input++;
+
+		// Copy the literals
+		size_t literalLength = token >> 4;
+		if (literalLength == 15)
+		{
+			uint8_t extra;
+			do
+			{
+				if (input >= inputEnd)
+				{
+					return false;
+				}
+				extra = *input++;
+				literalLength += extra;
+			} while (extra == 255);
+		}
+		if (literalLength > static_cast<size_t>(inputEnd - input) || literalLength > static_cast<size_t>(outputEnd - output))
+		{
+			return false;
+		}
+		memcpy(output, input, literalLength);
+		input += literalLength;
+		output += literalLength;
+
+		// The last sequence has no match
+		if (input == inputEnd)
+		{
+			break;
+		}
+
+		// Copy the match - it may overlap the bytes it produces so short offsets are copied a byte at a time
+		if (inputEnd - input < 2)
+		{
+			return false;
+		}
+		size_t offset = input[0] | (static_cast<size_t>(input[1]) << 8);
+		input += 2;
+		if (offset == 0 || offset > static_cast<size_t>(output - destination))
+		{
+			return false;
+		}
+		size_t matchLength = token & 15;
+		if (matchLength == 15)
+		{
+			uint8_t extra;
+			do
+			{
+				if (input >= inputEnd)
+				{
+					return false;
+				}
+				extra = *input++;
+				matchLength += extra;
+			} while (extra == 255);
+		}
+		matchLength += lz4MinimumMatch;
+		if (matchLength > static_cast<size_t>(outputEnd - output))
+		{
+			return false;
+		}
+		const uint8_t *match = output - offset;
+		if (offset >= matchLength)
+		{
+			memcpy(output, match, matchLength);
+			output += matchLength;
+		}
+		else
+		{
+			for (size_t i = 0; i < matchLength; i++)
+			{
+				*output++ = *match++;
+			}
+		}
+	}
+
+	return output == outputEnd;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// LZ4 block format compression - the output is a plain LZ4 block so any LZ4 decoder can read it
+// The compressor is the simple greedy single hash table kind - it trades some ratio for speed, decompression runs at memory speed either way
+
+// Function which compresses size bytes of source into compressed, replacing its contents
+void lz4Compress(const uint8_t *source, size_t size, std::vector<uint8_t> &compressed);
+
+// Function which decompresses an LZ4 block into exactly destinationSize bytes - returns false if the block is corrupt or does not fill the destination exactly
+bool lz4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize);
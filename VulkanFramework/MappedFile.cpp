@@ -0,0 +1,128 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// Function which maps the file at the path into memory - returns false if the file cannot be opened
+bool MappedFile::open(const std::string &path)
+{
+	// Release any file that is already mapped
+	close();
+
+#ifdef _WIN32
+	// Open the file for reading and let other readers share it
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER length;
+	if (!GetFileSizeEx(file, &length))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	fileSize = static_cast<size_t>(length.QuadPart);
+
+	// An empty file cannot be mapped but is still a valid file
+	if (fileSize > 0)
+	{
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr)
+		{
+			close();
+			return false;
+		}
+		fileData = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (fileData == nullptr)
+		{
+			close();
+			return false;
+		}
+	}
+#else
+	// Open the file for reading
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fileDescriptor, &info) != 0)
+	{
+		close();
+		return false;
+	}
+	fileSize = static_cast<size_t>(info.st_size);
+
+	// An empty file cannot be mapped but is still a valid file
+	if (fileSize > 0)
+	{
+		void* view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (view == MAP_FAILED)
+		{
+			close();
+			return false;
+		}
+		fileData = static_cast<const uint8_t*>(view);
+	}
+#endif
+
+	opened = true;
+	return true;
+}
+
+// Function which unmaps the file and closes its handles
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (fileData != nullptr)
+	{
+		UnmapViewOfFile(fileData);
+	}
+	if (mappingHandle != nullptr)
+	{
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != nullptr)
+	{
+		CloseHandle(fileHandle);
+	}
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (fileData != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(fileData), fileSize);
+	}
+	if (fileDescriptor >= 0)
+	{
+		::close(fileDescriptor);
+	}
+	fileDescriptor = -1;
+#endif
+
+	fileData = nullptr;
+	fileSize = 0;
+	opened = false;
+}
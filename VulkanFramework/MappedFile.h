@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Class which maps a whole file into memory read only - the operating system pages the file in on demand so nothing is copied up front
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string &path);
+	void close();
+
+	bool isOpen() const { return opened; }
+	const uint8_t* data() const { return fileData; }
+	size_t size() const { return fileSize; }
+
+private:
+	// A mapping owns operating system handles so it cannot be copied
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool opened = false;
+	const uint8_t* fileData = nullptr;
+	size_t fileSize = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+};
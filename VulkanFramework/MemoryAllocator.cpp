@@ -0,0 +1,501 @@
+#include "MemoryAllocator.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+
+MemoryAllocator::MemoryAllocator()
+{
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+}
+
+// Function which finds the highest set bit of a non-zero value
+static uint32_t highestBit(uint64_t value)
+{
+	uint32_t bit = 0;
+	while (value >>= 1)
+	{
+		bit++;
+	}
+	return bit;
+}
+
+// Function which finds the lowest set bit of a non-zero value
+static uint32_t lowestBit(uint64_t value)
+{
+	uint32_t bit = 0;
+	while ((value & 1) == 0)
+	{
+		value >>= 1;
+		bit++;
+	}
+	return bit;
+}
+
+// Function which rounds a value up to a multiple of a power of two
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Function which works out the free list a range of this size belongs in - the first level is the power of two below it, the second the step above that
+static void freeListIndex(VkDeviceSize size, uint32_t &firstLevel, uint32_t &secondLevel)
+{
+	firstLevel = highestBit(size);
+	secondLevel = static_cast<uint32_t>(size >> (firstLevel - memorySecondLevelBits)) & (memorySecondLevelCount - 1);
+}
+
+// Function which creates a buffer's memory and binds it
+void MemoryAllocator::bindBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties)
+{
+	VkMemoryRequirements memRequirements;
+	vkGetBufferMemoryRequirements(FrameworkSingleton::getInstance()->device, buffer, &memRequirements);
+
+	std::lock_guard<std::mutex> lock(allocatorMutex);
+	MemoryAllocation allocation = allocate(memRequirements, properties, false);
+	vkBindBufferMemory(FrameworkSingleton::getInstance()->device, buffer, allocation.memory, allocation.offset);
+	bufferAllocations[buffer] = allocation;
+}
+
+// Function which creates an optimal tiling image's memory and binds it
+void MemoryAllocator::bindImage(VkImage image, VkMemoryPropertyFlags properties)
+{
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(FrameworkSingleton::getInstance()->device, image, &memRequirements);
+
+	std::lock_guard<std::mutex> lock(allocatorMutex);
+	MemoryAllocation allocation = allocate(memRequirements, properties, true);
+	vkBindImageMemory(FrameworkSingleton::getInstance()->device, image, allocation.memory, allocation.offset);
+	imageAllocations[image] = allocation;
+}
+
+// Function which destroys a buffer and returns its memory - buffers that were never bound are just destroyed
+void MemoryAllocator::destroyBuffer(VkBuffer buffer)
+{
+	std::lock_guard<std::mutex> lock(allocatorMutex);
+	vkDestroyBuffer(FrameworkSingleton::getInstance()->device, buffer, nullptr);
+	auto allocation = bufferAllocations.find(buffer);
+	if (allocation != bufferAllocations.end())
+	{
+		free(allocation->second);
+		bufferAllocations.erase(allocation);
+	}
+}
+
+// Function which destroys an image and returns its memory
+void MemoryAllocator::destroyImage(VkImage image)
+{
+	std::lock_guard<std::mutex> lock(allocatorMutex);
+	vkDestroyImage(FrameworkSingleton::getInstance()->device, image, nullptr);
+	auto allocation = imageAllocations.find(image);
+	if (allocation != imageAllocations.end())
+	{
+		free(allocation->second);
+		imageAllocations.erase(allocation);
+	}
+}
+
+// Function which returns where a host visible buffer can be written - its memory stays mapped until the buffer is destroyed
+void* MemoryAllocator::mappedData(VkBuffer buffer)
+{
+	std::lock_guard<std::mutex> lock(allocatorMutex);
+	auto allocation = bufferAllocations.find(buffer);
+	if (allocation == bufferAllocations.end() || allocation->second.mapped == nullptr)
+	{
+		throw std::runtime_error("failed to map buffer memory!");
+	}
+	return allocation->second.mapped;
+}
+
+// Function which finds memory for a resource - a range of a block of its memory type, or memory of its own if it is too large to share a block
+// Called with the allocator locked
+MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements &memRequirements, VkMemoryPropertyFlags properties, bool optimalImage)
+{
+	if (!memPropertiesRead)
+	{
+		vkGetPhysicalDeviceMemoryProperties(FrameworkSingleton::getInstance()->physicalDevice, &memProperties);
+		memPropertiesRead = true;
+	}
+	uint32_t memoryTypeIndex = FrameworkSingleton::getInstance()->vulkanManager.findMemoryType(memRequirements.memoryTypeBits, properties);
+
+	// Every range starts on the granularity so only stricter alignments need room to move within the free range found
+	VkDeviceSize alignment = std::max(memRequirements.alignment, memoryRangeGranularity);
+	VkDeviceSize size = alignUp(memRequirements.size, memoryRangeGranularity);
+	VkDeviceSize searchSize = size + alignment - memoryRangeGranularity;
+
+	MemoryAllocation allocation;
+	if (!FrameworkSingleton::getInstance()->useMemoryAllocator || searchSize > blockSize(memoryTypeIndex) / 2)
+	{
+		allocation.memory = allocateMemory(memoryTypeIndex, memRequirements.size, allocation.mapped);
+		if (allocation.memory == VK_NULL_HANDLE)
+		{
+			throw std::runtime_error("failed to allocate device memory!");
+		}
+		allocation.size = memRequirements.size;
+		dedicatedCount++;
+		dedicatedBytes += allocation.size;
+		return allocation;
+	}
+
+	size_t poolIndex = memoryTypeIndex * 2 + (optimalImage ? 1 : 0);
+	if (pools.size() <= poolIndex)
+	{
+		pools.resize(poolIndex + 1);
+	}
+	if (!pools[poolIndex])
+	{
+		pools[poolIndex].reset(new MemoryPool());
+		pools[poolIndex]->memoryTypeIndex = memoryTypeIndex;
+	}
+	MemoryPool &pool = *pools[poolIndex];
+
+	// Take a free range from the pool, adding a block if none is large enough - a block cut short by the device may be too small for the
+	// search to find its range, but it is still at least the size needed
+	MemoryRange *range = findFreeRange(pool, searchSize);
+	if (range == nullptr)
+	{
+		MemoryBlock *block = createBlock(pool, searchSize);
+		range = findFreeRange(pool, searchSize);
+		if (range == nullptr)
+		{
+			range = block->firstRange;
+		}
+	}
+	removeFreeRange(pool, range);
+
+	// Split off the space before the aligned offset and after the end as free ranges of their own
+	VkDeviceSize padding = alignUp(range->offset, alignment) - range->offset;
+	if (padding > 0)
+	{
+		MemoryRange *front = new MemoryRange();
+		front->offset = range->offset;
+		front->size = padding;
+		front->block = range->block;
+		front->previousPhysical = range->previousPhysical;
+		front->nextPhysical = range;
+		if (front->previousPhysical)
+		{
+			front->previousPhysical->nextPhysical = front;
+		}
+		else
+		{
+			range->block->firstRange = front;
+		}
+		range->previousPhysical = front;
+		range->offset += padding;
+		range->size -= padding;
+		insertFreeRange(pool, front);
+	}
+	if (range->size > size)
+	{
+		MemoryRange *back = new MemoryRange();
+		back->offset = range->offset + size;
+		back->size = range->size - size;
+		back->block = range->block;
+		back->previousPhysical = range;
+		back->nextPhysical = range->nextPhysical;
+		if (back->nextPhysical)
+		{
+			back->nextPhysical->previousPhysical = back;
+		}
+		range->nextPhysical = back;
+		range->size = size;
+		insertFreeRange(pool, back);
+	}
+	range->free = false;
+
+	allocation.memory = range->block->memory;
+	allocation.offset = range->offset;
+	allocation.size = range->size;
+	allocation.mapped = range->block->mapped ? range->block->mapped + range->offset : nullptr;
+	allocation.pool = &pool;
+	allocation.range = range;
+	allocationCount++;
+	usedBytes += range->size;
+	return allocation;
+}
+
+// Function which returns a resource's memory - a range merges with its free neighbours, and a block left empty is freed unless it is the pool's last
+// Called with the allocator locked
+void MemoryAllocator::free(const MemoryAllocation &allocation)
+{
+	if (allocation.range == nullptr)
+	{
+		vkFreeMemory(FrameworkSingleton::getInstance()->device, allocation.memory, nullptr);
+		dedicatedCount--;
+		dedicatedBytes -= allocation.size;
+		return;
+	}
+
+	MemoryPool &pool = *allocation.pool;
+	MemoryRange *range = allocation.range;
+	allocationCount--;
+	usedBytes -= range->size;
+	range->free = true;
+	MemoryRange *next = range->nextPhysical;
+	if (next && next->free)
+	{
+		removeFreeRange(pool, next);
+		range->size += next->size;
+		range->nextPhysical = next->nextPhysical;
+		if (range->nextPhysical)
+		{
+			range->nextPhysical->previousPhysical = range;
+		}
+		delete next;
+	}
+	MemoryRange *previous = range->previousPhysical;
+	if (previous && previous->free)
+	{
+		removeFreeRange(pool, previous);
+		previous->size += range->size;
+		previous->nextPhysical = range->nextPhysical;
+		if (previous->nextPhysical)
+		{
+			previous->nextPhysical->previousPhysical = previous;
+		}
+		delete range;
+		range = previous;
+	}
+
+	if (range->size == range->block->size && pool.blocks.size() > 1)
+	{
+		destroyBlock(pool, range->block);
+		return;
+	}
+	insertFreeRange(pool, range);
+}
+
+// Function which works out the size of the blocks of a memory type - memoryBlockSize, or an eighth of the heap for small heaps
+VkDeviceSize MemoryAllocator::blockSize(uint32_t memoryTypeIndex) const
+{
+	VkDeviceSize heapSize = memProperties.memoryHeaps[memProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+	VkDeviceSize size = std::max(std::min(static_cast<VkDeviceSize>(FrameworkSingleton::getInstance()->memoryBlockSize), heapSize / 8), memoryRangeGranularity * memorySecondLevelCount);
+	return size & ~(memoryRangeGranularity - 1);
+}
+
+// Function which allocates device memory of a memory type and maps it if it is host visible - null if the device is out of memory
+VkDeviceMemory MemoryAllocator::allocateMemory(uint32_t memoryTypeIndex, VkDeviceSize size, uint8_t *&mapped)
+{
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	if (vkAllocateMemory(FrameworkSingleton::getInstance()->device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+	{
+		return VK_NULL_HANDLE;
+	}
+	mapped = nullptr;
+	if (memProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		void *data;
+		if (vkMapMemory(FrameworkSingleton::getInstance()->device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS)
+		{
+			vkFreeMemory(FrameworkSingleton::getInstance()->device, memory, nullptr);
+			return VK_NULL_HANDLE;
+		}
+		mapped = static_cast<uint8_t*>(data);
+	}
+	return memory;
+}
+
+// Function which adds a block to a pool holding one free range over all of it
+// If the device cannot give a full block, smaller ones are tried down to the size needed
+MemoryBlock* MemoryAllocator::createBlock(MemoryPool &pool, VkDeviceSize minimumSize)
+{
+	VkDeviceSize size = blockSize(pool.memoryTypeIndex);
+	uint8_t *mapped = nullptr;
+	VkDeviceMemory memory = allocateMemory(pool.memoryTypeIndex, size, mapped);
+	while (memory == VK_NULL_HANDLE && size / 2 >= minimumSize)
+	{
+		size = (size / 2) & ~(memoryRangeGranularity - 1);
+		memory = allocateMemory(pool.memoryTypeIndex, size, mapped);
+	}
+	if (memory == VK_NULL_HANDLE)
+	{
+		throw std::runtime_error("failed to allocate device memory!");
+	}
+
+	MemoryBlock *block = new MemoryBlock();
+	block->memory = memory;
+	block->size = size;
+	block->mapped = mapped;
+	block->firstRange = new MemoryRange();
+	block->firstRange->size = size;
+	block->firstRange->block = block;
+	pool.blocks.push_back(block);
+	insertFreeRange(pool, block->firstRange);
+	return block;
+}
+
+// Function which frees a block whose only range is free and already out of its free list
+void MemoryAllocator::destroyBlock(MemoryPool &pool, MemoryBlock *block)
+{
+	vkFreeMemory(FrameworkSingleton::getInstance()->device, block->memory, nullptr);
+	pool.blocks.erase(std::find(pool.blocks.begin(), pool.blocks.end(), block));
+	delete block->firstRange;
+	delete block;
+}
+
+// Function which finds a free range at least this large in constant time - null if the pool has none
+// The size is rounded up to the next list so every range in the list found is large enough
+MemoryRange* MemoryAllocator::findFreeRange(MemoryPool &pool, VkDeviceSize size)
+{
+	size += (static_cast<VkDeviceSize>(1) << (highestBit(size) - memorySecondLevelBits)) - 1;
+	uint32_t firstLevel, secondLevel;
+	freeListIndex(size, firstLevel, secondLevel);
+
+	uint32_t secondLevelMap = pool.secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+	if (secondLevelMap == 0)
+	{
+		// Take the smallest list of any larger first level
+		uint64_t firstLevelMap = firstLevel + 1 < memoryFirstLevelCount ? pool.firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+		if (firstLevelMap == 0)
+		{
+			return nullptr;
+		}
+		firstLevel = lowestBit(firstLevelMap);
+		secondLevelMap = pool.secondLevelBitmaps[firstLevel];
+	}
+	return pool.freeLists[firstLevel][lowestBit(secondLevelMap)];
+}
+
+// Function which adds a free range to the front of its free list
+void MemoryAllocator::insertFreeRange(MemoryPool &pool, MemoryRange *range)
+{
+	uint32_t firstLevel, secondLevel;
+	freeListIndex(range->size, firstLevel, secondLevel);
+	range->previousFree = nullptr;
+	range->nextFree = pool.freeLists[firstLevel][secondLevel];
+	if (range->nextFree)
+	{
+		range->nextFree->previousFree = range;
+	}
+	pool.freeLists[firstLevel][secondLevel] = range;
+	pool.firstLevelBitmap |= static_cast<uint64_t>(1) << firstLevel;
+	pool.secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+// Function which takes a free range out of its free list, clearing the list's bits once it is empty
+void MemoryAllocator::removeFreeRange(MemoryPool &pool, MemoryRange *range)
+{
+	uint32_t firstLevel, secondLevel;
+	freeListIndex(range->size, firstLevel, secondLevel);
+	if (range->previousFree)
+	{
+		range->previousFree->nextFree = range->nextFree;
+	}
+	else
+	{
+		pool.freeLists[firstLevel][secondLevel] = range->nextFree;
+	}
+	if (range->nextFree)
+	{
+		range->nextFree->previousFree = range->previousFree;
+	}
+	range->previousFree = nullptr;
+	range->nextFree = nullptr;
+	if (pool.freeLists[firstLevel][secondLevel] == nullptr)
+	{
+		pool.secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+		if (pool.secondLevelBitmaps[firstLevel] == 0)
+		{
+			pool.firstLevelBitmap &= ~(static_cast<uint64_t>(1) << firstLevel);
+		}
+	}
+}
+
+// Function which gathers how much device memory is reserved and used and how broken up the free space is
+MemoryStatistics MemoryAllocator::statistics()
+{
+	std::lock_guard<std::mutex> lock(allocatorMutex);
+	MemoryStatistics stats;
+	stats.allocationCount = allocationCount;
+	stats.usedBytes = usedBytes;
+	stats.dedicatedCount = dedicatedCount;
+	stats.dedicatedBytes = dedicatedBytes;
+	VkDeviceSize freeBytes = 0, unbrokenBytes = 0;
+	for (const auto& pool : pools)
+	{
+		if (!pool)
+		{
+			continue;
+		}
+		for (const auto& block : pool->blocks)
+		{
+			stats.blockCount++;
+			stats.blockBytes += block->size;
+			VkDeviceSize largestInBlock = 0;
+			for (MemoryRange *range = block->firstRange; range; range = range->nextPhysical)
+			{
+				if (range->free)
+				{
+					freeBytes += range->size;
+					largestInBlock = std::max(largestInBlock, range->size);
+				}
+			}
+			unbrokenBytes += largestInBlock;
+			stats.largestFreeRange = std::max(stats.largestFreeRange, largestInBlock);
+		}
+	}
+	stats.fragmentation = freeBytes > 0 ? 1.0f - static_cast<float>(unbrokenBytes) / static_cast<float>(freeBytes) : 0.0f;
+	return stats;
+}
+
+// Function which writes the allocator's statistics and how many device memory allocations they come to
+void MemoryAllocator::report()
+{
+	MemoryStatistics stats = statistics();
+	std::cout << "Device memory: " + std::to_string(stats.allocationCount) + " resources in " + std::to_string(stats.usedBytes / 1024) + " KB of " + std::to_string(stats.blockCount) + " blocks holding "
+		+ std::to_string(stats.blockBytes / 1024) + " KB, " + std::to_string(stats.dedicatedCount) + " dedicated allocations of " + std::to_string(stats.dedicatedBytes / 1024) + " KB, "
+		+ std::to_string(static_cast<int>(stats.fragmentation * 100.0f)) + "% of free space fragmented\n";
+}
+
+// Function which frees every block and dedicated allocation still held - once every buffer and image has been destroyed on close
+void MemoryAllocator::cleanup()
+{
+	std::lock_guard<std::mutex> lock(allocatorMutex);
+	for (const auto& allocation : bufferAllocations)
+	{
+		if (allocation.second.range == nullptr)
+		{
+			vkFreeMemory(FrameworkSingleton::getInstance()->device, allocation.second.memory, nullptr);
+		}
+	}
+	for (const auto& allocation : imageAllocations)
+	{
+		if (allocation.second.range == nullptr)
+		{
+			vkFreeMemory(FrameworkSingleton::getInstance()->device, allocation.second.memory, nullptr);
+		}
+	}
+	for (const auto& pool : pools)
+	{
+		if (!pool)
+		{
+			continue;
+		}
+		for (const auto& block : pool->blocks)
+		{
+			vkFreeMemory(FrameworkSingleton::getInstance()->device, block->memory, nullptr);
+			MemoryRange *range = block->firstRange;
+			while (range)
+			{
+				MemoryRange *next = range->nextPhysical;
+				delete range;
+				range = next;
+			}
+			delete block;
+		}
+	}
+	pools.clear();
+	bufferAllocations.clear();
+	imageAllocations.clear();
+	allocationCount = 0;
+	usedBytes = 0;
+	dedicatedCount = 0;
+	dedicatedBytes = 0;
+}
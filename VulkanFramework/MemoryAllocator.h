@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// Ranges are handed out in multiples of this many bytes, always at least this aligned
+const VkDeviceSize memoryRangeGranularity = 256;
+// Free ranges are listed by the power of two below their size, then by which of sixteen even steps up to the next power they fall in
+const uint32_t memoryFirstLevelCount = 64;
+const uint32_t memorySecondLevelBits = 4;
+const uint32_t memorySecondLevelCount = 1 << memorySecondLevelBits;
+
+struct MemoryBlock;
+
+// Struct which stores one range of a memory block, free or handed out - ranges are linked to their neighbours in the block so freed ranges can merge
+struct MemoryRange
+{
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	bool free = true;
+	MemoryBlock *block = nullptr;
+	MemoryRange *previousPhysical = nullptr;
+	MemoryRange *nextPhysical = nullptr;
+	// Neighbours in its free list - only set while the range is free
+	MemoryRange *previousFree = nullptr;
+	MemoryRange *nextFree = nullptr;
+};
+
+// Struct which stores one block of device memory ranges are sub-allocated from
+struct MemoryBlock
+{
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize size = 0;
+	uint8_t *mapped = nullptr; // Whole block mapped for as long as it lives when its memory is host visible
+	MemoryRange *firstRange = nullptr;
+};
+
+// Struct which stores the blocks of one memory type and their free ranges - a two level segregated fit (TLSF) allocator
+// Optimal tiling images are kept in a pool of their own so they never share a page with buffers and bufferImageGranularity can be ignored
+struct MemoryPool
+{
+	uint32_t memoryTypeIndex = 0;
+	std::vector<MemoryBlock*> blocks;
+	// A bit is set for each first level with a free range and, within it, each second level list holding one
+	uint64_t firstLevelBitmap = 0;
+	uint32_t secondLevelBitmaps[memoryFirstLevelCount] = {};
+	MemoryRange *freeLists[memoryFirstLevelCount][memorySecondLevelCount] = {};
+};
+
+// Struct which stores where a buffer or image's memory was found - a range of a pool's block, or memory of its own when range is null
+struct MemoryAllocation
+{
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	uint8_t *mapped = nullptr;
+	MemoryPool *pool = nullptr;
+	MemoryRange *range = nullptr;
+};
+
+// Struct which stores the state of device memory at one moment
+struct MemoryStatistics
+{
+	uint32_t blockCount = 0;
+	VkDeviceSize blockBytes = 0; // Device memory reserved in blocks
+	uint32_t allocationCount = 0; // Buffers and images sub-allocated from the blocks
+	VkDeviceSize usedBytes = 0; // Bytes of the blocks handed out, alignment included
+	uint32_t dedicatedCount = 0; // Buffers and images given memory of their own
+	VkDeviceSize dedicatedBytes = 0;
+	VkDeviceSize largestFreeRange = 0;
+	float fragmentation = 0.0f; // Share of the free bytes outside the largest free range of their block - 0 when each block's free space is one range
+};
+
+// Class which binds every buffer and image to device memory, reserving large blocks of each memory type and handing out aligned ranges of them
+// so the application makes a handful of vkAllocateMemory calls rather than one per resource. Free ranges are found in constant time by size class
+// and merge with free neighbours when they are returned. Resources larger than half a block are given memory of their own
+// Host visible memory stays mapped, so buffers are written through mappedData rather than vkMapMemory - safe to call from any thread
+class MemoryAllocator
+{
+public:
+	MemoryAllocator();
+	~MemoryAllocator();
+
+	void bindBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties);
+	void bindImage(VkImage image, VkMemoryPropertyFlags properties);
+	void destroyBuffer(VkBuffer buffer);
+	void destroyImage(VkImage image);
+	void* mappedData(VkBuffer buffer);
+	MemoryStatistics statistics();
+	void report();
+	void cleanup();
+
+private:
+	MemoryAllocation allocate(const VkMemoryRequirements &memRequirements, VkMemoryPropertyFlags properties, bool optimalImage);
+	void free(const MemoryAllocation &allocation);
+	VkDeviceSize blockSize(uint32_t memoryTypeIndex) const;
+	VkDeviceMemory allocateMemory(uint32_t memoryTypeIndex, VkDeviceSize size, uint8_t *&mapped);
+	MemoryBlock* createBlock(MemoryPool &pool, VkDeviceSize minimumSize);
+	void destroyBlock(MemoryPool &pool, MemoryBlock *block);
+	MemoryRange* findFreeRange(MemoryPool &pool, VkDeviceSize size);
+	void insertFreeRange(MemoryPool &pool, MemoryRange *range);
+	void removeFreeRange(MemoryPool &pool, MemoryRange *range);
+
+	std::mutex allocatorMutex;
+	VkPhysicalDeviceMemoryProperties memProperties = {};
+	bool memPropertiesRead = false;
+	// Two pools for each memory type, created when first used - buffers at memoryTypeIndex * 2, optimal tiling images after them
+	std::vector<std::unique_ptr<MemoryPool>> pools;
+	std::unordered_map<VkBuffer, MemoryAllocation> bufferAllocations;
+	std::unordered_map<VkImage, MemoryAllocation> imageAllocations;
+	uint32_t allocationCount = 0;
+	VkDeviceSize usedBytes = 0;
+	uint32_t dedicatedCount = 0;
+	VkDeviceSize dedicatedBytes = 0;
+};
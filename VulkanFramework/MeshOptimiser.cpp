@@ -0,0 +1,397 @@
+#include "MeshOptimiser.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Vertex.h"
+
+MeshOptimiser::MeshOptimiser()
+{
+}
+
+MeshOptimiser::~MeshOptimiser()
+{
+}
+
+// Size of the FIFO cache used when measuring - a common size for post transform caches on current hardware
+const unsigned int analysisCacheSize = 16;
+// Size of the LRU cache the vertex cache optimiser models - larger than the hardware cache so the order suits any cache up to this size
+const int optimiserCacheSize = 32;
+// Allowed increase in ACMR when triangles are reordered to reduce overdraw - 1% worse cache use in exchange for drawing outside surfaces first
+const float overdrawThreshold = 1.01f;
+
+// Function which runs every optimisation on a mesh and reports the vertex cache statistics before and after
+void MeshOptimiser::optimiseMesh(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+	VertexCacheStatistics before = analyseVertexCache(indices, vertices.size(), analysisCacheSize);
+
+	// Reorder triangles so vertices are reused while still in the cache, then reorder clusters of triangles to reduce overdraw
+	optimiseVertexCache(indices, vertices.size());
+	optimiseOverdraw(indices, vertices, overdrawThreshold);
+	// Finally reorder the vertices into the order they are first used so vertex fetches walk through memory in order
+	optimiseVertexFetch(vertices, indices);
+
+	VertexCacheStatistics after = analyseVertexCache(indices, vertices.size(), analysisCacheSize);
+
+	std::cout << "Mesh optimised: ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+}
+
+// Function which simulates a FIFO post transform cache over the index buffer and returns how many vertices had to be transformed
+VertexCacheStatistics MeshOptimiser::analyseVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStatistics statistics = {};
+	if (indices.empty() || vertexCount == 0)
+	{
+		return statistics;
+	}
+
+	// Each vertex remembers when it entered the cache - it is still in the cache while fewer than cacheSize vertices have entered since
+	std::vector<size_t> cacheTimestamps(vertexCount, 0);
+	size_t timestamp = cacheSize + 1;
+	size_t misses = 0;
+
+	for (uint32_t index : indices)
+	{
+		if (timestamp - cacheTimestamps[index] > cacheSize)
+		{
+			cacheTimestamps[index] = timestamp++;
+			misses++;
+		}
+	}
+
+	statistics.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+	statistics.atvr = static_cast<float>(misses) / static_cast<float>(vertexCount);
+	return statistics;
+}
+
+// Vertex scoring from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static float forsythVertexScore(int cachePosition, int remainingTriangles)
+{
+	// Vertices with no triangles left are never needed again
+	if (remainingTriangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The three vertices of the last triangle get a fixed score so the next triangle does not just reuse the same edge
+		if (cachePosition < 3)
+		{
+			score = 0.75f;
+		}
+		else
+		{
+			// Score falls off with the position in the cache
+			float scaler = 1.0f / (optimiserCacheSize - 3);
+			score = std::pow(1.0f - (cachePosition - 3) * scaler, 1.5f);
+		}
+	}
+
+	// Boost vertices with few triangles left so they are finished off rather than left stranded
+	score += 2.0f * std::pow(static_cast<float>(remainingTriangles), -0.5f);
+	return score;
+}
+
+// Function which reorders the triangles so vertices are reused while they are still in the post transform cache
+void MeshOptimiser::optimiseVertexCache(std::vector<uint32_t> &indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Build the list of triangles that use each vertex
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+	for (uint32_t index : indices)
+	{
+		triangleOffsets[index + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		triangleOffsets[v + 1] += triangleOffsets[v];
+	}
+	std::vector<uint32_t> vertexTriangles(indices.size());
+	std::vector<uint32_t> fillOffsets(triangleOffsets.begin(), triangleOffsets.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			vertexTriangles[fillOffsets[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+		}
+	}
+
+	// Triangles not drawn yet that use each vertex - emitted triangles are swapped past the end of the vertex's live range
+	std::vector<int> remainingTriangles(vertexCount);
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		remainingTriangles[v] = static_cast<int>(triangleOffsets[v + 1] - triangleOffsets[v]);
+		vertexScores[v] = forsythVertexScore(-1, remainingTriangles[v]);
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	// Simulated LRU cache - one extra entry for each of the three new vertices pushed in at the front
+	std::vector<uint32_t> cache, newCache;
+	cache.reserve(optimiserCacheSize + 3);
+	newCache.reserve(optimiserCacheSize + 3);
+
+	size_t nextUnemitted = 0;
+	int64_t bestTriangle = -1;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		// If no triangle touching the cache has a score then pick up the first triangle that has not been drawn yet
+		if (bestTriangle < 0)
+		{
+			while (emitted[nextUnemitted])
+			{
+				nextUnemitted++;
+			}
+			bestTriangle = static_cast<int64_t>(nextUnemitted);
+		}
+
+		// Draw the best triangle
+		size_t t = static_cast<size_t>(bestTriangle);
+		emitted[t] = true;
+		newCache.clear();
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t v = indices[t * 3 + k];
+			output.push_back(v);
+			newCache.push_back(v);
+
+			// Remove the triangle from the vertex's list of remaining triangles
+			uint32_t begin = triangleOffsets[v];
+			uint32_t last = begin + remainingTriangles[v] - 1;
+			for (uint32_t i = begin; i <= last; i++)
+			{
+				if (vertexTriangles[i] == t)
+				{
+					std::swap(vertexTriangles[i], vertexTriangles[last]);
+					break;
+				}
+			}
+			remainingTriangles[v]--;
+		}
+
+		// The drawn triangle's vertices move to the front of the cache and everything else shifts back
+		for (uint32_t v : cache)
+		{
+			if (v != newCache[0] && v != newCache[1] && v != newCache[2])
+			{
+				newCache.push_back(v);
+			}
+		}
+		cache.swap(newCache);
+
+		// Vertices that fell out of the cache lose their cache score
+		for (size_t i = optimiserCacheSize; i < cache.size(); i++)
+		{
+			cachePositions[cache[i]] = -1;
+			vertexScores[cache[i]] = forsythVertexScore(-1, remainingTriangles[cache[i]]);
+		}
+		if (cache.size() > static_cast<size_t>(optimiserCacheSize))
+		{
+			cache.resize(optimiserCacheSize);
+		}
+
+		// Update the scores of the vertices in the cache then rescore their triangles and find the best one
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			cachePositions[cache[i]] = static_cast<int>(i);
+			vertexScores[cache[i]] = forsythVertexScore(static_cast<int>(i), remainingTriangles[cache[i]]);
+		}
+
+		bestTriangle = -1;
+		float bestScore = 0.0f;
+		for (uint32_t v : cache)
+		{
+			for (int i = 0; i < remainingTriangles[v]; i++)
+			{
+				uint32_t candidate = vertexTriangles[triangleOffsets[v] + i];
+				float score = vertexScores[indices[candidate * 3 + 0]] + vertexScores[indices[candidate * 3 + 1]] + vertexScores[indices[candidate * 3 + 2]];
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = candidate;
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+// Function which finds where clusters of triangles start by simulating the cache over the optimised order
+// A hard boundary is where all three vertices miss - the cache has been flushed so reordering there costs nothing
+// A soft boundary is where a cluster of at least minimumSize triangles is already as cheap as targetAcmr
+static std::vector<size_t> findClusters(const std::vector<uint32_t> &indices, size_t vertexCount, size_t minimumSize, float targetAcmr)
+{
+	size_t triangleCount = indices.size() / 3;
+	std::vector<size_t> cacheTimestamps(vertexCount, 0);
+	size_t timestamp = analysisCacheSize + 1;
+	std::vector<size_t> clusterStarts;
+	size_t clusterMisses = 0;
+	size_t clusterTriangles = 0;
+
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		int misses = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t v = indices[t * 3 + k];
+			if (timestamp - cacheTimestamps[v] > analysisCacheSize)
+			{
+				cacheTimestamps[v] = timestamp++;
+				misses++;
+			}
+		}
+
+		if (clusterTriangles == 0 || misses == 3)
+		{
+			if (clusterStarts.empty() || clusterStarts.back() != t)
+			{
+				clusterStarts.push_back(t);
+			}
+			clusterMisses = 0;
+			clusterTriangles = 0;
+		}
+
+		clusterMisses += misses;
+		clusterTriangles++;
+
+		if (clusterTriangles >= minimumSize && static_cast<float>(clusterMisses) / clusterTriangles <= targetAcmr)
+		{
+			clusterTriangles = 0;
+		}
+	}
+
+	clusterStarts.push_back(triangleCount);
+	return clusterStarts;
+}
+
+// Function which orders clusters of triangles by how far each cluster lies out along its average normal from the centre of the mesh
+// Clusters facing away from the centre are the ones most likely to cover others so they are drawn first
+static std::vector<uint32_t> sortClusters(const std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices, const glm::vec3 &meshCentre, const std::vector<size_t> &clusterStarts)
+{
+	size_t clusterCount = clusterStarts.size() - 1;
+	std::vector<float> clusterKeys(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		glm::vec3 centre(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+		{
+			const glm::vec3 &a = vertices[indices[t * 3 + 0]].pos;
+			const glm::vec3 &b = vertices[indices[t * 3 + 1]].pos;
+			const glm::vec3 &p = vertices[indices[t * 3 + 2]].pos;
+			glm::vec3 crossProduct = glm::cross(b - a, p - a);
+			float triangleArea = glm::length(crossProduct);
+			centre += (a + b + p) * (triangleArea / 3.0f);
+			normal += crossProduct;
+			area += triangleArea;
+		}
+		if (area > 0.0f)
+		{
+			centre /= area;
+		}
+		float normalLength = glm::length(normal);
+		if (normalLength > 0.0f)
+		{
+			normal /= normalLength;
+		}
+		clusterKeys[c] = glm::dot(centre - meshCentre, normal);
+	}
+
+	// Stable sort keeps the cache friendly order of clusters with equal keys
+	std::vector<size_t> clusterOrder(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		clusterOrder[c] = c;
+	}
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](size_t a, size_t b) { return clusterKeys[a] > clusterKeys[b]; });
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (size_t c : clusterOrder)
+	{
+		output.insert(output.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+	}
+	return output;
+}
+
+// Function which splits the cache optimised triangles into clusters and orders the clusters so outward facing ones are drawn first
+// Based on "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" by Sander, Nehab and Barczak
+void MeshOptimiser::optimiseOverdraw(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices, float threshold)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	// Find the area weighted centre of the whole mesh
+	glm::vec3 meshCentre(0.0f);
+	float meshArea = 0.0f;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		const glm::vec3 &a = vertices[indices[t * 3 + 0]].pos;
+		const glm::vec3 &b = vertices[indices[t * 3 + 1]].pos;
+		const glm::vec3 &c = vertices[indices[t * 3 + 2]].pos;
+		float area = glm::length(glm::cross(b - a, c - a));
+		meshCentre += (a + b + c) * (area / 3.0f);
+		meshArea += area;
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCentre /= meshArea;
+	}
+
+	// Try clusters from small to large - small clusters sort the surface more finely but every cluster boundary costs cache misses
+	// The first clustering that keeps the ACMR within threshold times the cache optimised ACMR is used
+	float meshAcmr = analyseVertexCache(indices, vertices.size(), analysisCacheSize).acmr;
+	for (size_t minimumClusterSize = 64; minimumClusterSize <= triangleCount; minimumClusterSize *= 2)
+	{
+		std::vector<uint32_t> output = sortClusters(indices, vertices, meshCentre, findClusters(indices, vertices.size(), minimumClusterSize, threshold * meshAcmr));
+		if (analyseVertexCache(output, vertices.size(), analysisCacheSize).acmr <= threshold * meshAcmr)
+		{
+			indices.swap(output);
+			return;
+		}
+	}
+}
+
+// Function which reorders the vertices into the order the index buffer first uses them and rewrites the indices to match
+void MeshOptimiser::optimiseVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+	const uint32_t unassigned = 0xFFFFFFFFu;
+	std::vector<uint32_t> remap(vertices.size(), unassigned);
+	std::vector<Vertex> output;
+	output.reserve(vertices.size());
+
+	for (auto& index : indices)
+	{
+		if (remap[index] == unassigned)
+		{
+			remap[index] = static_cast<uint32_t>(output.size());
+			output.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	// Keep any vertices the index buffer never uses at the end
+	for (size_t v = 0; v < vertices.size(); v++)
+	{
+		if (remap[v] == unassigned)
+		{
+			output.push_back(vertices[v]);
+		}
+	}
+
+	vertices.swap(output);
+}
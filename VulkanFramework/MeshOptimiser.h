@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct Vertex;
+
+// Struct which stores how well an index buffer uses the post transform vertex cache
+struct VertexCacheStatistics
+{
+	float acmr; // Average cache miss ratio - vertices transformed per triangle, 0.5 is ideal for large grids and 3 is the worst case
+	float atvr; // Average transformed vertex ratio - vertices transformed per unique vertex, 1 is ideal
+};
+
+class MeshOptimiser
+{
+public:
+	MeshOptimiser();
+	~MeshOptimiser();
+
+	void optimiseMesh(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+	void optimiseVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+	void optimiseOverdraw(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices, float threshold);
+	void optimiseVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+	VertexCacheStatistics analyseVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, unsigned int cacheSize);
+};
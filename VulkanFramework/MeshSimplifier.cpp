@@ -0,0 +1,375 @@
+#include "MeshSimplifier.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Vertex.h"
+#include "MeshOptimiser.h"
+
+#include <unordered_set>
+
+MeshSimplifier::MeshSimplifier()
+{
+}
+
+MeshSimplifier::~MeshSimplifier()
+{
+}
+
+// Each level of detail aims for this fraction of the indices of the level before it
+const float lodReduction = 0.5f;
+// Levels which do not get below this fraction of the level before them are dropped - the mesh is too locked up to simplify further
+const float lodMinimumReduction = 0.9f;
+// Largest error any level may have, as a fraction of the model's bounding radius - beyond this the shape is lost and the level is not worth drawing
+const float lodMaximumError = 0.1f;
+
+// Struct which stores the sum of squared distances to a set of planes, each weighted by the area of the triangle it came from
+struct Quadric
+{
+	double a00, a11, a22, a10, a20, a21;
+	double b0, b1, b2;
+	double c;
+	double weight;
+};
+
+// Function which builds the quadric of the plane through a triangle, weighted by its area
+static Quadric planeQuadric(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2)
+{
+	glm::dvec3 normal = glm::cross(glm::dvec3(p1 - p0), glm::dvec3(p2 - p0));
+	double length = glm::length(normal);
+	Quadric quadric = {};
+	if (length == 0.0)
+	{
+		return quadric;
+	}
+	double area = length * 0.5;
+	normal /= length;
+	double distance = -glm::dot(normal, glm::dvec3(p0));
+
+	quadric.a00 = normal.x * normal.x * area;
+	quadric.a11 = normal.y * normal.y * area;
+	quadric.a22 = normal.z * normal.z * area;
+	quadric.a10 = normal.y * normal.x * area;
+	quadric.a20 = normal.z * normal.x * area;
+	quadric.a21 = normal.z * normal.y * area;
+	quadric.b0 = normal.x * distance * area;
+	quadric.b1 = normal.y * distance * area;
+	quadric.b2 = normal.z * distance * area;
+	quadric.c = distance * distance * area;
+	quadric.weight = area;
+	return quadric;
+}
+
+// Function which adds one quadric to another
+static void addQuadric(Quadric &quadric, const Quadric &other)
+{
+	quadric.a00 += other.a00;
+	quadric.a11 += other.a11;
+	quadric.a22 += other.a22;
+	quadric.a10 += other.a10;
+	quadric.a20 += other.a20;
+	quadric.a21 += other.a21;
+	quadric.b0 += other.b0;
+	quadric.b1 += other.b1;
+	quadric.b2 += other.b2;
+	quadric.c += other.c;
+	quadric.weight += other.weight;
+}
+
+// Function which returns the mean squared distance from a point to the planes in a quadric
+static double quadricError(const Quadric &quadric, const glm::vec3 &point)
+{
+	double x = point.x, y = point.y, z = point.z;
+	double rx = quadric.a00 * x + quadric.a10 * y + quadric.a20 * z + quadric.b0;
+	double ry = quadric.a10 * x + quadric.a11 * y + quadric.a21 * z + quadric.b1;
+	double rz = quadric.a20 * x + quadric.a21 * y + quadric.a22 * z + quadric.b2;
+	double error = rx * x + ry * y + rz * z + quadric.b0 * x + quadric.b1 * y + quadric.b2 * z + quadric.c;
+	return quadric.weight > 0.0 ? std::max(error, 0.0) / quadric.weight : 0.0;
+}
+
+// Struct which stores one possible collapse of a vertex onto its neighbour
+struct Collapse
+{
+	uint32_t from;
+	uint32_t to;
+	double error;
+};
+
+// Function which simplifies a mesh until it has at most targetIndexCount indices or no collapse is left within targetError
+// Returns the largest error of any collapse that was made, in the same units as the vertex positions
+// Vertices on an open edge or on a texture seam never move so holes do not open up and textures do not tear
+float MeshSimplifier::simplify(const std::vector<Vertex> &vertices, const uint32_t *indices, size_t indexCount, size_t targetIndexCount, float targetError, std::vector<uint32_t> &simplified)
+{
+	simplified.assign(indices, indices + indexCount);
+	size_t vertexCount = vertices.size();
+	if (indexCount <= targetIndexCount || vertexCount == 0)
+	{
+		return 0.0f;
+	}
+
+	// Vertices at the same position but with different texture coordinates are treated as one point - the first such vertex stands in for the rest
+	std::vector<uint32_t> positionRemap(vertexCount);
+	std::vector<uint32_t> wedgeCounts(vertexCount, 0);
+	std::unordered_map<glm::vec3, uint32_t> positionVertices;
+	positionVertices.reserve(vertexCount);
+	std::vector<bool> used(vertexCount, false);
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		used[indices[i]] = true;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		auto inserted = positionVertices.insert({ vertices[v].pos, static_cast<uint32_t>(v) });
+		positionRemap[v] = inserted.first->second;
+		if (used[v])
+		{
+			wedgeCounts[positionRemap[v]]++;
+		}
+	}
+
+	// Lock vertices on texture seams, then vertices on open edges - an edge is open when no triangle uses it in the other direction
+	std::vector<bool> locked(vertexCount, false);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		locked[v] = wedgeCounts[positionRemap[v]] > 1;
+	}
+	std::unordered_set<uint64_t> edges;
+	edges.reserve(indexCount);
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			uint64_t a = positionRemap[indices[i + k]];
+			uint64_t b = positionRemap[indices[i + (k + 1) % 3]];
+			edges.insert((a << 32) | b);
+		}
+	}
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			uint64_t a = positionRemap[indices[i + k]];
+			uint64_t b = positionRemap[indices[i + (k + 1) % 3]];
+			if (edges.count((b << 32) | a) == 0)
+			{
+				locked[indices[i + k]] = true;
+				locked[indices[i + (k + 1) % 3]] = true;
+			}
+		}
+	}
+
+	// Every point starts with the quadric of the triangles around it
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		Quadric quadric = planeQuadric(vertices[indices[i]].pos, vertices[indices[i + 1]].pos, vertices[indices[i + 2]].pos);
+		for (int k = 0; k < 3; k++)
+		{
+			addQuadric(quadrics[positionRemap[indices[i + k]]], quadric);
+		}
+	}
+
+	double errorLimit = static_cast<double>(targetError) * targetError;
+	double resultError = 0.0;
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+	std::vector<uint32_t> vertexTriangles;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> collapseTargets(vertexCount);
+	std::vector<bool> touched(vertexCount);
+
+	// Collapse in passes - each pass makes the cheapest collapses whose triangles do not overlap, then rebuilds the index list
+	while (simplified.size() > targetIndexCount)
+	{
+		size_t triangleCount = simplified.size() / 3;
+
+		// Build the list of triangles around each vertex
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (uint32_t index : simplified)
+		{
+			triangleOffsets[index + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			triangleOffsets[v + 1] += triangleOffsets[v];
+		}
+		vertexTriangles.resize(simplified.size());
+		std::vector<uint32_t> fillOffsets(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				vertexTriangles[fillOffsets[simplified[t * 3 + k]]++] = static_cast<uint32_t>(t);
+			}
+		}
+
+		// Price every collapse of an unlocked vertex along one of its edges
+		collapses.clear();
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t from = simplified[t * 3 + k];
+				uint32_t to = simplified[t * 3 + (k + 1) % 3];
+				if (!locked[from])
+				{
+					double error = quadricError(quadrics[positionRemap[from]], vertices[to].pos);
+					if (error <= errorLimit)
+					{
+						collapses.push_back({ from, to, error });
+					}
+				}
+				if (!locked[to])
+				{
+					double error = quadricError(quadrics[positionRemap[to]], vertices[from].pos);
+					if (error <= errorLimit)
+					{
+						collapses.push_back({ to, from, error });
+					}
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) { return a.error < b.error; });
+
+		// Each collapse removes about two triangles - stop once enough have been made to reach the target
+		size_t collapseLimit = (simplified.size() - targetIndexCount) / 6 + 1;
+		size_t collapseCount = 0;
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			collapseTargets[v] = static_cast<uint32_t>(v);
+		}
+		std::fill(touched.begin(), touched.end(), false);
+
+		for (const auto& collapse : collapses)
+		{
+			if (collapseCount >= collapseLimit)
+			{
+				break;
+			}
+			if (touched[collapse.from] || touched[collapse.to])
+			{
+				continue;
+			}
+
+			// Check no triangle around the vertex would flip over or collapse to a sliver once the vertex has moved
+			bool flips = false;
+			const glm::vec3 &target = vertices[collapse.to].pos;
+			for (uint32_t i = triangleOffsets[collapse.from]; i < triangleOffsets[collapse.from + 1] && !flips; i++)
+			{
+				const uint32_t *triangle = &simplified[vertexTriangles[i] * 3];
+				if (positionRemap[triangle[0]] == positionRemap[collapse.to] || positionRemap[triangle[1]] == positionRemap[collapse.to] || positionRemap[triangle[2]] == positionRemap[collapse.to])
+				{
+					continue;
+				}
+				glm::vec3 before[3], after[3];
+				for (int k = 0; k < 3; k++)
+				{
+					before[k] = vertices[triangle[k]].pos;
+					after[k] = triangle[k] == collapse.from ? target : before[k];
+				}
+				glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				flips = glm::dot(normalBefore, normalAfter) <= 1e-3f * glm::length(normalBefore) * glm::length(normalAfter);
+			}
+			if (flips)
+			{
+				continue;
+			}
+
+			// Make the collapse and keep every triangle around the vertex out of the rest of this pass
+			collapseTargets[collapse.from] = collapse.to;
+			addQuadric(quadrics[positionRemap[collapse.to]], quadrics[positionRemap[collapse.from]]);
+			resultError = std::max(resultError, collapse.error);
+			touched[collapse.to] = true;
+			for (uint32_t i = triangleOffsets[collapse.from]; i < triangleOffsets[collapse.from + 1]; i++)
+			{
+				const uint32_t *triangle = &simplified[vertexTriangles[i] * 3];
+				touched[triangle[0]] = true;
+				touched[triangle[1]] = true;
+				touched[triangle[2]] = true;
+			}
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		// Rebuild the index list, dropping triangles that now have two corners at the same position
+		size_t writeIndex = 0;
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			uint32_t a = collapseTargets[simplified[t * 3 + 0]];
+			uint32_t b = collapseTargets[simplified[t * 3 + 1]];
+			uint32_t c = collapseTargets[simplified[t * 3 + 2]];
+			if (positionRemap[a] == positionRemap[b] || positionRemap[b] == positionRemap[c] || positionRemap[c] == positionRemap[a])
+			{
+				continue;
+			}
+			simplified[writeIndex++] = a;
+			simplified[writeIndex++] = b;
+			simplified[writeIndex++] = c;
+		}
+		simplified.resize(writeIndex);
+	}
+
+	return static_cast<float>(std::sqrt(resultError));
+}
+
+// Function which works out the bounding sphere of the vertices a model added to the vector
+void MeshSimplifier::computeBounds(const std::vector<Vertex> &vertices, size_t vertexBase, MeshLods &lods)
+{
+	if (vertices.size() <= vertexBase)
+	{
+		lods.boundsCentre = glm::vec3(0.0f);
+		lods.boundsRadius = 0.0f;
+		return;
+	}
+
+	// Centre the sphere on the bounding box then grow it to reach the furthest vertex
+	glm::vec3 minimum = vertices[vertexBase].pos;
+	glm::vec3 maximum = vertices[vertexBase].pos;
+	for (size_t v = vertexBase; v < vertices.size(); v++)
+	{
+		minimum = glm::min(minimum, vertices[v].pos);
+		maximum = glm::max(maximum, vertices[v].pos);
+	}
+	lods.boundsCentre = (minimum + maximum) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (size_t v = vertexBase; v < vertices.size(); v++)
+	{
+		glm::vec3 offset = vertices[v].pos - lods.boundsCentre;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+	lods.boundsRadius = std::sqrt(radiusSquared);
+}
+
+// Function which appends up to lodCount - 1 simplified copies of a model's triangles to its index list and records where every level lies
+// Each level is simplified from the one before it so its error is the sum of the errors along the way
+void MeshSimplifier::generateLods(const std::vector<Vertex> &vertices, size_t vertexBase, std::vector<uint32_t> &indices, size_t indexBase, unsigned int lodCount, MeshLods &lods)
+{
+	computeBounds(vertices, vertexBase, lods);
+	lods.levels.clear();
+	lods.levels.push_back({ 0, static_cast<uint32_t>(indices.size() - indexBase), 0.0f });
+
+	float maximumError = lodMaximumError * lods.boundsRadius;
+	std::vector<uint32_t> simplified;
+	MeshOptimiser meshOptimiser;
+	for (unsigned int level = 1; level < lodCount; level++)
+	{
+		MeshLod previous = lods.levels.back();
+		size_t targetIndexCount = static_cast<size_t>(previous.indexCount * lodReduction) / 3 * 3;
+		float levelError = simplify(vertices, indices.data() + indexBase + previous.firstIndex, previous.indexCount, targetIndexCount, maximumError - previous.error, simplified);
+
+		// Stop once a level barely shrinks - drawing it would cost about as much as the level before
+		if (simplified.empty() || simplified.size() > previous.indexCount * lodMinimumReduction)
+		{
+			break;
+		}
+
+		// Reorder the new level's triangles for the vertex cache as the full model was
+		meshOptimiser.optimiseVertexCache(simplified, vertices.size());
+
+		MeshLod lod = { static_cast<uint32_t>(indices.size() - indexBase), static_cast<uint32_t>(simplified.size()), previous.error + levelError };
+		indices.insert(indices.end(), simplified.begin(), simplified.end());
+		lods.levels.push_back(lod);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "MeshletBuilder.h"
+
+struct Vertex;
+
+// Struct which stores where one level of detail lies in a model's index list and how far it strays from the full model
+struct MeshLod
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	float error; // Largest distance in model units the simplified surface is expected to be from the full model - 0 for the full model
+};
+
+// Struct which stores every level of detail of a model, finest first, and the bounding sphere used to work out how large it is on screen
+struct MeshLods
+{
+	std::vector<MeshLod> levels;
+	glm::vec3 boundsCentre = glm::vec3(0.0f);
+	float boundsRadius = 0.0f;
+	// Meshlets of every level one after another and where each level's meshlets are - empty unless meshlet culling is on
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletRange> meshletLevels;
+};
+
+// Class which builds simplified versions of a mesh with quadric error metrics
+// Vertices are only ever collapsed onto other existing vertices so every level of detail indexes the same vertex buffer
+class MeshSimplifier
+{
+public:
+	MeshSimplifier();
+	~MeshSimplifier();
+
+	void generateLods(const std::vector<Vertex> &vertices, size_t vertexBase, std::vector<uint32_t> &indices, size_t indexBase, unsigned int lodCount, MeshLods &lods);
+	float simplify(const std::vector<Vertex> &vertices, const uint32_t *indices, size_t indexCount, size_t targetIndexCount, float targetError, std::vector<uint32_t> &simplified);
+	static void computeBounds(const std::vector<Vertex> &vertices, size_t vertexBase, MeshLods &lods);
+};
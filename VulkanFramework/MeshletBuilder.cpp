@@ -0,0 +1,180 @@
+#include "MeshletBuilder.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Vertex.h"
+#include "MeshSimplifier.h"
+
+MeshletBuilder::MeshletBuilder()
+{
+}
+
+MeshletBuilder::~MeshletBuilder()
+{
+}
+
+// Function which builds the meshlets of every level of detail of a model - indices points at the model's first index, as the levels' firstIndex does
+void MeshletBuilder::buildMeshlets(const std::vector<Vertex> &vertices, const uint32_t *indices, MeshLods &lods)
+{
+	lods.meshlets.clear();
+	lods.meshletLevels.clear();
+	for (const auto& lod : lods.levels)
+	{
+		MeshletRange range;
+		range.firstMeshlet = static_cast<uint32_t>(lods.meshlets.size());
+		buildLevel(vertices, indices, lod.firstIndex, lod.indexCount, lods.meshlets);
+		range.meshletCount = static_cast<uint32_t>(lods.meshlets.size()) - range.firstMeshlet;
+		lods.meshletLevels.push_back(range);
+	}
+}
+
+// Function which splits a run of triangles into meshlets - a meshlet is finished as soon as the next triangle would take it past either limit
+void MeshletBuilder::buildLevel(const std::vector<Vertex> &vertices, const uint32_t *indices, uint32_t firstIndex, uint32_t indexCount, std::vector<Meshlet> &meshlets)
+{
+	// Stamps start past any meshlet number so every vertex begins unused
+	vertexMeshlet.assign(vertices.size(), UINT32_MAX);
+	uint32_t stamp = 0;
+
+	Meshlet meshlet = {};
+	meshlet.firstIndex = firstIndex;
+	uint32_t vertexCount = 0;
+	for (uint32_t i = firstIndex; i + 2 < firstIndex + indexCount; i += 3)
+	{
+		// Count the corners this meshlet does not have yet
+		uint32_t newVertices = 0;
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			newVertices += vertexMeshlet[indices[i + corner]] != stamp ? 1 : 0;
+		}
+		// Corners shared within the triangle are counted twice - this only ever ends a meshlet a triangle early
+		if (vertexCount + newVertices > meshletMaxVertices || meshlet.indexCount / 3 + 1 > meshletMaxTriangles)
+		{
+			computeBounds(vertices, indices, meshlet);
+			meshlets.push_back(meshlet);
+			meshlet = {};
+			meshlet.firstIndex = i;
+			vertexCount = 0;
+			stamp++;
+		}
+
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			if (vertexMeshlet[indices[i + corner]] != stamp)
+			{
+				vertexMeshlet[indices[i + corner]] = stamp;
+				vertexCount++;
+			}
+		}
+		meshlet.indexCount += 3;
+	}
+	if (meshlet.indexCount > 0)
+	{
+		computeBounds(vertices, indices, meshlet);
+		meshlets.push_back(meshlet);
+	}
+}
+
+// Function which works out a meshlet's bounding sphere and normal cone
+void MeshletBuilder::computeBounds(const std::vector<Vertex> &vertices, const uint32_t *indices, Meshlet &meshlet)
+{
+	const uint32_t *meshletIndices = indices + meshlet.firstIndex;
+
+	// Ritter's sphere - start from the two corners furthest apart along the widest axis then grow it over any corner left outside
+	uint32_t minimumCorner[3] = { 0, 0, 0 }, maximumCorner[3] = { 0, 0, 0 };
+	for (uint32_t i = 0; i < meshlet.indexCount; i++)
+	{
+		const glm::vec3 &p = vertices[meshletIndices[i]].pos;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (p[axis] < vertices[meshletIndices[minimumCorner[axis]]].pos[axis])
+			{
+				minimumCorner[axis] = i;
+			}
+			if (p[axis] > vertices[meshletIndices[maximumCorner[axis]]].pos[axis])
+			{
+				maximumCorner[axis] = i;
+			}
+		}
+	}
+	int widestAxis = 0;
+	float widestSpan = 0.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float span = glm::distance(vertices[meshletIndices[minimumCorner[axis]]].pos, vertices[meshletIndices[maximumCorner[axis]]].pos);
+		if (span > widestSpan)
+		{
+			widestSpan = span;
+			widestAxis = axis;
+		}
+	}
+	glm::vec3 centre = (vertices[meshletIndices[minimumCorner[widestAxis]]].pos + vertices[meshletIndices[maximumCorner[widestAxis]]].pos) * 0.5f;
+	float radius = widestSpan * 0.5f;
+	for (uint32_t i = 0; i < meshlet.indexCount; i++)
+	{
+		const glm::vec3 &p = vertices[meshletIndices[i]].pos;
+		float distance = glm::distance(p, centre);
+		if (distance > radius)
+		{
+			// Move the centre towards the corner just far enough to take it in
+			float grownRadius = (radius + distance) * 0.5f;
+			centre += (p - centre) * ((grownRadius - radius) / distance);
+			radius = grownRadius;
+		}
+	}
+	meshlet.centre = centre;
+	meshlet.radius = radius;
+
+	// The cone axis is the average direction the triangles face - counter clockwise triangles are the front faces
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.indexCount / 3);
+	glm::vec3 normalSum = glm::vec3(0.0f);
+	for (uint32_t i = 0; i + 2 < meshlet.indexCount; i += 3)
+	{
+		const glm::vec3 &p0 = vertices[meshletIndices[i]].pos;
+		glm::vec3 normal = glm::cross(vertices[meshletIndices[i + 1]].pos - p0, vertices[meshletIndices[i + 2]].pos - p0);
+		float length = glm::length(normal);
+		// Degenerate triangles are never drawn so they do not widen the cone
+		if (length > 0.0f)
+		{
+			normals.push_back(normal / length);
+			normalSum += normal / length;
+		}
+	}
+
+	meshlet.coneApex = centre;
+	meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.coneCutoff = 1.0f;
+	float sumLength = glm::length(normalSum);
+	if (normals.empty() || sumLength == 0.0f)
+	{
+		return;
+	}
+	glm::vec3 axis = normalSum / sumLength;
+	float minimumDot = 1.0f;
+	for (const auto& normal : normals)
+	{
+		minimumDot = std::min(minimumDot, glm::dot(normal, axis));
+	}
+	// A triangle at 90 degrees or more from the axis faces the camera from some direction the rest do not - the meshlet can never be back facing as a whole
+	if (minimumDot <= 0.0f)
+	{
+		return;
+	}
+
+	// Pull the apex back along the axis until every triangle's plane is in front of it - a camera behind the apex inside the cone is behind every triangle
+	float apexDistance = 0.0f;
+	size_t n = 0;
+	for (uint32_t i = 0; i + 2 < meshlet.indexCount; i += 3)
+	{
+		const glm::vec3 &p0 = vertices[meshletIndices[i]].pos;
+		glm::vec3 normal = glm::cross(vertices[meshletIndices[i + 1]].pos - p0, vertices[meshletIndices[i + 2]].pos - p0);
+		if (glm::length(normal) == 0.0f)
+		{
+			continue;
+		}
+		const glm::vec3 &unitNormal = normals[n++];
+		apexDistance = std::max(apexDistance, glm::dot(centre - p0, unitNormal) / glm::dot(axis, unitNormal));
+	}
+	meshlet.coneApex = centre - axis * apexDistance;
+	meshlet.coneAxis = axis;
+	meshlet.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+}
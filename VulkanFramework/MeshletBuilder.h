@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+struct Vertex;
+struct MeshLods;
+
+// Most vertices and triangles one meshlet may hold
+const uint32_t meshletMaxVertices = 64;
+const uint32_t meshletMaxTriangles = 124;
+
+// Struct which stores one cluster of neighbouring triangles and what the culler needs to skip it - everything is in model space
+struct Meshlet
+{
+	uint32_t firstIndex; // Where the meshlet's triangles start in the model's index list - each meshlet is a run of whole triangles
+	uint32_t indexCount;
+	glm::vec3 centre; // Bounding sphere of every vertex the meshlet uses
+	float radius;
+	glm::vec3 coneApex; // Normal cone - the meshlet faces away from any camera inside the cone opening backwards from the apex
+	glm::vec3 coneAxis;
+	float coneCutoff; // Sine of the widest angle between the axis and a triangle normal - 1 when the triangles face too many ways to ever be back facing together
+};
+
+// Struct which stores where the meshlets of one level of detail lie in a model's meshlet list
+struct MeshletRange
+{
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+};
+
+// Class which splits each level of detail of a model into meshlets
+// Triangles are taken in index order, which the mesh optimiser has already made local, so each meshlet is a run of the index list and no indices are moved
+class MeshletBuilder
+{
+public:
+	MeshletBuilder();
+	~MeshletBuilder();
+
+	void buildMeshlets(const std::vector<Vertex> &vertices, const uint32_t *indices, MeshLods &lods);
+	void buildLevel(const std::vector<Vertex> &vertices, const uint32_t *indices, uint32_t firstIndex, uint32_t indexCount, std::vector<Meshlet> &meshlets);
+
+private:
+	void computeBounds(const std::vector<Vertex> &vertices, const uint32_t *indices, Meshlet &meshlet);
+
+	// Meshlet each vertex was last added to - kept between meshlets so no set has to be cleared
+	std::vector<uint32_t> vertexMeshlet;
+};
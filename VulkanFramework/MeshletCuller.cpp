@@ -0,0 +1,92 @@
+#include "MeshletCuller.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "MeshSimplifier.h"
+
+MeshletCuller::MeshletCuller()
+{
+}
+
+MeshletCuller::~MeshletCuller()
+{
+}
+
+// Function which sets the camera the next meshlets are culled against - model is the matrix the model is drawn with
+void MeshletCuller::setView(const glm::mat4 &model, const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition)
+{
+	// Planes pulled out of the whole transform are already in model space - depth runs from 0 to 1 so the near plane is the third row on its own
+	glm::mat4 modelViewProjection = viewProjection * model;
+	glm::vec4 rows[4];
+	for (int r = 0; r < 4; r++)
+	{
+		rows[r] = glm::vec4(modelViewProjection[0][r], modelViewProjection[1][r], modelViewProjection[2][r], modelViewProjection[3][r]);
+	}
+	glm::vec4 planes[6] = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2] };
+	for (int p = 0; p < 6; p++)
+	{
+		// Normalise so a sphere's radius can be compared with the distance to the plane
+		frustumPlanes[p] = planes[p] / std::max(glm::length(glm::vec3(planes[p])), 1e-12f);
+	}
+
+	modelCameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+}
+
+// Function which copies the triangles of every meshlet of a level that may be seen into visibleIndices and returns how many indices it wrote
+// visibleIndices needs room for the whole level - runs of visible meshlets are next to each other in the index list so each run is one copy
+uint32_t MeshletCuller::cull(const MeshLods &lods, size_t level, const uint32_t *indices, uint32_t *visibleIndices)
+{
+	const MeshletRange &range = lods.meshletLevels[level];
+	uint32_t visibleCount = 0;
+	uint32_t runStart = 0, runCount = 0;
+	for (uint32_t m = range.firstMeshlet; m < range.firstMeshlet + range.meshletCount; m++)
+	{
+		const Meshlet &meshlet = lods.meshlets[m];
+		testedTriangles += meshlet.indexCount / 3;
+
+		bool visible = true;
+		for (int p = 0; p < 6 && visible; p++)
+		{
+			visible = glm::dot(glm::vec3(frustumPlanes[p]), meshlet.centre) + frustumPlanes[p].w >= -meshlet.radius;
+		}
+		if (!visible)
+		{
+			frustumCulledTriangles += meshlet.indexCount / 3;
+		}
+		// Seen from inside the cone behind the apex every triangle is back facing
+		else if (meshlet.coneCutoff < 1.0f && glm::dot(glm::normalize(meshlet.coneApex - modelCameraPosition), meshlet.coneAxis) >= meshlet.coneCutoff)
+		{
+			coneCulledTriangles += meshlet.indexCount / 3;
+			visible = false;
+		}
+
+		// Extend the current run or copy it out and start a new one
+		if (visible && runCount > 0 && runStart + runCount == meshlet.firstIndex)
+		{
+			runCount += meshlet.indexCount;
+		}
+		else
+		{
+			if (runCount > 0)
+			{
+				memcpy(visibleIndices + visibleCount, indices + runStart, runCount * sizeof(uint32_t));
+				visibleCount += runCount;
+			}
+			runStart = meshlet.firstIndex;
+			runCount = visible ? meshlet.indexCount : 0;
+		}
+	}
+	if (runCount > 0)
+	{
+		memcpy(visibleIndices + visibleCount, indices + runStart, runCount * sizeof(uint32_t));
+		visibleCount += runCount;
+	}
+	return visibleCount;
+}
+
+// Function which zeroes the triangle counts
+void MeshletCuller::resetStats()
+{
+	testedTriangles = 0;
+	frustumCulledTriangles = 0;
+	coneCulledTriangles = 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+struct MeshLods;
+
+// Class which picks the meshlets of a model that may be seen from the camera and copies their triangles into an index list
+// Meshlets are skipped when their bounding sphere is outside the view frustum or their normal cone shows every triangle faces away from the camera
+class MeshletCuller
+{
+public:
+	MeshletCuller();
+	~MeshletCuller();
+
+	void setView(const glm::mat4 &model, const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition);
+	uint32_t cull(const MeshLods &lods, size_t level, const uint32_t *indices, uint32_t *visibleIndices);
+	void resetStats();
+
+	// Triangles passed to cull since the stats were last reset, and how many of them were skipped by each test
+	size_t testedTriangles = 0;
+	size_t frustumCulledTriangles = 0;
+	size_t coneCulledTriangles = 0;
+
+private:
+	// View frustum planes and camera position in model space so the meshlet bounds do not have to be moved
+	glm::vec4 frustumPlanes[6];
+	glm::vec3 modelCameraPosition = glm::vec3(0.0f);
+};
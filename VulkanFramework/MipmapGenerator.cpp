@@ -0,0 +1,134 @@
+#include "MipmapGenerator.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include <algorithm>
+#include <cstring>
+
+// SSE2 is always available on x64 and on x86 builds targeting it - fall back to a pixel at a time loop elsewhere
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MIPMAPGENERATOR_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+MipmapGenerator::MipmapGenerator()
+{
+}
+
+MipmapGenerator::~MipmapGenerator()
+{
+}
+
+// Function which returns the number of levels in a full mip chain - down to 1x1
+uint32_t MipmapGenerator::mipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levelCount = 1;
+	for (uint32_t extent = std::max(width, height); extent > 1; extent >>= 1)
+	{
+		levelCount++;
+	}
+	return levelCount;
+}
+
+// Function which writes rows firstRow to lastRow of the next level down - odd widths and heights repeat their last column or row
+void MipmapGenerator::downsampleRows(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t *destination, uint32_t destinationWidth, uint32_t firstRow, uint32_t lastRow)
+{
+	for (uint32_t y = firstRow; y < lastRow; y++)
+	{
+		const uint8_t *row0 = source + static_cast<size_t>(std::min(y * 2, sourceHeight - 1)) * sourceWidth * 4;
+		const uint8_t *row1 = source + static_cast<size_t>(std::min(y * 2 + 1, sourceHeight - 1)) * sourceWidth * 4;
+		uint8_t *output = destination + static_cast<size_t>(y) * destinationWidth * 4;
+		uint32_t x = 0;
+
+#ifdef MIPMAPGENERATOR_USE_SSE2
+		// Two output pixels at a time from four source pixels on each row - only while all four are inside the row
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rounding = _mm_set1_epi16(2);
+		for (; x + 1 < destinationWidth && x * 2 + 3 < sourceWidth; x += 2)
+		{
+			__m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+			__m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+			// Widen to 16 bits and add the rows - low holds the first two columns, high the second two
+			__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+			__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+			// Add neighbouring columns together to finish each 2x2 sum, then round and divide by four
+			low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+			high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+			__m128i sum = _mm_unpacklo_epi64(low, high);
+			sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(output + x * 4), _mm_packus_epi16(sum, zero));
+		}
+#endif
+
+		for (; x < destinationWidth; x++)
+		{
+			uint32_t x0 = std::min(x * 2, sourceWidth - 1) * 4;
+			uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1) * 4;
+			for (int c = 0; c < 4; c++)
+			{
+				output[x * 4 + c] = static_cast<uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+			}
+		}
+	}
+}
+
+// Function which builds levelCount levels of the mip chain - rows of each level are shared out across the threads the hardware can natively support
+void MipmapGenerator::generate(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t levelCount, std::vector<uint8_t> &levels)
+{
+	// Work out where each level starts
+	std::vector<size_t> levelOffsets(levelCount + 1, 0);
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		levelOffsets[level + 1] = levelOffsets[level] + static_cast<size_t>(levelExtent(width, level)) * levelExtent(height, level) * 4;
+	}
+	levels.resize(levelOffsets[levelCount]);
+	memcpy(levels.data(), pixels, levelOffsets[1]);
+
+	// Each level depends on the one above it so only the rows within a level run in parallel
+	for (uint32_t level = 1; level < levelCount; level++)
+	{
+		downsampleLevel(levels.data() + levelOffsets[level - 1], levelExtent(width, level - 1), levelExtent(height, level - 1), levels.data() + levelOffsets[level], levelExtent(width, level), levelExtent(height, level));
+	}
+}
+
+// Function which halves an RGBA8 image halvings times with the same box filter as the mip chain and keeps only the result - the same pixels as level halvings of the chain
+void MipmapGenerator::downscale(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t halvings, std::vector<uint8_t> &downscaled, uint32_t &downscaledWidth, uint32_t &downscaledHeight)
+{
+	if (halvings == 0)
+	{
+		downscaled.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+	}
+
+	// Only the level being read and the level being written are kept - the first halving reads the image itself
+	std::vector<uint8_t> source;
+	const uint8_t *sourcePixels = pixels;
+	for (uint32_t level = 1; level <= halvings; level++)
+	{
+		if (level > 1)
+		{
+			source.swap(downscaled);
+			sourcePixels = source.data();
+		}
+		downscaled.resize(static_cast<size_t>(levelExtent(width, level)) * levelExtent(height, level) * 4);
+		downsampleLevel(sourcePixels, levelExtent(width, level - 1), levelExtent(height, level - 1), downscaled.data(), levelExtent(width, level), levelExtent(height, level));
+	}
+	downscaledWidth = levelExtent(width, halvings);
+	downscaledHeight = levelExtent(height, halvings);
+}
+
+// Function which writes one level from the level above it - rows are shared out across the thread pool
+void MipmapGenerator::downsampleLevel(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t *destination, uint32_t destinationWidth, uint32_t destinationHeight)
+{
+	// Small levels are not worth splitting - one slice of at least 64 rows for each pool worker and the calling thread
+	ThreadPool &threadPool = FrameworkSingleton::getInstance()->threadPool;
+	uint32_t sliceCount = std::min(static_cast<uint32_t>(threadPool.threadCount() + 1), std::max(1u, destinationHeight / 64));
+	uint32_t rowsPerSlice = (destinationHeight + sliceCount - 1) / sliceCount;
+	threadPool.parallelFor(sliceCount, [&](size_t slice)
+	{
+		uint32_t firstRow = std::min(destinationHeight, static_cast<uint32_t>(slice) * rowsPerSlice);
+		uint32_t lastRow = std::min(destinationHeight, firstRow + rowsPerSlice);
+		downsampleRows(source, sourceWidth, sourceHeight, destination, destinationWidth, firstRow, lastRow);
+	});
+}
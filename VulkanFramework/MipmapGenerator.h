@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Class which builds the mip chain of an RGBA8 image on the CPU
+// Each level is a 2x2 box filter of the one above it - levels are stored one after another, largest first, each tightly packed
+class MipmapGenerator
+{
+public:
+	MipmapGenerator();
+	~MipmapGenerator();
+
+	void generate(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t levelCount, std::vector<uint8_t> &levels);
+	void downscale(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t halvings, std::vector<uint8_t> &downscaled, uint32_t &downscaledWidth, uint32_t &downscaledHeight);
+
+	static uint32_t mipLevelCount(uint32_t width, uint32_t height);
+	static uint32_t levelExtent(uint32_t extent, uint32_t level) { return extent >> level > 0 ? extent >> level : 1; }
+
+private:
+	static void downsampleLevel(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t *destination, uint32_t destinationWidth, uint32_t destinationHeight);
+	static void downsampleRows(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t *destination, uint32_t destinationWidth, uint32_t firstRow, uint32_t lastRow);
+};
@@ -0,0 +1,522 @@
+#include "ObjReader.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+// SSE2 is always available on x64 and on x86 builds targeting it - fall back to a byte at a time loop elsewhere
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define OBJREADER_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+ObjReader::ObjReader()
+{
+}
+
+ObjReader::~ObjReader()
+{
+}
+
+// Smallest chunk worth giving its own thread - smaller files are read as one chunk
+const size_t minimumChunkBytes = 64 * 1024;
+
+// Function which maps the OBJ file, reads every position and texture coordinate and splits the file into at most maximumChunks chunks of whole lines
+bool ObjReader::open(const std::string &path, unsigned int maximumChunks, std::string &error)
+{
+	close();
+
+	if (!file.open(path))
+	{
+		error = "failed to open model file!";
+		return false;
+	}
+
+	fileData = file.data();
+	fileSize = file.size();
+	readContents(maximumChunks);
+	return true;
+}
+
+// Function which reads an OBJ file already in memory - the memory is not copied so it has to stay valid until the reader is closed
+bool ObjReader::open(const uint8_t *data, size_t size, unsigned int maximumChunks, std::string &error)
+{
+	close();
+
+	if (data == nullptr)
+	{
+		error = "failed to open model file!";
+		return false;
+	}
+
+	fileData = data;
+	fileSize = size;
+	readContents(maximumChunks);
+	return true;
+}
+
+// Function which reads every position and texture coordinate and splits the file into chunks
+void ObjReader::readContents(unsigned int maximumChunks)
+{
+	const char *data = reinterpret_cast<const char*>(fileData);
+	const char *end = data + fileSize;
+	const char *cursor = data;
+
+	// Split the file into roughly even chunks - a new chunk only starts at the start of a line
+	size_t targetChunkBytes = std::max(minimumChunkBytes, fileSize / std::max(1u, maximumChunks) + 1);
+	ObjChunk chunk = { 0, 0, 0, 0 };
+	int positionCount = 0;
+	int texCoordCount = 0;
+
+	while (cursor < end)
+	{
+		size_t lineStart = static_cast<size_t>(cursor - data);
+		if (lineStart - chunk.begin >= targetChunkBytes)
+		{
+			chunk.end = lineStart;
+			chunks.push_back(chunk);
+			chunk.begin = lineStart;
+			chunk.positionCount = positionCount;
+			chunk.texCoordCount = texCoordCount;
+		}
+
+		const char *lineEnd = findLineEnd(cursor, end);
+		const char *token = skipSpaces(cursor, lineEnd);
+
+		// Position - the optional vertex colour after it is not used
+		if (lineEnd - token > 1 && token[0] == 'v' && isSpace(token[1]))
+		{
+			token += 2;
+			positions.push_back(parseFloat(token, lineEnd, 0.0f));
+			positions.push_back(parseFloat(token, lineEnd, 0.0f));
+			positions.push_back(parseFloat(token, lineEnd, 0.0f));
+			positionCount++;
+		}
+		// Texture coordinate
+		else if (lineEnd - token > 2 && token[0] == 'v' && token[1] == 't' && isSpace(token[2]))
+		{
+			token += 3;
+			texCoords.push_back(parseFloat(token, lineEnd, 0.0f));
+			texCoords.push_back(parseFloat(token, lineEnd, 0.0f));
+			texCoordCount++;
+		}
+
+		cursor = lineEnd + 1;
+	}
+
+	chunk.end = fileSize;
+	chunks.push_back(chunk);
+}
+
+// Function which unmaps the file and frees the positions and texture coordinates
+void ObjReader::close()
+{
+	file.close();
+	fileData = nullptr;
+	fileSize = 0;
+	chunks.clear();
+	positions.clear();
+	positions.shrink_to_fit();
+	texCoords.clear();
+	texCoords.shrink_to_fit();
+}
+
+// Function which skips spaces and tabs
+const char* ObjReader::skipSpaces(const char *cursor, const char *end)
+{
+	while (cursor < end && isSpace(*cursor))
+	{
+		cursor++;
+	}
+	return cursor;
+}
+
+// Function which finds the end of the line - either line ending character counts so \r\n just gives an extra empty line
+// Scans 16 bytes at a time with SSE2 where it is available
+const char* ObjReader::findLineEnd(const char *cursor, const char *end)
+{
+#ifdef OBJREADER_USE_SSE2
+	const __m128i newLine = _mm_set1_epi8('\n');
+	const __m128i carriageReturn = _mm_set1_epi8('\r');
+	while (end - cursor >= 16)
+	{
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, newLine), _mm_cmpeq_epi8(bytes, carriageReturn)));
+		if (mask != 0)
+		{
+#ifdef _MSC_VER
+			unsigned long firstBit;
+			_BitScanForward(&firstBit, static_cast<unsigned long>(mask));
+			return cursor + firstBit;
+#else
+			return cursor + __builtin_ctz(static_cast<unsigned int>(mask));
+#endif
+		}
+		cursor += 16;
+	}
+#endif
+
+	while (cursor < end && *cursor != '\n' && *cursor != '\r')
+	{
+		cursor++;
+	}
+	return cursor;
+}
+
+// Powers of ten that are exactly representable as doubles
+static const double exactPowersOfTen[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Function which parses the next number on the line - returns defaultValue if the token is not a number
+// Accepts the same grammar as tinyobj: [sign] digits [. digits] [(e|E) [sign] digits], but the whole token must match so 1.0abc is not read as 1.0
+// Numbers with up to 15 significant digits and small exponents are converted exactly with one multiply or divide, anything else goes through strtod
+float ObjReader::parseFloat(const char *&cursor, const char *end, float defaultValue)
+{
+	cursor = skipSpaces(cursor, end);
+	const char *tokenEnd = cursor;
+	while (tokenEnd < end && !isSpace(*tokenEnd))
+	{
+		tokenEnd++;
+	}
+
+	const char *start = cursor;
+	const char *current = cursor;
+	cursor = tokenEnd;
+
+	bool negative = false;
+	if (current < tokenEnd && (*current == '+' || *current == '-'))
+	{
+		negative = *current == '-';
+		current++;
+	}
+
+	// Collect the significant digits - leading zeros do not count towards the 19 that fit in the mantissa
+	uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int decimalExponent = 0;
+	int integerDigits = 0;
+	while (current < tokenEnd && static_cast<unsigned int>(*current - '0') < 10)
+	{
+		if (significantDigits < 19)
+		{
+			mantissa = mantissa * 10 + static_cast<unsigned int>(*current - '0');
+			if (mantissa != 0)
+			{
+				significantDigits++;
+			}
+		}
+		else
+		{
+			decimalExponent++;
+			significantDigits++;
+		}
+		integerDigits++;
+		current++;
+	}
+
+	// There must be at least one digit before anything else
+	if (integerDigits == 0)
+	{
+		return defaultValue;
+	}
+
+	if (current < tokenEnd && *current == '.')
+	{
+		current++;
+		while (current < tokenEnd && static_cast<unsigned int>(*current - '0') < 10)
+		{
+			if (significantDigits < 19)
+			{
+				mantissa = mantissa * 10 + static_cast<unsigned int>(*current - '0');
+				decimalExponent--;
+				if (mantissa != 0)
+				{
+					significantDigits++;
+				}
+			}
+			else
+			{
+				significantDigits++;
+			}
+			current++;
+		}
+	}
+
+	if (current < tokenEnd && (*current == 'e' || *current == 'E'))
+	{
+		current++;
+		bool negativeExponent = false;
+		if (current < tokenEnd && (*current == '+' || *current == '-'))
+		{
+			negativeExponent = *current == '-';
+			current++;
+		}
+
+		// An exponent needs at least one digit
+		int exponent = 0;
+		int exponentDigits = 0;
+		while (current < tokenEnd && static_cast<unsigned int>(*current - '0') < 10)
+		{
+			exponent = std::min(exponent * 10 + (*current - '0'), 100000);
+			exponentDigits++;
+			current++;
+		}
+		if (exponentDigits == 0)
+		{
+			return defaultValue;
+		}
+		decimalExponent += negativeExponent ? -exponent : exponent;
+	}
+
+	// Anything left over means the token is not a number
+	if (current != tokenEnd)
+	{
+		return defaultValue;
+	}
+
+	// Exact fast path - the mantissa and the power of ten are both exact doubles so a single operation rounds correctly
+	double value;
+	if (significantDigits <= 15 && decimalExponent >= -22 && decimalExponent <= 22)
+	{
+		value = static_cast<double>(mantissa);
+		value = decimalExponent < 0 ? value / exactPowersOfTen[-decimalExponent] : value * exactPowersOfTen[decimalExponent];
+		if (negative)
+		{
+			value = -value;
+		}
+	}
+	else
+	{
+		// Rare long or extreme numbers - strtod rounds them correctly
+		std::string number(start, current);
+		value = std::strtod(number.c_str(), nullptr);
+	}
+
+	return static_cast<float>(value);
+}
+
+// Function which reads the corners of a face in the forms v, v/vt, v//vn and v/vt/vn - indices are made zero based and relative indices resolved
+bool ObjReader::parseFace(const char *cursor, const char *end, int positionCount, int texCoordCount, std::vector<ObjCorner> &face) const
+{
+	// Reads an integer the way atoi does and moves past anything up to the next separator
+	auto readIndex = [&](int count, int &index)
+	{
+		bool negative = false;
+		if (cursor < end && (*cursor == '+' || *cursor == '-'))
+		{
+			negative = *cursor == '-';
+			cursor++;
+		}
+		int value = 0;
+		while (cursor < end && static_cast<unsigned int>(*cursor - '0') < 10)
+		{
+			value = value * 10 + (*cursor - '0');
+			cursor++;
+		}
+		while (cursor < end && *cursor != '/' && !isSpace(*cursor))
+		{
+			cursor++;
+		}
+
+		// Zero is not a valid index
+		if (value == 0)
+		{
+			return false;
+		}
+		index = negative ? count - value : value - 1;
+		return true;
+	};
+
+	face.clear();
+	int positionTotal = static_cast<int>(positions.size() / 3);
+	int texCoordTotal = static_cast<int>(texCoords.size() / 2);
+	cursor = skipSpaces(cursor, end);
+
+	while (cursor < end)
+	{
+		ObjCorner corner = { -1, -1 };
+		int normal = -1;
+		if (!readIndex(positionCount, corner.position))
+		{
+			return false;
+		}
+
+		if (cursor < end && *cursor == '/')
+		{
+			cursor++;
+			// v//vn
+			if (cursor < end && *cursor == '/')
+			{
+				cursor++;
+				if (!readIndex(0, normal))
+				{
+					return false;
+				}
+			}
+			// v/vt or v/vt/vn
+			else
+			{
+				if (!readIndex(texCoordCount, corner.texCoord))
+				{
+					return false;
+				}
+				if (cursor < end && *cursor == '/')
+				{
+					cursor++;
+					if (!readIndex(0, normal))
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		// Indices outside the file would read past the end of the arrays
+		if (corner.position < 0 || corner.position >= positionTotal || corner.texCoord >= texCoordTotal || corner.texCoord < -1)
+		{
+			return false;
+		}
+
+		face.push_back(corner);
+		cursor = skipSpaces(cursor, end);
+	}
+
+	return true;
+}
+
+// Point in polygon test used by the ear clipping - from https://wrf.ecse.rpi.edu//Research/Short_Notes/pnpoly.html as used by tinyobj
+static int pointInPolygon(int vertexCount, const float *vertexX, const float *vertexY, float testX, float testY)
+{
+	int inside = 0;
+	for (int i = 0, j = vertexCount - 1; i < vertexCount; j = i++)
+	{
+		if (((vertexY[i] > testY) != (vertexY[j] > testY)) && (testX < (vertexX[j] - vertexX[i]) * (testY - vertexY[i]) / (vertexY[j] - vertexY[i]) + vertexX[i]))
+		{
+			inside = !inside;
+		}
+	}
+	return inside;
+}
+
+// Function which splits a face into triangles by ear clipping - a step for step copy of tinyobj's triangulation so both give the same triangles
+void ObjReader::triangulateFace(const std::vector<ObjCorner> &face, std::vector<ObjCorner> &triangles) const
+{
+	triangles.clear();
+	size_t cornerCount = face.size();
+	if (cornerCount < 3)
+	{
+		return;
+	}
+
+	const float *v = positions.data();
+
+	// Find the two axes to work in - drop the axis the face is most facing along
+	size_t axes[2] = { 1, 2 };
+	for (size_t k = 0; k < cornerCount; k++)
+	{
+		const float *v0 = v + face[(k + 0) % cornerCount].position * 3;
+		const float *v1 = v + face[(k + 1) % cornerCount].position * 3;
+		const float *v2 = v + face[(k + 2) % cornerCount].position * 3;
+		float e0x = v1[0] - v0[0];
+		float e0y = v1[1] - v0[1];
+		float e0z = v1[2] - v0[2];
+		float e1x = v2[0] - v1[0];
+		float e1y = v2[1] - v1[1];
+		float e1z = v2[2] - v1[2];
+		float cx = std::fabs(e0y * e1z - e0z * e1y);
+		float cy = std::fabs(e0z * e1x - e0x * e1z);
+		float cz = std::fabs(e0x * e1y - e0y * e1x);
+		const float epsilon = 0.0001f;
+		if (cx > epsilon || cy > epsilon || cz > epsilon)
+		{
+			if (!(cx > cy && cx > cz))
+			{
+				axes[0] = 0;
+				if (cz > cx && cz > cy)
+				{
+					axes[1] = 1;
+				}
+			}
+			break;
+		}
+	}
+
+	// Signed area of the face in those axes gives its winding
+	float area = 0.0f;
+	for (size_t k = 0; k < cornerCount; k++)
+	{
+		const float *v0 = v + face[(k + 0) % cornerCount].position * 3;
+		const float *v1 = v + face[(k + 1) % cornerCount].position * 3;
+		area += (v0[axes[0]] * v1[axes[1]] - v0[axes[1]] * v1[axes[0]]) * 0.5f;
+	}
+
+	// Clip ears until a triangle is left - the round limit protects against faces that never give up an ear
+	int maxRounds = 10;
+	std::vector<ObjCorner> remaining = face;
+	size_t guess = 0;
+	ObjCorner corners[3];
+	float vx[3], vy[3];
+	while (remaining.size() > 3 && maxRounds > 0)
+	{
+		size_t remainingCount = remaining.size();
+		if (guess >= remainingCount)
+		{
+			maxRounds -= 1;
+			guess -= remainingCount;
+		}
+		for (size_t k = 0; k < 3; k++)
+		{
+			corners[k] = remaining[(guess + k) % remainingCount];
+			vx[k] = v[corners[k].position * 3 + axes[0]];
+			vy[k] = v[corners[k].position * 3 + axes[1]];
+		}
+		float e0x = vx[1] - vx[0];
+		float e0y = vy[1] - vy[0];
+		float e1x = vx[2] - vx[1];
+		float e1y = vy[2] - vy[1];
+		float cross = e0x * e1y - e0y * e1x;
+
+		// Not an ear if the corner bends the wrong way
+		if (cross * area < 0.0f)
+		{
+			guess += 1;
+			continue;
+		}
+
+		// Not an ear if any other corner is inside the triangle
+		bool overlap = false;
+		for (size_t other = 3; other < remainingCount; other++)
+		{
+			const float *ov = v + remaining[(guess + other) % remainingCount].position * 3;
+			if (pointInPolygon(3, vx, vy, ov[axes[0]], ov[axes[1]]))
+			{
+				overlap = true;
+				break;
+			}
+		}
+		if (overlap)
+		{
+			guess += 1;
+			continue;
+		}
+
+		// Emit the ear and remove its middle corner
+		triangles.push_back(corners[0]);
+		triangles.push_back(corners[1]);
+		triangles.push_back(corners[2]);
+		remaining.erase(remaining.begin() + (guess + 1) % remainingCount);
+	}
+
+	if (remaining.size() == 3)
+	{
+		triangles.push_back(remaining[0]);
+		triangles.push_back(remaining[1]);
+		triangles.push_back(remaining[2]);
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MappedFile.h"
+
+// Struct which stores one corner of a triangle read from an OBJ file - indices are zero based and -1 when the corner has no texture coordinate
+struct ObjCorner
+{
+	int position;
+	int texCoord;
+};
+
+// Struct which stores where a chunk of the OBJ file starts and how many positions and texture coordinates were defined before it
+struct ObjChunk
+{
+	size_t begin;
+	size_t end;
+	int positionCount;
+	int texCoordCount;
+};
+
+// Class which reads OBJ files straight from a memory mapped file, or from memory the file has already been read into
+// open reads the positions and texture coordinates and splits the file into chunks, readFaces then triangulates the faces of one chunk
+// Faces are triangulated exactly as tinyobj does so the output matches it corner for corner
+class ObjReader
+{
+public:
+	ObjReader();
+	~ObjReader();
+
+	bool open(const std::string &path, unsigned int maximumChunks, std::string &error);
+	bool open(const uint8_t *data, size_t size, unsigned int maximumChunks, std::string &error);
+	void close();
+
+	// Function which reads every face in a chunk and passes each triangle corner to emitCorner in file order - safe to call for different chunks on many threads at once
+	template<typename EmitCorner>
+	bool readFaces(size_t chunk, EmitCorner emitCorner, std::string &error) const
+	{
+		std::vector<ObjCorner> face, triangles;
+		int positionCount = chunks[chunk].positionCount;
+		int texCoordCount = chunks[chunk].texCoordCount;
+		const char *data = reinterpret_cast<const char*>(fileData);
+		const char *cursor = data + chunks[chunk].begin;
+		const char *chunkEnd = data + chunks[chunk].end;
+
+		while (cursor < chunkEnd)
+		{
+			const char *lineEnd = findLineEnd(cursor, chunkEnd);
+			const char *token = skipSpaces(cursor, lineEnd);
+
+			// Keep count of positions and texture coordinates so relative indices resolve the same way they would reading from the start
+			if (lineEnd - token > 1 && token[0] == 'v' && isSpace(token[1]))
+			{
+				positionCount++;
+			}
+			else if (lineEnd - token > 2 && token[0] == 'v' && token[1] == 't' && isSpace(token[2]))
+			{
+				texCoordCount++;
+			}
+			else if (lineEnd - token > 1 && token[0] == 'f' && isSpace(token[1]))
+			{
+				if (!parseFace(token + 2, lineEnd, positionCount, texCoordCount, face))
+				{
+					error = "failed to parse face in OBJ file!";
+					return false;
+				}
+				triangulateFace(face, triangles);
+				for (const auto& corner : triangles)
+				{
+					emitCorner(corner);
+				}
+			}
+
+			cursor = lineEnd + 1;
+		}
+
+		return true;
+	}
+
+	// Number of chunks the file was split into
+	size_t chunkCount() const { return chunks.size(); }
+
+	// Positions (three floats each) and texture coordinates (two floats each) in the order they appear in the file
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+
+private:
+	void readContents(unsigned int maximumChunks);
+	static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+	static const char* skipSpaces(const char *cursor, const char *end);
+	static const char* findLineEnd(const char *cursor, const char *end);
+	static float parseFloat(const char *&cursor, const char *end, float defaultValue);
+	bool parseFace(const char *cursor, const char *end, int positionCount, int texCoordCount, std::vector<ObjCorner> &face) const;
+	void triangulateFace(const std::vector<ObjCorner> &face, std::vector<ObjCorner> &triangles) const;
+
+	MappedFile file;
+	// Contents being read - either the mapped file or memory the caller owns, which must outlive the reader
+	const uint8_t *fileData = nullptr;
+	size_t fileSize = 0;
+	std::vector<ObjChunk> chunks;
+};
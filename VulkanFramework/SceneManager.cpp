@@ -159,9 +159,14 @@ void SceneManager::update()
 
 	glfwPollEvents();
 
-	// Update the uniform buffer to allow for transforms to take place 
-	vulkanManager.updateUniformBuffer(FrameworkSingleton::getInstance()->uniformBufferMemory);
-	vulkanManager.updateUniformBuffer(FrameworkSingleton::getInstance()->rotatingUniformBufferMemory);
-	// Draw the frame
+	// Reload any asset files that have been edited
+	if (FrameworkSingleton::getInstance()->useHotReload)
+	{
+		vulkanManager.reloadChangedAssets();
+	}
+	// Swap in any streamed textures and models that have finished uploading and start uploading the next ones
+	FrameworkSingleton::getInstance()->streamingManager.update();
+
+	// Draw the frame - the uniform buffer objects, level of detail draws and terrain patches are written once the swap chain image it is drawn into is known
 	vulkanManager.drawFrame();
 }
\ No newline at end of file
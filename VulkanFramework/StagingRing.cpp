@@ -0,0 +1,144 @@
+#include "StagingRing.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+
+StagingRing::StagingRing()
+{
+}
+
+StagingRing::~StagingRing()
+{
+}
+
+// Function which creates the ring's buffer and maps it for as long as it lives
+void StagingRing::create()
+{
+	// Whole regions of the largest alignment fit end to end
+	capacity = std::max<VkDeviceSize>(FrameworkSingleton::getInstance()->stagingRingSize, stagingRegionAlignment * 2);
+	capacity = (capacity + stagingRegionAlignment - 1) / stagingRegionAlignment * stagingRegionAlignment;
+	FrameworkSingleton::getInstance()->vulkanManager.createBuffer(capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer);
+	mapped = static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(buffer));
+	writePosition = 0;
+	submittedPosition = 0;
+	readPosition = 0;
+}
+
+// Function which hands out a region of size bytes to copy an upload into - waits for the oldest submissions still reading the ring when it is full
+// False, with nothing handed out, when only regions not yet submitted are in the way or the region is larger than largestRegion - the caller then
+// submits what it has recorded, or splits the upload into smaller chunks, and asks again
+bool StagingRing::allocate(VkDeviceSize size, StagingRegion &region)
+{
+	if (size > largestRegion())
+	{
+		return false;
+	}
+
+	// A region never runs past the end of the buffer - it starts again at the beginning instead
+	uint64_t start = (writePosition + stagingRegionAlignment - 1) / stagingRegionAlignment * stagingRegionAlignment;
+	if (start % capacity + size > capacity)
+	{
+		start = (start / capacity + 1) * capacity;
+	}
+	uint64_t end = start + size;
+
+	retireFinished();
+	while (end - readPosition > capacity)
+	{
+		if (batches.empty())
+		{
+			return false;
+		}
+		StagingBatch &oldest = batches.front();
+		if (!oldest.finished)
+		{
+			vkWaitForFences(FrameworkSingleton::getInstance()->device, 1, &oldest.fence, VK_TRUE, UINT64_MAX);
+			waitCount++;
+		}
+		readPosition = oldest.end;
+		batches.pop_front();
+	}
+
+	writePosition = end;
+	region.offset = static_cast<VkDeviceSize>(start % capacity);
+	region.size = size;
+	region.data = mapped + region.offset;
+	regionCount++;
+	stagedBytes += size;
+	return true;
+}
+
+// Function which returns the largest region the ring hands out - half of it, so one chunk of a large upload can be filled while the one before is copied
+VkDeviceSize StagingRing::largestRegion() const
+{
+	return capacity / 2;
+}
+
+// Function which returns the bytes that can be handed out without waiting for the GPU
+VkDeviceSize StagingRing::available()
+{
+	retireFinished();
+	return capacity - static_cast<VkDeviceSize>(writePosition - readPosition);
+}
+
+// Function which marks every region handed out since the last submission as read by the one that signals fence
+// The fence has to stay alive until it is released
+void StagingRing::submitted(VkFence fence)
+{
+	if (writePosition == submittedPosition)
+	{
+		return;
+	}
+	StagingBatch batch;
+	batch.end = writePosition;
+	batch.fence = fence;
+	batches.push_back(batch);
+	submittedPosition = writePosition;
+}
+
+// Function which is told a fence has signalled and is about to be destroyed - the regions of its submission are given back
+void StagingRing::release(VkFence fence)
+{
+	for (auto& batch : batches)
+	{
+		if (batch.fence == fence)
+		{
+			batch.finished = true;
+			batch.fence = VK_NULL_HANDLE;
+		}
+	}
+	retireFinished();
+}
+
+// Function which gives back the regions of the oldest submissions, in order, for as long as they have finished
+void StagingRing::retireFinished()
+{
+	while (!batches.empty() && (batches.front().finished || vkGetFenceStatus(FrameworkSingleton::getInstance()->device, batches.front().fence) == VK_SUCCESS))
+	{
+		readPosition = batches.front().end;
+		batches.pop_front();
+	}
+}
+
+// Function which writes how much was staged through the ring and how often uploads had to wait for room in it
+void StagingRing::report()
+{
+	if (buffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	std::cout << "Staging ring: " + std::to_string(stagedBytes / 1024) + " KB staged through " + std::to_string(regionCount) + " regions of a " + std::to_string(capacity / 1024) + " KB ring, "
+		+ std::to_string(waitCount) + " waits for the GPU to free room\n";
+}
+
+// Function which destroys the ring's buffer - once the device is idle on close
+void StagingRing::cleanup()
+{
+	if (buffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(buffer);
+	buffer = VK_NULL_HANDLE;
+	mapped = nullptr;
+	batches.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <cstdint>
+
+// Every region starts on this many bytes - a multiple of the texel block size of every format uploaded through the ring, as image copies need
+const VkDeviceSize stagingRegionAlignment = 16;
+
+// Struct which stores one region of the staging ring - offset is where it starts in the ring's buffer, data where it starts in the mapping
+struct StagingRegion
+{
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	uint8_t *data = nullptr;
+};
+
+// Struct which stores where the regions read by one submission end and the fence it signals - finished once the fence has been released
+struct StagingBatch
+{
+	uint64_t end = 0;
+	VkFence fence = VK_NULL_HANDLE;
+	bool finished = false;
+};
+
+// Class which owns the one host visible buffer every upload is staged through - mapped once when it is created and handed out front to back, wrapping around
+// Regions handed out since the last submission are tracked with the fence of the submission that reads them and reused once it signals,
+// so loading assets allocates no staging memory of its own. Only used from the main thread
+class StagingRing
+{
+public:
+	StagingRing();
+	~StagingRing();
+
+	void create();
+	bool allocate(VkDeviceSize size, StagingRegion &region);
+	VkDeviceSize largestRegion() const;
+	VkDeviceSize available();
+	void submitted(VkFence fence);
+	void release(VkFence fence);
+	void report();
+	void cleanup();
+
+	VkBuffer buffer = VK_NULL_HANDLE;
+
+private:
+	void retireFinished();
+
+	uint8_t *mapped = nullptr;
+	VkDeviceSize capacity = 0;
+	// Bytes ever handed out, padding at the end of the buffer included, and how many of them were handed to a submission and how many given back
+	// Offsets in the buffer are these modulo the capacity
+	uint64_t writePosition = 0;
+	uint64_t submittedPosition = 0;
+	uint64_t readPosition = 0;
+	// Submissions still reading the ring, oldest first
+	std::deque<StagingBatch> batches;
+	// Regions handed out, bytes staged through them and how often the main thread waited for the GPU to free room
+	uint32_t regionCount = 0;
+	uint64_t stagedBytes = 0;
+	uint32_t waitCount = 0;
+};
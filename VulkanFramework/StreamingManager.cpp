@@ -0,0 +1,488 @@
+#include "StreamingManager.h"
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Vertex.h"
+
+StreamingManager::StreamingManager()
+{
+}
+
+StreamingManager::~StreamingManager()
+{
+}
+
+// Struct which stores one texture or model request from the moment it is made until it is swapped in
+struct StreamingJob
+{
+	std::string path;
+	int priority = 0;
+	uint64_t sequence = 0;
+	bool isModel = false;
+	std::function<void()> onLoaded;
+	// Hash of the file contents the asset registry knows the asset by, and whether the registry already held it when the worker got to it
+	uint64_t contentKey = 0;
+	bool shared = false;
+
+	// Where a texture is swapped in to
+	VkImage *textureIm = nullptr;
+	VkFormat *textureFormat = nullptr;
+	// Where a model is swapped in to
+	std::vector<Vertex> *modelVertices = nullptr;
+	std::vector<uint32_t> *modelIndices = nullptr;
+	MeshLods *modelLods = nullptr;
+	VkBuffer *vertexBuffer = nullptr;
+	VertexDequantisation *dequantisation = nullptr;
+	VkBuffer *indexBuffer = nullptr;
+	VkIndexType *indexType = nullptr;
+	MeshRange *range = nullptr;
+
+	// Written by the worker thread
+	DecodedTexture texture;
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	MeshLods lods;
+	std::vector<uint8_t> vertexData; // Vertices in the layout they are uploaded in
+	std::vector<uint8_t> indexData; // Indices in the type they are uploaded in
+	VertexDequantisation loadedDequantisation;
+	VkIndexType loadedIndexType = VK_INDEX_TYPE_UINT32;
+	std::string error;
+
+	// Created on the main thread when the upload is recorded - replace the targets once the upload has finished
+	VkImage image = VK_NULL_HANDLE;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	VkBuffer newVertexBuffer = VK_NULL_HANDLE;
+	VkBuffer newIndexBuffer = VK_NULL_HANDLE;
+	MeshRange newRange;
+
+	// Bytes copied into the staging ring for this request - none if it shares an asset already uploaded
+	size_t uploadSize() const
+	{
+		if (shared)
+		{
+			return 0;
+		}
+		return isModel ? vertexData.size() + indexData.size() : texture.byteSize();
+	}
+};
+
+// Struct which stores one frame's worth of uploads - every request in it is recorded into the upload context and finished with the ticket of its submission
+struct StreamingUpload
+{
+	uint64_t ticket = UINT64_MAX; // None until it has been submitted
+	std::vector<std::shared_ptr<StreamingJob>> jobs;
+};
+
+// Function which orders the pending requests - the heap keeps the highest priority, then the oldest request, at the front
+static bool isLowerPriority(const std::shared_ptr<StreamingJob> &a, const std::shared_ptr<StreamingJob> &b)
+{
+	if (a->priority != b->priority)
+	{
+		return a->priority < b->priority;
+	}
+	return a->sequence > b->sequence;
+}
+
+// Function which starts decoding the requests made so far on the thread pool - later requests are handed to it as they are made
+void StreamingManager::start()
+{
+	size_t pendingCount = 0;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = false;
+		pendingCount = pendingJobs.size();
+	}
+	started = true;
+	for (size_t i = 0; i < pendingCount; i++)
+	{
+		FrameworkSingleton::getInstance()->threadPool.submit([this]() { decodeNextJob(); });
+	}
+}
+
+// Function which stops decoding and frees everything the streaming manager still holds - requests that have not been swapped in are dropped
+void StreamingManager::stop()
+{
+	// Wait for every request being decoded to finish - pool tasks that have not started yet find nothing left to decode
+	{
+		std::unique_lock<std::mutex> lock(jobMutex);
+		stopping = true;
+		jobCondition.wait(lock, [&]() { return decodingCount == 0; });
+	}
+
+	// Nothing can be freed while the GPU may still be copying into it - an upload that failed part way may not have been submitted yet
+	if (!uploads.empty())
+	{
+		FrameworkSingleton::getInstance()->uploadContext.wait(FrameworkSingleton::getInstance()->uploadContext.submit());
+	}
+	for (auto& upload : uploads)
+	{
+		// The resources of an upload that was never swapped in belong to nobody else
+		for (auto& job : upload->jobs)
+		{
+			FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(job->image);
+			if (job->isModel && !job->shared)
+			{
+				FrameworkSingleton::getInstance()->geometryBuffer.releaseMesh(job->newVertexBuffer, job->newIndexBuffer, job->newRange, job->loadedIndexType);
+			}
+		}
+	}
+	uploads.clear();
+	pendingJobs.clear();
+	decodedJobs.clear();
+	started = false;
+}
+
+// Function which asks for a texture to be loaded - the image, memory and format are replaced, and onLoaded called, on the main thread once it has been uploaded
+// Higher priorities are loaded first
+void StreamingManager::requestTexture(const std::string &texturePath, int priority, VkImage &textureIm, VkFormat &textureFormat, std::function<void()> onLoaded)
+{
+	std::shared_ptr<StreamingJob> job = std::make_shared<StreamingJob>();
+	job->path = texturePath;
+	job->priority = priority;
+	job->onLoaded = onLoaded;
+	job->textureIm = &textureIm;
+	job->textureFormat = &textureFormat;
+	queueJob(job);
+}
+
+// Function which asks for a model to be loaded - the vertices, indices and buffers are replaced, and onLoaded called, on the main thread once it has been uploaded
+// Higher priorities are loaded first
+void StreamingManager::requestModel(const std::string &modelPath, int priority, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods &modelLods, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range, std::function<void()> onLoaded)
+{
+	std::shared_ptr<StreamingJob> job = std::make_shared<StreamingJob>();
+	job->path = modelPath;
+	job->priority = priority;
+	job->isModel = true;
+	job->onLoaded = onLoaded;
+	job->modelVertices = &modelVertices;
+	job->modelIndices = &modelIndices;
+	job->modelLods = &modelLods;
+	job->vertexBuffer = &vertexBuffer;
+	job->dequantisation = &dequantisation;
+	job->indexBuffer = &indexBuffer;
+	job->indexType = &indexType;
+	job->range = &range;
+	queueJob(job);
+}
+
+// Function which hands a request to the thread pool - each request gets a pool task of its own which decodes the highest priority request waiting when it runs
+void StreamingManager::queueJob(std::shared_ptr<StreamingJob> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		job->sequence = requestCount++;
+		pendingJobs.push_back(job);
+		std::push_heap(pendingJobs.begin(), pendingJobs.end(), isLowerPriority);
+	}
+	if (started)
+	{
+		FrameworkSingleton::getInstance()->threadPool.submit([this]() { decodeNextJob(); });
+	}
+}
+
+// Function which each pool task runs - takes the highest priority request, decodes it and hands it back to the main thread, unless the manager has been stopped
+void StreamingManager::decodeNextJob()
+{
+	std::shared_ptr<StreamingJob> job;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		if (stopping || pendingJobs.empty())
+		{
+			return;
+		}
+		std::pop_heap(pendingJobs.begin(), pendingJobs.end(), isLowerPriority);
+		job = pendingJobs.back();
+		pendingJobs.pop_back();
+		decodingCount++;
+	}
+
+	// Errors are reported on the main thread
+	try
+	{
+		// Nothing needs decoding if the asset registry already holds the same contents - the main thread takes a reference to them instead
+		// A model's file is opened once, its mapping hashed for the content key and then parsed. A texture that cannot be opened is left to fail when it is decoded
+		if (job->isModel)
+		{
+			AssetFile sourceFile;
+			if (!FrameworkSingleton::getInstance()->fileSystem.open(job->path, sourceFile))
+			{
+				throw std::runtime_error("failed to open model file!");
+			}
+			job->contentKey = FrameworkSingleton::getInstance()->assetRegistry.contentKey(sourceFile);
+			job->shared = FrameworkSingleton::getInstance()->assetRegistry.contains(job->contentKey, true);
+			if (!job->shared)
+			{
+				decodeModel(*job, sourceFile);
+			}
+		}
+		else if (FrameworkSingleton::getInstance()->assetRegistry.contentKey(job->path, job->contentKey) && FrameworkSingleton::getInstance()->assetRegistry.contains(job->contentKey, false))
+		{
+			job->shared = true;
+		}
+		else
+		{
+			vulkanManager.decodeTexture(job->path, job->texture);
+			job->error = job->texture.error;
+		}
+	}
+	catch (const std::exception &e)
+	{
+		job->error = e.what();
+	}
+
+	std::lock_guard<std::mutex> lock(jobMutex);
+	decodedJobs.push_back(job);
+	decodingCount--;
+	jobCondition.notify_all();
+}
+
+// Function which loads a model and lays out its vertices and indices exactly as createMeshBuffers would upload them
+void StreamingManager::decodeModel(StreamingJob &job, AssetFile &sourceFile)
+{
+	vulkanManager.loadModel(job.path, sourceFile, job.vertices, job.indices, &job.lods);
+	vulkanManager.layoutVertices(job.vertices, job.vertexData, job.loadedDequantisation);
+	vulkanManager.layoutIndices(job.indices, job.indexData, job.loadedIndexType);
+}
+
+// Function which is called once a frame on the main thread before the frame is drawn
+// Swaps in every upload that has finished, then starts uploading the requests the workers have finished with - at most streamingUploadBudget bytes a frame
+// so a frame never stalls on a large copy, but always at least one request so nothing is starved
+void StreamingManager::update()
+{
+	if (!started)
+	{
+		return;
+	}
+
+	// Swap in the uploads whose submission has finished
+	bool swapped = false;
+	for (size_t i = 0; i < uploads.size();)
+	{
+		if (!FrameworkSingleton::getInstance()->uploadContext.finished(uploads[i]->ticket))
+		{
+			i++;
+			continue;
+		}
+
+		// The resources being replaced are still bound by the draw command buffers - make sure the last frame has finished with them
+		// Only the frame is waited for, uploads submitted since carry on
+		if (!swapped)
+		{
+			vulkanManager.waitForFrame();
+			swapped = true;
+		}
+		finishUpload(*uploads[i]);
+		uploads.erase(uploads.begin() + i);
+	}
+
+	// Take decoded requests in the order they finished until the budget for this frame, or the room left in the staging ring, is spent
+	// so recording them does not wait for earlier uploads to free the ring
+	size_t uploadLimit = std::min<size_t>(FrameworkSingleton::getInstance()->streamingUploadBudget, static_cast<size_t>(FrameworkSingleton::getInstance()->stagingRing.available()));
+	std::vector<std::shared_ptr<StreamingJob>> jobs;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		size_t uploadBytes = 0;
+		size_t taken = 0;
+		while (taken < decodedJobs.size() && (taken == 0 || uploadBytes + decodedJobs[taken]->uploadSize() <= uploadLimit))
+		{
+			uploadBytes += decodedJobs[taken]->uploadSize();
+			taken++;
+		}
+		jobs.assign(decodedJobs.begin(), decodedJobs.begin() + taken);
+		decodedJobs.erase(decodedJobs.begin(), decodedJobs.begin() + taken);
+	}
+
+	// A request that could not be loaded stops the application just as it would without streaming
+	// With hot reload it is only reported, so a file saved half edited can be fixed and saved again, and whatever was drawn before stays
+	for (size_t i = 0; i < jobs.size();)
+	{
+		if (jobs[i]->error.empty())
+		{
+			i++;
+			continue;
+		}
+		std::string error = jobs[i]->path + ": " + jobs[i]->error;
+		if (!FrameworkSingleton::getInstance()->useHotReload)
+		{
+			stop();
+			throw std::runtime_error(error);
+		}
+		std::cerr << "Asset not loaded: " + error << std::endl;
+		jobs.erase(jobs.begin() + i);
+	}
+
+	// Requests for contents the asset registry holds take a reference to them instead of uploading and are swapped in straight away
+	// Requests for contents another request is still uploading wait for it so they can share it too
+	std::vector<std::shared_ptr<StreamingJob>> sharedJobs;
+	std::vector<std::shared_ptr<StreamingJob>> waitingJobs;
+	auto isUploading = [&](const StreamingJob &job, size_t jobIndex)
+	{
+		auto sameContents = [&job](const std::shared_ptr<StreamingJob> &other) { return other->isModel == job.isModel && other->contentKey == job.contentKey; };
+		if (std::any_of(jobs.begin(), jobs.begin() + jobIndex, sameContents))
+		{
+			return true;
+		}
+		for (const auto& upload : uploads)
+		{
+			if (std::any_of(upload->jobs.begin(), upload->jobs.end(), sameContents))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	for (size_t i = 0; i < jobs.size();)
+	{
+		StreamingJob &job = *jobs[i];
+		bool acquired = job.isModel
+			? FrameworkSingleton::getInstance()->assetRegistry.acquireModel(job.contentKey, job.indices, job.lods, job.newVertexBuffer, job.loadedDequantisation, job.newIndexBuffer, job.loadedIndexType, job.newRange)
+			: FrameworkSingleton::getInstance()->assetRegistry.acquireTexture(job.contentKey, job.image, job.format);
+		if (acquired)
+		{
+			job.shared = true;
+			sharedJobs.push_back(jobs[i]);
+		}
+		else if (job.shared)
+		{
+			// The asset was released after the worker found it so the file has to be decoded after all
+			job.shared = false;
+			queueJob(jobs[i]);
+		}
+		else if (FrameworkSingleton::getInstance()->shareAssets && isUploading(job, i))
+		{
+			waitingJobs.push_back(jobs[i]);
+		}
+		else
+		{
+			i++;
+			continue;
+		}
+		jobs.erase(jobs.begin() + i);
+	}
+	if (!waitingJobs.empty())
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		decodedJobs.insert(decodedJobs.begin(), waitingJobs.begin(), waitingJobs.end());
+	}
+	if (!sharedJobs.empty())
+	{
+		if (!swapped)
+		{
+			vulkanManager.waitForFrame();
+			swapped = true;
+		}
+		StreamingUpload sharedUpload;
+		sharedUpload.jobs = sharedJobs;
+		finishUpload(sharedUpload);
+	}
+
+	if (!jobs.empty())
+	{
+		beginUpload(jobs);
+	}
+
+	// Descriptor sets and buffers bound by the draw command buffers have changed so record them again
+	if (swapped)
+	{
+		vkFreeCommandBuffers(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->commandPool, static_cast<uint32_t>(FrameworkSingleton::getInstance()->commandBuffers.size()), FrameworkSingleton::getInstance()->commandBuffers.data());
+		vulkanManager.createMeshletIndexBuffers();
+		vulkanManager.createCommandBuffers();
+	}
+}
+
+// Function which copies a batch of decoded requests into the staging ring, records every copy into the upload context and submits them
+// When the ring fills part way the upload context submits what has been recorded so far and recording carries on in a new command buffer
+void StreamingManager::beginUpload(std::vector<std::shared_ptr<StreamingJob>> &jobs)
+{
+	std::shared_ptr<StreamingUpload> upload = std::make_shared<StreamingUpload>();
+	upload->jobs = jobs;
+
+	// Keep the upload even if recording fails part way so everything created so far is freed by stop
+	uploads.push_back(upload);
+
+	VkCommandBuffer commandBuffer = FrameworkSingleton::getInstance()->uploadContext.begin();
+	for (auto& job : jobs)
+	{
+		if (!job->isModel)
+		{
+			vulkanManager.recordTextureUpload(commandBuffer, job->texture, job->image, job->format);
+			continue;
+		}
+
+		// Give the model a range of the geometry buffer, or create device local buffers of its own when it does not fit, and record the copies into them
+		// The rest of the geometry buffer may be drawn from while the copy runs - nothing draws the range until the model is swapped in
+		VkDeviceSize vertexOffset = 0;
+		VkDeviceSize indexOffset = 0;
+		GeometryBuffer &geometryBuffer = FrameworkSingleton::getInstance()->geometryBuffer;
+		if (geometryBuffer.allocate(static_cast<uint32_t>(job->vertices.size()), static_cast<uint32_t>(job->indices.size()), job->loadedIndexType, job->newRange))
+		{
+			job->newVertexBuffer = geometryBuffer.vertexBuffer;
+			job->newIndexBuffer = geometryBuffer.indexBuffer;
+			vertexOffset = geometryBuffer.vertexByteOffset(job->newRange);
+			indexOffset = geometryBuffer.indexByteOffset(job->newRange, job->loadedIndexType);
+		}
+		else
+		{
+			job->newRange = MeshRange();
+			job->newRange.vertexCount = static_cast<uint32_t>(job->vertices.size());
+			job->newRange.indexCount = static_cast<uint32_t>(job->indices.size());
+			vulkanManager.createBuffer(job->vertexData.size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, job->newVertexBuffer);
+			vulkanManager.createBuffer(job->indexData.size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, job->newIndexBuffer);
+		}
+		vulkanManager.recordStagedBufferUpload(commandBuffer, job->vertexData.data(), job->vertexData.size(), job->newVertexBuffer, vertexOffset);
+		vulkanManager.recordStagedBufferUpload(commandBuffer, job->indexData.data(), job->indexData.size(), job->newIndexBuffer, indexOffset);
+		std::vector<uint8_t>().swap(job->vertexData);
+		std::vector<uint8_t>().swap(job->indexData);
+	}
+
+	// Submit without waiting - update checks the ticket on later frames and the frames drawn meanwhile are queued behind the copies
+	upload->ticket = FrameworkSingleton::getInstance()->uploadContext.submit();
+}
+
+// Function which replaces the targets of every request in a finished upload with the resources that were uploaded for it, or that it shares
+// Newly uploaded resources are handed to the asset registry and the old ones released to it, unless they are the placeholders
+void StreamingManager::finishUpload(StreamingUpload &upload)
+{
+	for (auto& job : upload.jobs)
+	{
+		if (job->isModel)
+		{
+			// The placeholder index buffer is only ever bound alongside the placeholder vertex buffer - in the geometry buffer its range tells it apart
+			if (*job->vertexBuffer != FrameworkSingleton::getInstance()->placeholderVertexBuffer || job->range->firstVertex != FrameworkSingleton::getInstance()->placeholderRange.firstVertex)
+			{
+				FrameworkSingleton::getInstance()->assetRegistry.releaseModel(*job->vertexBuffer, *job->indexBuffer, *job->range, *job->indexType);
+			}
+			*job->vertexBuffer = job->newVertexBuffer;
+			*job->indexBuffer = job->newIndexBuffer;
+			*job->dequantisation = job->loadedDequantisation;
+			*job->indexType = job->loadedIndexType;
+			*job->range = job->newRange;
+			job->modelVertices->swap(job->vertices);
+			job->modelIndices->swap(job->indices);
+			std::swap(*job->modelLods, job->lods);
+			if (!job->shared)
+			{
+				FrameworkSingleton::getInstance()->assetRegistry.addModel(job->contentKey, *job->modelIndices, *job->modelLods, *job->vertexBuffer, *job->dequantisation, *job->indexBuffer, *job->indexType, *job->range);
+			}
+			job->newVertexBuffer = VK_NULL_HANDLE;
+			job->newIndexBuffer = VK_NULL_HANDLE;
+		}
+		else
+		{
+			// Textures start out with no image at all - the placeholder is only ever bound through the descriptor sets
+			FrameworkSingleton::getInstance()->assetRegistry.releaseTexture(*job->textureIm);
+			*job->textureIm = job->image;
+			*job->textureFormat = job->format;
+			if (!job->shared)
+			{
+				FrameworkSingleton::getInstance()->assetRegistry.addTexture(job->contentKey, *job->textureIm, *job->textureFormat);
+			}
+			job->image = VK_NULL_HANDLE;
+		}
+
+		// Let the owner create views and update descriptor sets for the new resources
+		if (job->onLoaded)
+		{
+			job->onLoaded();
+		}
+	}
+	upload.jobs.clear();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "VulkanManager.h"
+
+#include <memory>
+
+struct StreamingJob;
+struct StreamingUpload;
+
+// Class which loads textures and models in the background while frames are drawn with placeholders
+// Requests are decoded on the thread pool, highest priority first, then uploaded through the staging ring by the upload context
+// and swapped in once their submission has finished - nothing on the main thread waits for a file to be read
+class StreamingManager
+{
+public:
+	StreamingManager();
+	~StreamingManager();
+
+	VulkanManager vulkanManager;
+
+	void start();
+	void stop();
+	void update();
+	void requestTexture(const std::string &texturePath, int priority, VkImage &textureIm, VkFormat &textureFormat, std::function<void()> onLoaded);
+	void requestModel(const std::string &modelPath, int priority, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods &modelLods, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range, std::function<void()> onLoaded);
+
+private:
+	void queueJob(std::shared_ptr<StreamingJob> job);
+	void decodeNextJob();
+	void decodeModel(StreamingJob &job, AssetFile &sourceFile);
+	void beginUpload(std::vector<std::shared_ptr<StreamingJob>> &jobs);
+	void finishUpload(StreamingUpload &upload);
+
+	// Requests waiting for a worker, kept as a heap with the highest priority at the front
+	std::vector<std::shared_ptr<StreamingJob>> pendingJobs;
+	// Requests the pool tasks have finished with, in the order they finished
+	std::vector<std::shared_ptr<StreamingJob>> decodedJobs;
+	// Uploads that have been submitted and are waiting on their ticket
+	std::vector<std::shared_ptr<StreamingUpload>> uploads;
+	std::mutex jobMutex;
+	// Signalled whenever a pool task finishes a request so stop can wait for those being decoded
+	std::condition_variable jobCondition;
+	size_t decodingCount = 0;
+	bool stopping = false;
+	// Number of requests made so far - requests of equal priority are started in the order they were made
+	uint64_t requestCount = 0;
+	// Whether start has been called - nothing is swapped in before then
+	bool started = false;
+};
@@ -0,0 +1,858 @@
+#include "TerrainManager.h"
+#include "include\STBIMAGE\stb_image.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Vertex.h"
+#include "VirtualFileSystem.h"
+
+#include <cfloat>
+#include <deque>
+
+TerrainManager::TerrainManager()
+{
+}
+
+TerrainManager::~TerrainManager()
+{
+}
+
+// Grid cells along each side of the patch every part of the terrain is drawn with - also the height samples a finest level node covers
+const uint32_t terrainPatchCells = 16;
+// Fraction of the way from one level's range to the next at which a patch starts to morph into the next coarser level
+const float terrainMorphStart = 0.66f;
+
+// Function which builds the terrain, uploads it and creates the pipeline it is drawn with
+void TerrainManager::createTerrain()
+{
+	// Build the heights from the heightmap image when one is set, otherwise from the scenery model
+	bool built;
+	if (!FrameworkSingleton::getInstance()->terrainHeightmapPath.empty())
+	{
+		built = buildHeightsFromImage(FrameworkSingleton::getInstance()->terrainHeightmapPath, FrameworkSingleton::getInstance()->terrainResolution, FrameworkSingleton::getInstance()->terrainSize, FrameworkSingleton::getInstance()->terrainHeightScale);
+	}
+	else
+	{
+		std::vector<Vertex> sceneryVertices;
+		std::vector<uint32_t> sceneryIndices;
+		vulkanManager.loadModel(FrameworkSingleton::getInstance()->modelSceneryPath, sceneryVertices, sceneryIndices);
+		built = buildHeightsFromMesh(sceneryVertices, sceneryIndices, FrameworkSingleton::getInstance()->terrainResolution);
+	}
+	if (!built)
+	{
+		throw std::runtime_error("failed to build terrain heights!");
+	}
+	buildQuadtree(FrameworkSingleton::getInstance()->terrainDetailDistance);
+
+	createHeightImage();
+	createPatchBuffers();
+	createDescriptorSet();
+	createPipeline();
+}
+
+// Function which rounds the resolution up to a power of two no smaller than one patch so the quadtree splits evenly
+static uint32_t terrainResolution(uint32_t resolution)
+{
+	uint32_t rounded = terrainPatchCells;
+	while (rounded < resolution)
+	{
+		rounded *= 2;
+	}
+	return rounded;
+}
+
+// Function which builds the heights by dropping a grid of samples onto a mesh from above - each sample takes the highest triangle under it
+// The grid is square and covers the mesh's footprint, samples no triangle covers take the height of the nearest sample that one does
+bool TerrainManager::buildHeightsFromMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t resolution)
+{
+	if (vertices.empty() || indices.size() < 3)
+	{
+		return false;
+	}
+
+	// Fit the grid over the mesh
+	glm::vec3 minimum = vertices[0].pos;
+	glm::vec3 maximum = vertices[0].pos;
+	for (const auto& vertex : vertices)
+	{
+		minimum = glm::min(minimum, vertex.pos);
+		maximum = glm::max(maximum, vertex.pos);
+	}
+	this->resolution = terrainResolution(resolution);
+	float extent = std::max(maximum.x - minimum.x, maximum.z - minimum.z);
+	if (extent <= 0.0f)
+	{
+		return false;
+	}
+	origin = glm::vec3(minimum.x, 0.0f, minimum.z);
+	sampleSpacing = extent / this->resolution;
+
+	// Rasterise every triangle onto the grid from above
+	uint32_t samples = this->resolution + 1;
+	heights.assign(static_cast<size_t>(samples) * samples, -FLT_MAX);
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		glm::vec3 corners[3];
+		for (int k = 0; k < 3; k++)
+		{
+			const glm::vec3 &position = vertices[indices[i + k]].pos;
+			corners[k] = glm::vec3((position.x - origin.x) / sampleSpacing, position.y, (position.z - origin.z) / sampleSpacing);
+		}
+		float area = (corners[1].x - corners[0].x) * (corners[2].z - corners[0].z) - (corners[2].x - corners[0].x) * (corners[1].z - corners[0].z);
+		if (std::abs(area) < 1e-12f)
+		{
+			continue;
+		}
+
+		// Visit the samples inside the triangle's bounding rectangle
+		int startX = std::max(0, static_cast<int>(std::ceil(std::min(corners[0].x, std::min(corners[1].x, corners[2].x)))));
+		int endX = std::min(static_cast<int>(this->resolution), static_cast<int>(std::floor(std::max(corners[0].x, std::max(corners[1].x, corners[2].x)))));
+		int startY = std::max(0, static_cast<int>(std::ceil(std::min(corners[0].z, std::min(corners[1].z, corners[2].z)))));
+		int endY = std::min(static_cast<int>(this->resolution), static_cast<int>(std::floor(std::max(corners[0].z, std::max(corners[1].z, corners[2].z)))));
+		for (int y = startY; y <= endY; y++)
+		{
+			for (int x = startX; x <= endX; x++)
+			{
+				// Barycentric weights of the sample - a small tolerance keeps samples on shared edges from falling between triangles
+				float w1 = ((x - corners[0].x) * (corners[2].z - corners[0].z) - (corners[2].x - corners[0].x) * (y - corners[0].z)) / area;
+				float w2 = ((corners[1].x - corners[0].x) * (y - corners[0].z) - (x - corners[0].x) * (corners[1].z - corners[0].z)) / area;
+				float w0 = 1.0f - w1 - w2;
+				if (w0 < -1e-4f || w1 < -1e-4f || w2 < -1e-4f)
+				{
+					continue;
+				}
+				float &height = heights[static_cast<size_t>(y) * samples + x];
+				height = std::max(height, w0 * corners[0].y + w1 * corners[1].y + w2 * corners[2].y);
+			}
+		}
+	}
+
+	// Spread the covered samples outwards into any the mesh did not cover
+	std::deque<size_t> filled;
+	for (size_t s = 0; s < heights.size(); s++)
+	{
+		if (heights[s] != -FLT_MAX)
+		{
+			filled.push_back(s);
+		}
+	}
+	if (filled.empty())
+	{
+		return false;
+	}
+	while (!filled.empty())
+	{
+		size_t s = filled.front();
+		filled.pop_front();
+		uint32_t x = static_cast<uint32_t>(s % samples);
+		uint32_t y = static_cast<uint32_t>(s / samples);
+		size_t neighbours[4] = { x > 0 ? s - 1 : s, x + 1 < samples ? s + 1 : s, y > 0 ? s - samples : s, y + 1 < samples ? s + samples : s };
+		for (size_t neighbour : neighbours)
+		{
+			if (heights[neighbour] == -FLT_MAX)
+			{
+				heights[neighbour] = heights[s];
+				filled.push_back(neighbour);
+			}
+		}
+	}
+	return true;
+}
+
+// Function which builds the heights from a greyscale heightmap image centred on the origin - black is height 0 and white is heightScale
+// The image is resampled to the terrain's resolution so it does not need to be a power of two
+bool TerrainManager::buildHeightsFromImage(const std::string &imagePath, uint32_t resolution, float worldSize, float heightScale)
+{
+	// Read the image through the file system so heightmaps can live in the asset pack - 16 bit images keep their full precision
+	AssetFile imageFile;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(imagePath, imageFile) || imageFile.data() == nullptr)
+	{
+		return false;
+	}
+	int imageWidth, imageHeight, imageChannels;
+	stbi_us *pixels = stbi_load_16_from_memory(imageFile.data(), static_cast<int>(imageFile.size()), &imageWidth, &imageHeight, &imageChannels, 1);
+	if (!pixels)
+	{
+		return false;
+	}
+
+	this->resolution = terrainResolution(resolution);
+	origin = glm::vec3(-worldSize * 0.5f, 0.0f, -worldSize * 0.5f);
+	sampleSpacing = worldSize / this->resolution;
+
+	// Sample the image bilinearly at every grid sample
+	uint32_t samples = this->resolution + 1;
+	heights.resize(static_cast<size_t>(samples) * samples);
+	for (uint32_t y = 0; y < samples; y++)
+	{
+		float imageY = static_cast<float>(y) / this->resolution * (imageHeight - 1);
+		int y0 = std::min(static_cast<int>(imageY), imageHeight - 1);
+		int y1 = std::min(y0 + 1, imageHeight - 1);
+		float weightY = imageY - y0;
+		for (uint32_t x = 0; x < samples; x++)
+		{
+			float imageX = static_cast<float>(x) / this->resolution * (imageWidth - 1);
+			int x0 = std::min(static_cast<int>(imageX), imageWidth - 1);
+			int x1 = std::min(x0 + 1, imageWidth - 1);
+			float weightX = imageX - x0;
+			float top = pixels[y0 * imageWidth + x0] + (pixels[y0 * imageWidth + x1] - static_cast<float>(pixels[y0 * imageWidth + x0])) * weightX;
+			float bottom = pixels[y1 * imageWidth + x0] + (pixels[y1 * imageWidth + x1] - static_cast<float>(pixels[y1 * imageWidth + x0])) * weightX;
+			heights[static_cast<size_t>(y) * samples + x] = (top + (bottom - top) * weightY) / 65535.0f * heightScale;
+		}
+	}
+	stbi_image_free(pixels);
+	return true;
+}
+
+// Function which builds the lowest and highest height under every quadtree node and the distance each level of detail is drawn to
+void TerrainManager::buildQuadtree(float detailDistance)
+{
+	// One level for the finest patches, then one more each time the nodes double in size, until a node covers the terrain
+	levelCount = 1;
+	while ((terrainPatchCells << levelCount) <= resolution && levelCount < terrainMaxLevels)
+	{
+		levelCount++;
+	}
+
+	// Finest level nodes read their heights, every level above combines the four nodes below it
+	uint32_t samples = resolution + 1;
+	levelOffsets.assign(levelCount, 0);
+	nodeHeightRanges.clear();
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		uint32_t nodesPerSide = resolution / (terrainPatchCells << level);
+		levelOffsets[level] = nodeHeightRanges.size();
+		for (uint32_t nodeY = 0; nodeY < nodesPerSide; nodeY++)
+		{
+			for (uint32_t nodeX = 0; nodeX < nodesPerSide; nodeX++)
+			{
+				glm::vec2 range(FLT_MAX, -FLT_MAX);
+				if (level == 0)
+				{
+					for (uint32_t y = nodeY * terrainPatchCells; y <= (nodeY + 1) * terrainPatchCells; y++)
+					{
+						for (uint32_t x = nodeX * terrainPatchCells; x <= (nodeX + 1) * terrainPatchCells; x++)
+						{
+							float height = heights[static_cast<size_t>(y) * samples + x];
+							range = glm::vec2(std::min(range.x, height), std::max(range.y, height));
+						}
+					}
+				}
+				else
+				{
+					uint32_t childrenPerSide = nodesPerSide * 2;
+					for (uint32_t child = 0; child < 4; child++)
+					{
+						glm::vec2 childRange = nodeHeightRanges[levelOffsets[level - 1] + (nodeY * 2 + child / 2) * childrenPerSide + nodeX * 2 + child % 2];
+						range = glm::vec2(std::min(range.x, childRange.x), std::max(range.y, childRange.y));
+					}
+				}
+				nodeHeightRanges.push_back(range);
+			}
+		}
+	}
+
+	// A node can reach as far as its diagonal past the range that picked it - the range has to be long enough that all of it has finished morphing
+	// before the next level's morph begins or neighbouring patches of different levels would not line up
+	float shortestRange = detailDistance;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		float nodeSize = sampleSpacing * (terrainPatchCells << level);
+		float tallestNode = 0.0f;
+		for (size_t n = levelOffsets[level]; n < (level + 1 < levelCount ? levelOffsets[level + 1] : nodeHeightRanges.size()); n++)
+		{
+			tallestNode = std::max(tallestNode, nodeHeightRanges[n].y - nodeHeightRanges[n].x);
+		}
+		float diagonal = std::sqrt(2.0f * nodeSize * nodeSize + tallestNode * tallestNode);
+		shortestRange = std::max(shortestRange, diagonal / terrainMorphStart / static_cast<float>(1u << level));
+	}
+
+	// Each level reaches twice as far as the one below and morphs into the next over the end of its range
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		lodRanges[level] = shortestRange * static_cast<float>(1u << level);
+		float previousRange = level > 0 ? lodRanges[level - 1] : 0.0f;
+		morphRanges[level] = glm::vec4(previousRange + (lodRanges[level] - previousRange) * terrainMorphStart, lodRanges[level], 0.0f, 0.0f);
+	}
+	// The coarsest level has nothing to morph into
+	morphRanges[levelCount - 1] = glm::vec4(FLT_MAX * 0.5f, FLT_MAX, 0.0f, 0.0f);
+
+	std::cout << "Terrain built: " << resolution + 1 << "x" << resolution + 1 << " heights, " << levelCount << " levels, finest level drawn to " << lodRanges[0] << std::endl;
+}
+
+// Function which returns the box around a quadtree node in world space
+void TerrainManager::nodeBounds(uint32_t level, uint32_t nodeX, uint32_t nodeY, glm::vec3 &minimum, glm::vec3 &maximum) const
+{
+	uint32_t nodesPerSide = resolution / (terrainPatchCells << level);
+	float nodeSize = sampleSpacing * (terrainPatchCells << level);
+	glm::vec2 range = nodeHeightRanges[levelOffsets[level] + nodeY * nodesPerSide + nodeX];
+	minimum = origin + glm::vec3(nodeX * nodeSize, range.x, nodeY * nodeSize);
+	maximum = origin + glm::vec3((nodeX + 1) * nodeSize, range.y, (nodeY + 1) * nodeSize);
+}
+
+// Function which returns true if any part of a box is within distance of a point
+static bool boxInRange(const glm::vec3 &minimum, const glm::vec3 &maximum, const glm::vec3 &point, float distance)
+{
+	glm::vec3 offset = point - glm::clamp(point, minimum, maximum);
+	return glm::dot(offset, offset) <= distance * distance;
+}
+
+// Function which returns false if a box is entirely outside one of the frustum planes
+static bool boxInFrustum(const glm::vec3 &minimum, const glm::vec3 &maximum, const glm::vec4 *frustumPlanes)
+{
+	for (int p = 0; p < 6; p++)
+	{
+		// Test the corner furthest along the plane's normal
+		glm::vec3 corner(frustumPlanes[p].x >= 0.0f ? maximum.x : minimum.x, frustumPlanes[p].y >= 0.0f ? maximum.y : minimum.y, frustumPlanes[p].z >= 0.0f ? maximum.z : minimum.z);
+		if (glm::dot(glm::vec3(frustumPlanes[p]), corner) + frustumPlanes[p].w < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Function which adds a node, or one quadrant of it when quadrant is 0 to 3, to the patches drawn this frame
+void TerrainManager::addPatch(uint32_t level, uint32_t nodeX, uint32_t nodeY, int quadrant, std::vector<TerrainPatch> &patches) const
+{
+	float nodeSamples = static_cast<float>(terrainPatchCells << level);
+	TerrainPatch patch;
+	patch.node = glm::vec4(nodeX * nodeSamples, nodeY * nodeSamples, static_cast<float>(1u << level), static_cast<float>(level));
+	patch.quadrant = glm::vec4(0.0f, 0.0f, static_cast<float>(terrainPatchCells), static_cast<float>(terrainPatchCells));
+	if (quadrant >= 0)
+	{
+		float half = terrainPatchCells * 0.5f;
+		patch.quadrant = glm::vec4((quadrant % 2) * half, (quadrant / 2) * half, (quadrant % 2 + 1) * half, (quadrant / 2 + 1) * half);
+	}
+	patches.push_back(patch);
+}
+
+// Function which picks the patches to draw in a node - returns false if the node is beyond its level's range and has to be drawn by its parent
+bool TerrainManager::selectNode(uint32_t level, uint32_t nodeX, uint32_t nodeY, const glm::vec3 &cameraPosition, const glm::vec4 *frustumPlanes, std::vector<TerrainPatch> &patches) const
+{
+	glm::vec3 minimum, maximum;
+	nodeBounds(level, nodeX, nodeY, minimum, maximum);
+
+	// The coarsest level is drawn at any distance
+	if (level + 1 < levelCount && !boxInRange(minimum, maximum, cameraPosition, lodRanges[level]))
+	{
+		return false;
+	}
+	// Nodes out of view are dealt with - nothing in them is drawn
+	if (!boxInFrustum(minimum, maximum, frustumPlanes))
+	{
+		return true;
+	}
+	// Draw the whole node at this level if no part of it is close enough for the level below
+	if (level == 0 || !boxInRange(minimum, maximum, cameraPosition, lodRanges[level - 1]))
+	{
+		addPatch(level, nodeX, nodeY, -1, patches);
+		return true;
+	}
+
+	// Otherwise split it - children too far away for the level below are drawn as a quadrant of this node so they still morph with this level
+	for (int child = 0; child < 4; child++)
+	{
+		uint32_t childX = nodeX * 2 + child % 2;
+		uint32_t childY = nodeY * 2 + child / 2;
+		if (!selectNode(level - 1, childX, childY, cameraPosition, frustumPlanes, patches))
+		{
+			glm::vec3 childMinimum, childMaximum;
+			nodeBounds(level - 1, childX, childY, childMinimum, childMaximum);
+			if (boxInFrustum(childMinimum, childMaximum, frustumPlanes))
+			{
+				addPatch(level, nodeX, nodeY, child, patches);
+			}
+		}
+	}
+	return true;
+}
+
+// Function which walks the quadtree and lists the patches to draw from a camera position and view projection matrix
+void TerrainManager::selectPatches(const glm::vec3 &cameraPosition, const glm::mat4 &viewProjection, std::vector<TerrainPatch> &patches) const
+{
+	patches.clear();
+	if (levelCount == 0)
+	{
+		return;
+	}
+
+	// Pull the frustum planes out of the matrix - depth runs from 0 to 1 so the near plane is the third row on its own
+	glm::vec4 rows[4];
+	for (int r = 0; r < 4; r++)
+	{
+		rows[r] = glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+	}
+	glm::vec4 frustumPlanes[6] = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2] };
+
+	// Start from every node of the coarsest level - one unless the terrain is larger than the levels can cover
+	uint32_t topLevel = levelCount - 1;
+	uint32_t nodesPerSide = resolution / (terrainPatchCells << topLevel);
+	for (uint32_t nodeY = 0; nodeY < nodesPerSide; nodeY++)
+	{
+		for (uint32_t nodeX = 0; nodeX < nodesPerSide; nodeX++)
+		{
+			selectNode(topLevel, nodeX, nodeY, cameraPosition, frustumPlanes, patches);
+		}
+	}
+}
+
+// Function which uploads the heights into a float texture the vertex shader reads
+void TerrainManager::createHeightImage()
+{
+	uint32_t samples = resolution + 1;
+
+	// Copy the heights into the image and make it readable by shaders
+	vulkanManager.createImage(samples, samples, 1, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, heightImage);
+	vulkanManager.uploadImage(heights.data(), heightImage, VK_FORMAT_R32_SFLOAT, samples, samples);
+	heightImageView = vulkanManager.createImageView(heightImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 1, FrameworkSingleton::getInstance()->twoDImageView);
+
+	// Float textures do not have to support filtering so the shader reads single samples and blends them itself
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_NEAREST;
+	samplerInfo.minFilter = VK_FILTER_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.anisotropyEnable = VK_FALSE;
+	samplerInfo.maxAnisotropy = 1;
+	samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerInfo.compareEnable = VK_FALSE;
+	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	if (vkCreateSampler(FrameworkSingleton::getInstance()->device, &samplerInfo, nullptr, &heightSampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create terrain height sampler!");
+	}
+}
+
+// Function which creates the grid patch, the buffer of patches drawn each frame, their draw parameters and the terrain uniform buffer
+void TerrainManager::createPatchBuffers()
+{
+	// One vertex per grid corner holding its grid position
+	std::vector<glm::vec2> patchVertices;
+	for (uint32_t y = 0; y <= terrainPatchCells; y++)
+	{
+		for (uint32_t x = 0; x <= terrainPatchCells; x++)
+		{
+			patchVertices.push_back(glm::vec2(static_cast<float>(x), static_cast<float>(y)));
+		}
+	}
+	// Two triangles per cell, wound counter clockwise when seen from above
+	std::vector<uint16_t> patchIndices;
+	for (uint32_t y = 0; y < terrainPatchCells; y++)
+	{
+		for (uint32_t x = 0; x < terrainPatchCells; x++)
+		{
+			uint16_t corner = static_cast<uint16_t>(y * (terrainPatchCells + 1) + x);
+			uint16_t row = static_cast<uint16_t>(terrainPatchCells + 1);
+			patchIndices.insert(patchIndices.end(), { corner, static_cast<uint16_t>(corner + row), static_cast<uint16_t>(corner + 1) });
+			patchIndices.insert(patchIndices.end(), { static_cast<uint16_t>(corner + 1), static_cast<uint16_t>(corner + row), static_cast<uint16_t>(corner + row + 1) });
+		}
+	}
+	patchIndexCount = static_cast<uint32_t>(patchIndices.size());
+	vulkanManager.createDeviceLocalBuffer(patchVertices.data(), sizeof(patchVertices[0]) * patchVertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, patchVertexBuffer);
+	vulkanManager.createDeviceLocalBuffer(patchIndices.data(), sizeof(patchIndices[0]) * patchIndices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, patchIndexBuffer);
+
+	// Every patch drawn covers at least one finest level node so there should never be more patches than those - update grows the buffer if there are
+	uint32_t nodesPerSide = resolution / terrainPatchCells;
+	instanceCapacity = nodesPerSide * nodesPerSide;
+
+	// Each slice of the terrain uniform buffer has to start on the device's alignment to be picked with a dynamic offset
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(FrameworkSingleton::getInstance()->physicalDevice, &properties);
+	VkDeviceSize alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+	terrainUniformSliceSize = (sizeof(TerrainUniformBufferObject) + alignment - 1) / alignment * alignment;
+
+	createFrameBuffers(static_cast<uint32_t>(FrameworkSingleton::getInstance()->swapChainImages.size()));
+}
+
+// Function which creates the patch list, draw parameters and terrain uniform buffer with a slice for each of frameCount swap chain images
+void TerrainManager::createFrameBuffers(uint32_t frameCount)
+{
+	frameSliceCount = std::max(frameCount, 1u);
+	vulkanManager.createBuffer(frameSliceCount * instanceCapacity * sizeof(TerrainPatch), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, instanceBuffer);
+
+	// Nothing is drawn until the first update
+	vulkanManager.createBuffer(frameSliceCount * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, drawBuffer);
+	VkDrawIndexedIndirectCommand draw = {};
+	draw.indexCount = patchIndexCount;
+	for (uint32_t frame = 0; frame < frameSliceCount; frame++)
+	{
+		memcpy(static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(drawBuffer)) + frame * sizeof(draw), &draw, sizeof(draw));
+	}
+
+	vulkanManager.createBuffer(frameSliceCount * terrainUniformSliceSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, terrainUniformBuffer);
+}
+
+// Function which destroys the patch list, draw parameters and terrain uniform buffer
+void TerrainManager::destroyFrameBuffers()
+{
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(instanceBuffer);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(drawBuffer);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(terrainUniformBuffer);
+}
+
+// Function which makes the per frame buffers again when the swap chain has a different number of images - returns true if they were
+// Called with the device idle while the swap chain is recreated, which records the draw command buffers again afterwards
+bool TerrainManager::resize(uint32_t frameCount)
+{
+	if (std::max(frameCount, 1u) == frameSliceCount)
+	{
+		return false;
+	}
+	destroyFrameBuffers();
+	createFrameBuffers(frameCount);
+	updateDescriptorSet();
+	return true;
+}
+
+// Function which creates the terrain's descriptor set layout, pool and set
+// The set holds the usual uniform buffer and colour texture plus the terrain uniform buffer and the heights, both read by the vertex shader
+void TerrainManager::createDescriptorSet()
+{
+	std::array<VkDescriptorSetLayoutBinding, 4> bindings = {};
+	bindings[0].binding = 0;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	bindings[1].binding = 1;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[1].descriptorCount = 1;
+	bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[2].binding = 2;
+	bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	bindings[2].descriptorCount = 1;
+	bindings[2].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	bindings[3].binding = 3;
+	bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[3].descriptorCount = 1;
+	bindings[3].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+	if (vkCreateDescriptorSetLayout(FrameworkSingleton::getInstance()->device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create terrain descriptor set layout!");
+	}
+
+	// The terrain has a pool of its own so the shared pool's sizes do not change when it is turned on
+	std::array<VkDescriptorPoolSize, 2> poolSizes = {};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSizes[0].descriptorCount = 2;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[1].descriptorCount = 2;
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = 1;
+	if (vkCreateDescriptorPool(FrameworkSingleton::getInstance()->device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create terrain descriptor pool!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &descriptorSetLayout;
+	if (vkAllocateDescriptorSets(FrameworkSingleton::getInstance()->device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to allocate terrain descriptor set!");
+	}
+
+	updateDescriptorSet();
+}
+
+// Function which points the terrain's descriptor set at its buffers and textures - called again when the scenery texture has been streamed in
+void TerrainManager::updateDescriptorSet()
+{
+	// The usual uniform buffer object is read out of the uniform arena at the offset recordDraw binds
+	VkDescriptorBufferInfo uniformInfo = {};
+	uniformInfo.buffer = FrameworkSingleton::getInstance()->uniformArena.buffer;
+	uniformInfo.offset = 0;
+	uniformInfo.range = FrameworkSingleton::getInstance()->uniformArena.objectSize(FrameworkSingleton::getInstance()->uniformObject);
+	VkDescriptorImageInfo colourInfo = {};
+	colourInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	colourInfo.imageView = FrameworkSingleton::getInstance()->modelSceneryImageView;
+	colourInfo.sampler = FrameworkSingleton::getInstance()->textureSampler;
+	// So is the terrain uniform buffer, one slice for each swap chain image
+	VkDescriptorBufferInfo terrainInfo = {};
+	terrainInfo.buffer = terrainUniformBuffer;
+	terrainInfo.offset = 0;
+	terrainInfo.range = sizeof(TerrainUniformBufferObject);
+	VkDescriptorImageInfo heightInfo = {};
+	heightInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	heightInfo.imageView = heightImageView;
+	heightInfo.sampler = heightSampler;
+
+	std::array<VkWriteDescriptorSet, 4> descriptorWrites = {};
+	for (uint32_t i = 0; i < descriptorWrites.size(); i++)
+	{
+		descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[i].dstSet = descriptorSet;
+		descriptorWrites[i].dstBinding = i;
+		descriptorWrites[i].dstArrayElement = 0;
+		descriptorWrites[i].descriptorCount = 1;
+	}
+	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorWrites[0].pBufferInfo = &uniformInfo;
+	descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrites[1].pImageInfo = &colourInfo;
+	descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorWrites[2].pBufferInfo = &terrainInfo;
+	descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrites[3].pImageInfo = &heightInfo;
+	vkUpdateDescriptorSets(FrameworkSingleton::getInstance()->device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+// Function which creates the terrain pipeline - the grid patch is read per vertex and the patch list per instance
+// Created again with the swap chain as the viewport is part of it
+void TerrainManager::createPipeline()
+{
+	auto vertShaderCode = vulkanManager.readFile("shaders/terrainVert.spv");
+	auto fragShaderCode = vulkanManager.readFile("shaders/frag.spv");
+	VkShaderModule vertShaderModule = vulkanManager.createShaderModule(vertShaderCode);
+	VkShaderModule fragShaderModule = vulkanManager.createShaderModule(fragShaderCode);
+
+	VkPipelineShaderStageCreateInfo shaderStages[2] = {};
+	shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	shaderStages[0].module = vertShaderModule;
+	shaderStages[0].pName = "main";
+	shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	shaderStages[1].module = fragShaderModule;
+	shaderStages[1].pName = "main";
+
+	// Binding 0 steps once per grid vertex, binding 1 once per patch
+	std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {};
+	bindingDescriptions[0].binding = 0;
+	bindingDescriptions[0].stride = sizeof(glm::vec2);
+	bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	bindingDescriptions[1].binding = 1;
+	bindingDescriptions[1].stride = sizeof(TerrainPatch);
+	bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+	std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
+	attributeDescriptions[0].binding = 0;
+	attributeDescriptions[0].location = 0;
+	attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+	attributeDescriptions[0].offset = 0;
+	attributeDescriptions[1].binding = 1;
+	attributeDescriptions[1].location = 1;
+	attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+	attributeDescriptions[1].offset = offsetof(TerrainPatch, node);
+	attributeDescriptions[2].binding = 1;
+	attributeDescriptions[2].location = 2;
+	attributeDescriptions[2].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+	attributeDescriptions[2].offset = offsetof(TerrainPatch, quadrant);
+	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+	vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+	// The rest of the state matches the default pipeline
+	VkViewport viewport = {};
+	viewport.width = (float)FrameworkSingleton::getInstance()->swapChainExtent.width;
+	viewport.height = (float)FrameworkSingleton::getInstance()->swapChainExtent.height;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	VkRect2D scissor = {};
+	scissor.offset = { 0, 0 };
+	scissor.extent = FrameworkSingleton::getInstance()->swapChainExtent;
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.pViewports = &viewport;
+	viewportState.scissorCount = 1;
+	viewportState.pScissors = &scissor;
+
+	VkPipelineRasterizationStateCreateInfo rasterizer = {};
+	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizer.depthClampEnable = VK_FALSE;
+	rasterizer.rasterizerDiscardEnable = VK_FALSE;
+	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.lineWidth = 1.0f;
+	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizer.depthBiasEnable = VK_FALSE;
+
+	VkPipelineMultisampleStateCreateInfo multisampling = {};
+	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisampling.sampleShadingEnable = VK_FALSE;
+	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = VK_TRUE;
+	depthStencil.depthWriteEnable = VK_TRUE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencil.depthBoundsTestEnable = VK_FALSE;
+	depthStencil.stencilTestEnable = VK_FALSE;
+
+	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.blendEnable = VK_FALSE;
+	VkPipelineColorBlendStateCreateInfo colorBlending = {};
+	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlending.logicOpEnable = VK_FALSE;
+	colorBlending.logicOp = VK_LOGIC_OP_COPY;
+	colorBlending.attachmentCount = 1;
+	colorBlending.pAttachments = &colorBlendAttachment;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+	if (vkCreatePipelineLayout(FrameworkSingleton::getInstance()->device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create terrain pipeline layout!");
+	}
+
+	VkGraphicsPipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = 2;
+	pipelineInfo.pStages = shaderStages;
+	pipelineInfo.pVertexInputState = &vertexInputInfo;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterizer;
+	pipelineInfo.pMultisampleState = &multisampling;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlending;
+	pipelineInfo.layout = pipelineLayout;
+	pipelineInfo.renderPass = FrameworkSingleton::getInstance()->renderPass;
+	pipelineInfo.subpass = 0;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(FrameworkSingleton::getInstance()->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create terrain pipeline!");
+	}
+
+	vkDestroyShaderModule(FrameworkSingleton::getInstance()->device, fragShaderModule, nullptr);
+	vkDestroyShaderModule(FrameworkSingleton::getInstance()->device, vertShaderModule, nullptr);
+}
+
+// Function which builds the terrain pipeline again from its shaders - the old pipeline is kept if the new one cannot be built
+void TerrainManager::reloadPipeline()
+{
+	VkPipeline oldPipeline = pipeline;
+	VkPipelineLayout oldPipelineLayout = pipelineLayout;
+	try
+	{
+		createPipeline();
+	}
+	catch (const std::runtime_error &e)
+	{
+		if (pipelineLayout != oldPipelineLayout)
+		{
+			vkDestroyPipelineLayout(FrameworkSingleton::getInstance()->device, pipelineLayout, nullptr);
+		}
+		pipelineLayout = oldPipelineLayout;
+		pipeline = oldPipeline;
+		std::cerr << std::string("Shader not reloaded: shaders/terrainVert.spv, shaders/frag.spv - ") + e.what() << std::endl;
+		return;
+	}
+	vkDestroyPipeline(FrameworkSingleton::getInstance()->device, oldPipeline, nullptr);
+	vkDestroyPipelineLayout(FrameworkSingleton::getInstance()->device, oldPipelineLayout, nullptr);
+}
+
+// Function which picks this frame's patches from the camera and writes them, their draw parameters and the terrain uniform buffer into the slices for swap chain image frame
+void TerrainManager::update(uint32_t frame)
+{
+	glm::mat4 view, proj;
+	if (FrameworkSingleton::getInstance()->cameraType == 0)
+	{
+		view = FrameworkSingleton::getInstance()->freeCam->get_View();
+		proj = FrameworkSingleton::getInstance()->freeCam->get_Projection();
+	}
+	else
+	{
+		view = FrameworkSingleton::getInstance()->targetCamera->get_View();
+		proj = FrameworkSingleton::getInstance()->targetCamera->get_Projection();
+	}
+	glm::vec3 cameraPosition = glm::vec3(glm::inverse(view)[3]);
+
+	// The terrain is drawn with the default uniform buffer object so its model matrix moves the camera into terrain space
+	glm::mat4 model = vulkanManager.modelMatrix(FrameworkSingleton::getInstance()->uniformObject);
+	glm::vec3 terrainCameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+	selectPatches(terrainCameraPosition, proj * view * model, selectedPatches);
+	uint32_t patchCount = static_cast<uint32_t>(selectedPatches.size());
+
+	// More patches than a slice holds - grow the buffer rather than drop the rest. The draw command buffers bind the old buffer so they are recorded again
+	// The last frame has finished so nothing is reading the old buffer, and every other slice is written again before its image is next drawn
+	if (patchCount > instanceCapacity)
+	{
+		FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(instanceBuffer);
+		instanceCapacity = std::max(patchCount, instanceCapacity * 2);
+		vulkanManager.createBuffer(frameSliceCount * instanceCapacity * sizeof(TerrainPatch), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, instanceBuffer);
+		vkFreeCommandBuffers(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->commandPool, static_cast<uint32_t>(FrameworkSingleton::getInstance()->commandBuffers.size()), FrameworkSingleton::getInstance()->commandBuffers.data());
+		vulkanManager.createCommandBuffers();
+	}
+
+	if (patchCount > 0)
+	{
+		memcpy(static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(instanceBuffer)) + frame * instanceCapacity * sizeof(TerrainPatch), selectedPatches.data(), patchCount * sizeof(TerrainPatch));
+	}
+
+	VkDrawIndexedIndirectCommand draw = {};
+	draw.indexCount = patchIndexCount;
+	draw.instanceCount = patchCount;
+	memcpy(static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(drawBuffer)) + frame * sizeof(draw), &draw, sizeof(draw));
+
+	TerrainUniformBufferObject terrainUbo = {};
+	terrainUbo.cameraPosition = glm::vec4(terrainCameraPosition, 1.0f);
+	terrainUbo.origin = glm::vec4(origin, sampleSpacing);
+	terrainUbo.size = glm::vec4(static_cast<float>(resolution), 0.0f, 0.0f, 0.0f);
+	std::copy(morphRanges, morphRanges + terrainMaxLevels, terrainUbo.morphRanges);
+	memcpy(static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(terrainUniformBuffer)) + frame * terrainUniformSliceSize, &terrainUbo, sizeof(terrainUbo));
+}
+
+// Function which records the terrain draw - one instanced draw of the grid patch whose instance count is written by update every frame
+// frame is the swap chain image the command buffer draws into, which picks the slices of the uniform arena, patch list, draw parameters and terrain uniform buffer it reads
+void TerrainManager::recordDraw(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	VkBuffer vertexBuffers[] = { patchVertexBuffer, instanceBuffer };
+	VkDeviceSize offsets[] = { 0, frame * instanceCapacity * sizeof(TerrainPatch) };
+	vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+	vkCmdBindIndexBuffer(commandBuffer, patchIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	// Dynamic offsets go in binding order - the uniform buffer object then the terrain uniform buffer
+	uint32_t uniformOffsets[] = { FrameworkSingleton::getInstance()->uniformArena.dynamicOffset(frame, FrameworkSingleton::getInstance()->uniformObject), static_cast<uint32_t>(frame * terrainUniformSliceSize) };
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 2, uniformOffsets);
+	vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, frame * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+}
+
+// Function which destroys the pipeline when the swap chain is cleaned up
+void TerrainManager::destroyPipeline()
+{
+	vkDestroyPipeline(FrameworkSingleton::getInstance()->device, pipeline, nullptr);
+	vkDestroyPipelineLayout(FrameworkSingleton::getInstance()->device, pipelineLayout, nullptr);
+	pipeline = VK_NULL_HANDLE;
+	pipelineLayout = VK_NULL_HANDLE;
+}
+
+// Function which destroys everything the terrain created
+void TerrainManager::cleanup()
+{
+	destroyPipeline();
+	vkDestroyDescriptorPool(FrameworkSingleton::getInstance()->device, descriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(FrameworkSingleton::getInstance()->device, descriptorSetLayout, nullptr);
+	vkDestroySampler(FrameworkSingleton::getInstance()->device, heightSampler, nullptr);
+	vkDestroyImageView(FrameworkSingleton::getInstance()->device, heightImageView, nullptr);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(heightImage);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(patchVertexBuffer);
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(patchIndexBuffer);
+	destroyFrameBuffers();
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "VulkanManager.h"
+
+// Most levels of detail the terrain quadtree may have - the terrain vertex shader holds a morph range for each
+const uint32_t terrainMaxLevels = 8;
+
+// Struct which stores one grid patch the quadtree picked to draw this frame - read by the terrain vertex shader once per instance
+struct TerrainPatch
+{
+	glm::vec4 node; // x, y = first height sample the patch covers, z = height samples between its grid vertices, w = level of detail
+	glm::vec4 quadrant; // Part of the grid drawn - x, y = lowest grid vertex, z, w = highest - grid vertices outside it are collapsed onto its edge
+};
+
+// Struct which stores the values the terrain vertex shader needs that are not in the usual uniform buffer
+struct TerrainUniformBufferObject
+{
+	glm::vec4 cameraPosition;
+	glm::vec4 origin; // xyz = world position of the first height sample, w = world units between height samples
+	glm::vec4 size; // x = height samples along each side less one
+	glm::vec4 morphRanges[terrainMaxLevels]; // x = distance a level starts to morph into the next coarser level, y = distance it has fully morphed
+};
+
+// Class which draws the scenery as a heightmap terrain instead of a model
+// The heights live in a float texture and every part of the terrain is drawn with the same small grid patch, displaced in the vertex shader
+// Patches are picked each frame by a continuous distance level of detail (CDLOD) quadtree - nodes near the camera are split into finer patches,
+// nodes outside the view are skipped, and each patch morphs into the next coarser level as it nears the end of its range so levels never pop or crack
+class TerrainManager
+{
+public:
+	TerrainManager();
+	~TerrainManager();
+
+	VulkanManager vulkanManager;
+
+	void createTerrain();
+	void createPipeline();
+	void reloadPipeline();
+	void updateDescriptorSet();
+	bool resize(uint32_t frameCount);
+	void update(uint32_t frame);
+	void recordDraw(VkCommandBuffer commandBuffer, uint32_t frame);
+	void destroyPipeline();
+	void cleanup();
+
+	bool buildHeightsFromMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t resolution);
+	bool buildHeightsFromImage(const std::string &imagePath, uint32_t resolution, float worldSize, float heightScale);
+	void buildQuadtree(float detailDistance);
+	void selectPatches(const glm::vec3 &cameraPosition, const glm::mat4 &viewProjection, std::vector<TerrainPatch> &patches) const;
+
+private:
+	bool selectNode(uint32_t level, uint32_t nodeX, uint32_t nodeY, const glm::vec3 &cameraPosition, const glm::vec4 *frustumPlanes, std::vector<TerrainPatch> &patches) const;
+	void nodeBounds(uint32_t level, uint32_t nodeX, uint32_t nodeY, glm::vec3 &minimum, glm::vec3 &maximum) const;
+	void addPatch(uint32_t level, uint32_t nodeX, uint32_t nodeY, int quadrant, std::vector<TerrainPatch> &patches) const;
+	void createPatchBuffers();
+	void createFrameBuffers(uint32_t frameCount);
+	void destroyFrameBuffers();
+	void createHeightImage();
+	void createDescriptorSet();
+
+	// Height of every sample in world units, row by row - (resolution + 1) samples along each side
+	std::vector<float> heights;
+	uint32_t resolution = 0;
+	glm::vec3 origin = glm::vec3(0.0f);
+	float sampleSpacing = 1.0f;
+
+	// Quadtree levels, finest first - nodes of level 0 are one patch and each level's nodes cover four of the level below
+	uint32_t levelCount = 0;
+	// Lowest and highest height under every node of every level, levels one after another
+	std::vector<glm::vec2> nodeHeightRanges;
+	std::vector<size_t> levelOffsets;
+	// Distance each level is drawn to - each level reaches twice as far as the one below
+	float lodRanges[terrainMaxLevels] = {};
+	glm::vec4 morphRanges[terrainMaxLevels] = {};
+
+	// Vulkan objects - the grid patch, the heights and the per frame patch list and draw parameters
+	// The patch list, draw parameters and terrain uniform buffer have a slice for each swap chain image so a frame never rewrites what the GPU may still be reading for another
+	VkBuffer patchVertexBuffer = VK_NULL_HANDLE;
+	VkBuffer patchIndexBuffer = VK_NULL_HANDLE;
+	uint32_t patchIndexCount = 0;
+	uint32_t frameSliceCount = 0;
+	VkBuffer instanceBuffer = VK_NULL_HANDLE;
+	uint32_t instanceCapacity = 0; // Patches each slice holds
+	VkBuffer drawBuffer = VK_NULL_HANDLE;
+	VkBuffer terrainUniformBuffer = VK_NULL_HANDLE;
+	VkDeviceSize terrainUniformSliceSize = 0; // Rounded up to the device's minimum uniform buffer offset alignment
+	VkImage heightImage = VK_NULL_HANDLE;
+	VkImageView heightImageView = VK_NULL_HANDLE;
+	VkSampler heightSampler = VK_NULL_HANDLE;
+	VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	VkPipeline pipeline = VK_NULL_HANDLE;
+
+	// Patches picked this frame - kept so its storage is reused
+	std::vector<TerrainPatch> selectedPatches;
+};
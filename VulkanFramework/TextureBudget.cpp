@@ -0,0 +1,170 @@
+#include "TextureBudget.h"
+#include "include\STBIMAGE\stb_image.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "MipmapGenerator.h"
+#include "KtxReader.h"
+
+TextureBudget::TextureBudget()
+{
+}
+
+TextureBudget::~TextureBudget()
+{
+}
+
+// Function which works out the device memory a texture of this size takes once it has lost levelsDropped levels - in the format and with the mip chain it will be uploaded with
+// BC1 textures with alpha are stored as BC3 so this can be under by half for them
+VkDeviceSize TextureBudget::textureSize(uint32_t width, uint32_t height, uint32_t levelsDropped)
+{
+	TextureFormat format = TEXTURE_FORMAT_RGBA8;
+	if (FrameworkSingleton::getInstance()->compressTextures && FrameworkSingleton::getInstance()->textureCompressionBCSupported)
+	{
+		format = FrameworkSingleton::getInstance()->textureCompressionFormat;
+	}
+	uint32_t levelCount = FrameworkSingleton::getInstance()->generateMipmaps ? MipmapGenerator::mipLevelCount(width, height) : levelsDropped + 1;
+
+	VkDeviceSize size = 0;
+	for (uint32_t level = levelsDropped; level < levelCount; level++)
+	{
+		size += TextureCompressor::compressedSize(MipmapGenerator::levelExtent(width, level), MipmapGenerator::levelExtent(height, level), format);
+	}
+	return size;
+}
+
+// Function which plans the levels every texture loses and returns the device memory the textures are then expected to take
+// Called before any of them are loaded - textures not in the plan are loaded at the quality tier
+VkDeviceSize TextureBudget::plan(const std::vector<TextureBudgetRequest> &requests)
+{
+	uint32_t tierLevels = static_cast<uint32_t>(FrameworkSingleton::getInstance()->textureQuality);
+	textureNames.clear();
+	droppedLevels.clear();
+	scaledDownRequests.clear();
+
+	// Read the size of every image from its header - a request can lose as many levels as the smallest of its images
+	// Each layer of a KTX file counts as an image, and it can only lose the levels it holds as it is never decoded
+	std::vector<std::vector<uint32_t>> widths(requests.size()), heights(requests.size());
+	std::vector<uint32_t> requestLevels(requests.size(), 0), mostLevels(requests.size(), UINT32_MAX);
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		for (const auto& textureName : requests[i].textureNames)
+		{
+			AssetFile file;
+			int width, height, channels;
+			uint32_t layerCount = 1, levelCount = UINT32_MAX;
+			const uint8_t *data = FrameworkSingleton::getInstance()->fileSystem.open(textureName, file) ? file.data() : nullptr;
+			KtxReader ktxReader;
+			std::string ktxError;
+			if (data && KtxReader::isKtxPath(textureName) && ktxReader.open(data, file.size(), ktxError))
+			{
+				width = static_cast<int>(ktxReader.width);
+				height = static_cast<int>(ktxReader.height);
+				layerCount = ktxReader.layerCount;
+				levelCount = static_cast<uint32_t>(ktxReader.levels.size());
+			}
+			else if (!data || KtxReader::isKtxPath(textureName) || !stbi_info_from_memory(data, static_cast<int>(file.size()), &width, &height, &channels))
+			{
+				// Images that cannot be read are left for the loader to report
+				continue;
+			}
+			for (uint32_t layer = 0; layer < layerCount; layer++)
+			{
+				widths[i].push_back(static_cast<uint32_t>(width));
+				heights[i].push_back(static_cast<uint32_t>(height));
+			}
+			uint32_t levels = 0;
+			while (levels + 1 < levelCount && (std::max(widths[i].back(), heights[i].back()) >> (levels + 1)) >= textureBudgetMinimumExtent)
+			{
+				levels++;
+			}
+			mostLevels[i] = std::min(mostLevels[i], levels);
+		}
+		if (widths[i].empty())
+		{
+			mostLevels[i] = 0;
+		}
+		requestLevels[i] = std::min(tierLevels, mostLevels[i]);
+	}
+	auto requestSize = [&](size_t i, uint32_t levels)
+	{
+		VkDeviceSize size = 0;
+		for (size_t t = 0; t < widths[i].size(); t++)
+		{
+			size += textureSize(widths[i][t], heights[i][t], levels);
+		}
+		return size;
+	};
+
+	// Take levels off the request holding the most memory for its importance until the textures fit
+	VkDeviceSize totalSize = 0;
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		totalSize += requestSize(i, requestLevels[i]);
+	}
+	VkDeviceSize budget = FrameworkSingleton::getInstance()->textureMemoryBudget;
+	while (budget > 0 && totalSize > budget)
+	{
+		size_t reduced = requests.size();
+		double mostSizePerImportance = 0.0;
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			double sizePerImportance = requestSize(i, requestLevels[i]) / std::max(requests[i].importance, 0.001f);
+			if (requestLevels[i] < mostLevels[i] && sizePerImportance > mostSizePerImportance)
+			{
+				reduced = i;
+				mostSizePerImportance = sizePerImportance;
+			}
+		}
+		// Every texture is already as small as it is allowed to be
+		if (reduced == requests.size())
+		{
+			break;
+		}
+		totalSize -= requestSize(reduced, requestLevels[reduced]);
+		requestLevels[reduced]++;
+		totalSize += requestSize(reduced, requestLevels[reduced]);
+	}
+
+	// Store the plan and what was scaled down so the cost of a budget can be reported
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		for (const auto& textureName : requests[i].textureNames)
+		{
+			textureNames.push_back(textureName);
+			droppedLevels.push_back(requestLevels[i]);
+		}
+		if (requestLevels[i] > 0)
+		{
+			scaledDownRequests.push_back(requests[i].textureNames.front() + (requests[i].textureNames.size() > 1 ? " and " + std::to_string(requests[i].textureNames.size() - 1) + " more" : "") + " by " + std::to_string(1u << requestLevels[i]) + "x");
+		}
+	}
+	planned = true;
+	plannedSize = totalSize;
+	plannedBudget = budget;
+	return totalSize;
+}
+
+// Function which writes what the last plan scaled down and the device memory it expected the textures to take
+void TextureBudget::report()
+{
+	if (!planned)
+	{
+		return;
+	}
+	for (const auto& request : scaledDownRequests)
+	{
+		std::cout << "Texture scaled down: " + request + "\n";
+	}
+	std::cout << "Texture memory: " + std::to_string(plannedSize / 1024) + " KB" + (plannedBudget > 0 ? " of a " + std::to_string(plannedBudget / 1024) + " KB budget" : "") + (plannedBudget > 0 && plannedSize > plannedBudget ? " - over budget with every texture at its smallest" : "") + "\n";
+}
+
+// Function which returns the top mip levels a texture loses when it is loaded - safe to call from any thread once the plan is made
+uint32_t TextureBudget::levelsDropped(const std::string &textureName) const
+{
+	auto texture = std::find(textureNames.begin(), textureNames.end(), textureName);
+	if (texture == textureNames.end())
+	{
+		return static_cast<uint32_t>(FrameworkSingleton::getInstance()->textureQuality);
+	}
+	return droppedLevels[texture - textureNames.begin()];
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Texture quality tiers - the number of top mip levels every texture loses, each one halving its width and height
+enum TextureQuality : uint32_t
+{
+	TEXTURE_QUALITY_HIGH = 0, // Native resolution
+	TEXTURE_QUALITY_MEDIUM = 1, // Half resolution - a quarter of the memory
+	TEXTURE_QUALITY_LOW = 2 // Quarter resolution - a sixteenth of the memory
+};
+
+// Textures are never reduced below this many pixels along their longest side
+const uint32_t textureBudgetMinimumExtent = 32;
+
+// Struct which names textures the scene draws and how much their detail matters on screen - textures twice as important give up their detail half as readily
+// Textures named together, such as the faces of a skybox, are always scaled down together so they stay the same size
+struct TextureBudgetRequest
+{
+	std::vector<std::string> textureNames;
+	float importance;
+};
+
+// Class which decides how far each texture is scaled down when it is loaded so the scene's textures fit the quality tier and device memory budget
+// Every texture first loses the levels its quality tier asks for, then while the textures are still over budget the one holding the most memory
+// for its importance loses another level - the sizes are read from the image headers so nothing is decoded to plan
+class TextureBudget
+{
+public:
+	TextureBudget();
+	~TextureBudget();
+
+	VkDeviceSize plan(const std::vector<TextureBudgetRequest> &requests);
+	uint32_t levelsDropped(const std::string &textureName) const;
+	void report();
+
+	static VkDeviceSize textureSize(uint32_t width, uint32_t height, uint32_t levelsDropped);
+
+private:
+	// Planned textures and the levels each loses
+	std::vector<std::string> textureNames;
+	std::vector<uint32_t> droppedLevels;
+	// Requests the last plan scaled down and the memory it expected them to take - written out by report
+	std::vector<std::string> scaledDownRequests;
+	VkDeviceSize plannedSize = 0;
+	VkDeviceSize plannedBudget = 0;
+	bool planned = false;
+};
@@ -0,0 +1,740 @@
+#include "TextureCompressor.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+TextureCompressor::TextureCompressor()
+{
+}
+
+TextureCompressor::~TextureCompressor()
+{
+}
+
+// Number of refinement passes run on the endpoints of each block - each pass refits the endpoints to the chosen indices by least squares
+const int endpointRefinements = 2;
+
+// Function which returns true if any pixel is not fully opaque
+bool TextureCompressor::hasAlpha(const uint8_t *pixels, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		if (pixels[i * 4 + 3] != 255)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Function which returns the number of bytes an image takes in a format
+size_t TextureCompressor::compressedSize(uint32_t width, uint32_t height, TextureFormat format)
+{
+	size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+	switch (format)
+	{
+	case TEXTURE_FORMAT_BC1:
+		return blocks * 8;
+	case TEXTURE_FORMAT_BC3:
+	case TEXTURE_FORMAT_BC7:
+		return blocks * 16;
+	default:
+		return static_cast<size_t>(width) * height * 4;
+	}
+}
+
+// Function which returns the Vulkan format the GPU samples a format as
+VkFormat TextureCompressor::vulkanFormat(TextureFormat format)
+{
+	switch (format)
+	{
+	case TEXTURE_FORMAT_BC1:
+		return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	case TEXTURE_FORMAT_BC3:
+		return VK_FORMAT_BC3_UNORM_BLOCK;
+	case TEXTURE_FORMAT_BC7:
+		return VK_FORMAT_BC7_UNORM_BLOCK;
+	default:
+		return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+// Function which copies a 4x4 block of pixels out of the image - pixels past the right or bottom edge repeat the last row or column
+static void loadBlock(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t block[64])
+{
+	for (uint32_t y = 0; y < 4; y++)
+	{
+		uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+		for (uint32_t x = 0; x < 4; x++)
+		{
+			uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+			memcpy(block + (y * 4 + x) * 4, pixels + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+		}
+	}
+}
+
+// Function which finds the line through a block's colours that best fits them - the principal axis of the first channelCount channels
+static void principalAxis(const uint8_t block[64], int channelCount, float mean[4], float axis[4])
+{
+	for (int c = 0; c < 4; c++)
+	{
+		mean[c] = 0.0f;
+		axis[c] = 0.0f;
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < channelCount; c++)
+		{
+			mean[c] += block[i * 4 + c];
+		}
+	}
+	for (int c = 0; c < channelCount; c++)
+	{
+		mean[c] /= 16.0f;
+	}
+
+	// Covariance of the block's colours
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		float d[4] = {};
+		for (int c = 0; c < channelCount; c++)
+		{
+			d[c] = block[i * 4 + c] - mean[c];
+		}
+		for (int a = 0; a < channelCount; a++)
+		{
+			for (int b = 0; b < channelCount; b++)
+			{
+				covariance[a][b] += d[a] * d[b];
+			}
+		}
+	}
+
+	// Power iteration converges on the eigenvector with the largest eigenvalue - start along the diagonal of the colour cube
+	for (int c = 0; c < channelCount; c++)
+	{
+		axis[c] = 1.0f;
+	}
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {};
+		for (int a = 0; a < channelCount; a++)
+		{
+			for (int b = 0; b < channelCount; b++)
+			{
+				next[a] += covariance[a][b] * axis[b];
+			}
+		}
+		float length = 0.0f;
+		for (int c = 0; c < channelCount; c++)
+		{
+			length = std::max(length, std::fabs(next[c]));
+		}
+		// Flat blocks have no axis - any direction will do
+		if (length < 1e-8f)
+		{
+			return;
+		}
+		for (int c = 0; c < channelCount; c++)
+		{
+			axis[c] = next[c] / length;
+		}
+	}
+}
+
+// Function which places the two endpoints at the extremes of the block's colours along the axis
+static void endpointsAlongAxis(const uint8_t block[64], int channelCount, const float mean[4], const float axis[4], float endpoint0[4], float endpoint1[4])
+{
+	float minimum = 1e30f, maximum = -1e30f;
+	for (int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for (int c = 0; c < channelCount; c++)
+		{
+			t += (block[i * 4 + c] - mean[c]) * axis[c];
+		}
+		minimum = std::min(minimum, t);
+		maximum = std::max(maximum, t);
+	}
+
+	float lengthSquared = 0.0f;
+	for (int c = 0; c < channelCount; c++)
+	{
+		lengthSquared += axis[c] * axis[c];
+	}
+	if (lengthSquared > 0.0f)
+	{
+		minimum /= lengthSquared;
+		maximum /= lengthSquared;
+	}
+
+	for (int c = 0; c < 4; c++)
+	{
+		endpoint0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * maximum));
+		endpoint1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * minimum));
+	}
+}
+
+// Function which refits two endpoints to a set of indices by least squares - weights0 gives how much of endpoint0 each index uses
+// Returns false if the indices do not pin down two different endpoints
+static bool refitEndpoints(const uint8_t block[64], int channelCount, const uint8_t indices[16], const float *weights0, float endpoint0[4], float endpoint1[4])
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[4] = {}, bx[4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		float a = weights0[indices[i]];
+		float b = 1.0f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < channelCount; c++)
+		{
+			ax[c] += a * block[i * 4 + c];
+			bx[c] += b * block[i * 4 + c];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+	if (std::fabs(determinant) < 1e-6f)
+	{
+		return false;
+	}
+	for (int c = 0; c < channelCount; c++)
+	{
+		endpoint0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / determinant));
+		endpoint1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / determinant));
+	}
+	return true;
+}
+
+// Function which converts an 8 bit per channel colour to 5:6:5
+static uint16_t packColour565(const float colour[4])
+{
+	uint16_t r = static_cast<uint16_t>(colour[0] * 31.0f / 255.0f + 0.5f);
+	uint16_t g = static_cast<uint16_t>(colour[1] * 63.0f / 255.0f + 0.5f);
+	uint16_t b = static_cast<uint16_t>(colour[2] * 31.0f / 255.0f + 0.5f);
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+// Function which expands a 5:6:5 colour back to 8 bits per channel the way the GPU does
+static void unpackColour565(uint16_t packed, int colour[3])
+{
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+	colour[0] = (r << 3) | (r >> 2);
+	colour[1] = (g << 2) | (g >> 4);
+	colour[2] = (b << 3) | (b >> 2);
+}
+
+// Function which builds the four colour palette of a BC1 colour block
+static void colourPalette(uint16_t colour0, uint16_t colour1, bool fourColours, int palette[4][3])
+{
+	unpackColour565(colour0, palette[0]);
+	unpackColour565(colour1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		if (fourColours)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		else
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+}
+
+// Function which picks the closest palette entry for every pixel and returns the total squared error
+static int chooseColourIndices(const uint8_t block[64], uint16_t colour0, uint16_t colour1, uint8_t indices[16])
+{
+	int palette[4][3];
+	colourPalette(colour0, colour1, true, palette);
+
+	int totalError = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int bestError = 1 << 30;
+		for (int p = 0; p < 4; p++)
+		{
+			int dr = block[i * 4 + 0] - palette[p][0];
+			int dg = block[i * 4 + 1] - palette[p][1];
+			int db = block[i * 4 + 2] - palette[p][2];
+			int error = dr * dr + dg * dg + db * db;
+			if (error < bestError)
+			{
+				bestError = error;
+				indices[i] = static_cast<uint8_t>(p);
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+// Function which encodes the colour of a block as a BC1 colour block - always in four colour mode so it is also valid inside BC3
+static void encodeColourBlock(const uint8_t block[64], uint8_t *output)
+{
+	// Share of the first endpoint each of the four palette entries uses
+	static const float colourWeights0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	float mean[4], axis[4], endpoint0[4], endpoint1[4];
+	principalAxis(block, 3, mean, axis);
+	endpointsAlongAxis(block, 3, mean, axis, endpoint0, endpoint1);
+
+	uint16_t colour0 = packColour565(endpoint0);
+	uint16_t colour1 = packColour565(endpoint1);
+	uint8_t indices[16];
+	int bestError = chooseColourIndices(block, colour0, colour1, indices);
+
+	// Refit the endpoints to the indices and keep the result whenever it is better
+	for (int refinement = 0; refinement < endpointRefinements; refinement++)
+	{
+		if (!refitEndpoints(block, 3, indices, colourWeights0, endpoint0, endpoint1))
+		{
+			break;
+		}
+		uint16_t refitColour0 = packColour565(endpoint0);
+		uint16_t refitColour1 = packColour565(endpoint1);
+		uint8_t refitIndices[16];
+		int error = chooseColourIndices(block, refitColour0, refitColour1, refitIndices);
+		if (error >= bestError)
+		{
+			break;
+		}
+		bestError = error;
+		colour0 = refitColour0;
+		colour1 = refitColour1;
+		memcpy(indices, refitIndices, sizeof(indices));
+	}
+
+	// Four colour mode needs colour0 greater than colour1 - swap the endpoints and the indices that point at them
+	static const uint8_t swappedIndex[4] = { 1, 0, 3, 2 };
+	if (colour0 < colour1)
+	{
+		std::swap(colour0, colour1);
+		for (int i = 0; i < 16; i++)
+		{
+			indices[i] = swappedIndex[indices[i]];
+		}
+	}
+	// Equal endpoints would be read as three colour mode - only the first entry is the same in both so use it for every pixel
+	else if (colour0 == colour1)
+	{
+		memset(indices, 0, sizeof(indices));
+	}
+
+	uint32_t packedIndices = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		packedIndices |= static_cast<uint32_t>(indices[i]) << (i * 2);
+	}
+	output[0] = static_cast<uint8_t>(colour0 & 0xFF);
+	output[1] = static_cast<uint8_t>(colour0 >> 8);
+	output[2] = static_cast<uint8_t>(colour1 & 0xFF);
+	output[3] = static_cast<uint8_t>(colour1 >> 8);
+	memcpy(output + 4, &packedIndices, 4);
+}
+
+// Function which encodes the alpha of a block as a BC4 block - eight interpolated values between the largest and smallest alpha
+static void encodeAlphaBlock(const uint8_t block[64], uint8_t *output)
+{
+	int alpha0 = 0, alpha1 = 255;
+	for (int i = 0; i < 16; i++)
+	{
+		alpha0 = std::max(alpha0, static_cast<int>(block[i * 4 + 3]));
+		alpha1 = std::min(alpha1, static_cast<int>(block[i * 4 + 3]));
+	}
+
+	uint64_t packedIndices = 0;
+	if (alpha0 != alpha1)
+	{
+		// Eight value mode - alpha0 and alpha1 then six values between them
+		int palette[8] = { alpha0, alpha1 };
+		for (int p = 1; p < 7; p++)
+		{
+			palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			int bestError = 1 << 30;
+			uint64_t bestIndex = 0;
+			for (int p = 0; p < 8; p++)
+			{
+				int error = std::abs(block[i * 4 + 3] - palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = static_cast<uint64_t>(p);
+				}
+			}
+			packedIndices |= bestIndex << (i * 3);
+		}
+	}
+
+	output[0] = static_cast<uint8_t>(alpha0);
+	output[1] = static_cast<uint8_t>(alpha1);
+	for (int b = 0; b < 6; b++)
+	{
+		output[2 + b] = static_cast<uint8_t>(packedIndices >> (b * 8));
+	}
+}
+
+// Interpolation weights for the 4 bit indices of BC7 - out of 64
+static const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Function which quantises a BC7 mode 6 endpoint to 7 bits per channel plus a shared parity bit, picking the parity bit that fits best
+static void quantiseBc7Endpoint(const float endpoint[4], uint8_t quantised[4], uint8_t &parityBit)
+{
+	int bestError = 1 << 30;
+	for (int parity = 0; parity < 2; parity++)
+	{
+		uint8_t candidate[4];
+		int error = 0;
+		for (int c = 0; c < 4; c++)
+		{
+			int value = static_cast<int>((endpoint[c] - parity) / 2.0f + 0.5f);
+			value = std::min(127, std::max(0, value));
+			candidate[c] = static_cast<uint8_t>(value);
+			int difference = ((value << 1) | parity) - static_cast<int>(endpoint[c] + 0.5f);
+			error += difference * difference;
+		}
+		if (error < bestError)
+		{
+			bestError = error;
+			parityBit = static_cast<uint8_t>(parity);
+			memcpy(quantised, candidate, 4);
+		}
+	}
+}
+
+// Function which picks the closest of the 16 interpolated colours for every pixel and returns the total squared error
+static int chooseBc7Indices(const uint8_t block[64], const uint8_t quantised0[4], uint8_t parity0, const uint8_t quantised1[4], uint8_t parity1, uint8_t indices[16])
+{
+	int palette[16][4];
+	for (int c = 0; c < 4; c++)
+	{
+		int e0 = (quantised0[c] << 1) | parity0;
+		int e1 = (quantised1[c] << 1) | parity1;
+		for (int p = 0; p < 16; p++)
+		{
+			palette[p][c] = ((64 - bc7Weights[p]) * e0 + bc7Weights[p] * e1 + 32) >> 6;
+		}
+	}
+
+	int totalError = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int bestError = 1 << 30;
+		for (int p = 0; p < 16; p++)
+		{
+			int error = 0;
+			for (int c = 0; c < 4; c++)
+			{
+				int d = block[i * 4 + c] - palette[p][c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				indices[i] = static_cast<uint8_t>(p);
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+// Struct which writes a 128 bit block a few bits at a time, least significant bit first
+struct BlockBitWriter
+{
+	uint8_t *output;
+	int position;
+
+	void write(uint32_t value, int bitCount)
+	{
+		for (int b = 0; b < bitCount; b++, position++)
+		{
+			if ((value >> b) & 1)
+			{
+				output[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+			}
+		}
+	}
+};
+
+// Function which encodes a block as BC7 mode 6
+static void encodeBc7Block(const uint8_t block[64], uint8_t *output)
+{
+	// Share of the first endpoint each of the 16 interpolated colours uses
+	float bc7Weights0[16];
+	for (int p = 0; p < 16; p++)
+	{
+		bc7Weights0[p] = (64 - bc7Weights[p]) / 64.0f;
+	}
+
+	float mean[4], axis[4], endpoint0[4], endpoint1[4];
+	principalAxis(block, 4, mean, axis);
+	endpointsAlongAxis(block, 4, mean, axis, endpoint0, endpoint1);
+
+	uint8_t quantised0[4], quantised1[4], parity0, parity1;
+	quantiseBc7Endpoint(endpoint0, quantised0, parity0);
+	quantiseBc7Endpoint(endpoint1, quantised1, parity1);
+	uint8_t indices[16];
+	int bestError = chooseBc7Indices(block, quantised0, parity0, quantised1, parity1, indices);
+
+	// Refit the endpoints to the indices and keep the result whenever it is better
+	for (int refinement = 0; refinement < endpointRefinements && bestError > 0; refinement++)
+	{
+		if (!refitEndpoints(block, 4, indices, bc7Weights0, endpoint0, endpoint1))
+		{
+			break;
+		}
+		uint8_t refit0[4], refit1[4], refitParity0, refitParity1, refitIndices[16];
+		quantiseBc7Endpoint(endpoint0, refit0, refitParity0);
+		quantiseBc7Endpoint(endpoint1, refit1, refitParity1);
+		int error = chooseBc7Indices(block, refit0, refitParity0, refit1, refitParity1, refitIndices);
+		if (error >= bestError)
+		{
+			break;
+		}
+		bestError = error;
+		memcpy(quantised0, refit0, 4);
+		memcpy(quantised1, refit1, 4);
+		parity0 = refitParity0;
+		parity1 = refitParity1;
+		memcpy(indices, refitIndices, sizeof(indices));
+	}
+
+	// The first pixel's index is stored with its top bit implied to be zero - swap the endpoints if it is set
+	if (indices[0] >= 8)
+	{
+		uint8_t swapped[4];
+		memcpy(swapped, quantised0, 4);
+		memcpy(quantised0, quantised1, 4);
+		memcpy(quantised1, swapped, 4);
+		std::swap(parity0, parity1);
+		for (int i = 0; i < 16; i++)
+		{
+			indices[i] = static_cast<uint8_t>(15 - indices[i]);
+		}
+	}
+
+	// Mode 6 layout - mode bits, then each channel's two 7 bit endpoints, the two parity bits and the indices
+	memset(output, 0, 16);
+	BlockBitWriter writer = { output, 0 };
+	writer.write(1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		writer.write(quantised0[c], 7);
+		writer.write(quantised1[c], 7);
+	}
+	writer.write(parity0, 1);
+	writer.write(parity1, 1);
+	writer.write(indices[0], 3);
+	for (int i = 1; i < 16; i++)
+	{
+		writer.write(indices[i], 4);
+	}
+}
+
+// Function which compresses an RGBA8 image - rows of blocks are shared out across the thread pool
+void TextureCompressor::compress(const uint8_t *pixels, uint32_t width, uint32_t height, TextureFormat format, std::vector<uint8_t> &blocks)
+{
+	blocks.resize(compressedSize(width, height, format));
+	if (format == TEXTURE_FORMAT_RGBA8)
+	{
+		memcpy(blocks.data(), pixels, blocks.size());
+		return;
+	}
+
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+	size_t blockBytes = format == TEXTURE_FORMAT_BC1 ? 8 : 16;
+
+	// Each thread compresses its own range of block rows straight into its own part of the output
+	auto compressRows = [&](uint32_t firstRow, uint32_t lastRow)
+	{
+		uint8_t block[64];
+		for (uint32_t blockY = firstRow; blockY < lastRow; blockY++)
+		{
+			for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+			{
+				loadBlock(pixels, width, height, blockX, blockY, block);
+				uint8_t *output = blocks.data() + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockBytes;
+				switch (format)
+				{
+				case TEXTURE_FORMAT_BC1:
+					encodeColourBlock(block, output);
+					break;
+				case TEXTURE_FORMAT_BC3:
+					encodeAlphaBlock(block, output);
+					encodeColourBlock(block, output + 8);
+					break;
+				default:
+					encodeBc7Block(block, output);
+					break;
+				}
+			}
+		}
+	};
+
+	// One slice of rows for each pool worker and the calling thread
+	ThreadPool &threadPool = FrameworkSingleton::getInstance()->threadPool;
+	uint32_t sliceCount = std::max(1u, std::min(static_cast<uint32_t>(threadPool.threadCount() + 1), blocksHigh));
+	uint32_t rowsPerSlice = (blocksHigh + sliceCount - 1) / sliceCount;
+	threadPool.parallelFor(sliceCount, [&](size_t slice)
+	{
+		uint32_t firstRow = std::min(blocksHigh, static_cast<uint32_t>(slice) * rowsPerSlice);
+		uint32_t lastRow = std::min(blocksHigh, firstRow + rowsPerSlice);
+		compressRows(firstRow, lastRow);
+	});
+}
+
+// Function which decodes a compressed image back to RGBA8 - BC7 blocks in any mode other than 6 decode as black
+void TextureCompressor::decompress(const uint8_t *blocks, uint32_t width, uint32_t height, TextureFormat format, std::vector<uint8_t> &pixels)
+{
+	pixels.resize(static_cast<size_t>(width) * height * 4);
+	if (format == TEXTURE_FORMAT_RGBA8)
+	{
+		memcpy(pixels.data(), blocks, pixels.size());
+		return;
+	}
+
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+	size_t blockBytes = format == TEXTURE_FORMAT_BC1 ? 8 : 16;
+
+	for (uint32_t blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+		{
+			const uint8_t *input = blocks + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockBytes;
+			uint8_t block[64];
+
+			if (format == TEXTURE_FORMAT_BC7)
+			{
+				memset(block, 0, sizeof(block));
+				if ((input[0] & 0x7F) == (1 << 6))
+				{
+					// Read the block back a bit at a time in the order encodeBc7Block wrote it
+					int position = 7;
+					auto read = [&](int bitCount)
+					{
+						int value = 0;
+						for (int b = 0; b < bitCount; b++, position++)
+						{
+							value |= ((input[position >> 3] >> (position & 7)) & 1) << b;
+						}
+						return value;
+					};
+					int quantised0[4], quantised1[4];
+					for (int c = 0; c < 4; c++)
+					{
+						quantised0[c] = read(7);
+						quantised1[c] = read(7);
+					}
+					int parity0 = read(1);
+					int parity1 = read(1);
+					for (int i = 0; i < 16; i++)
+					{
+						int index = read(i == 0 ? 3 : 4);
+						for (int c = 0; c < 4; c++)
+						{
+							int e0 = (quantised0[c] << 1) | parity0;
+							int e1 = (quantised1[c] << 1) | parity1;
+							block[i * 4 + c] = static_cast<uint8_t>(((64 - bc7Weights[index]) * e0 + bc7Weights[index] * e1 + 32) >> 6);
+						}
+					}
+				}
+			}
+			else
+			{
+				// Colour - BC3 always uses four colour mode, BC1 uses three colours plus black when colour0 is not greater than colour1
+				const uint8_t *colourBlock = format == TEXTURE_FORMAT_BC3 ? input + 8 : input;
+				uint16_t colour0 = static_cast<uint16_t>(colourBlock[0] | (colourBlock[1] << 8));
+				uint16_t colour1 = static_cast<uint16_t>(colourBlock[2] | (colourBlock[3] << 8));
+				uint32_t colourIndices;
+				memcpy(&colourIndices, colourBlock + 4, 4);
+				int palette[4][3];
+				colourPalette(colour0, colour1, format == TEXTURE_FORMAT_BC3 || colour0 > colour1, palette);
+				for (int i = 0; i < 16; i++)
+				{
+					int index = (colourIndices >> (i * 2)) & 3;
+					for (int c = 0; c < 3; c++)
+					{
+						block[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+					}
+					block[i * 4 + 3] = 255;
+				}
+
+				// Alpha
+				if (format == TEXTURE_FORMAT_BC3)
+				{
+					int alpha0 = input[0], alpha1 = input[1];
+					int palette[8] = { alpha0, alpha1 };
+					for (int p = 1; p < 7; p++)
+					{
+						palette[p + 1] = alpha0 > alpha1 ? ((7 - p) * alpha0 + p * alpha1) / 7 : 0;
+					}
+					if (alpha0 <= alpha1)
+					{
+						for (int p = 1; p < 5; p++)
+						{
+							palette[p + 1] = ((5 - p) * alpha0 + p * alpha1) / 5;
+						}
+						palette[6] = 0;
+						palette[7] = 255;
+					}
+					uint64_t alphaIndices = 0;
+					for (int b = 0; b < 6; b++)
+					{
+						alphaIndices |= static_cast<uint64_t>(input[2 + b]) << (b * 8);
+					}
+					for (int i = 0; i < 16; i++)
+					{
+						block[i * 4 + 3] = static_cast<uint8_t>(palette[(alphaIndices >> (i * 3)) & 7]);
+					}
+				}
+			}
+
+			// Write the pixels that are inside the image
+			for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++)
+			{
+				for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++)
+				{
+					memcpy(pixels.data() + ((static_cast<size_t>(blockY) * 4 + y) * width + blockX * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+}
+
+// Function which measures how close a decoded image is to the original - peak signal to noise ratio in decibels, higher is better
+double TextureCompressor::psnr(const uint8_t *original, const uint8_t *decoded, size_t pixelCount, bool includeAlpha)
+{
+	int channelCount = includeAlpha ? 4 : 3;
+	double squaredError = 0.0;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		for (int c = 0; c < channelCount; c++)
+		{
+			double d = static_cast<double>(original[i * 4 + c]) - decoded[i * 4 + c];
+			squaredError += d * d;
+		}
+	}
+
+	// An exact match has no noise at all - report a ceiling rather than infinity
+	double meanSquaredError = squaredError / (static_cast<double>(pixelCount) * channelCount);
+	if (meanSquaredError <= 0.0)
+	{
+		return 100.0;
+	}
+	return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Formats a texture can be stored in on the GPU
+enum TextureFormat : uint32_t
+{
+	TEXTURE_FORMAT_RGBA8 = 0, // Uncompressed - 4 bytes per pixel
+	TEXTURE_FORMAT_BC1 = 1, // 8 bytes per 4x4 block, colour only - textures with alpha are given BC3 instead
+	TEXTURE_FORMAT_BC3 = 2, // 16 bytes per 4x4 block, BC1 colour plus separately compressed alpha
+	TEXTURE_FORMAT_BC7 = 3 // 16 bytes per 4x4 block, the best quality of the three
+};
+
+// Class which block compresses RGBA8 images on the CPU and decodes them again so the quality can be measured
+// BC7 is written as mode 6 only - one subset with 4 bit indices across all four channels
+class TextureCompressor
+{
+public:
+	TextureCompressor();
+	~TextureCompressor();
+
+	void compress(const uint8_t *pixels, uint32_t width, uint32_t height, TextureFormat format, std::vector<uint8_t> &blocks);
+	void decompress(const uint8_t *blocks, uint32_t width, uint32_t height, TextureFormat format, std::vector<uint8_t> &pixels);
+	double psnr(const uint8_t *original, const uint8_t *decoded, size_t pixelCount, bool includeAlpha);
+
+	static bool hasAlpha(const uint8_t *pixels, size_t pixelCount);
+	static size_t compressedSize(uint32_t width, uint32_t height, TextureFormat format);
+	static VkFormat vulkanFormat(TextureFormat format);
+};
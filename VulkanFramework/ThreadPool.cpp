@@ -0,0 +1,168 @@
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+// Set on the pool's own worker threads
+static thread_local bool workerThread = false;
+
+ThreadPool::ThreadPool()
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+// Function which starts the worker threads
+void ThreadPool::start()
+{
+	if (!workers.empty())
+	{
+		return;
+	}
+	stopping = false;
+	unsigned int threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	for (unsigned int t = 0; t < threadCount; t++)
+	{
+		workers.emplace_back(&ThreadPool::runTasks, this);
+	}
+}
+
+// Function which waits for every task already submitted to finish and stops the worker threads
+void ThreadPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(taskMutex);
+		stopping = true;
+	}
+	taskCondition.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	workers.clear();
+}
+
+// Function which hands a task to the next free worker - it is run straight away on the calling thread if the pool has not been started
+void ThreadPool::submit(std::function<void()> task)
+{
+	if (workers.empty())
+	{
+		task();
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(taskMutex);
+		tasks.push_back(std::move(task));
+	}
+	taskCondition.notify_one();
+}
+
+// Function which calls task once for every index below count, shared out across the workers and the calling thread, and returns once every call has
+// The calling thread takes indices too so the loop always finishes even when every worker is busy. Called from a worker the loop runs on it alone
+// The first exception thrown by a call is rethrown once the rest have finished
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &task)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (count == 1 || workers.empty() || workerThread)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	// Shared with the helper tasks, which may only get to run after the loop has finished - by then there is no index left for them to take
+	struct LoopState
+	{
+		std::atomic<size_t> nextIndex;
+		size_t finishedCount = 0;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	std::shared_ptr<LoopState> state = std::make_shared<LoopState>();
+	state->nextIndex = 0;
+	const std::function<void(size_t)> *loopTask = &task;
+	auto runIndices = [state, loopTask, count]()
+	{
+		for (size_t i = state->nextIndex++; i < count; i = state->nextIndex++)
+		{
+			std::exception_ptr error;
+			try
+			{
+				(*loopTask)(i);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if (error && !state->error)
+			{
+				state->error = error;
+			}
+			if (++state->finishedCount == count)
+			{
+				state->finished.notify_all();
+			}
+		}
+	};
+
+	size_t helperCount = std::min(workers.size(), count - 1);
+	for (size_t t = 0; t < helperCount; t++)
+	{
+		submit(runIndices);
+	}
+	runIndices();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&]() { return state->finishedCount == count; });
+	if (state->error)
+	{
+		std::rethrow_exception(state->error);
+	}
+}
+
+// Function which each worker thread runs - takes the oldest task and runs it, until the pool is stopped and no task is left
+void ThreadPool::runTasks()
+{
+	workerThread = true;
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(taskMutex);
+			taskCondition.wait(lock, [&]() { return stopping || !tasks.empty(); });
+			if (tasks.empty())
+			{
+				return;
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		// Tasks report their own errors - one that escapes is printed rather than ending the process from a worker thread
+		try
+		{
+			task();
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << std::string("Thread pool task failed: ") + e.what() << std::endl;
+		}
+		catch (...)
+		{
+			std::cerr << "Thread pool task failed" << std::endl;
+		}
+	}
+}
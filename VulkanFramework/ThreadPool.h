@@ -0,0 +1,35 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+// Class which owns the one set of worker threads every parallel task in the framework is shared out across - one fewer than the hardware can natively
+// support so the thread that asks for work keeps a core. Loops split with parallelFor from a worker run on that worker alone, so work nested inside
+// other work, such as compressing a texture the streaming manager is decoding, never starts more threads than there are cores
+class ThreadPool
+{
+public:
+	ThreadPool();
+	~ThreadPool();
+
+	void start();
+	void stop();
+	void submit(std::function<void()> task);
+	void parallelFor(size_t count, const std::function<void(size_t)> &task);
+	size_t threadCount() const { return workers.size(); }
+
+private:
+	void runTasks();
+
+	// Tasks waiting for a worker, oldest first
+	std::deque<std::function<void()>> tasks;
+	std::mutex taskMutex;
+	std::condition_variable taskCondition;
+	std::vector<std::thread> workers;
+	bool stopping = false;
+};
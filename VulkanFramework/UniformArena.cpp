@@ -0,0 +1,100 @@
+#include "UniformArena.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+
+UniformArena::UniformArena()
+{
+}
+
+UniformArena::~UniformArena()
+{
+}
+
+// Function which creates the arena's buffer with a slice for each of frameCount frames and maps it for as long as it lives
+void UniformArena::create(uint32_t frameCount)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(FrameworkSingleton::getInstance()->physicalDevice, &properties);
+	alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+
+	// Every slice starts on the alignment so an object's offset is aligned in each of them
+	sliceCount = std::max(frameCount, 1u);
+	sliceSize = std::max<VkDeviceSize>(FrameworkSingleton::getInstance()->uniformArenaSliceSize, alignment);
+	sliceSize = (sliceSize + alignment - 1) / alignment * alignment;
+	FrameworkSingleton::getInstance()->vulkanManager.createBuffer(sliceSize * sliceCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer);
+	mapped = static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(buffer));
+	usedSize = 0;
+	objectSizes.clear();
+}
+
+// Function which makes sure the arena has a slice for each of frameCount frames, for when the swap chain is made again with more images - returns true if
+// the buffer had to be made again, in which case every descriptor set reading it has to be pointed at the new one. Objects keep their offsets and are
+// written again before the next draw reads them. Only called once the device is idle
+bool UniformArena::resize(uint32_t frameCount)
+{
+	if (frameCount <= sliceCount)
+	{
+		return false;
+	}
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(buffer);
+	sliceCount = frameCount;
+	FrameworkSingleton::getInstance()->vulkanManager.createBuffer(sliceSize * sliceCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer);
+	mapped = static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(buffer));
+	return true;
+}
+
+// Function which gives an object size bytes in every slice and returns its offset within a slice - if the slices are full throw an error
+uint32_t UniformArena::allocate(VkDeviceSize size)
+{
+	VkDeviceSize alignedSize = (size + alignment - 1) / alignment * alignment;
+	if (usedSize + alignedSize > sliceSize)
+	{
+		throw std::runtime_error("failed to allocate uniform object - the uniform arena is full!");
+	}
+	uint32_t object = static_cast<uint32_t>(usedSize);
+	usedSize += alignedSize;
+	objectSizes[object] = size;
+	return object;
+}
+
+// Function which returns the dynamic offset a draw binds to read an object's data for the frame drawn into swap chain image frame
+uint32_t UniformArena::dynamicOffset(uint32_t frame, uint32_t object) const
+{
+	return static_cast<uint32_t>((frame % sliceCount) * sliceSize + object);
+}
+
+// Function which returns the size an object was given - the range its descriptors cover
+VkDeviceSize UniformArena::objectSize(uint32_t object) const
+{
+	auto found = objectSizes.find(object);
+	return found != objectSizes.end() ? found->second : 0;
+}
+
+// Function which writes an object's data for the frame drawn into swap chain image frame - nothing else reads that slice until the frame is submitted
+void UniformArena::write(uint32_t frame, uint32_t object, const void *data, VkDeviceSize size)
+{
+	memcpy(mapped + dynamicOffset(frame, object), data, static_cast<size_t>(size));
+}
+
+// Function which writes how many objects the arena holds and how much of it they use
+void UniformArena::report()
+{
+	if (buffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	std::cout << "Uniform arena: " + std::to_string(objectSizes.size()) + " objects using " + std::to_string(usedSize) + " bytes of a " + std::to_string(sliceSize / 1024) + " KB slice for each of "
+		+ std::to_string(sliceCount) + " frames, aligned to " + std::to_string(alignment) + " bytes\n";
+}
+
+// Function which destroys the arena's buffer - once the device is idle on close
+void UniformArena::cleanup()
+{
+	if (buffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(buffer);
+	buffer = VK_NULL_HANDLE;
+	mapped = nullptr;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <map>
+#include <cstdint>
+
+// Class which owns the one host visible buffer every object's uniform data is written into - mapped once when it is created
+// The buffer is split into a slice for each swap chain image and every object is given the same offset in each slice, a multiple of the device's
+// minimum uniform buffer offset alignment. Draws bind one descriptor set and pick their object and frame with a dynamic offset, so a frame never
+// writes data the GPU may still be reading for another. Only used from the main thread
+class UniformArena
+{
+public:
+	UniformArena();
+	~UniformArena();
+
+	void create(uint32_t frameCount);
+	bool resize(uint32_t frameCount);
+	uint32_t allocate(VkDeviceSize size);
+	uint32_t dynamicOffset(uint32_t frame, uint32_t object) const;
+	VkDeviceSize objectSize(uint32_t object) const;
+	void write(uint32_t frame, uint32_t object, const void *data, VkDeviceSize size);
+	void report();
+	void cleanup();
+
+	VkBuffer buffer = VK_NULL_HANDLE;
+
+private:
+	uint8_t *mapped = nullptr;
+	VkDeviceSize alignment = 0;
+	VkDeviceSize sliceSize = 0;
+	uint32_t sliceCount = 0;
+	// Bytes of each slice handed out so far and the size each object asked for, by its offset
+	VkDeviceSize usedSize = 0;
+	std::map<uint32_t, VkDeviceSize> objectSizes;
+};
@@ -0,0 +1,187 @@
+#include "UploadContext.h"
+
+#include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+
+UploadContext::UploadContext()
+{
+}
+
+UploadContext::~UploadContext()
+{
+}
+
+// Function which creates the pool the upload command buffers are recorded from - kept apart from the draw command buffers
+void UploadContext::create()
+{
+	FrameworkSingleton::getInstance()->vulkanManager.createCommandPool(commandPool, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	submittedTicket = 0;
+	finishedTicket = 0;
+}
+
+// Function which returns the command buffer uploads are being recorded into - a finished one is begun again, or a new one allocated, if nothing has been recorded yet
+VkCommandBuffer UploadContext::begin()
+{
+	if (recording != VK_NULL_HANDLE)
+	{
+		return recording;
+	}
+
+	retireFinished();
+	if (freeCommandBuffers.empty())
+	{
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = commandPool;
+		allocInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(FrameworkSingleton::getInstance()->device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate upload command buffer!");
+		}
+		freeCommandBuffers.push_back(commandBuffer);
+		commandBufferCount++;
+	}
+	recording = freeCommandBuffers.back();
+	freeCommandBuffers.pop_back();
+
+	// Beginning the command buffer resets whatever it held the last time it was submitted
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(recording, &beginInfo);
+	return recording;
+}
+
+// Function which submits everything recorded since the last submission with a fence and returns its ticket - the last submission's ticket if nothing has been recorded
+// Nothing waits here - the staging ring is told which fence frees the regions the submission reads
+uint64_t UploadContext::submit()
+{
+	if (recording == VK_NULL_HANDLE)
+	{
+		return submittedTicket;
+	}
+
+	// Make the buffer copies visible to every later draw that reads them - images are handed to the shaders by their own layout transitions
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	if (vkEndCommandBuffer(recording) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to record upload command buffer!");
+	}
+
+	UploadSubmission submission;
+	submission.commandBuffer = recording;
+	recording = VK_NULL_HANDLE;
+	if (freeFences.empty())
+	{
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VkFence fence;
+		if (vkCreateFence(FrameworkSingleton::getInstance()->device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create upload fence!");
+		}
+		freeFences.push_back(fence);
+	}
+	submission.fence = freeFences.back();
+	freeFences.pop_back();
+
+	// Uploads go to the graphics queue - the layout transitions and mipmap blits recorded alongside the copies need it, and sharing it with the frames
+	// means each frame is ordered after every upload submitted before it without any semaphore
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &submission.commandBuffer;
+	if (vkQueueSubmit(FrameworkSingleton::getInstance()->graphicsQueue, 1, &submitInfo, submission.fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to submit uploads!");
+	}
+	FrameworkSingleton::getInstance()->stagingRing.submitted(submission.fence);
+
+	submission.ticket = ++submittedTicket;
+	submissions.push_back(submission);
+	return submission.ticket;
+}
+
+// Function which submits what has been recorded so far and hands back the command buffer to carry on recording into - used when the staging ring fills part way
+void UploadContext::flush(VkCommandBuffer &commandBuffer)
+{
+	submit();
+	commandBuffer = begin();
+}
+
+// Function which checks, without waiting, whether the submission with this ticket and every one before it have finished
+bool UploadContext::finished(uint64_t ticket)
+{
+	retireFinished();
+	return ticket <= finishedTicket;
+}
+
+// Function which waits for the submission with this ticket and every one before it to finish
+void UploadContext::wait(uint64_t ticket)
+{
+	retireFinished();
+	while (finishedTicket < ticket && !submissions.empty())
+	{
+		vkWaitForFences(FrameworkSingleton::getInstance()->device, 1, &submissions.front().fence, VK_TRUE, UINT64_MAX);
+		waitCount++;
+		retire();
+	}
+}
+
+// Function which retires the oldest submissions, in order, for as long as their fences have signalled
+void UploadContext::retireFinished()
+{
+	while (!submissions.empty() && vkGetFenceStatus(FrameworkSingleton::getInstance()->device, submissions.front().fence) == VK_SUCCESS)
+	{
+		retire();
+	}
+}
+
+// Function which retires the oldest submission once its fence has signalled - the staging regions it read are given back and its command buffer and fence kept to use again
+void UploadContext::retire()
+{
+	UploadSubmission &submission = submissions.front();
+	FrameworkSingleton::getInstance()->stagingRing.release(submission.fence);
+	vkResetFences(FrameworkSingleton::getInstance()->device, 1, &submission.fence);
+	freeFences.push_back(submission.fence);
+	freeCommandBuffers.push_back(submission.commandBuffer);
+	finishedTicket = submission.ticket;
+	submissions.pop_front();
+}
+
+// Function which writes how many submissions the uploads were batched into and how often the main thread waited for one
+void UploadContext::report()
+{
+	if (commandPool == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	std::cout << "Upload context: " + std::to_string(submittedTicket) + " submissions recorded into " + std::to_string(commandBufferCount) + " command buffers, "
+		+ std::to_string(waitCount) + " waits for an upload to finish\n";
+}
+
+// Function which waits for every submission and destroys the fences and command pool - anything recorded but never submitted is dropped
+void UploadContext::cleanup()
+{
+	if (commandPool == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	wait(submittedTicket);
+	for (auto fence : freeFences)
+	{
+		vkDestroyFence(FrameworkSingleton::getInstance()->device, fence, nullptr);
+	}
+	freeFences.clear();
+	freeCommandBuffers.clear();
+	recording = VK_NULL_HANDLE;
+
+	// Destroying the pool frees every command buffer allocated from it
+	vkDestroyCommandPool(FrameworkSingleton::getInstance()->device, commandPool, nullptr);
+	commandPool = VK_NULL_HANDLE;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+
+// Struct which stores one submission of recorded uploads - the ticket it was given, its command buffer and the fence it signals
+struct UploadSubmission
+{
+	uint64_t ticket = 0;
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;
+};
+
+// Class which records copies and layout transitions into one command buffer and submits them together, with a fence, when they are first needed
+// Each submission is given a ticket counting up from one - a ticket has finished once its submission and every one before it has, so whoever
+// needs an upload on the CPU waits for its ticket and the frames simply submit what has been recorded ahead of their draws. Only used from the main thread
+class UploadContext
+{
+public:
+	UploadContext();
+	~UploadContext();
+
+	void create();
+	VkCommandBuffer begin();
+	uint64_t submit();
+	void flush(VkCommandBuffer &commandBuffer);
+	bool finished(uint64_t ticket);
+	void wait(uint64_t ticket);
+	void report();
+	void cleanup();
+
+private:
+	void retireFinished();
+	void retire();
+
+	// Command buffers are reset when they are begun again so the pool lets them be reset one at a time
+	VkCommandPool commandPool = VK_NULL_HANDLE;
+	// Command buffer being recorded into, if anything has been recorded since the last submission
+	VkCommandBuffer recording = VK_NULL_HANDLE;
+	// Submissions the GPU may still be working on, oldest first, and the command buffers and fences of finished ones ready to be used again
+	std::deque<UploadSubmission> submissions;
+	std::vector<VkCommandBuffer> freeCommandBuffers;
+	std::vector<VkFence> freeFences;
+	// Ticket of the last submission and of the last one known to have finished
+	uint64_t submittedTicket = 0;
+	uint64_t finishedTicket = 0;
+	// Command buffers allocated and how often the main thread waited for an upload to finish
+	uint32_t commandBufferCount = 0;
+	uint32_t waitCount = 0;
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+// Include the Vulkan SDK giving access to functions, structures and enumerations
+#include <vulkan/vulkan.h>
+
+// Include GLM
+#include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Struct called vertex which stores the information for the vertex shader
+struct Vertex
+{
+	glm::vec3 pos;
+	glm::vec3 color;
+	glm::vec2 texCoord;
+
+	// Tell Vulkan how to pass this data format to the vertex shader - bind the information
+	static VkVertexInputBindingDescription getBindingDescription()
+	{
+		// Struct which contains information regarding how the data is sumbitted to the GPU and vertex shader
+		VkVertexInputBindingDescription bindingDescription = {};
+		bindingDescription.binding = 0; // Specifies the index of the binding in the array of bindings
+		bindingDescription.stride = sizeof(Vertex); // Specifies the number of bytes from one entry to the next
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Specifies the move to the next data entry after each vertex
+
+		return bindingDescription;
+	}
+
+	// Tell Vulkan the attribute description 
+	static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
+	{
+		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
+
+		// Two different attribute description, one for position
+		attributeDescriptions[0].binding = 0; // Binding parameter specifies from which binding the per-vertex data comes
+		attributeDescriptions[0].location = 0; // References the location directive of the input in the vertex shader.
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT; // Describes the type of data for the attribute - vec3
+		attributeDescriptions[0].offset = offsetof(Vertex, pos);
+		// The other for colour 
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT; // vec3
+		attributeDescriptions[1].offset = offsetof(Vertex, color);
+		// The other for the texture coordinates
+		attributeDescriptions[2].binding = 0;
+		attributeDescriptions[2].location = 2;
+		attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT; // Vec2
+		attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
+
+		return attributeDescriptions;
+	}
+
+	// Helper function used as part of the model loader to set the vertex information - Comment out when not using models
+	bool operator==(const Vertex& other) const
+	{
+		return pos == other.pos && color == other.color && texCoord == other.texCoord;
+	}
+};
+
+namespace std //- Comment out when not using models
+{
+	template<> struct hash<Vertex>
+	{
+		size_t operator()(Vertex const& vertex) const
+		{
+			return ((hash<glm::vec3>()(vertex.pos) ^
+				(hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
+				(hash<glm::vec2>()(vertex.texCoord) << 1);
+		}
+	};
+}
+
+// Struct which stores the transform that turns a packed vertex position back into a model space position - pushed to the vertex shader for each mesh
+struct VertexDequantisation
+{
+	glm::vec4 offset; // Minimum corner of the mesh's bounding box
+	glm::vec4 scale; // Size of the mesh's bounding box
+};
+
+// Struct which stores a vertex in the packed layout - 12 bytes instead of the 32 bytes of Vertex
+// Positions are 16 bit unsigned normalised values inside the mesh's bounding box, texture coordinates are half floats and there is no colour
+struct PackedVertex
+{
+	uint16_t pos[4]; // x, y and z then padding so the attribute stays four byte aligned
+	uint32_t texCoord; // Two half floats
+
+	// Tell Vulkan how to pass this data format to the vertex shader - bind the information
+	static VkVertexInputBindingDescription getBindingDescription()
+	{
+		VkVertexInputBindingDescription bindingDescription = {};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof(PackedVertex);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	// Tell Vulkan the attribute description - the vertex shader reads the position as a vec4 between 0 and 1 and the texture coordinates as a vec2
+	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions()
+	{
+		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions = {};
+
+		// Position
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM; // Three component 16 bit formats are not widely supported for vertex input
+		attributeDescriptions[0].offset = offsetof(PackedVertex, pos);
+		// Texture coordinates
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(PackedVertex, texCoord);
+
+		return attributeDescriptions;
+	}
+};
+
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must stay tightly packed");
+
+// Function which packs vertices into the packed layout and works out the transform that unpacks their positions
+inline void packVertices(const std::vector<Vertex> &vertices, std::vector<PackedVertex> &packedVertices, VertexDequantisation &dequantisation)
+{
+	// Find the bounding box of the mesh - positions are stored relative to it
+	glm::vec3 minimum(0.0f), maximum(0.0f);
+	if (!vertices.empty())
+	{
+		minimum = maximum = vertices[0].pos;
+	}
+	for (const auto& vertex : vertices)
+	{
+		minimum = glm::min(minimum, vertex.pos);
+		maximum = glm::max(maximum, vertex.pos);
+	}
+
+	// Flat axes still get a non zero scale so nothing is divided by zero
+	glm::vec3 scale = glm::max(maximum - minimum, glm::vec3(1e-20f));
+	dequantisation.offset = glm::vec4(minimum, 0.0f);
+	dequantisation.scale = glm::vec4(scale, 1.0f);
+
+	packedVertices.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		glm::vec3 normalised = glm::clamp((vertices[i].pos - minimum) / scale, 0.0f, 1.0f);
+		packedVertices[i].pos[0] = static_cast<uint16_t>(normalised.x * 65535.0f + 0.5f);
+		packedVertices[i].pos[1] = static_cast<uint16_t>(normalised.y * 65535.0f + 0.5f);
+		packedVertices[i].pos[2] = static_cast<uint16_t>(normalised.z * 65535.0f + 0.5f);
+		packedVertices[i].pos[3] = 0;
+		packedVertices[i].texCoord = glm::packHalf2x16(vertices[i].texCoord);
+	}
+}
@@ -0,0 +1,64 @@
+#include "VertexHashTable.h"
+
+VertexHashTable::VertexHashTable()
+{
+}
+
+VertexHashTable::~VertexHashTable()
+{
+}
+
+// Function which sizes the table from the number of indices in a mesh
+// Most meshes share each vertex between about six triangles so a quarter of the index count is a generous guess at the unique vertex count
+// The table grows if the guess is wrong so this only has to be close, not exact
+void VertexHashTable::reserveForIndexCount(size_t indexCount)
+{
+	size_t expectedVertices = indexCount / 4 + 16;
+	size_t wanted = 16;
+	while (wanted * 7 < expectedVertices * 10)
+	{
+		wanted *= 2;
+	}
+
+	// The table can only grow here - shrinking would need a rehash
+	if (wanted > slots.size() && count == 0)
+	{
+		slots.assign(wanted, Slot{ emptySlot, 0 });
+		mask = wanted - 1;
+	}
+}
+
+// Function which empties the table but keeps its memory
+void VertexHashTable::clear()
+{
+	for (auto& slot : slots)
+	{
+		slot.index = emptySlot;
+	}
+	count = 0;
+}
+
+// Function which doubles the table size and reinserts every vertex - the hashes are recomputed from the vertex array
+void VertexHashTable::grow(const std::vector<Vertex> &vertices)
+{
+	size_t newSize = slots.empty() ? 16 : slots.size() * 2;
+	std::vector<Slot> oldSlots(newSize, Slot{ emptySlot, 0 });
+	oldSlots.swap(slots);
+	mask = newSize - 1;
+
+	for (const auto& oldSlot : oldSlots)
+	{
+		if (oldSlot.index == emptySlot)
+		{
+			continue;
+		}
+
+		uint64_t hash = hashVertex(vertices[oldSlot.index]);
+		size_t i = static_cast<size_t>(hash) & mask;
+		while (slots[i].index != emptySlot)
+		{
+			i = (i + 1) & mask;
+		}
+		slots[i] = oldSlot;
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Vertex.h"
+#include "Hash.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+// Flat open addressing hash table which maps unique vertices to their index in a vertex array
+// Slots only hold the vertex index and part of its hash so the whole table stays small and cache friendly - the vertices themselves stay in the array
+class VertexHashTable
+{
+public:
+	VertexHashTable();
+	~VertexHashTable();
+
+	// Size the table for a mesh with this many indices so it rarely has to grow while loading
+	void reserveForIndexCount(size_t indexCount);
+	void clear();
+	size_t size() const { return count; }
+	size_t capacity() const { return slots.size(); }
+
+	// Returns the index of the vertex in vertices - if the vertex is not there yet it is appended and the new index returned
+	inline uint32_t findOrInsert(const Vertex &vertex, std::vector<Vertex> &vertices);
+
+	// 64 bit hash of the exact bits of the vertex
+	static uint64_t hashVertex(const Vertex &vertex) { return murmurHash64(&vertex, sizeof(Vertex)); }
+	// Vertices match only if every bit matches
+	static bool sameVertex(const Vertex &a, const Vertex &b) { return memcmp(&a, &b, sizeof(Vertex)) == 0; }
+
+private:
+	// Slot marker for an empty slot
+	static const uint32_t emptySlot = 0xFFFFFFFFu;
+
+	struct Slot
+	{
+		uint32_t index; // Index of the vertex in the vertex array or emptySlot
+		uint32_t hashTag; // Top 32 bits of the hash - checked before the vertex itself is compared
+	};
+
+	void grow(const std::vector<Vertex> &vertices);
+
+	std::vector<Slot> slots;
+	size_t mask = 0;
+	size_t count = 0;
+};
+
+// The key is compared as raw bytes so the vertex must not contain padding
+static_assert(sizeof(Vertex) == sizeof(float) * 8, "Vertex must not contain padding");
+
+inline uint32_t VertexHashTable::findOrInsert(const Vertex &vertex, std::vector<Vertex> &vertices)
+{
+	// Keep the table at most 70% full so probe sequences stay short
+	if ((count + 1) * 10 > slots.size() * 7)
+	{
+		grow(vertices);
+	}
+
+	uint64_t hash = hashVertex(vertex);
+	uint32_t hashTag = static_cast<uint32_t>(hash >> 32);
+
+	// Linear probing from the home slot until the vertex or an empty slot is found
+	for (size_t i = static_cast<size_t>(hash) & mask;; i = (i + 1) & mask)
+	{
+		Slot &slot = slots[i];
+		if (slot.index == emptySlot)
+		{
+			slot.index = static_cast<uint32_t>(vertices.size());
+			slot.hashTag = hashTag;
+			vertices.push_back(vertex);
+			count++;
+			return slot.index;
+		}
+		if (slot.hashTag == hashTag && sameVertex(vertices[slot.index], vertex))
+		{
+			return slot.index;
+		}
+	}
+}
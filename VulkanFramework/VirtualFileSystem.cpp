@@ -0,0 +1,103 @@
+#include "VirtualFileSystem.h"
+#include "Hash.h"
+#include "Lz4.h"
+
+AssetFile::AssetFile()
+{
+}
+
+AssetFile::~AssetFile()
+{
+}
+
+// Function which closes the file and frees anything it decompressed
+void AssetFile::close()
+{
+	looseFile.close();
+	std::vector<uint8_t>().swap(decompressed);
+	opened = false;
+	pack = nullptr;
+	entry = nullptr;
+	fileData = nullptr;
+	fileSize = 0;
+	fileHash = 0;
+	hashed = false;
+}
+
+// Function which returns the contents of the file - returns nullptr if a compressed entry turns out to be corrupt
+const uint8_t* AssetFile::data()
+{
+	if (fileData == nullptr && entry != nullptr && (entry->flags & ASSET_PACK_ENTRY_LZ4) != 0)
+	{
+		decompressed.resize(fileSize);
+		if (!lz4Decompress(pack->entryData(*entry), static_cast<size_t>(entry->storedSize), decompressed.data(), fileSize))
+		{
+			std::vector<uint8_t>().swap(decompressed);
+			return nullptr;
+		}
+		fileData = decompressed.data();
+	}
+	return fileData;
+}
+
+// Function which returns the hash of the file's contents - pack entries store it in the table of contents so only loose files are hashed here
+uint64_t AssetFile::contentHash()
+{
+	if (!hashed)
+	{
+		fileHash = entry != nullptr ? entry->contentHash : murmurHash64(fileData, fileSize);
+		hashed = true;
+	}
+	return fileHash;
+}
+
+VirtualFileSystem::VirtualFileSystem()
+{
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+}
+
+// Function which mounts an asset pack so its files are used in place of the loose files - returns false with the reason in error if it cannot be used
+bool VirtualFileSystem::mount(const std::string &packPath, std::string &error)
+{
+	return pack.open(packPath, error);
+}
+
+// Function which unmounts the asset pack - any data still pointing into it is no longer valid
+void VirtualFileSystem::unmount()
+{
+	pack.close();
+}
+
+// Function which opens a file from the asset pack, or from disk if the pack does not hold it - returns false if neither does
+bool VirtualFileSystem::open(const std::string &path, AssetFile &file) const
+{
+	file.close();
+
+	// Look in the pack first
+	const AssetPackEntry *entry = pack.isOpen() ? pack.find(path) : nullptr;
+	if (entry != nullptr)
+	{
+		file.pack = &pack;
+		file.entry = entry;
+		file.fileSize = static_cast<size_t>(entry->size);
+		if ((entry->flags & ASSET_PACK_ENTRY_LZ4) == 0)
+		{
+			file.fileData = pack.entryData(*entry);
+		}
+		file.opened = true;
+		return true;
+	}
+
+	// Fall back to the loose file
+	if (!file.looseFile.open(path))
+	{
+		return false;
+	}
+	file.fileData = file.looseFile.data();
+	file.fileSize = file.looseFile.size();
+	file.opened = true;
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "AssetPack.h"
+#include "MappedFile.h"
+
+// Class which holds one file opened through the virtual file system - either an entry of the mounted asset pack or a memory mapped loose file
+class AssetFile
+{
+public:
+	AssetFile();
+	~AssetFile();
+
+	void close();
+	bool isOpen() const { return opened; }
+
+	const uint8_t* data();
+	size_t size() const { return fileSize; }
+	uint64_t contentHash();
+	// True if data points straight into the mounted asset pack - it then stays valid until the pack is unmounted, not just while this file is open
+	bool isPackMapped() const { return entry != nullptr && (entry->flags & ASSET_PACK_ENTRY_LZ4) == 0; }
+
+private:
+	friend class VirtualFileSystem;
+
+	// A file may own a mapping so it cannot be copied
+	AssetFile(const AssetFile&) = delete;
+	AssetFile& operator=(const AssetFile&) = delete;
+
+	bool opened = false;
+	const AssetPack *pack = nullptr;
+	const AssetPackEntry *entry = nullptr;
+	const uint8_t *fileData = nullptr;
+	size_t fileSize = 0;
+	uint64_t fileHash = 0;
+	bool hashed = false;
+	// Compressed pack entries are only decompressed the first time their data is asked for
+	std::vector<uint8_t> decompressed;
+	MappedFile looseFile;
+};
+
+// Class which resolves asset paths - files in the mounted asset pack are read from it, anything else falls back to the loose file on disk
+// Mounting and unmounting must happen while nothing else is reading, opening files is safe on many threads at once
+class VirtualFileSystem
+{
+public:
+	VirtualFileSystem();
+	~VirtualFileSystem();
+
+	bool mount(const std::string &packPath, std::string &error);
+	void unmount();
+	bool isMounted() const { return pack.isOpen(); }
+
+	bool open(const std::string &path, AssetFile &file) const;
+
+private:
+	AssetPack pack;
+};
@@ -1,8 +1,17 @@
 #include "VulkanManager.h"
 #include "include\STBIMAGE\stb_image.h"
-#include "include\TinyOBJ\tiny_obj_loader.h"
 
 #include "FrameworkSingleton.h" // Gives access to singleton and required libraries
+#include "Vertex.h"
+#include "VertexHashTable.h"
+#include "VirtualFileSystem.h"
+#include "Hash.h"
+#include "MeshOptimiser.h"
+#include "MeshSimplifier.h"
+#include "ObjReader.h"
+#include "GltfReader.h"
+#include "TextureCompressor.h"
+#include "MipmapGenerator.h"
 
 VulkanManager::VulkanManager()
 {
@@ -12,56 +21,6 @@ VulkanManager::~VulkanManager()
 {
 }
 
-// Struct called vertex which stores the information for the vertex shader
-struct Vertex
-{
-	glm::vec3 pos;
-	glm::vec3 color;
-	glm::vec2 texCoord;
-
-	// Tell Vulkan how to pass this data format to the vertex shader - bind the information
-	static VkVertexInputBindingDescription getBindingDescription()
-	{
-		// Struct which contains information regarding how the data is sumbitted to the GPU and vertex shader
-		VkVertexInputBindingDescription bindingDescription = {};
-		bindingDescription.binding = 0; // Specifies the index of the binding in the array of bindings
-		bindingDescription.stride = sizeof(Vertex); // Specifies the number of bytes from one entry to the next
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Specifies the move to the next data entry after each vertex
-
-		return bindingDescription;
-	}
-
-	// Tell Vulkan the attribute description 
-	static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
-	{
-		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
-
-		// Two different attribute description, one for position
-		attributeDescriptions[0].binding = 0; // Binding parameter specifies from which binding the per-vertex data comes
-		attributeDescriptions[0].location = 0; // References the location directive of the input in the vertex shader.
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT; // Describes the type of data for the attribute - vec3
-		attributeDescriptions[0].offset = offsetof(Vertex, pos);
-		// The other for colour 
-		attributeDescriptions[1].binding = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT; // vec3
-		attributeDescriptions[1].offset = offsetof(Vertex, color);
-		// The other for the texture coordinates
-		attributeDescriptions[2].binding = 0;
-		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT; // Vec2
-		attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
-
-		return attributeDescriptions;
-	}
-
-	// Helper function used as part of the model loader to set the vertex information - Comment out when not using models
-	bool operator==(const Vertex& other) const
-	{
-		return pos == other.pos && color == other.color && texCoord == other.texCoord;
-	}
-};
-
 // Struct which stores details of swap chain support - query the physical device for some details 
 struct SwapChainSupportDetails
 {
@@ -70,19 +29,6 @@ struct SwapChainSupportDetails
 	std::vector<VkPresentModeKHR> presentModes;
 };
 
-namespace std //- Comment out when not using models
-{
-	template<> struct hash<Vertex>
-	{
-		size_t operator()(Vertex const& vertex) const
-		{
-			return ((hash<glm::vec3>()(vertex.pos) ^
-				(hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-				(hash<glm::vec2>()(vertex.texCoord) << 1);
-		}
-	};
-}
-
 // Struct which checks queue families supporting drawing commands and the ones supporting presentation do not overlap
 struct QueueFamilyIndices
 {
@@ -115,431 +61,2096 @@ void VulkanManager::initVulkan()
 	createImageViews();
 	createRenderPass();
 	createDescriptorSetLayout();
-	createGraphicsPipeline("shaders/vert.spv", "shaders/frag.spv"); // Default texture shaders
-	createSkyboxGraphicsPipeline("shaders/skyVert.spv", "shaders/skyFrag.spv"); // Skybox Shaders
+	createGraphicsPipeline(FrameworkSingleton::getInstance()->usePackedVertices ? "shaders/packedVert.spv" : "shaders/vert.spv", FrameworkSingleton::getInstance()->textureArraysActive ? "shaders/arrayFrag.spv" : "shaders/frag.spv"); // Default texture shaders - the packed vertex shader when the packed layout is used and the array fragment shader when textures are packed into arrays
+	createSkyboxGraphicsPipeline(FrameworkSingleton::getInstance()->usePackedVertices ? "shaders/packedSkyVert.spv" : "shaders/skyVert.spv", "shaders/skyFrag.spv"); // Skybox shaders - the skybox is drawn with them when it is loaded from a cube map
 	createCommandPool();
+	// Copies and layout transitions are recorded into the upload context from here on and submitted together ahead of the frames that need them
+	FrameworkSingleton::getInstance()->uploadContext.create();
 	createDepthResources();
 	createFramebuffers();
-	// Create Images and image buffers for all images
-	createTextureImage(FrameworkSingleton::getInstance()->boxesTexturePath, FrameworkSingleton::getInstance()->boxesTexture, FrameworkSingleton::getInstance()->boxesTextureMemory); // Load repeat texture
-	createTextureImageView(FrameworkSingleton::getInstance()->boxesTexture, FrameworkSingleton::getInstance()->textureImageView, FrameworkSingleton::getInstance()->twoDImageView); // Create repeat texture view
-	createTextureImage(FrameworkSingleton::getInstance()->checkedTexturePath, FrameworkSingleton::getInstance()->checkedTexture, FrameworkSingleton::getInstance()->checkedTextureMemory);
-	createTextureImageView(FrameworkSingleton::getInstance()->checkedTexture, FrameworkSingleton::getInstance()->checkedImageView, FrameworkSingleton::getInstance()->twoDImageView);
-	createTextureImage(FrameworkSingleton::getInstance()->modelSceneryTexturePath, FrameworkSingleton::getInstance()->modelSceneryTexture, FrameworkSingleton::getInstance()->modelSceneryTextureMemory);
-	createTextureImageView(FrameworkSingleton::getInstance()->modelSceneryTexture, FrameworkSingleton::getInstance()->modelSceneryImageView, FrameworkSingleton::getInstance()->twoDImageView);
-	createTextureImage(FrameworkSingleton::getInstance()->modelChaletTexturePath, FrameworkSingleton::getInstance()->modelChaletTexture, FrameworkSingleton::getInstance()->modelChaletTextureMemory);
-	createTextureImageView(FrameworkSingleton::getInstance()->modelChaletTexture, FrameworkSingleton::getInstance()->modelChaletImageView, FrameworkSingleton::getInstance()->twoDImageView);
-	// Skybox images 
-	createTextureImage(FrameworkSingleton::getInstance()->topSkyTexturePath, FrameworkSingleton::getInstance()->topSkyTexture, FrameworkSingleton::getInstance()->topSkyTextureMemory);
-	createTextureImage(FrameworkSingleton::getInstance()->bottomSkyTexturePath, FrameworkSingleton::getInstance()->bottomSkyTexture, FrameworkSingleton::getInstance()->bottomSkyTextureMemory);
-	createTextureImage(FrameworkSingleton::getInstance()->leftSkyTexturePath, FrameworkSingleton::getInstance()->leftSkyTexture, FrameworkSingleton::getInstance()->leftSkyTextureMemory);
-	createTextureImage(FrameworkSingleton::getInstance()->rightSkyTexturePath, FrameworkSingleton::getInstance()->rightSkyTexture, FrameworkSingleton::getInstance()->rightSkyTextureMemory);
-	createTextureImage(FrameworkSingleton::getInstance()->frontSkyTexturePath, FrameworkSingleton::getInstance()->frontSkyTexture, FrameworkSingleton::getInstance()->frontSkyTextureMemory);
-	createTextureImage(FrameworkSingleton::getInstance()->backSkyTexturePath, FrameworkSingleton::getInstance()->backSkyTexture, FrameworkSingleton::getInstance()->backSkyTextureMemory);
-	createCubeTextureImageView(FrameworkSingleton::getInstance()->topSkyTexture, FrameworkSingleton::getInstance()->bottomSkyTexture, FrameworkSingleton::getInstance()->leftSkyTexture, FrameworkSingleton::getInstance()->rightSkyTexture, FrameworkSingleton::getInstance()->frontSkyTexture, FrameworkSingleton::getInstance()->backSkyTexture, FrameworkSingleton::getInstance()->skyboxImageView, FrameworkSingleton::getInstance()->twoDImageView);
+	// Create the staging ring every upload is copied through and the shared vertex and index buffers meshes are packed into
+	FrameworkSingleton::getInstance()->stagingRing.create();
+	FrameworkSingleton::getInstance()->geometryBuffer.create();
+	// Load the skybox from its cube map when there is one - texture arrays hold the skybox faces as layers so they keep the face images
+	AssetFile skyboxCubeMapFile;
+	FrameworkSingleton::getInstance()->skyboxCubeMapActive = FrameworkSingleton::getInstance()->useSkyboxCubeMap && !FrameworkSingleton::getInstance()->textureArraysActive && FrameworkSingleton::getInstance()->fileSystem.open(FrameworkSingleton::getInstance()->skyboxCubeMapPath, skyboxCubeMapFile);
+	skyboxCubeMapFile.close();
+	// Decide how far each texture is scaled down before any of them are loaded
+	planTextureBudget();
+	// Streamed textures and models are drawn with placeholders until they arrive - the first frame does not wait for any file
+	if (FrameworkSingleton::getInstance()->streamAssets)
+	{
+		createPlaceholderResources();
+	}
+	else if (FrameworkSingleton::getInstance()->textureArraysActive)
+	{
+		// Pack every image into texture arrays - each texture still gets a view of its own layer for anything that samples it alone
+		createTextureArrays({
+			{ FrameworkSingleton::getInstance()->boxesTexturePath, &FrameworkSingleton::getInstance()->boxesTextureLayer, &FrameworkSingleton::getInstance()->textureImageView, &FrameworkSingleton::getInstance()->boxesTextureFormat },
+			{ FrameworkSingleton::getInstance()->checkedTexturePath, &FrameworkSingleton::getInstance()->checkedTextureLayer, &FrameworkSingleton::getInstance()->checkedImageView, &FrameworkSingleton::getInstance()->checkedTextureFormat },
+			{ FrameworkSingleton::getInstance()->modelSceneryTexturePath, &FrameworkSingleton::getInstance()->modelSceneryTextureLayer, &FrameworkSingleton::getInstance()->modelSceneryImageView, &FrameworkSingleton::getInstance()->modelSceneryTextureFormat },
+			{ FrameworkSingleton::getInstance()->modelChaletTexturePath, &FrameworkSingleton::getInstance()->modelChaletTextureLayer, &FrameworkSingleton::getInstance()->modelChaletImageView, &FrameworkSingleton::getInstance()->modelChaletTextureFormat },
+			// Skybox images - the skybox is drawn with the top face like the cube view it replaces
+			{ FrameworkSingleton::getInstance()->topSkyTexturePath, &FrameworkSingleton::getInstance()->skyboxTextureLayer, &FrameworkSingleton::getInstance()->skyboxImageView, &FrameworkSingleton::getInstance()->topSkyTextureFormat },
+			{ FrameworkSingleton::getInstance()->bottomSkyTexturePath, nullptr, nullptr, &FrameworkSingleton::getInstance()->bottomSkyTextureFormat },
+			{ FrameworkSingleton::getInstance()->leftSkyTexturePath, nullptr, nullptr, &FrameworkSingleton::getInstance()->leftSkyTextureFormat },
+			{ FrameworkSingleton::getInstance()->rightSkyTexturePath, nullptr, nullptr, &FrameworkSingleton::getInstance()->rightSkyTextureFormat },
+			{ FrameworkSingleton::getInstance()->frontSkyTexturePath, nullptr, nullptr, &FrameworkSingleton::getInstance()->frontSkyTextureFormat },
+			{ FrameworkSingleton::getInstance()->backSkyTexturePath, nullptr, nullptr, &FrameworkSingleton::getInstance()->backSkyTextureFormat }
+		});
+	}
+	else
+	{
+		// Create Images and image buffers for all images - decoded in parallel and uploaded together
+		std::vector<TextureRequest> textureRequests = {
+			{ FrameworkSingleton::getInstance()->boxesTexturePath, &FrameworkSingleton::getInstance()->boxesTexture, &FrameworkSingleton::getInstance()->boxesTextureFormat }, // Load repeat texture
+			{ FrameworkSingleton::getInstance()->checkedTexturePath, &FrameworkSingleton::getInstance()->checkedTexture, &FrameworkSingleton::getInstance()->checkedTextureFormat },
+			{ FrameworkSingleton::getInstance()->modelSceneryTexturePath, &FrameworkSingleton::getInstance()->modelSceneryTexture, &FrameworkSingleton::getInstance()->modelSceneryTextureFormat },
+			{ FrameworkSingleton::getInstance()->modelChaletTexturePath, &FrameworkSingleton::getInstance()->modelChaletTexture, &FrameworkSingleton::getInstance()->modelChaletTextureFormat }
+		};
+		// Skybox images - one cube map holding all six faces, or an image for each face
+		if (FrameworkSingleton::getInstance()->skyboxCubeMapActive)
+		{
+			textureRequests.push_back({ FrameworkSingleton::getInstance()->skyboxCubeMapPath, &FrameworkSingleton::getInstance()->skyboxCubeMap, &FrameworkSingleton::getInstance()->skyboxTextureFormat });
+		}
+		else
+		{
+			textureRequests.insert(textureRequests.end(), {
+				{ FrameworkSingleton::getInstance()->topSkyTexturePath, &FrameworkSingleton::getInstance()->topSkyTexture, &FrameworkSingleton::getInstance()->topSkyTextureFormat },
+				{ FrameworkSingleton::getInstance()->bottomSkyTexturePath, &FrameworkSingleton::getInstance()->bottomSkyTexture, &FrameworkSingleton::getInstance()->bottomSkyTextureFormat },
+				{ FrameworkSingleton::getInstance()->leftSkyTexturePath, &FrameworkSingleton::getInstance()->leftSkyTexture, &FrameworkSingleton::getInstance()->leftSkyTextureFormat },
+				{ FrameworkSingleton::getInstance()->rightSkyTexturePath, &FrameworkSingleton::getInstance()->rightSkyTexture, &FrameworkSingleton::getInstance()->rightSkyTextureFormat },
+				{ FrameworkSingleton::getInstance()->frontSkyTexturePath, &FrameworkSingleton::getInstance()->frontSkyTexture, &FrameworkSingleton::getInstance()->frontSkyTextureFormat },
+				{ FrameworkSingleton::getInstance()->backSkyTexturePath, &FrameworkSingleton::getInstance()->backSkyTexture, &FrameworkSingleton::getInstance()->backSkyTextureFormat }
+			});
+		}
+		createTextureImages(textureRequests);
+		createTextureImageView(FrameworkSingleton::getInstance()->boxesTexture, FrameworkSingleton::getInstance()->boxesTextureFormat, FrameworkSingleton::getInstance()->textureImageView, FrameworkSingleton::getInstance()->twoDImageView); // Create repeat texture view
+		createTextureImageView(FrameworkSingleton::getInstance()->checkedTexture, FrameworkSingleton::getInstance()->checkedTextureFormat, FrameworkSingleton::getInstance()->checkedImageView, FrameworkSingleton::getInstance()->twoDImageView);
+		createTextureImageView(FrameworkSingleton::getInstance()->modelSceneryTexture, FrameworkSingleton::getInstance()->modelSceneryTextureFormat, FrameworkSingleton::getInstance()->modelSceneryImageView, FrameworkSingleton::getInstance()->twoDImageView);
+		createTextureImageView(FrameworkSingleton::getInstance()->modelChaletTexture, FrameworkSingleton::getInstance()->modelChaletTextureFormat, FrameworkSingleton::getInstance()->modelChaletImageView, FrameworkSingleton::getInstance()->twoDImageView);
+		createSkyboxImageView();
+	}
 	createTextureSampler();
-	// Load any models 
-	loadModel(FrameworkSingleton::getInstance()->modelChaletPath, FrameworkSingleton::getInstance()->modelChaletVertices, FrameworkSingleton::getInstance()->modelChaletIndices);
-	loadModel(FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelSceneryVertices, FrameworkSingleton::getInstance()->modelSceneryIndices);
-	// Create Vertex Buffers - one required for every peice of geometry
-	createVertexBuffer(cubeVertices1, FrameworkSingleton::getInstance()->vertexBox1, FrameworkSingleton::getInstance()->vertexBox1Memory);
-	createVertexBuffer(cubeVertices2, FrameworkSingleton::getInstance()->vertexBox2, FrameworkSingleton::getInstance()->vertexBox2Memory);
-	createVertexBuffer(cubeVertices3, FrameworkSingleton::getInstance()->vertexBox3, FrameworkSingleton::getInstance()->vertexBox3Memory);
-	createVertexBuffer(FrameworkSingleton::getInstance()->modelSceneryVertices, FrameworkSingleton::getInstance()->vertexSceneryModel, FrameworkSingleton::getInstance()->vertexSceneryModelMemory);
-	createVertexBuffer(FrameworkSingleton::getInstance()->modelChaletVertices, FrameworkSingleton::getInstance()->vertexChaletModel, FrameworkSingleton::getInstance()->vertexChaletModelMemory);
-	createVertexBuffer(skyboxVertices, FrameworkSingleton::getInstance()->vertexSkybox, FrameworkSingleton::getInstance()->vertexSkyboxMemory);
-	// Create Index Buffers - one required for every peice of geometry
-	createIndexBuffer(planeIndices, FrameworkSingleton::getInstance()->indexPlane, FrameworkSingleton::getInstance()->indexPlaneMemory);
-	createIndexBuffer(cubeIndices, FrameworkSingleton::getInstance()->indexBox, FrameworkSingleton::getInstance()->indexBoxMemory);
-	createIndexBuffer(FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->indexSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModelMemory);
-	createIndexBuffer(FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->indexChaletModel, FrameworkSingleton::getInstance()->indexChaletModelMemory);
-	createIndexBuffer(skyboxIndices, FrameworkSingleton::getInstance()->indexSkybox, FrameworkSingleton::getInstance()->indexSkyboxMemory);
-	// Create normal and rotating uniform buffer
-	createUniformBuffer(FrameworkSingleton::getInstance()->uniformBuffer, FrameworkSingleton::getInstance()->uniformBufferMemory);
-	createUniformBuffer(FrameworkSingleton::getInstance()->rotatingUniformBuffer, FrameworkSingleton::getInstance()->rotatingUniformBufferMemory);
+	// Load any models and create their vertex and index buffers - a model with the same contents as one already loaded shares its buffers
+	if (!FrameworkSingleton::getInstance()->streamAssets)
+	{
+		createModelBuffers(FrameworkSingleton::getInstance()->modelChaletPath, FrameworkSingleton::getInstance()->modelChaletVertices, FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->modelChaletLods, FrameworkSingleton::getInstance()->vertexChaletModel, FrameworkSingleton::getInstance()->dequantChaletModel, FrameworkSingleton::getInstance()->indexChaletModel, FrameworkSingleton::getInstance()->indexChaletModelType, FrameworkSingleton::getInstance()->rangeChaletModel);
+		// The terrain reads the scenery model itself when it replaces it
+		if (!FrameworkSingleton::getInstance()->useTerrain)
+		{
+			createModelBuffers(FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelSceneryVertices, FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->modelSceneryLods, FrameworkSingleton::getInstance()->vertexSceneryModel, FrameworkSingleton::getInstance()->dequantSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModelType, FrameworkSingleton::getInstance()->rangeSceneryModel);
+		}
+	}
+	// Create Vertex and Index Buffers - one range of the geometry buffer required for every peice of geometry, the boxes share the cube's indices
+	createMeshBuffers(cubeVertices1, cubeIndices, FrameworkSingleton::getInstance()->vertexBox1, FrameworkSingleton::getInstance()->dequantBox1, FrameworkSingleton::getInstance()->indexBox, FrameworkSingleton::getInstance()->indexBoxType, FrameworkSingleton::getInstance()->rangeBox1);
+	createMeshVertexBuffer(cubeVertices2, FrameworkSingleton::getInstance()->vertexBox2, FrameworkSingleton::getInstance()->dequantBox2, FrameworkSingleton::getInstance()->rangeBox1, FrameworkSingleton::getInstance()->rangeBox2);
+	createMeshVertexBuffer(cubeVertices3, FrameworkSingleton::getInstance()->vertexBox3, FrameworkSingleton::getInstance()->dequantBox3, FrameworkSingleton::getInstance()->rangeBox1, FrameworkSingleton::getInstance()->rangeBox3);
+	createMeshBuffers(skyboxVertices, skyboxIndices, FrameworkSingleton::getInstance()->vertexSkybox, FrameworkSingleton::getInstance()->dequantSkybox, FrameworkSingleton::getInstance()->indexSkybox, FrameworkSingleton::getInstance()->indexSkyboxType, FrameworkSingleton::getInstance()->rangeSkybox);
+	// The plane is not drawn so it keeps an index buffer of its own
+	createIndexBuffer(planeIndices, FrameworkSingleton::getInstance()->indexPlane, FrameworkSingleton::getInstance()->indexPlaneType);
+	// Create the uniform arena with the normal and rotating uniform buffer objects in it
+	createUniformBuffers();
+	// Create the buffer the models' level of detail draws are read from
+	createLodDrawBuffer();
+	createMeshletIndexBuffers();
+	// Build the terrain which replaces the scenery model
+	if (FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->terrainManager.createTerrain();
+	}
 	// Create descriptor pool
 	createDescriptorPool();
-	// Create descriptor set - one required for every peice of geometry
-	createDescriptorSet(FrameworkSingleton::getInstance()->cubedescriptorSet, FrameworkSingleton::getInstance()->textureImageView, FrameworkSingleton::getInstance()->uniformBuffer);
-	createDescriptorSet(FrameworkSingleton::getInstance()->checkedDescriptorSet, FrameworkSingleton::getInstance()->checkedImageView, FrameworkSingleton::getInstance()->uniformBuffer);
-	createDescriptorSet(FrameworkSingleton::getInstance()->modelSceneryDescriptorSet, FrameworkSingleton::getInstance()->modelSceneryImageView, FrameworkSingleton::getInstance()->uniformBuffer);
-	createDescriptorSet(FrameworkSingleton::getInstance()->modelChaletDescriptorSet, FrameworkSingleton::getInstance()->modelChaletImageView, FrameworkSingleton::getInstance()->rotatingUniformBuffer);
-	createDescriptorSet(FrameworkSingleton::getInstance()->skyboxDescriptorSet, FrameworkSingleton::getInstance()->skyboxImageView, FrameworkSingleton::getInstance()->uniformBuffer);
+	// Create descriptor set - one required for every texture, or just the one when every texture is in a texture array - draws pick their uniform buffer object when they bind it
+	if (FrameworkSingleton::getInstance()->textureArraysActive)
+	{
+		createTextureArrayDescriptorSet(FrameworkSingleton::getInstance()->textureArrayDescriptorSet);
+	}
+	else
+	{
+		createDescriptorSet(FrameworkSingleton::getInstance()->cubedescriptorSet, FrameworkSingleton::getInstance()->textureImageView);
+		createDescriptorSet(FrameworkSingleton::getInstance()->checkedDescriptorSet, FrameworkSingleton::getInstance()->checkedImageView);
+		createDescriptorSet(FrameworkSingleton::getInstance()->modelSceneryDescriptorSet, FrameworkSingleton::getInstance()->modelSceneryImageView);
+		createDescriptorSet(FrameworkSingleton::getInstance()->modelChaletDescriptorSet, FrameworkSingleton::getInstance()->modelChaletImageView);
+		createDescriptorSet(FrameworkSingleton::getInstance()->skyboxDescriptorSet, FrameworkSingleton::getInstance()->skyboxImageView);
+	}
+	// Start loading the streamed textures and models now their descriptor sets exist
+	if (FrameworkSingleton::getInstance()->streamAssets)
+	{
+		requestStreamedAssets();
+	}
 	// Create command buffers and semaphores
 	createCommandBuffers();
 	createSemaphores();
+	// Pick up edits to the asset files while the application runs
+	if (FrameworkSingleton::getInstance()->useHotReload)
+	{
+		watchAssets();
+	}
 }
 
-void modelLoad(std::vector<tinyobj::shape_t> shapes, tinyobj::attrib_t attrib, std::unordered_map<Vertex, uint32_t> uniqueVertices, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, unsigned int iterations)
+// Function which hands every texture the scene draws to the texture budget with how much its detail matters on screen - returns the device memory they are expected to take
+VkDeviceSize VulkanManager::planTextureBudget()
 {
-	for (int i = 0; i < iterations; i++)
+	std::vector<std::string> skyboxTextures = { FrameworkSingleton::getInstance()->topSkyTexturePath, FrameworkSingleton::getInstance()->bottomSkyTexturePath, FrameworkSingleton::getInstance()->leftSkyTexturePath, FrameworkSingleton::getInstance()->rightSkyTexturePath, FrameworkSingleton::getInstance()->frontSkyTexturePath, FrameworkSingleton::getInstance()->backSkyTexturePath };
+	if (FrameworkSingleton::getInstance()->skyboxCubeMapActive)
 	{
-		for (const auto& shape : shapes)
-		{
-			// For all the incides in the model
+		skyboxTextures = { FrameworkSingleton::getInstance()->skyboxCubeMapPath };
+	}
+	return FrameworkSingleton::getInstance()->textureBudget.plan({
+		// The chalet is seen close up in the centre of the view
+		{ { FrameworkSingleton::getInstance()->modelChaletTexturePath }, 4.0f },
+		// The scenery covers the ground around it but is mostly seen at a distance
+		{ { FrameworkSingleton::getInstance()->modelSceneryTexturePath }, 3.0f },
+		{ { FrameworkSingleton::getInstance()->boxesTexturePath }, 2.0f },
+		{ { FrameworkSingleton::getInstance()->checkedTexturePath }, 1.0f },
+		// The skybox fills the background but is stretched over the whole view so fine detail is lost on it first - its faces have to stay the same size
+		{ skyboxTextures, 1.0f }
+	});
+}
 
-			for (const auto& index : shape.mesh.indices)
-			{
-				// Find the vertex positions
-				Vertex vertex = {};
-				vertex.pos = {
-					attrib.vertices[3 * index.vertex_index + 0],
-					attrib.vertices[3 * index.vertex_index + 1],
-					attrib.vertices[3 * index.vertex_index + 2]
-				};
-
-				// Find the vertex texture coordinates
-				vertex.texCoord = {
-					attrib.texcoords[2 * index.texcoord_index + 0],
-					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-				};
-
-				// Set the vertex colour
-				vertex.color = { 1.0f, 1.0f, 1.0f };
-
-				if (uniqueVertices.count(vertex) == 0)
-				{
-					uniqueVertices[vertex] = static_cast<uint32_t>(modelVertices.size());
-					modelVertices.push_back(vertex);
-				}
+// Function which creates the 1x1 texture and cube mesh streamed assets are drawn with until they arrive and points every streamed texture view and model at them
+void VulkanManager::createPlaceholderResources()
+{
+	// Mid grey so nothing stands out before the real texture arrives
+	const uint8_t placeholderPixel[4] = { 128, 128, 128, 255 };
+
+	// Upload the pixel and create its view - a skybox loaded from a cube map is sampled as a cube so the pixel is given six faces and a cube view as well
+	uint32_t placeholderLayers = FrameworkSingleton::getInstance()->skyboxCubeMapActive ? 6 : 1;
+	createImage(1, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, FrameworkSingleton::getInstance()->placeholderTexture,
+		placeholderLayers, FrameworkSingleton::getInstance()->skyboxCubeMapActive ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0);
+	uploadImage(placeholderPixel, FrameworkSingleton::getInstance()->placeholderTexture, VK_FORMAT_R8G8B8A8_UNORM, 1, 1, placeholderLayers);
+	createTextureImageView(FrameworkSingleton::getInstance()->placeholderTexture, VK_FORMAT_R8G8B8A8_UNORM, FrameworkSingleton::getInstance()->placeholderImageView, FrameworkSingleton::getInstance()->twoDImageView);
+	if (FrameworkSingleton::getInstance()->skyboxCubeMapActive)
+	{
+		FrameworkSingleton::getInstance()->placeholderCubeImageView = createImageView(FrameworkSingleton::getInstance()->placeholderTexture, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 1, FrameworkSingleton::getInstance()->cubeImageView, 0, 6);
+	}
+
+	// The first box doubles as the placeholder mesh
+	createMeshBuffers(cubeVertices1, cubeIndices, FrameworkSingleton::getInstance()->placeholderVertexBuffer, FrameworkSingleton::getInstance()->placeholderDequantisation, FrameworkSingleton::getInstance()->placeholderIndexBuffer, FrameworkSingleton::getInstance()->placeholderIndexType, FrameworkSingleton::getInstance()->placeholderRange);
+
+	// Every streamed texture is sampled as the placeholder until it has been swapped in
+	FrameworkSingleton::getInstance()->textureImageView = FrameworkSingleton::getInstance()->placeholderImageView;
+	FrameworkSingleton::getInstance()->checkedImageView = FrameworkSingleton::getInstance()->placeholderImageView;
+	FrameworkSingleton::getInstance()->modelSceneryImageView = FrameworkSingleton::getInstance()->placeholderImageView;
+	FrameworkSingleton::getInstance()->modelChaletImageView = FrameworkSingleton::getInstance()->placeholderImageView;
+	FrameworkSingleton::getInstance()->skyboxImageView = FrameworkSingleton::getInstance()->skyboxCubeMapActive ? FrameworkSingleton::getInstance()->placeholderCubeImageView : FrameworkSingleton::getInstance()->placeholderImageView;
+
+	// Every streamed model is drawn as the placeholder mesh - the vertices and indices are copied so the draw counts match it
+	FrameworkSingleton::getInstance()->modelChaletVertices = cubeVertices1;
+	FrameworkSingleton::getInstance()->modelChaletIndices = cubeIndices;
+	FrameworkSingleton::getInstance()->vertexChaletModel = FrameworkSingleton::getInstance()->placeholderVertexBuffer;
+	FrameworkSingleton::getInstance()->dequantChaletModel = FrameworkSingleton::getInstance()->placeholderDequantisation;
+	FrameworkSingleton::getInstance()->indexChaletModel = FrameworkSingleton::getInstance()->placeholderIndexBuffer;
+	FrameworkSingleton::getInstance()->indexChaletModelType = FrameworkSingleton::getInstance()->placeholderIndexType;
+	FrameworkSingleton::getInstance()->rangeChaletModel = FrameworkSingleton::getInstance()->placeholderRange;
+	FrameworkSingleton::getInstance()->modelSceneryVertices = cubeVertices1;
+	FrameworkSingleton::getInstance()->modelSceneryIndices = cubeIndices;
+	FrameworkSingleton::getInstance()->vertexSceneryModel = FrameworkSingleton::getInstance()->placeholderVertexBuffer;
+	FrameworkSingleton::getInstance()->dequantSceneryModel = FrameworkSingleton::getInstance()->placeholderDequantisation;
+	FrameworkSingleton::getInstance()->indexSceneryModel = FrameworkSingleton::getInstance()->placeholderIndexBuffer;
+	FrameworkSingleton::getInstance()->indexSceneryModelType = FrameworkSingleton::getInstance()->placeholderIndexType;
+	FrameworkSingleton::getInstance()->rangeSceneryModel = FrameworkSingleton::getInstance()->placeholderRange;
+}
 
-				modelIndices.push_back(uniqueVertices[vertex]);
+// Function which hands every texture and model to the streaming manager, most visible first, and starts decoding them
+void VulkanManager::requestStreamedAssets()
+{
+	// The chalet is the centre of the scene so it comes first, then the terrain around it, then the boxes and the skybox
+	FrameworkSingleton::getInstance()->streamingManager.requestModel(FrameworkSingleton::getInstance()->modelChaletPath, 3, FrameworkSingleton::getInstance()->modelChaletVertices, FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->modelChaletLods, FrameworkSingleton::getInstance()->vertexChaletModel, FrameworkSingleton::getInstance()->dequantChaletModel, FrameworkSingleton::getInstance()->indexChaletModel, FrameworkSingleton::getInstance()->indexChaletModelType, FrameworkSingleton::getInstance()->rangeChaletModel, nullptr);
+	streamTexture(FrameworkSingleton::getInstance()->modelChaletTexturePath, 3, FrameworkSingleton::getInstance()->modelChaletTexture, FrameworkSingleton::getInstance()->modelChaletTextureFormat, FrameworkSingleton::getInstance()->modelChaletImageView, FrameworkSingleton::getInstance()->modelChaletDescriptorSet);
+	// The terrain already holds everything it needs from the scenery model except its texture
+	if (!FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->streamingManager.requestModel(FrameworkSingleton::getInstance()->modelSceneryPath, 2, FrameworkSingleton::getInstance()->modelSceneryVertices, FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->modelSceneryLods, FrameworkSingleton::getInstance()->vertexSceneryModel, FrameworkSingleton::getInstance()->dequantSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModelType, FrameworkSingleton::getInstance()->rangeSceneryModel, nullptr);
+		streamTexture(FrameworkSingleton::getInstance()->modelSceneryTexturePath, 2, FrameworkSingleton::getInstance()->modelSceneryTexture, FrameworkSingleton::getInstance()->modelSceneryTextureFormat, FrameworkSingleton::getInstance()->modelSceneryImageView, FrameworkSingleton::getInstance()->modelSceneryDescriptorSet);
+	}
+	else
+	{
+		streamTexture(FrameworkSingleton::getInstance()->modelSceneryTexturePath, 2, FrameworkSingleton::getInstance()->modelSceneryTexture, FrameworkSingleton::getInstance()->modelSceneryTextureFormat, FrameworkSingleton::getInstance()->modelSceneryImageView, FrameworkSingleton::getInstance()->modelSceneryDescriptorSet, []()
+		{
+			FrameworkSingleton::getInstance()->terrainManager.updateDescriptorSet();
+		});
+	}
+	streamTexture(FrameworkSingleton::getInstance()->boxesTexturePath, 1, FrameworkSingleton::getInstance()->boxesTexture, FrameworkSingleton::getInstance()->boxesTextureFormat, FrameworkSingleton::getInstance()->textureImageView, FrameworkSingleton::getInstance()->cubedescriptorSet);
+	streamTexture(FrameworkSingleton::getInstance()->checkedTexturePath, 0, FrameworkSingleton::getInstance()->checkedTexture, FrameworkSingleton::getInstance()->checkedTextureFormat, FrameworkSingleton::getInstance()->checkedImageView, FrameworkSingleton::getInstance()->checkedDescriptorSet);
+
+	// The skybox view covers all six faces so it is only created once the last of them has arrived - a cube map arrives with all six at once
+	std::vector<TextureRequest> skyboxFaces = {
+		{ FrameworkSingleton::getInstance()->topSkyTexturePath, &FrameworkSingleton::getInstance()->topSkyTexture, &FrameworkSingleton::getInstance()->topSkyTextureFormat },
+		{ FrameworkSingleton::getInstance()->bottomSkyTexturePath, &FrameworkSingleton::getInstance()->bottomSkyTexture, &FrameworkSingleton::getInstance()->bottomSkyTextureFormat },
+		{ FrameworkSingleton::getInstance()->leftSkyTexturePath, &FrameworkSingleton::getInstance()->leftSkyTexture, &FrameworkSingleton::getInstance()->leftSkyTextureFormat },
+		{ FrameworkSingleton::getInstance()->rightSkyTexturePath, &FrameworkSingleton::getInstance()->rightSkyTexture, &FrameworkSingleton::getInstance()->rightSkyTextureFormat },
+		{ FrameworkSingleton::getInstance()->frontSkyTexturePath, &FrameworkSingleton::getInstance()->frontSkyTexture, &FrameworkSingleton::getInstance()->frontSkyTextureFormat },
+		{ FrameworkSingleton::getInstance()->backSkyTexturePath, &FrameworkSingleton::getInstance()->backSkyTexture, &FrameworkSingleton::getInstance()->backSkyTextureFormat }
+	};
+	if (FrameworkSingleton::getInstance()->skyboxCubeMapActive)
+	{
+		skyboxFaces = { { FrameworkSingleton::getInstance()->skyboxCubeMapPath, &FrameworkSingleton::getInstance()->skyboxCubeMap, &FrameworkSingleton::getInstance()->skyboxTextureFormat } };
+	}
+	std::shared_ptr<size_t> skyboxFacesLoaded = std::make_shared<size_t>(0);
+	size_t skyboxFaceCount = skyboxFaces.size();
+	for (const auto& face : skyboxFaces)
+	{
+		FrameworkSingleton::getInstance()->streamingManager.requestTexture(face.textureName, 0, *face.textureIm, *face.textureFormat, [this, skyboxFacesLoaded, skyboxFaceCount]()
+		{
+			if (++*skyboxFacesLoaded == skyboxFaceCount)
+			{
+				createSkyboxImageView();
+				updateDescriptorSet(FrameworkSingleton::getInstance()->skyboxDescriptorSet, FrameworkSingleton::getInstance()->skyboxImageView);
 			}
-		}
+		});
 	}
+
+	FrameworkSingleton::getInstance()->streamingManager.start();
 }
 
-// Function which loads a model
-void VulkanManager::loadModel(std::string modelPath, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices)
+// Function which streams a texture in and, once it has arrived, gives it a view and points its descriptor set at it - then calls onLoaded if given
+void VulkanManager::streamTexture(const std::string &textureName, int priority, VkImage &textureIm, VkFormat &textureFormat, VkImageView &textureImView, VkDescriptorSet &desSet, std::function<void()> onLoaded)
 {
-	// Attribute container which holds all of the position, texture coordinates and faces
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes; // Shapes
-	std::vector<tinyobj::material_t> materials; // The materials
-	std::string err; // Any errors or warnings that can occur while the model is in transit - loading...
-
-	// Get the number of threads the hardware can natively support
-	auto num_threadss = std::thread::hardware_concurrency();
+	FrameworkSingleton::getInstance()->streamingManager.requestTexture(textureName, priority, textureIm, textureFormat, [this, &textureIm, &textureFormat, &textureImView, &desSet, onLoaded]()
+	{
+		// Views other than the placeholder belong to the image being replaced
+		if (textureImView != FrameworkSingleton::getInstance()->placeholderImageView)
+		{
+			vkDestroyImageView(FrameworkSingleton::getInstance()->device, textureImView, nullptr);
+		}
+		createTextureImageView(textureIm, textureFormat, textureImView, FrameworkSingleton::getInstance()->twoDImageView);
+		updateDescriptorSet(desSet, textureImView);
+		if (onLoaded)
+		{
+			onLoaded();
+		}
+	});
+}
 
-	std::cout << num_threadss << " Thread Count" << std::endl;
-	// For all elements in array
-	// OpenMP statement must be placed here - doesnt work at inner for loop where initial alaysis identied
+// Function which starts watching every shader, texture and model file the scene is built from so edits to them are picked up while it runs
+void VulkanManager::watchAssets()
+{
+	if (!FrameworkSingleton::getInstance()->assetWatcher.start())
+	{
+		std::cerr << "Hot reload not used: failed to watch asset files!" << std::endl;
+		return;
+	}
 
-	// If the model cannot be loaded then throw an error
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, modelPath.c_str()))
+	// Reloaded textures and models are decoded and uploaded by the streaming manager, which only runs on its own when assets are streamed
+	if (!FrameworkSingleton::getInstance()->streamAssets)
 	{
-		throw std::runtime_error(err);
+		FrameworkSingleton::getInstance()->streamingManager.start();
 	}
 
-	// Unordered map which stores all of the unique vertices 
-	std::unordered_map<Vertex, uint32_t> uniqueVertices = {};
+	std::vector<std::string> paths = {
+		"shaders/vert.spv", "shaders/frag.spv", "shaders/packedVert.spv", "shaders/arrayFrag.spv", "shaders/skyVert.spv", "shaders/packedSkyVert.spv", "shaders/skyFrag.spv", "shaders/terrainVert.spv",
+		FrameworkSingleton::getInstance()->boxesTexturePath, FrameworkSingleton::getInstance()->checkedTexturePath, FrameworkSingleton::getInstance()->modelSceneryTexturePath, FrameworkSingleton::getInstance()->modelChaletTexturePath,
+		FrameworkSingleton::getInstance()->topSkyTexturePath, FrameworkSingleton::getInstance()->bottomSkyTexturePath, FrameworkSingleton::getInstance()->leftSkyTexturePath,
+		FrameworkSingleton::getInstance()->rightSkyTexturePath, FrameworkSingleton::getInstance()->frontSkyTexturePath, FrameworkSingleton::getInstance()->backSkyTexturePath,
+		FrameworkSingleton::getInstance()->skyboxCubeMapPath, FrameworkSingleton::getInstance()->modelSceneryPath, FrameworkSingleton::getInstance()->modelChaletPath
+	};
+	for (const auto& path : paths)
+	{
+		FrameworkSingleton::getInstance()->assetWatcher.watch(path);
+	}
+}
 
+// Function which is called once a frame on the main thread to reload whatever asset files have changed
+// Only the objects built from a changed file are replaced - pipelines are rebuilt here, textures and models are handed to the streaming manager,
+// which swaps them in, updates their descriptor sets and records the draw command buffers again once they have been uploaded
+void VulkanManager::reloadChangedAssets()
+{
+	std::vector<std::string> changedPaths;
+	FrameworkSingleton::getInstance()->assetWatcher.poll(changedPaths);
+	if (changedPaths.empty())
+	{
+		return;
+	}
 
-	for (const auto& shape : shapes) 
+	// Shader paths of the main pipeline - as chosen in initVulkan
+	std::string vertPath = FrameworkSingleton::getInstance()->usePackedVertices ? "shaders/packedVert.spv" : "shaders/vert.spv";
+	std::string fragPath = FrameworkSingleton::getInstance()->textureArraysActive ? "shaders/arrayFrag.spv" : "shaders/frag.spv";
+	std::string skyVertPath = FrameworkSingleton::getInstance()->usePackedVertices ? "shaders/packedSkyVert.spv" : "shaders/skyVert.spv";
+	bool reloadMain = false, reloadSkybox = false, reloadTerrain = false;
+	// The skybox view is made from every face so it is made again around a new face or cube map
+	auto recreateSkyboxView = [this]()
 	{
-//#pragma omp parallel for num_threads(num_threadss) schedule(static, 8)
-		// For all the incides in the model
-		for (const auto& index : shape.mesh.indices)
+		if (FrameworkSingleton::getInstance()->skyboxImageView != FrameworkSingleton::getInstance()->placeholderImageView && FrameworkSingleton::getInstance()->skyboxImageView != FrameworkSingleton::getInstance()->placeholderCubeImageView)
 		{
-			// Find the vertex positions
-			Vertex vertex = {};
-			vertex.pos = {
-				attrib.vertices[3 * index.vertex_index + 0],
-				attrib.vertices[3 * index.vertex_index + 1],
-				attrib.vertices[3 * index.vertex_index + 2]
-			};
+			vkDestroyImageView(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->skyboxImageView, nullptr);
+		}
+		createSkyboxImageView();
+		updateDescriptorSet(FrameworkSingleton::getInstance()->skyboxDescriptorSet, FrameworkSingleton::getInstance()->skyboxImageView);
+	};
+	for (const auto& path : changedPaths)
+	{
+		std::cout << "Asset changed: " + path + "\n";
+		reloadMain = reloadMain || path == vertPath || path == fragPath;
+		reloadSkybox = reloadSkybox || path == skyVertPath || path == "shaders/skyFrag.spv";
+		reloadTerrain = reloadTerrain || (FrameworkSingleton::getInstance()->useTerrain && (path == "shaders/terrainVert.spv" || path == "shaders/frag.spv"));
 
-			// Find the vertex texture coordinates
-			vertex.texCoord = {
-				attrib.texcoords[2 * index.texcoord_index + 0],
-				1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+		if (path == FrameworkSingleton::getInstance()->modelChaletPath)
+		{
+			FrameworkSingleton::getInstance()->streamingManager.requestModel(path, 3, FrameworkSingleton::getInstance()->modelChaletVertices, FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->modelChaletLods, FrameworkSingleton::getInstance()->vertexChaletModel, FrameworkSingleton::getInstance()->dequantChaletModel, FrameworkSingleton::getInstance()->indexChaletModel, FrameworkSingleton::getInstance()->indexChaletModelType, FrameworkSingleton::getInstance()->rangeChaletModel, nullptr);
+		}
+		else if (path == FrameworkSingleton::getInstance()->modelSceneryPath)
+		{
+			// The terrain's heights were sampled from the scenery model when it was built
+			if (FrameworkSingleton::getInstance()->useTerrain)
+			{
+				std::cout << "Asset not reloaded: " + path + " - restart to rebuild the terrain from it\n";
+				continue;
+			}
+			FrameworkSingleton::getInstance()->streamingManager.requestModel(path, 2, FrameworkSingleton::getInstance()->modelSceneryVertices, FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->modelSceneryLods, FrameworkSingleton::getInstance()->vertexSceneryModel, FrameworkSingleton::getInstance()->dequantSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModelType, FrameworkSingleton::getInstance()->rangeSceneryModel, nullptr);
+		}
+		else if (path.compare(0, 9, "textures/") == 0 && FrameworkSingleton::getInstance()->textureArraysActive)
+		{
+			// Each texture array layer is shared with other textures so the array would have to be built again
+			std::cout << "Asset not reloaded: " + path + " - textures packed into texture arrays are not reloaded\n";
+		}
+		else if (path == FrameworkSingleton::getInstance()->boxesTexturePath)
+		{
+			streamTexture(path, 1, FrameworkSingleton::getInstance()->boxesTexture, FrameworkSingleton::getInstance()->boxesTextureFormat, FrameworkSingleton::getInstance()->textureImageView, FrameworkSingleton::getInstance()->cubedescriptorSet);
+		}
+		else if (path == FrameworkSingleton::getInstance()->checkedTexturePath)
+		{
+			streamTexture(path, 0, FrameworkSingleton::getInstance()->checkedTexture, FrameworkSingleton::getInstance()->checkedTextureFormat, FrameworkSingleton::getInstance()->checkedImageView, FrameworkSingleton::getInstance()->checkedDescriptorSet);
+		}
+		else if (path == FrameworkSingleton::getInstance()->modelSceneryTexturePath)
+		{
+			streamTexture(path, 2, FrameworkSingleton::getInstance()->modelSceneryTexture, FrameworkSingleton::getInstance()->modelSceneryTextureFormat, FrameworkSingleton::getInstance()->modelSceneryImageView, FrameworkSingleton::getInstance()->modelSceneryDescriptorSet, []()
+			{
+				if (FrameworkSingleton::getInstance()->useTerrain)
+				{
+					FrameworkSingleton::getInstance()->terrainManager.updateDescriptorSet();
+				}
+			});
+		}
+		else if (path == FrameworkSingleton::getInstance()->modelChaletTexturePath)
+		{
+			streamTexture(path, 3, FrameworkSingleton::getInstance()->modelChaletTexture, FrameworkSingleton::getInstance()->modelChaletTextureFormat, FrameworkSingleton::getInstance()->modelChaletImageView, FrameworkSingleton::getInstance()->modelChaletDescriptorSet);
+		}
+		else if (FrameworkSingleton::getInstance()->skyboxCubeMapActive)
+		{
+			// The skybox cube map - the face images are not used while it is
+			if (path == FrameworkSingleton::getInstance()->skyboxCubeMapPath)
+			{
+				FrameworkSingleton::getInstance()->streamingManager.requestTexture(path, 0, FrameworkSingleton::getInstance()->skyboxCubeMap, FrameworkSingleton::getInstance()->skyboxTextureFormat, recreateSkyboxView);
+			}
+		}
+		else
+		{
+			// A skybox face - the cube view is built from the faces so it is made again around the new one
+			std::vector<std::pair<std::string, VkImage*>> skyboxFaces = {
+				{ FrameworkSingleton::getInstance()->topSkyTexturePath, &FrameworkSingleton::getInstance()->topSkyTexture },
+				{ FrameworkSingleton::getInstance()->bottomSkyTexturePath, &FrameworkSingleton::getInstance()->bottomSkyTexture },
+				{ FrameworkSingleton::getInstance()->leftSkyTexturePath, &FrameworkSingleton::getInstance()->leftSkyTexture },
+				{ FrameworkSingleton::getInstance()->rightSkyTexturePath, &FrameworkSingleton::getInstance()->rightSkyTexture },
+				{ FrameworkSingleton::getInstance()->frontSkyTexturePath, &FrameworkSingleton::getInstance()->frontSkyTexture },
+				{ FrameworkSingleton::getInstance()->backSkyTexturePath, &FrameworkSingleton::getInstance()->backSkyTexture }
 			};
-
-			// Set the vertex colour
-			vertex.color = { 1.0f, 1.0f, 1.0f };
-
-			if (uniqueVertices.count(vertex) == 0)
+			VkFormat *faceFormats[6] = { &FrameworkSingleton::getInstance()->topSkyTextureFormat, &FrameworkSingleton::getInstance()->bottomSkyTextureFormat, &FrameworkSingleton::getInstance()->leftSkyTextureFormat,
+				&FrameworkSingleton::getInstance()->rightSkyTextureFormat, &FrameworkSingleton::getInstance()->frontSkyTextureFormat, &FrameworkSingleton::getInstance()->backSkyTextureFormat };
+			for (size_t face = 0; face < skyboxFaces.size(); face++)
 			{
-				uniqueVertices[vertex] = static_cast<uint32_t>(modelVertices.size());
-				modelVertices.push_back(vertex);
+				if (path != skyboxFaces[face].first)
+				{
+					continue;
+				}
+				FrameworkSingleton::getInstance()->streamingManager.requestTexture(path, 0, *skyboxFaces[face].second, *faceFormats[face], recreateSkyboxView);
 			}
-
-			modelIndices.push_back(uniqueVertices[vertex]);
 		}
 	}
-}
 
-void VulkanManager::createDepthResources()
-{
-	// Find the depth format that will be used
-	VkFormat depthFormat = findDepthFormat();
+	if (!reloadMain && !reloadSkybox && !reloadTerrain)
+	{
+		return;
+	}
 
-	// Call the create image and depth image view functions now that we know what formats of depth buffer are supported 
-	createImage(FrameworkSingleton::getInstance()->swapChainExtent.width, FrameworkSingleton::getInstance()->swapChainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, FrameworkSingleton::getInstance()->depthImage, FrameworkSingleton::getInstance()->depthImageMemory);
-	FrameworkSingleton::getInstance()->depthImageView = createImageView(FrameworkSingleton::getInstance()->depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, FrameworkSingleton::getInstance()->twoDImageView);
+	// The pipelines being replaced are bound by the draw command buffers - make sure the last frame has finished with them
+	waitForFrame();
+	if (reloadMain)
+	{
+		reloadPipeline(false, vertPath, fragPath);
+	}
+	if (reloadSkybox)
+	{
+		reloadPipeline(true, skyVertPath, "shaders/skyFrag.spv");
+	}
+	if (reloadTerrain && isSpirvFile("shaders/terrainVert.spv") && isSpirvFile("shaders/frag.spv"))
+	{
+		FrameworkSingleton::getInstance()->terrainManager.reloadPipeline();
+	}
+	vkFreeCommandBuffers(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->commandPool, static_cast<uint32_t>(FrameworkSingleton::getInstance()->commandBuffers.size()), FrameworkSingleton::getInstance()->commandBuffers.data());
+	createCommandBuffers();
+}
 
-	// Transition to the image layout passing the depth image and format information to produce the depth buffering effect
-	transitionImageLayout(FrameworkSingleton::getInstance()->depthImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+// Function which checks a file holds SPIR-V - a shader half way through being compiled, or one that failed to compile, is not handed to the driver
+bool VulkanManager::isSpirvFile(const std::string &path)
+{
+	AssetFile file;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(path, file) || file.data() == nullptr || file.size() < 20 || file.size() % 4 != 0)
+	{
+		std::cerr << "Shader not reloaded: " + path + " is not a SPIR-V file" << std::endl;
+		return false;
+	}
+	uint32_t magic;
+	memcpy(&magic, file.data(), sizeof(magic));
+	if (magic != 0x07230203)
+	{
+		std::cerr << "Shader not reloaded: " + path + " is not a SPIR-V file" << std::endl;
+		return false;
+	}
+	return true;
 }
 
-// Function which finds the supported format based on the tiling mode and usuage - physical device is checked for support
-VkFormat VulkanManager::findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
+// Function which builds the main or skybox pipeline again from its shaders - the old pipeline is kept if the new one cannot be built
+void VulkanManager::reloadPipeline(bool skybox, const std::string &vertPath, const std::string &fragPath)
 {
-	// For all candiates
-	for (VkFormat format : candidates)
+	if (!isSpirvFile(vertPath) || !isSpirvFile(fragPath))
 	{
-		// Get the properties required to be compared against the physical device - checks for linear and optimal tiling features along with buffer features
-		VkFormatProperties props;
-		vkGetPhysicalDeviceFormatProperties(FrameworkSingleton::getInstance()->physicalDevice, format, &props);
+		return;
+	}
 
-		// If tiling type linear is supported then return format
-		if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features)
+	// Each pipeline has a layout of its own so the layout is swapped along with whichever pipeline is rebuilt
+	VkPipeline &pipeline = skybox ? FrameworkSingleton::getInstance()->skyboxGraphicsPipeline : FrameworkSingleton::getInstance()->graphicsPipeline;
+	VkPipelineLayout &pipelineLayout = skybox ? FrameworkSingleton::getInstance()->skyboxPipelineLayout : FrameworkSingleton::getInstance()->pipelineLayout;
+	VkPipeline oldPipeline = pipeline;
+	VkPipelineLayout oldPipelineLayout = pipelineLayout;
+	try
+	{
+		if (skybox)
 		{
-			return format;
+			createSkyboxGraphicsPipeline(vertPath, fragPath);
 		}
-		// Else if tiling type optimal is supported then return format
-		else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features)
+		else
 		{
-			return format;
+			createGraphicsPipeline(vertPath, fragPath);
 		}
 	}
-	// Else throw an error
-	throw std::runtime_error("failed to find supported format!");
+	catch (const std::runtime_error &e)
+	{
+		if (pipelineLayout != oldPipelineLayout)
+		{
+			vkDestroyPipelineLayout(FrameworkSingleton::getInstance()->device, pipelineLayout, nullptr);
+		}
+		pipelineLayout = oldPipelineLayout;
+		pipeline = oldPipeline;
+		std::cerr << "Shader not reloaded: " + vertPath + ", " + fragPath + " - " + e.what() << std::endl;
+		return;
+	}
+	vkDestroyPipeline(FrameworkSingleton::getInstance()->device, oldPipeline, nullptr);
+	vkDestroyPipelineLayout(FrameworkSingleton::getInstance()->device, oldPipelineLayout, nullptr);
 }
 
-// Helper function which is used to find the depth and format for the depth buffer
-VkFormat VulkanManager::findDepthFormat()
+// Struct which stores the result of deduplicating one chunk of a model's indices on a worker thread
+struct ModelChunk
 {
-	// Return the supported format from the find supported format function with all its data 
-	return findSupportedFormat(
-		{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
-	);
-}
-
-// Function which checks if the format has a stencil component
-bool VulkanManager::hasStencilComponent(VkFormat format) {
-
-	return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
-}
+	// Vertices that are unique within the chunk, in the order they were first seen
+	std::vector<Vertex> uniqueVertices;
+	// Indices into uniqueVertices for every index in the chunk
+	std::vector<uint32_t> localIndices;
+};
 
-// Function which specifies the type of texture sampler that will be used 
-void VulkanManager::createTextureSampler()
+// Function which reads the faces of one chunk of the OBJ file and deduplicates their vertices against a table owned by this chunk only - safe to run on many threads at once
+static void buildModelChunk(const ObjReader &objReader, size_t chunkIndex, ModelChunk &chunk, std::string &error)
 {
-	// Struct which specifies the sampler information
-	VkSamplerCreateInfo samplerInfo = {};
-	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO; // Specify the type of struct 
-	samplerInfo.magFilter = VK_FILTER_LINEAR; // specify how to interpolate texels that are magnified - set to linear
-	samplerInfo.minFilter = VK_FILTER_LINEAR; // specify how to interpolate texels that are minified - set to linear 
-	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT; // X - set the axis to repeat - means to stretching or wrapping the texture
-	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT; // Y - set the axis to repeat
-	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT; // Z - set the axis to repeat
-	samplerInfo.anisotropyEnable = VK_TRUE; // Set anisotropy filtering to true
-	samplerInfo.maxAnisotropy = 16; // Set the range to 16
-	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK; // Set the color which is returned when sampling beyond the image
-	samplerInfo.unnormalizedCoordinates = VK_FALSE; // Specifies which coordinate system you want to use to address texels in an image - false means range of 0 to 1
-	samplerInfo.compareEnable = VK_FALSE; // Set compare enable to false
-	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR; // Set mip map mode to linear 
-	samplerInfo.mipLodBias = 0.0f;
-	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
+	// Hash table which stores the unique vertices for this chunk only - no other thread touches it
+	VertexHashTable uniqueVertices;
 
-	// Initiate the texture sampler - if not successful throw an error 
-	if (vkCreateSampler(FrameworkSingleton::getInstance()->device, &samplerInfo, nullptr, &FrameworkSingleton::getInstance()->textureSampler) != VK_SUCCESS)
+	// Every triangle corner is built into a vertex and deduplicated as soon as it is read - no list of indices is kept for the whole file
+	objReader.readFaces(chunkIndex, [&](const ObjCorner &corner)
 	{
-		throw std::runtime_error("failed to create texture sampler!");
-	}
-}
+		// Find the vertex positions
+		Vertex vertex = {};
+		vertex.pos = {
+			objReader.positions[3 * corner.position + 0],
+			objReader.positions[3 * corner.position + 1],
+			objReader.positions[3 * corner.position + 2]
+		};
 
-// Function which is used to create a texture view for an image - used as part of the graphics pipeline and in the swap chain process 
-void VulkanManager::createTextureImageView(VkImage texture, VkImageView &textureImView, VkImageViewType &imageType)
-{
-	textureImView = createImageView(texture, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, imageType);
+		// Find the vertex texture coordinates - corners without one get the bottom left of the texture
+		if (corner.texCoord >= 0)
+		{
+			vertex.texCoord = {
+				objReader.texCoords[2 * corner.texCoord + 0],
+				1.0f - objReader.texCoords[2 * corner.texCoord + 1]
+			};
+		}
+		else
+		{
+			vertex.texCoord = { 0.0f, 1.0f };
+		}
+
+		// Set the vertex colour
+		vertex.color = { 1.0f, 1.0f, 1.0f };
+
+		// Add the vertex to the chunk if it has not been seen in this chunk before
+		chunk.localIndices.push_back(uniqueVertices.findOrInsert(vertex, chunk.uniqueVertices));
+	}, error);
 }
 
-void VulkanManager::createCubeTextureImageView(VkImage texture1, VkImage texture2, VkImage texture3, VkImage texture4, VkImage texture5, VkImage texture6, VkImageView &textureImView, VkImageViewType &imageType)
+// Function which loads a model - if modelLods is given then simplified levels of detail are appended to the indices after the full model
+void VulkanManager::loadModel(std::string modelPath, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods *modelLods)
 {
-	textureImView = createCubeImageView(texture1, texture2, texture3, texture4, texture5, texture6, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, imageType);
+	AssetFile sourceFile;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(modelPath, sourceFile))
+	{
+		throw std::runtime_error("failed to open model file!");
+	}
+	loadModel(modelPath, sourceFile, modelVertices, modelIndices, modelLods);
 }
 
-// Function which creates and returns an image view
-VkImageView VulkanManager::createCubeImageView(VkImage image1, VkImage image2, VkImage image3, VkImage image4, VkImage image5, VkImage image6, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType &imageType)
+// Function which loads a model from its file once it is open - the file is only mapped once however many passes read it, and is closed once every vertex is built
+void VulkanManager::loadModel(const std::string &modelPath, AssetFile &sourceFile, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods *modelLods)
 {
-	// Struct which contains information regarding the creation of the image view 
-	VkImageViewCreateInfo viewInfo = {};
-	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO; // Set struct type
-	viewInfo.image = image1, image2, image3, image4, image5, image6; // Image to image
-	viewInfo.viewType = imageType; // Image dimensions to one
-	viewInfo.format = format; // Format to format 
-	viewInfo.subresourceRange.aspectMask = aspectFlags;
-	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
-	viewInfo.subresourceRange.baseArrayLayer = 0;
-	viewInfo.subresourceRange.layerCount = 6;
+	// Hash the model file so a cache written from an older version of the file is never used - models in the asset pack have their hash stored with them
+	uint64_t sourceHash = sourceFile.contentHash();
+	uint64_t sourceSize = sourceFile.size();
 
-	// Image view object
-	VkImageView imageView;
-	// Initiate the image view - if not successful throw an error
-	if (vkCreateImageView(FrameworkSingleton::getInstance()->device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+	// If a cache for this exact file exists then use it and skip parsing the model altogether
+	std::string cachePath = modelPath + ".meshcache";
+	if (FrameworkSingleton::getInstance()->useModelCache && loadModelCache(cachePath, sourceHash, sourceSize, modelVertices, modelIndices, modelLods))
 	{
-		throw std::runtime_error("failed to create texture image view!");
+		return;
 	}
 
-	// Return the image view 
-	return imageView;
-}
+	// Remember where this model starts so only its own vertices and indices are written to the cache
+	size_t vertexBase = modelVertices.size();
+	size_t indexBase = modelIndices.size();
 
-// Function which creates and returns an image view
-VkImageView VulkanManager::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType &imageType)
-{
-	// Struct which contains information regarding the creation of the image view 
-	VkImageViewCreateInfo viewInfo = {};
-	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO; // Set struct type
-	viewInfo.image = image; // Image to image
+	// Binary glTF files are already indexed so their vertices and indices are copied straight out - anything else is read as an OBJ file
+	if (modelPath.size() > 4 && modelPath.compare(modelPath.size() - 4, 4, ".glb") == 0)
+	{
+		readGltfModel(sourceFile.data(), sourceFile.size(), modelVertices, modelIndices);
+	}
+	else
+	{
+		readObjModel(sourceFile.data(), sourceFile.size(), modelVertices, modelIndices);
+	}
+	// The file is not needed once every vertex is built
+	sourceFile.close();
+
+	// Optimise the triangle and vertex order of the new model - it only covers the part of the arrays this model appended
+	if (FrameworkSingleton::getInstance()->optimiseMeshes)
+	{
+		std::vector<Vertex> meshVertices(modelVertices.begin() + vertexBase, modelVertices.end());
+		std::vector<uint32_t> meshIndices(modelIndices.begin() + indexBase, modelIndices.end());
+		for (auto& index : meshIndices)
+		{
+			index -= static_cast<uint32_t>(vertexBase);
+		}
+
+		MeshOptimiser meshOptimiser;
+		meshOptimiser.optimiseMesh(meshVertices, meshIndices);
+
+		std::copy(meshVertices.begin(), meshVertices.end(), modelVertices.begin() + vertexBase);
+		for (size_t i = 0; i < meshIndices.size(); i++)
+		{
+			modelIndices[indexBase + i] = meshIndices[i] + static_cast<uint32_t>(vertexBase);
+		}
+	}
+
+	// Build the levels of detail from the optimised model so they share its vertices
+	if (modelLods)
+	{
+		if (FrameworkSingleton::getInstance()->generateMeshLods)
+		{
+			MeshSimplifier meshSimplifier;
+			meshSimplifier.generateLods(modelVertices, vertexBase, modelIndices, indexBase, FrameworkSingleton::getInstance()->meshLodCount, *modelLods);
+		}
+		else
+		{
+			MeshSimplifier::computeBounds(modelVertices, vertexBase, *modelLods);
+			modelLods->levels.assign(1, { 0, static_cast<uint32_t>(modelIndices.size() - indexBase), 0.0f });
+		}
+		// Meshlets are rebuilt on every load rather than cached since they only take a scan of the indices
+		if (FrameworkSingleton::getInstance()->useMeshletCulling)
+		{
+			MeshletBuilder().buildMeshlets(modelVertices, modelIndices.data() + indexBase, *modelLods);
+		}
+	}
+
+	// Write the deduplicated model out so the next launch can skip parsing
+	if (FrameworkSingleton::getInstance()->useModelCache)
+	{
+		saveModelCache(cachePath, sourceHash, sourceSize, modelVertices, modelIndices, vertexBase, indexBase, modelLods);
+	}
+}
+
+// Function which loads a model and creates its vertex and index buffers - if the asset registry already holds a model with the same contents
+// its buffers, indices and levels of detail are shared instead and the file is not parsed
+void VulkanManager::createModelBuffers(const std::string &modelPath, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods &modelLods, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range)
+{
+	// The file is opened once - the same mapping is hashed for its content key and then parsed
+	AssetFile sourceFile;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(modelPath, sourceFile))
+	{
+		throw std::runtime_error("failed to open model file!");
+	}
+	uint64_t contentKey = FrameworkSingleton::getInstance()->assetRegistry.contentKey(sourceFile);
+	if (FrameworkSingleton::getInstance()->assetRegistry.acquireModel(contentKey, modelIndices, modelLods, vertexBuffer, dequantisation, indexBuffer, indexType, range))
+	{
+		return;
+	}
+	loadModel(modelPath, sourceFile, modelVertices, modelIndices, &modelLods);
+	createMeshBuffers(modelVertices, modelIndices, vertexBuffer, dequantisation, indexBuffer, indexType, range);
+	FrameworkSingleton::getInstance()->assetRegistry.addModel(contentKey, modelIndices, modelLods, vertexBuffer, dequantisation, indexBuffer, indexType, range);
+}
+
+// Function which reads an OBJ file and appends its deduplicated vertices and indices to the model
+void VulkanManager::readObjModel(const uint8_t *data, size_t size, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices)
+{
+	size_t indexBase = modelIndices.size();
+
+	// Read the model's positions and texture coordinates - the file is split into one chunk of lines for each thread pool worker and the calling thread
+	ThreadPool &threadPool = FrameworkSingleton::getInstance()->threadPool;
+	ObjReader objReader;
+	std::string err;
+	if (!objReader.open(data, size, static_cast<unsigned int>(threadPool.threadCount() + 1), err))
+	{
+		throw std::runtime_error(err);
+	}
+	unsigned int threadCount = static_cast<unsigned int>(objReader.chunkCount());
+
+	// Read and deduplicate each chunk's faces on the thread pool - each call only writes to its own chunk so nothing is shared
+	std::vector<ModelChunk> chunks(threadCount);
+	std::vector<std::string> chunkErrors(threadCount);
+	threadPool.parallelFor(threadCount, [&](size_t t)
+	{
+		buildModelChunk(objReader, t, chunks[t], chunkErrors[t]);
+	});
+	for (const auto& chunkError : chunkErrors)
+	{
+		if (!chunkError.empty())
+		{
+			throw std::runtime_error(chunkError);
+		}
+	}
+
+	// The positions and texture coordinates are not needed once every vertex is built
+	objReader.close();
+
+	// Work out where each chunk's indices start in the final index list
+	std::vector<size_t> chunkOffsets(threadCount + 1, 0);
+	for (unsigned int t = 0; t < threadCount; t++)
+	{
+		chunkOffsets[t + 1] = chunkOffsets[t] + chunks[t].localIndices.size();
+	}
+	size_t indexCount = chunkOffsets[threadCount];
+
+	// Merge the chunks in order - each chunk lists its vertices in first-seen order so walking the chunks in order gives every vertex
+	// the same index a single threaded pass over the whole model would have given it
+	VertexHashTable uniqueVertices;
+	uniqueVertices.reserveForIndexCount(indexCount);
+	std::vector<std::vector<uint32_t>> chunkRemaps(threadCount);
+	for (unsigned int t = 0; t < threadCount; t++)
+	{
+		chunkRemaps[t].resize(chunks[t].uniqueVertices.size());
+		for (size_t v = 0; v < chunks[t].uniqueVertices.size(); v++)
+		{
+			chunkRemaps[t][v] = uniqueVertices.findOrInsert(chunks[t].uniqueVertices[v], modelVertices);
+		}
+	}
+
+	// Rewrite each chunk's local indices into the final index list - chunks write to separate ranges so this can run in parallel too
+	modelIndices.resize(indexBase + indexCount);
+	threadPool.parallelFor(threadCount, [&](size_t t)
+	{
+		uint32_t *out = modelIndices.data() + indexBase + chunkOffsets[t];
+		for (size_t i = 0; i < chunks[t].localIndices.size(); i++)
+		{
+			out[i] = chunkRemaps[t][chunks[t].localIndices[i]];
+		}
+	});
+}
+
+// Function which reads a binary glTF file and appends every mesh the default scene draws to the model
+// The file is already indexed so there is no deduplication - vertices are interleaved from the accessors and indices are copied, in one block when they are already 32 bit
+void VulkanManager::readGltfModel(const uint8_t *data, size_t size, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices)
+{
+	GltfReader gltfReader;
+	std::string err;
+	if (!gltfReader.open(data, size, err))
+	{
+		throw std::runtime_error(err);
+	}
+
+	// Size the arrays once so every primitive is written in place
+	size_t firstIndex = modelIndices.size();
+	size_t vertexTotal = modelVertices.size(), indexTotal = modelIndices.size();
+	for (const auto& instance : gltfReader.instances)
+	{
+		for (const auto& primitive : gltfReader.meshes[instance.mesh])
+		{
+			size_t vertexCount = gltfReader.accessors[primitive.position].count;
+			vertexTotal += vertexCount;
+			indexTotal += primitive.indices >= 0 ? gltfReader.accessors[primitive.indices].count / 3 * 3 : vertexCount / 3 * 3;
+		}
+	}
+	modelVertices.reserve(vertexTotal);
+	modelIndices.reserve(indexTotal);
+
+	for (const auto& instance : gltfReader.instances)
+	{
+		// Mirroring transforms turn the triangles inside out so their winding is swapped back
+		bool identity = instance.transform == glm::mat4(1.0f);
+		bool mirrored = glm::determinant(glm::mat3(instance.transform)) < 0.0f;
+		for (const auto& primitive : gltfReader.meshes[instance.mesh])
+		{
+			const GltfAccessor &positions = gltfReader.accessors[primitive.position];
+			uint32_t vertexBase = static_cast<uint32_t>(modelVertices.size());
+			modelVertices.resize(vertexBase + positions.count);
+			Vertex *vertices = modelVertices.data() + vertexBase;
+
+			// Vertices without texture coordinates get the bottom left of the texture as OBJ vertices do - glTF puts the texture origin at the top left as Vulkan does
+			for (size_t v = 0; v < positions.count; v++)
+			{
+				memcpy(&vertices[v].pos, positions.data + v * positions.stride, sizeof(glm::vec3));
+				if (!identity)
+				{
+					vertices[v].pos = glm::vec3(instance.transform * glm::vec4(vertices[v].pos, 1.0f));
+				}
+				vertices[v].color = { 1.0f, 1.0f, 1.0f };
+				vertices[v].texCoord = { 0.0f, 1.0f };
+			}
+			if (primitive.texCoord >= 0)
+			{
+				const GltfAccessor &texCoords = gltfReader.accessors[primitive.texCoord];
+				for (size_t v = 0; v < texCoords.count; v++)
+				{
+					vertices[v].texCoord = { GltfReader::readFloat(texCoords, v, 0), GltfReader::readFloat(texCoords, v, 1) };
+				}
+			}
+			if (primitive.color >= 0)
+			{
+				const GltfAccessor &colors = gltfReader.accessors[primitive.color];
+				for (size_t v = 0; v < colors.count; v++)
+				{
+					vertices[v].color = { GltfReader::readFloat(colors, v, 0), GltfReader::readFloat(colors, v, 1), GltfReader::readFloat(colors, v, 2) };
+				}
+			}
+
+			// Unindexed primitives draw every vertex in order - a trailing part triangle is dropped
+			size_t indexBase = modelIndices.size();
+			if (primitive.indices < 0)
+			{
+				modelIndices.resize(indexBase + positions.count / 3 * 3);
+				for (size_t i = indexBase; i < modelIndices.size(); i++)
+				{
+					modelIndices[i] = vertexBase + static_cast<uint32_t>(i - indexBase);
+				}
+			}
+			else
+			{
+				const GltfAccessor &indices = gltfReader.accessors[primitive.indices];
+				modelIndices.resize(indexBase + indices.count / 3 * 3);
+				uint32_t *out = modelIndices.data() + indexBase;
+				size_t indexCount = modelIndices.size() - indexBase;
+				if (indices.componentType == gltfUnsignedInt && indices.stride == sizeof(uint32_t))
+				{
+					memcpy(out, indices.data, indexCount * sizeof(uint32_t));
+					if (vertexBase != 0)
+					{
+						for (size_t i = 0; i < indexCount; i++)
+						{
+							out[i] += vertexBase;
+						}
+					}
+				}
+				else
+				{
+					for (size_t i = 0; i < indexCount; i++)
+					{
+						out[i] = vertexBase + GltfReader::readIndex(indices, i);
+					}
+				}
+			}
+			if (mirrored)
+			{
+				for (size_t i = indexBase; i + 2 < modelIndices.size(); i += 3)
+				{
+					std::swap(modelIndices[i + 1], modelIndices[i + 2]);
+				}
+			}
+		}
+	}
+
+	if (modelIndices.size() == firstIndex)
+	{
+		throw std::runtime_error("failed to read glTF file - it has no triangles!");
+	}
+}
+
+// Header at the start of every mesh cache file - the vertex and index arrays follow it directly
+struct MeshCacheHeader
+{
+	char magic[4]; // Always "VFMC"
+	uint32_t version; // Bumped whenever the layout or content of the cache changes
+	uint64_t sourceHash; // Hash of the model file the cache was built from
+	uint64_t sourceSize; // Size of the model file the cache was built from
+	uint32_t vertexStride; // sizeof(Vertex) when the cache was written
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t optimised; // 1 if the mesh optimiser was run on the model before it was cached
+	uint32_t lodTarget; // Number of levels of detail that were asked for - 1 if none were generated
+	uint32_t lodCount; // Number of levels of detail stored after the indices - the indices hold every level one after another
+};
+
+// Version of the mesh cache format - caches with any other version are ignored and rebuilt
+const uint32_t meshCacheVersion = 4;
+
+// Function which loads a deduplicated model from a mesh cache file - returns false if there is no valid cache for the model
+bool VulkanManager::loadModelCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods *modelLods)
+{
+	// Open the cache file - if it does not exist then the model has to be parsed
+	AssetFile cacheFile;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(cachePath, cacheFile) || cacheFile.size() < sizeof(MeshCacheHeader) || cacheFile.data() == nullptr)
+	{
+		return false;
+	}
+
+	// Check the cache was built from this exact model file with the current format
+	MeshCacheHeader header;
+	memcpy(&header, cacheFile.data(), sizeof(header));
+	if (memcmp(header.magic, "VFMC", 4) != 0 || header.version != meshCacheVersion || header.sourceHash != sourceHash || header.sourceSize != sourceSize || header.vertexStride != sizeof(Vertex) || header.optimised != (FrameworkSingleton::getInstance()->optimiseMeshes ? 1u : 0u))
+	{
+		return false;
+	}
+
+	// Check the cache holds the levels of detail being asked for - a cache with levels of detail can still give just the full model
+	uint32_t lodTarget = modelLods && FrameworkSingleton::getInstance()->generateMeshLods ? FrameworkSingleton::getInstance()->meshLodCount : 1;
+	if (lodTarget > 1 && header.lodTarget != lodTarget)
+	{
+		return false;
+	}
+
+	// Check each array the header describes fits in what is left of the file - worked out in 64 bits so a bad count cannot wrap size_t round on 32 bit builds
+	uint64_t bytesLeft = static_cast<uint64_t>(cacheFile.size()) - sizeof(MeshCacheHeader);
+	uint64_t cachedVertexBytes = static_cast<uint64_t>(header.vertexCount) * sizeof(Vertex);
+	if (cachedVertexBytes > bytesLeft)
+	{
+		return false;
+	}
+	bytesLeft -= cachedVertexBytes;
+	uint64_t cachedIndexBytes = static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t);
+	if (cachedIndexBytes > bytesLeft)
+	{
+		return false;
+	}
+	bytesLeft -= cachedIndexBytes;
+	uint64_t cachedLodBytes = static_cast<uint64_t>(header.lodCount) * sizeof(MeshLod);
+	if (cachedLodBytes > bytesLeft)
+	{
+		return false;
+	}
+	// Every array lies inside the mapped file so each size fits in size_t
+	size_t vertexBytes = static_cast<size_t>(cachedVertexBytes);
+	size_t indexBytes = static_cast<size_t>(cachedIndexBytes);
+	size_t lodBytes = static_cast<size_t>(cachedLodBytes);
+	const uint8_t* cacheData = cacheFile.data() + sizeof(MeshCacheHeader);
+	std::vector<MeshLod> cachedLods(header.lodCount);
+	memcpy(cachedLods.data(), cacheData + vertexBytes + indexBytes, lodBytes);
+	if (cachedLods.empty())
+	{
+		cachedLods.push_back({ 0, header.indexCount, 0.0f });
+	}
+
+	// Check every level lies inside the cached indices and the full model starts at the first of them
+	if (cachedLods[0].firstIndex != 0)
+	{
+		return false;
+	}
+	for (const auto& level : cachedLods)
+	{
+		if (static_cast<uint64_t>(level.firstIndex) + level.indexCount > header.indexCount)
+		{
+			return false;
+		}
+	}
+
+	// Leave the other levels out when only the full model is wanted
+	if (lodTarget == 1)
+	{
+		cachedLods.resize(1);
+		indexBytes = static_cast<size_t>(cachedLods[0].indexCount) * sizeof(uint32_t);
+	}
+
+	// Copy the arrays straight out of the mapped file
+	size_t vertexBase = modelVertices.size();
+	size_t indexBase = modelIndices.size();
+	modelVertices.resize(vertexBase + header.vertexCount);
+	modelIndices.resize(indexBase + indexBytes / sizeof(uint32_t));
+	memcpy(modelVertices.data() + vertexBase, cacheData, vertexBytes);
+	memcpy(modelIndices.data() + indexBase, cacheData + vertexBytes, indexBytes);
+
+	// Check every index points at a cached vertex - the arrays are put back as they were so the model can be parsed instead
+	for (size_t i = indexBase; i < modelIndices.size(); i++)
+	{
+		if (modelIndices[i] >= header.vertexCount)
+		{
+			modelVertices.resize(vertexBase);
+			modelIndices.resize(indexBase);
+			return false;
+		}
+	}
+
+	if (modelLods)
+	{
+		modelLods->levels.swap(cachedLods);
+		MeshSimplifier::computeBounds(modelVertices, vertexBase, *modelLods);
+	}
+
+	// Indices in the cache start at zero - offset them if the model was appended to existing vertices
+	if (vertexBase != 0)
+	{
+		for (size_t i = indexBase; i < modelIndices.size(); i++)
+		{
+			modelIndices[i] += static_cast<uint32_t>(vertexBase);
+		}
+	}
+
+	// Split the levels into meshlets once the indices point at the right vertices
+	if (modelLods && FrameworkSingleton::getInstance()->useMeshletCulling)
+	{
+		MeshletBuilder().buildMeshlets(modelVertices, modelIndices.data() + indexBase, *modelLods);
+	}
+
+	return true;
+}
+
+// Function which writes the vertices and indices a model added to the vectors out to a mesh cache file
+void VulkanManager::saveModelCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, const std::vector<Vertex> &modelVertices, const std::vector<uint32_t> &modelIndices, size_t vertexBase, size_t indexBase, const MeshLods *modelLods)
+{
+	MeshCacheHeader header = {};
+	memcpy(header.magic, "VFMC", 4);
+	header.version = meshCacheVersion;
+	header.sourceHash = sourceHash;
+	header.sourceSize = sourceSize;
+	header.vertexStride = sizeof(Vertex);
+	header.vertexCount = static_cast<uint32_t>(modelVertices.size() - vertexBase);
+	header.indexCount = static_cast<uint32_t>(modelIndices.size() - indexBase);
+	header.optimised = FrameworkSingleton::getInstance()->optimiseMeshes ? 1 : 0;
+	header.lodTarget = modelLods && FrameworkSingleton::getInstance()->generateMeshLods ? FrameworkSingleton::getInstance()->meshLodCount : 1;
+	header.lodCount = modelLods ? static_cast<uint32_t>(modelLods->levels.size()) : 0;
+
+	// Cached indices always start at zero
+	std::vector<uint32_t> cacheIndices(modelIndices.begin() + indexBase, modelIndices.end());
+	for (auto& index : cacheIndices)
+	{
+		index -= static_cast<uint32_t>(vertexBase);
+	}
+
+	// Write to a temporary file first so a half written cache is never picked up by a later run
+	std::string tempPath = cachePath + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cerr << "failed to write mesh cache " << cachePath << std::endl;
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(modelVertices.data() + vertexBase), header.vertexCount * sizeof(Vertex));
+	file.write(reinterpret_cast<const char*>(cacheIndices.data()), cacheIndices.size() * sizeof(uint32_t));
+	if (modelLods)
+	{
+		file.write(reinterpret_cast<const char*>(modelLods->levels.data()), modelLods->levels.size() * sizeof(MeshLod));
+	}
+	file.close();
+
+	if (!file)
+	{
+		std::remove(tempPath.c_str());
+		std::cerr << "failed to write mesh cache " << cachePath << std::endl;
+		return;
+	}
+
+	// Replace any old cache with the new one
+	std::remove(cachePath.c_str());
+	if (std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+	{
+		std::remove(tempPath.c_str());
+		std::cerr << "failed to write mesh cache " << cachePath << std::endl;
+	}
+}
+
+void VulkanManager::createDepthResources()
+{
+	// Find the depth format that will be used
+	VkFormat depthFormat = findDepthFormat();
+
+	// Call the create image and depth image view functions now that we know what formats of depth buffer are supported 
+	createImage(FrameworkSingleton::getInstance()->swapChainExtent.width, FrameworkSingleton::getInstance()->swapChainExtent.height, 1, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, FrameworkSingleton::getInstance()->depthImage);
+	FrameworkSingleton::getInstance()->depthImageView = createImageView(FrameworkSingleton::getInstance()->depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, FrameworkSingleton::getInstance()->twoDImageView);
+
+	// Transition to the image layout passing the depth image and format information to produce the depth buffering effect
+	transitionImageLayout(FrameworkSingleton::getInstance()->depthImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+}
+
+// Function which finds the supported format based on the tiling mode and usuage - physical device is checked for support
+VkFormat VulkanManager::findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
+{
+	// For all candiates
+	for (VkFormat format : candidates)
+	{
+		// Get the properties required to be compared against the physical device - checks for linear and optimal tiling features along with buffer features
+		VkFormatProperties props;
+		vkGetPhysicalDeviceFormatProperties(FrameworkSingleton::getInstance()->physicalDevice, format, &props);
+
+		// If tiling type linear is supported then return format
+		if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features)
+		{
+			return format;
+		}
+		// Else if tiling type optimal is supported then return format
+		else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features)
+		{
+			return format;
+		}
+	}
+	// Else throw an error
+	throw std::runtime_error("failed to find supported format!");
+}
+
+// Helper function which is used to find the depth and format for the depth buffer
+VkFormat VulkanManager::findDepthFormat()
+{
+	// Return the supported format from the find supported format function with all its data 
+	return findSupportedFormat(
+		{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+	);
+}
+
+// Function which checks if the format has a stencil component
+bool VulkanManager::hasStencilComponent(VkFormat format) {
+
+	return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
+}
+
+// Function which specifies the type of texture sampler that will be used 
+void VulkanManager::createTextureSampler()
+{
+	// Struct which specifies the sampler information
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO; // Specify the type of struct 
+	samplerInfo.magFilter = VK_FILTER_LINEAR; // specify how to interpolate texels that are magnified - set to linear
+	samplerInfo.minFilter = VK_FILTER_LINEAR; // specify how to interpolate texels that are minified - set to linear 
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT; // X - set the axis to repeat - means to stretching or wrapping the texture
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT; // Y - set the axis to repeat
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT; // Z - set the axis to repeat
+	samplerInfo.anisotropyEnable = VK_TRUE; // Set anisotropy filtering to true
+	samplerInfo.maxAnisotropy = 16; // Set the range to 16
+	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK; // Set the color which is returned when sampling beyond the image
+	samplerInfo.unnormalizedCoordinates = VK_FALSE; // Specifies which coordinate system you want to use to address texels in an image - false means range of 0 to 1
+	samplerInfo.compareEnable = VK_FALSE; // Set compare enable to false
+	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR; // Set mip map mode to linear 
+	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = static_cast<float>(FrameworkSingleton::getInstance()->textureMipLevels); // Allow every mip level of the texture with the most levels
+	if (FrameworkSingleton::getInstance()->streamAssets)
+	{
+		// Streamed textures have not been loaded yet so their levels are unknown - each view already limits sampling to the levels its image has
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+	}
+
+	// Initiate the texture sampler - if not successful throw an error 
+	if (vkCreateSampler(FrameworkSingleton::getInstance()->device, &samplerInfo, nullptr, &FrameworkSingleton::getInstance()->textureSampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create texture sampler!");
+	}
+}
+
+// Function which is used to create a texture view for an image - used as part of the graphics pipeline and in the swap chain process 
+// Texture views cover every mip level the image has
+void VulkanManager::createTextureImageView(VkImage texture, VkFormat textureFormat, VkImageView &textureImView, VkImageViewType &imageType)
+{
+	textureImView = createImageView(texture, textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_REMAINING_MIP_LEVELS, imageType);
+}
+
+// Function which creates the view the skybox is sampled through - a cube view of the cube map when the skybox is loaded from one, otherwise built around the six face images
+void VulkanManager::createSkyboxImageView()
+{
+	if (FrameworkSingleton::getInstance()->skyboxCubeMapActive)
+	{
+		FrameworkSingleton::getInstance()->skyboxImageView = createImageView(FrameworkSingleton::getInstance()->skyboxCubeMap, FrameworkSingleton::getInstance()->skyboxTextureFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_REMAINING_MIP_LEVELS, FrameworkSingleton::getInstance()->cubeImageView, 0, 6);
+		return;
+	}
+
+	// One view covers all six faces so they must have been uploaded in the same format
+	VkFormat faceFormats[6] = { FrameworkSingleton::getInstance()->topSkyTextureFormat, FrameworkSingleton::getInstance()->bottomSkyTextureFormat, FrameworkSingleton::getInstance()->leftSkyTextureFormat,
+		FrameworkSingleton::getInstance()->rightSkyTextureFormat, FrameworkSingleton::getInstance()->frontSkyTextureFormat, FrameworkSingleton::getInstance()->backSkyTextureFormat };
+	for (auto faceFormat : faceFormats)
+	{
+		if (faceFormat != faceFormats[0])
+		{
+			throw std::runtime_error("failed to create skybox image view - the skybox faces were not uploaded in the same format!");
+		}
+	}
+	FrameworkSingleton::getInstance()->skyboxTextureFormat = faceFormats[0];
+	createCubeTextureImageView(FrameworkSingleton::getInstance()->topSkyTexture, FrameworkSingleton::getInstance()->bottomSkyTexture, FrameworkSingleton::getInstance()->leftSkyTexture, FrameworkSingleton::getInstance()->rightSkyTexture, FrameworkSingleton::getInstance()->frontSkyTexture, FrameworkSingleton::getInstance()->backSkyTexture, FrameworkSingleton::getInstance()->skyboxTextureFormat, FrameworkSingleton::getInstance()->skyboxImageView, FrameworkSingleton::getInstance()->twoDImageView);
+}
+
+void VulkanManager::createCubeTextureImageView(VkImage texture1, VkImage texture2, VkImage texture3, VkImage texture4, VkImage texture5, VkImage texture6, VkFormat textureFormat, VkImageView &textureImView, VkImageViewType &imageType)
+{
+	textureImView = createCubeImageView(texture1, texture2, texture3, texture4, texture5, texture6, textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_REMAINING_MIP_LEVELS, imageType);
+}
+
+// Function which creates and returns an image view
+VkImageView VulkanManager::createCubeImageView(VkImage image1, VkImage image2, VkImage image3, VkImage image4, VkImage image5, VkImage image6, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageViewType &imageType)
+{
+	// Struct which contains information regarding the creation of the image view 
+	VkImageViewCreateInfo viewInfo = {};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO; // Set struct type
+	viewInfo.image = image1, image2, image3, image4, image5, image6; // Image to image
 	viewInfo.viewType = imageType; // Image dimensions to one
 	viewInfo.format = format; // Format to format 
 	viewInfo.subresourceRange.aspectMask = aspectFlags;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
-	viewInfo.subresourceRange.layerCount = 1;
+	viewInfo.subresourceRange.layerCount = 6;
+
+	// Image view object
+	VkImageView imageView;
+	// Initiate the image view - if not successful throw an error
+	if (vkCreateImageView(FrameworkSingleton::getInstance()->device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create texture image view!");
+	}
+
+	// Return the image view 
+	return imageView;
+}
+
+// Function which creates and returns an image view
+// baseArrayLayer and arrayLayers pick the layers of an array image the view covers
+VkImageView VulkanManager::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageViewType &imageType, uint32_t baseArrayLayer, uint32_t arrayLayers)
+{
+	// Struct which contains information regarding the creation of the image view 
+	VkImageViewCreateInfo viewInfo = {};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO; // Set struct type
+	viewInfo.image = image; // Image to image
+	viewInfo.viewType = imageType; // Image dimensions to one
+	viewInfo.format = format; // Format to format 
+	viewInfo.subresourceRange.aspectMask = aspectFlags;
+	viewInfo.subresourceRange.baseMipLevel = 0;
+	viewInfo.subresourceRange.levelCount = mipLevels;
+	viewInfo.subresourceRange.baseArrayLayer = baseArrayLayer;
+	viewInfo.subresourceRange.layerCount = arrayLayers;
+
+	// Image view object
+	VkImageView imageView;
+	// Initiate the image view - if not successful throw an error
+	if (vkCreateImageView(FrameworkSingleton::getInstance()->device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create texture image view!");
+	}
+
+	// Return the image view 
+	return imageView;
+}
+
+// Function which works out how many top levels a texture of this size can lose - never so many it ends up under textureBudgetMinimumExtent along its longest side
+static uint32_t clampLevelsDropped(uint32_t width, uint32_t height, uint32_t levelsDropped)
+{
+	while (levelsDropped > 0 && (std::max(width, height) >> levelsDropped) < textureBudgetMinimumExtent)
+	{
+		levelsDropped--;
+	}
+	return levelsDropped;
+}
+
+// Function which removes the top levels of a decoded texture's mip chain - the next level down becomes level 0
+static void dropTopLevels(DecodedTexture &texture, uint32_t levelsDropped)
+{
+	size_t droppedSize = 0;
+	for (uint32_t level = 0; level < levelsDropped; level++)
+	{
+		droppedSize += TextureCompressor::compressedSize(MipmapGenerator::levelExtent(texture.width, level), MipmapGenerator::levelExtent(texture.height, level), texture.format);
+	}
+	if (!texture.levels.empty())
+	{
+		texture.levels.erase(texture.levels.begin(), texture.levels.begin() + levelsDropped);
+	}
+	else if (texture.packedData)
+	{
+		texture.packedData += droppedSize;
+		texture.packedSize -= droppedSize;
+	}
+	else
+	{
+		texture.data.erase(texture.data.begin(), texture.data.begin() + droppedSize);
+	}
+	texture.width = MipmapGenerator::levelExtent(texture.width, levelsDropped);
+	texture.height = MipmapGenerator::levelExtent(texture.height, levelsDropped);
+	texture.mipLevels -= levelsDropped;
+}
+
+// Function which decodes an image and builds its mip chain, or reads both from the texture cache, ready to upload - safe to call on many threads at once
+// Textures the texture budget scales down lose their top mip levels, or are downscaled before their mip chain is built when they have no levels to lose
+void VulkanManager::decodeTexture(const std::string &textureName, DecodedTexture &texture)
+{
+	// KTX files already hold their levels in the format they are uploaded in so they are neither decoded nor cached
+	if (KtxReader::isKtxPath(textureName))
+	{
+		loadKtxTexture(textureName, texture);
+		return;
+	}
+
+	// Open and hash the image file so a cache written from an older version of the image is never used - images in the asset pack have their hash stored with them
+	AssetFile sourceFile;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(textureName, sourceFile))
+	{
+		texture.error = "failed to load texture image!";
+		return;
+	}
+	uint64_t sourceHash = sourceFile.contentHash();
+	uint64_t sourceSize = sourceFile.size();
+
+	// Only compress when the device can sample BC formats
+	TextureFormat requestedFormat = TEXTURE_FORMAT_RGBA8;
+	if (FrameworkSingleton::getInstance()->compressTextures && FrameworkSingleton::getInstance()->textureCompressionBCSupported)
+	{
+		requestedFormat = FrameworkSingleton::getInstance()->textureCompressionFormat;
+	}
+
+	// Top levels the texture budget takes off this texture
+	uint32_t levelsDropped = FrameworkSingleton::getInstance()->textureBudget.levelsDropped(textureName);
+
+	// If a cache for this exact image exists then upload its blocks and skip decoding altogether
+	texture.format = requestedFormat;
+	std::string cachePath = textureName + ".texcache";
+	if (requestedFormat != TEXTURE_FORMAT_RGBA8 && loadTextureCache(cachePath, sourceHash, sourceSize, requestedFormat, texture.format, texture.width, texture.height, texture.mipLevels, texture.data, texture.packedData, texture.packedSize))
+	{
+		// The cache holds the whole mip chain so scaling down only skips its top levels
+		levelsDropped = clampLevelsDropped(texture.width, texture.height, levelsDropped);
+		if (texture.mipLevels > levelsDropped)
+		{
+			dropTopLevels(texture, levelsDropped);
+			return;
+		}
+		// A cache without levels to skip to is decoded again and downscaled instead
+		std::vector<uint8_t>().swap(texture.data);
+		texture.packedData = nullptr;
+		texture.packedSize = 0;
+		texture.format = requestedFormat;
+	}
+
+	// Use the STBI image loader to decode the image straight from the mapped file
+	int texWidth, texHeight, texChannels;
+	const uint8_t* sourceData = sourceFile.data();
+	stbi_uc* pixels = sourceData ? stbi_load_from_memory(sourceData, static_cast<int>(sourceFile.size()), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha) : nullptr;
+	sourceFile.close();
+
+	// If pixels do not exist then report the error
+	if (!pixels)
+	{
+		texture.error = "failed to load texture image!";
+		return;
+	}
+	texture.width = static_cast<uint32_t>(texWidth);
+	texture.height = static_cast<uint32_t>(texHeight);
+	levelsDropped = clampLevelsDropped(texture.width, texture.height, levelsDropped);
+
+	// Compressed textures with a mip chain are compressed whole so their texture cache suits every quality, then lose their top levels
+	// Anything else is downscaled with the mip chain's box filter before its mip chain is built - such a texture's cache would only suit this quality so none is written
+	bool skipTopLevels = requestedFormat != TEXTURE_FORMAT_RGBA8 && FrameworkSingleton::getInstance()->generateMipmaps;
+	std::vector<uint8_t> downscaledPixels;
+	const uint8_t *imagePixels = pixels;
+	if (levelsDropped > 0 && !skipTopLevels)
+	{
+		MipmapGenerator downscaler;
+		downscaler.downscale(pixels, texture.width, texture.height, levelsDropped, downscaledPixels, texture.width, texture.height);
+		stbi_image_free(pixels);
+		pixels = nullptr;
+		imagePixels = downscaledPixels.data();
+	}
+	texture.mipLevels = FrameworkSingleton::getInstance()->generateMipmaps ? MipmapGenerator::mipLevelCount(texture.width, texture.height) : 1;
+
+	// Uncompressed textures can have their mip chain blitted on the GPU instead - compressed formats cannot be blitted to
+	if (requestedFormat == TEXTURE_FORMAT_RGBA8 && texture.mipLevels > 1 && FrameworkSingleton::getInstance()->generateMipmapsOnGpu && FrameworkSingleton::getInstance()->textureMipmapBlitSupported)
+	{
+		texture.generateMipmapsOnGpu = true;
+		texture.data.assign(imagePixels, imagePixels + static_cast<size_t>(texture.width) * texture.height * 4);
+		stbi_image_free(pixels);
+		return;
+	}
+
+	// Build the mip chain on the CPU
+	std::vector<uint8_t> levels;
+	MipmapGenerator mipmapGenerator;
+	mipmapGenerator.generate(imagePixels, texture.width, texture.height, texture.mipLevels, levels);
+
+	// Clean up the original pixel array 
+	stbi_image_free(pixels);
+
+	if (requestedFormat == TEXTURE_FORMAT_RGBA8)
+	{
+		texture.data.swap(levels);
+		return;
+	}
+
+	// BC1 has no alpha worth using - give textures that need it BC3 instead
+	if (texture.format == TEXTURE_FORMAT_BC1 && TextureCompressor::hasAlpha(levels.data(), static_cast<size_t>(texture.width) * texture.height))
+	{
+		texture.format = TEXTURE_FORMAT_BC3;
+	}
+
+	// Compress every level and cache the blocks for the next run
+	TextureCompressor textureCompressor;
+	size_t levelOffset = 0;
+	std::vector<uint8_t> levelBlocks;
+	for (uint32_t level = 0; level < texture.mipLevels; level++)
+	{
+		uint32_t levelWidth = MipmapGenerator::levelExtent(texture.width, level);
+		uint32_t levelHeight = MipmapGenerator::levelExtent(texture.height, level);
+		textureCompressor.compress(levels.data() + levelOffset, levelWidth, levelHeight, texture.format, levelBlocks);
+		texture.data.insert(texture.data.end(), levelBlocks.begin(), levelBlocks.end());
+		levelOffset += static_cast<size_t>(levelWidth) * levelHeight * 4;
+	}
 
-	// Image view object
-	VkImageView imageView;
-	// Initiate the image view - if not successful throw an error
-	if (vkCreateImageView(FrameworkSingleton::getInstance()->device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+	if (!skipTopLevels && levelsDropped > 0)
 	{
-		throw std::runtime_error("failed to create texture image view!");
+		return;
 	}
+	saveTextureCache(cachePath, sourceHash, sourceSize, requestedFormat, texture.format, texture.width, texture.height, texture.mipLevels, texture.data);
+	dropTopLevels(texture, levelsDropped);
+}
 
-	// Return the image view 
-	return imageView;
+// Function which reads where every level, layer and face of a KTX file is in its mapping, ready to upload - safe to call on many threads at once
+// The file stays mapped with the texture and its levels are copied straight into the staging buffer, so nothing is decoded or copied before then
+void VulkanManager::loadKtxTexture(const std::string &textureName, DecodedTexture &texture)
+{
+	std::shared_ptr<AssetFile> sourceFile = std::make_shared<AssetFile>();
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(textureName, *sourceFile))
+	{
+		texture.error = "failed to load texture image!";
+		return;
+	}
+	KtxReader ktxReader;
+	if (!ktxReader.open(sourceFile->data(), sourceFile->size(), texture.error))
+	{
+		return;
+	}
+	// Nothing is decoded so block compressed files cannot fall back to RGBA8 on devices without BC support
+	if (ktxReader.format != TEXTURE_FORMAT_RGBA8 && !FrameworkSingleton::getInstance()->textureCompressionBCSupported)
+	{
+		texture.error = "failed to load KTX texture - the device cannot sample its format!";
+		return;
+	}
+	texture.format = ktxReader.format;
+	texture.width = ktxReader.width;
+	texture.height = ktxReader.height;
+	texture.mipLevels = static_cast<uint32_t>(ktxReader.levels.size());
+	texture.arrayLayers = ktxReader.layerCount;
+	texture.cubeMap = ktxReader.cubeMap;
+	texture.levels = ktxReader.levels;
+	texture.sourceFile = sourceFile;
+
+	// The texture budget can only take off levels the file holds - a file without a mip chain is uploaded at full size
+	uint32_t levelsDropped = clampLevelsDropped(texture.width, texture.height, FrameworkSingleton::getInstance()->textureBudget.levelsDropped(textureName));
+	dropTopLevels(texture, std::min(levelsDropped, texture.mipLevels - 1));
 }
 
 // Function which will load an image and upload it into a Vulkan image object
-void VulkanManager::createTextureImage(std::string textureName, VkImage &textureIm, VkDeviceMemory &textureImMemory)
+void VulkanManager::createTextureImage(std::string textureName, VkImage &textureIm, VkFormat &textureFormat)
 {
-	// Use the STBI image loader to load the image and 
-	int texWidth, texHeight, texChannels;
-	stbi_uc* pixels = stbi_load(textureName.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+	createTextureImages({ { textureName, &textureIm, &textureFormat } });
+}
 
-	// If pixels do not exist then throw error 
-	if (!pixels)
+// Function which loads a set of images and uploads them into Vulkan image objects
+// Images are decoded on a pool of threads while the main thread copies the ones already decoded into staging buffers and records their uploads,
+// then every upload is submitted together in one command buffer - images already held by the asset registry are shared instead of loaded
+void VulkanManager::createTextureImages(const std::vector<TextureRequest> &requests)
+{
+	std::vector<DecodedTexture> textures(requests.size());
+	std::vector<bool> decoded(requests.size(), false);
+	std::mutex decodedMutex;
+	std::condition_variable decodedCondition;
+
+	// Images with the same contents as one already uploaded, or one earlier in the list, share its image instead of being decoded again
+	std::vector<uint64_t> contentKeys(requests.size(), 0);
+	std::vector<bool> shared(requests.size(), false);
+	std::vector<size_t> sharedWith(requests.size(), SIZE_MAX);
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		// Files that cannot be opened are left to decodeTexture to report
+		if (!FrameworkSingleton::getInstance()->assetRegistry.contentKey(requests[i].textureName, contentKeys[i]))
+		{
+			continue;
+		}
+		if (FrameworkSingleton::getInstance()->assetRegistry.acquireTexture(contentKeys[i], *requests[i].textureIm, *requests[i].textureFormat))
+		{
+			shared[i] = true;
+			continue;
+		}
+		for (size_t j = 0; j < i && FrameworkSingleton::getInstance()->shareAssets; j++)
+		{
+			if (!shared[j] && contentKeys[j] == contentKeys[i])
+			{
+				shared[i] = true;
+				sharedWith[i] = j;
+				break;
+			}
+		}
+	}
+
+	// Each thread pool task takes the next texture that has not been started - textures are started in order so the main thread rarely waits
+	// The main thread records uploads meanwhile rather than decoding, so it only waits for the texture it is about to upload
+	std::atomic<size_t> nextTexture(0);
+	size_t runningTasks = 0;
+	auto decodeTextures = [&]()
+	{
+		for (size_t i = nextTexture++; i < requests.size(); i = nextTexture++)
+		{
+			// A decode that throws is reported like one that failed, so the main thread is never left waiting for it
+			if (!shared[i])
+			{
+				try
+				{
+					decodeTexture(requests[i].textureName, textures[i]);
+				}
+				catch (const std::exception &e)
+				{
+					textures[i].error = e.what();
+				}
+			}
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			decoded[i] = true;
+			decodedCondition.notify_all();
+		}
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		runningTasks--;
+		decodedCondition.notify_all();
+	};
+	ThreadPool &threadPool = FrameworkSingleton::getInstance()->threadPool;
+	size_t taskCount = std::max<size_t>(1, std::min(threadPool.threadCount(), requests.size()));
+	runningTasks = taskCount;
+	for (size_t t = 0; t < taskCount; t++)
 	{
-		throw std::runtime_error("failed to load texture image!");
+		threadPool.submit(decodeTextures);
 	}
 
-	// Staging buffer used for copying the pixels from an image to the buffer
-	VkBuffer stagingBuffer;
-	// Staging buffer memory 
-	VkDeviceMemory stagingBufferMemory;
-	// Create the buffer based on the image size and the staging buffer
-	createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	// Uploads are copied through the staging ring and recorded into the upload context - what has been recorded is submitted early whenever the ring fills
+	VkCommandBuffer commandBuffer = FrameworkSingleton::getInstance()->uploadContext.begin();
+	std::string error;
+
+	// An image is created before its upload is recorded so one whose upload failed part way still has to be destroyed
+	std::vector<bool> uploaded(requests.size(), false);
+	std::vector<bool> created(requests.size(), false);
+	for (size_t i = 0; i < requests.size() && error.empty(); i++)
+	{
+		// Wait for this texture to be decoded
+		{
+			std::unique_lock<std::mutex> lock(decodedMutex);
+			decodedCondition.wait(lock, [&]() { return decoded[i]; });
+		}
+		if (shared[i])
+		{
+			continue;
+		}
+		DecodedTexture &texture = textures[i];
+		if (!texture.error.empty())
+		{
+			error = texture.error;
+			break;
+		}
+
+		// Vulkan errors are held until the pool tasks have finished
+		*requests[i].textureIm = VK_NULL_HANDLE;
+		try
+		{
+			recordTextureUpload(commandBuffer, texture, *requests[i].textureIm, *requests[i].textureFormat);
+			uploaded[i] = true;
+		}
+		catch (const std::runtime_error &e)
+		{
+			error = e.what();
+		}
+		created[i] = *requests[i].textureIm != VK_NULL_HANDLE;
+	}
 
-	// Copy the pixel values directly that were obtained from the image loading library to the buffer
-	void* data;
-	vkMapMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
-	vkUnmapMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory);
+	// The pool tasks have to finish before anything they write to goes out of scope
+	{
+		std::unique_lock<std::mutex> lock(decodedMutex);
+		decodedCondition.wait(lock, [&]() { return runningTasks == 0; });
+	}
 
-	// Clean up the original pixel array 
-	stbi_image_free(pixels);
+	// Submit every upload not yet submitted without waiting - the GPU copies them while the rest of the scene loads and the first frame is queued behind them
+	uint64_t uploadTicket = FrameworkSingleton::getInstance()->uploadContext.submit();
 
-	// Create the image by inputing the image and getting all the pixel information
-	createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureIm, textureImMemory);
+	// If any texture failed nothing is kept - the images already created are destroyed once the GPU has finished copying into them
+	// and the references taken to images the asset registry already held are given back
+	if (!error.empty())
+	{
+		FrameworkSingleton::getInstance()->uploadContext.wait(uploadTicket);
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (created[i])
+			{
+				FrameworkSingleton::getInstance()->memoryAllocator.destroyImage(*requests[i].textureIm);
+				*requests[i].textureIm = VK_NULL_HANDLE;
+			}
+			else if (shared[i] && sharedWith[i] == SIZE_MAX)
+			{
+				FrameworkSingleton::getInstance()->assetRegistry.releaseTexture(*requests[i].textureIm);
+				*requests[i].textureIm = VK_NULL_HANDLE;
+			}
+		}
+		throw std::runtime_error(error);
+	}
+
+	// Hand every new image to the asset registry, then give the images that were repeated in the list a reference to the one uploaded for them
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		if (uploaded[i])
+		{
+			FrameworkSingleton::getInstance()->assetRegistry.addTexture(contentKeys[i], *requests[i].textureIm, *requests[i].textureFormat);
+		}
+	}
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		if (sharedWith[i] != SIZE_MAX)
+		{
+			FrameworkSingleton::getInstance()->assetRegistry.acquireTexture(contentKeys[i], *requests[i].textureIm, *requests[i].textureFormat);
+		}
+	}
+}
+
+// Function which creates the image for a decoded texture and records its upload through the staging ring into the upload context's command buffer
+// The upload context is flushed when the ring fills, and commandBuffer is the one to carry on recording into afterwards
+void VulkanManager::recordTextureUpload(VkCommandBuffer &commandBuffer, DecodedTexture &texture, VkImage &textureIm, VkFormat &textureFormat)
+{
+	textureFormat = TextureCompressor::vulkanFormat(texture.format);
+	FrameworkSingleton::getInstance()->textureMipLevels = std::max(FrameworkSingleton::getInstance()->textureMipLevels, texture.mipLevels);
+
+	// Create the image by inputing the image and getting all the pixel information - blitted levels are read back from the image so it is also a transfer source
+	VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (texture.generateMipmapsOnGpu ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+	createImage(texture.width, texture.height, texture.mipLevels, textureFormat, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureIm, texture.arrayLayers, texture.cubeMap ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0);
+
+	// Transition every level of the image to the texture
+	recordImageLayoutTransition(commandBuffer, textureIm, textureFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, texture.mipLevels, texture.arrayLayers);
+
+	// Copy the pixel values or compressed blocks of each level - only level 0 is uploaded when the rest are blitted on the GPU
+	// Every layer of a level comes before the next level, as KTX files store them, and a KTX file's levels are copied one at a time out of its mapping
+	uint32_t uploadedLevels = texture.generateMipmapsOnGpu ? 1 : texture.mipLevels;
+	VkDeviceSize levelOffset = 0;
+	for (uint32_t level = 0; level < uploadedLevels; level++)
+	{
+		VkDeviceSize layerSize = TextureCompressor::compressedSize(MipmapGenerator::levelExtent(texture.width, level), MipmapGenerator::levelExtent(texture.height, level), texture.format);
+		const uint8_t *levelData = texture.levels.empty() ? texture.bytes() + levelOffset : texture.levels[level].data;
+		recordStagedLevelUpload(commandBuffer, textureIm, texture.format, texture.width, texture.height, level, texture.arrayLayers, [&](uint32_t layer) { return levelData + layer * layerSize; });
+		levelOffset += layerSize * texture.arrayLayers;
+	}
 
-	// Transition the image to the texture
-	transitionImageLayout(textureIm, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	// Copy the buffer
-	copyBufferToImage(stagingBuffer, textureIm, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-	// Transition the image to the texture, however, this time with shader access
-	transitionImageLayout(textureIm, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	// Clean up the texture data
+	std::vector<uint8_t>().swap(texture.data);
+	texture.packedData = nullptr;
+	texture.packedSize = 0;
+	texture.levels.clear();
+	texture.sourceFile.reset();
 
-	// Destroy and free the buffer/memory  
-	vkDestroyBuffer(FrameworkSingleton::getInstance()->device, stagingBuffer, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory, nullptr);
+	if (texture.generateMipmapsOnGpu)
+	{
+		// Fill the other levels from level 0 - this leaves every level ready for the shaders
+		recordGenerateMipmaps(commandBuffer, textureIm, texture.width, texture.height, texture.mipLevels);
+	}
+	else
+	{
+		// Transition the image to the texture, however, this time with shader access
+		recordImageLayoutTransition(commandBuffer, textureIm, textureFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, texture.mipLevels, texture.arrayLayers);
+	}
 }
 
-// Function which copies the buffer to the image
-void VulkanManager::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+// Function which loads a set of images and packs them into texture arrays - images with the same size, format and mip chain share one array image
+// Every image is decoded on the thread pool first as the arrays cannot be created until the size of every image is known, then each array is uploaded through the staging ring
+void VulkanManager::createTextureArrays(const std::vector<TextureLayerRequest> &requests)
 {
-	// Start recording the command buffer
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+	std::vector<DecodedTexture> textures(requests.size());
 
-	// Struct which specifies the region of the image 
-	VkBufferImageCopy region = {};
-	region.bufferOffset = 0;
-	region.bufferRowLength = 0;
-	region.bufferImageHeight = 0;
-	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount = 1;
-	region.imageOffset = { 0, 0, 0 };
-	region.imageExtent = {
-		width,
-		height,
-		1
+	// Decode every texture on the thread pool
+	FrameworkSingleton::getInstance()->threadPool.parallelFor(requests.size(), [&](size_t i)
+	{
+		decodeTexture(requests[i].textureName, textures[i]);
+	});
+	for (const auto& texture : textures)
+	{
+		if (!texture.error.empty())
+		{
+			throw std::runtime_error(texture.error);
+		}
+		// A KTX array or cube map already has layers of its own
+		if (texture.arrayLayers > 1)
+		{
+			throw std::runtime_error("failed to pack textures into texture arrays - a texture has layers of its own!");
+		}
+	}
+
+	// Group the textures which can be layers of the same image - in the order they were asked for so the layers are too
+	std::vector<std::vector<size_t>> arrays;
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		auto match = std::find_if(arrays.begin(), arrays.end(), [&](const std::vector<size_t> &layers)
+		{
+			const DecodedTexture &first = textures[layers[0]];
+			return first.width == textures[i].width && first.height == textures[i].height && first.format == textures[i].format && first.mipLevels == textures[i].mipLevels && first.generateMipmapsOnGpu == textures[i].generateMipmapsOnGpu;
+		});
+		if (match != arrays.end())
+		{
+			match->push_back(i);
+		}
+		else
+		{
+			arrays.push_back({ i });
+		}
+	}
+	if (arrays.size() > maxTextureArrays)
+	{
+		throw std::runtime_error("failed to pack textures into texture arrays!");
+	}
+
+	FrameworkSingleton::getInstance()->textureArrays.resize(arrays.size());
+	FrameworkSingleton::getInstance()->textureArrayViews.resize(arrays.size());
+	VkImageViewType arrayViewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	VkCommandBuffer commandBuffer = FrameworkSingleton::getInstance()->uploadContext.begin();
+
+	for (size_t a = 0; a < arrays.size(); a++)
+	{
+		const std::vector<size_t> &layers = arrays[a];
+		const DecodedTexture &first = textures[layers[0]];
+		uint32_t layerCount = static_cast<uint32_t>(layers.size());
+		VkFormat format = TextureCompressor::vulkanFormat(first.format);
+		FrameworkSingleton::getInstance()->textureMipLevels = std::max(FrameworkSingleton::getInstance()->textureMipLevels, first.mipLevels);
+
+		// Create the array image - blitted levels are read back from the image so it is also a transfer source
+		VkImage &arrayImage = FrameworkSingleton::getInstance()->textureArrays[a];
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (first.generateMipmapsOnGpu ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+		createImage(first.width, first.height, first.mipLevels, format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, arrayImage, layerCount);
+		recordImageLayoutTransition(commandBuffer, arrayImage, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, first.mipLevels, layerCount);
+
+		// Copy each level of every layer through the staging ring - each layer is the same level of a different texture
+		uint32_t uploadedLevels = first.generateMipmapsOnGpu ? 1 : first.mipLevels;
+		VkDeviceSize textureLevelOffset = 0;
+		for (uint32_t level = 0; level < uploadedLevels; level++)
+		{
+			auto layerData = [&](uint32_t layer)
+			{
+				const DecodedTexture &texture = textures[layers[layer]];
+				return texture.levels.empty() ? texture.bytes() + textureLevelOffset : texture.levels[level].data;
+			};
+			recordStagedLevelUpload(commandBuffer, arrayImage, first.format, first.width, first.height, level, layerCount, layerData);
+			textureLevelOffset += TextureCompressor::compressedSize(MipmapGenerator::levelExtent(first.width, level), MipmapGenerator::levelExtent(first.height, level), first.format);
+		}
+
+		// Clean up the texture data
+		for (uint32_t layer = 0; layer < layerCount; layer++)
+		{
+			DecodedTexture &texture = textures[layers[layer]];
+			std::vector<uint8_t>().swap(texture.data);
+			texture.packedData = nullptr;
+			texture.packedSize = 0;
+			texture.levels.clear();
+			texture.sourceFile.reset();
+		}
+
+		if (first.generateMipmapsOnGpu)
+		{
+			recordGenerateMipmaps(commandBuffer, arrayImage, first.width, first.height, first.mipLevels, layerCount);
+		}
+		else
+		{
+			recordImageLayoutTransition(commandBuffer, arrayImage, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, first.mipLevels, layerCount);
+		}
+
+		// The array view is what the shared descriptor sets bind - each texture also gets a view of its own layer
+		FrameworkSingleton::getInstance()->textureArrayViews[a] = createImageView(arrayImage, format, VK_IMAGE_ASPECT_COLOR_BIT, VK_REMAINING_MIP_LEVELS, arrayViewType, 0, layerCount);
+		for (uint32_t layer = 0; layer < layerCount; layer++)
+		{
+			const TextureLayerRequest &request = requests[layers[layer]];
+			if (request.textureLayer)
+			{
+				request.textureLayer->textureArray = static_cast<uint32_t>(a);
+				request.textureLayer->layer = layer;
+			}
+			if (request.textureImView)
+			{
+				*request.textureImView = createImageView(arrayImage, format, VK_IMAGE_ASPECT_COLOR_BIT, VK_REMAINING_MIP_LEVELS, FrameworkSingleton::getInstance()->twoDImageView, layer, 1);
+			}
+			*request.textureFormat = format;
+		}
+	}
+
+	// Submit every upload not yet submitted without waiting - the first frame is queued behind them
+	FrameworkSingleton::getInstance()->uploadContext.submit();
+	std::cout << "Textures packed: " + std::to_string(requests.size()) + " textures into " + std::to_string(arrays.size()) + " texture arrays\n";
+}
+
+// Header at the start of every texture cache file - the compressed blocks follow it directly
+struct TextureCacheHeader
+{
+	char magic[4]; // Always "VFTC"
+	uint32_t version; // Bumped whenever the layout or content of the cache changes
+	uint64_t sourceHash; // Hash of the image file the cache was built from
+	uint64_t sourceSize; // Size of the image file the cache was built from
+	uint32_t requestedFormat; // Format the framework asked for when the cache was written
+	uint32_t format; // Format the blocks are stored in - differs from requestedFormat when BC1 was upgraded to BC3 for alpha
+	uint32_t width;
+	uint32_t height;
+	uint32_t levelCount; // Number of mip levels stored one after another, largest first - 1 when mipmaps are turned off
+	uint32_t reserved;
+	uint64_t dataSize; // Size of the block data of every level together
+};
+
+// Version of the texture cache format - caches with any other version are ignored and rebuilt
+const uint32_t textureCacheVersion = 1;
+
+// Function which loads the compressed blocks of every mip level from a texture cache file - returns false if there is no valid cache for the image
+bool VulkanManager::loadTextureCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, TextureFormat requestedFormat, TextureFormat &format, uint32_t &width, uint32_t &height, uint32_t &levelCount, std::vector<uint8_t> &blocks, const uint8_t *&packedBlocks, size_t &packedSize)
+{
+	// Open the cache file - if it does not exist then the image has to be decoded and compressed
+	AssetFile cacheFile;
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(cachePath, cacheFile) || cacheFile.size() < sizeof(TextureCacheHeader) || cacheFile.data() == nullptr)
+	{
+		return false;
+	}
+
+	// Check the cache was built from this exact image file in the format being asked for
+	TextureCacheHeader header;
+	memcpy(&header, cacheFile.data(), sizeof(header));
+	if (memcmp(header.magic, "VFTC", 4) != 0 || header.version != textureCacheVersion || header.sourceHash != sourceHash || header.sourceSize != sourceSize || header.requestedFormat != requestedFormat)
+	{
+		return false;
+	}
+
+	// Check the cache holds as many mip levels as are wanted now
+	uint32_t expectedLevels = FrameworkSingleton::getInstance()->generateMipmaps ? MipmapGenerator::mipLevelCount(header.width, header.height) : 1;
+	if (header.levelCount != expectedLevels)
+	{
+		return false;
+	}
+
+	// Check the block data is the size the header says it should be and is all there
+	uint64_t expectedSize = 0;
+	for (uint32_t level = 0; level < header.levelCount; level++)
+	{
+		expectedSize += TextureCompressor::compressedSize(MipmapGenerator::levelExtent(header.width, level), MipmapGenerator::levelExtent(header.height, level), static_cast<TextureFormat>(header.format));
+	}
+	if (header.dataSize != expectedSize || cacheFile.size() < sizeof(TextureCacheHeader) + header.dataSize)
+	{
+		return false;
+	}
+
+	format = static_cast<TextureFormat>(header.format);
+	width = header.width;
+	height = header.height;
+	levelCount = header.levelCount;
+	const uint8_t* cacheData = cacheFile.data() + sizeof(TextureCacheHeader);
+
+	// Blocks stored uncompressed in the asset pack are copied straight from the pack into the staging buffer when they are uploaded
+	if (cacheFile.isPackMapped())
+	{
+		packedBlocks = cacheData;
+		packedSize = static_cast<size_t>(header.dataSize);
+		return true;
+	}
+	blocks.assign(cacheData, cacheData + header.dataSize);
+	return true;
+}
+
+// Function which writes the compressed blocks of every mip level out to a texture cache file
+void VulkanManager::saveTextureCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, TextureFormat requestedFormat, TextureFormat format, uint32_t width, uint32_t height, uint32_t levelCount, const std::vector<uint8_t> &blocks)
+{
+	TextureCacheHeader header = {};
+	memcpy(header.magic, "VFTC", 4);
+	header.version = textureCacheVersion;
+	header.sourceHash = sourceHash;
+	header.sourceSize = sourceSize;
+	header.requestedFormat = requestedFormat;
+	header.format = format;
+	header.width = width;
+	header.height = height;
+	header.levelCount = levelCount;
+	header.dataSize = blocks.size();
+
+	// Write to a temporary file first so a half written cache is never picked up by a later run
+	std::string tempPath = cachePath + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cerr << "failed to write texture cache " << cachePath << std::endl;
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+	file.close();
+
+	if (!file)
+	{
+		std::remove(tempPath.c_str());
+		std::cerr << "failed to write texture cache " << cachePath << std::endl;
+		return;
+	}
+
+	// Replace any old cache with the new one
+	std::remove(cachePath.c_str());
+	if (std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+	{
+		std::remove(tempPath.c_str());
+		std::cerr << "failed to write texture cache " << cachePath << std::endl;
+	}
+}
+
+// Function which packs every model, texture and shader the framework loads, and any caches built for them, into the asset pack
+void VulkanManager::buildAssetPack()
+{
+	std::vector<std::string> sourcePaths = {
+		FrameworkSingleton::getInstance()->modelSceneryPath,
+		FrameworkSingleton::getInstance()->modelChaletPath,
+		FrameworkSingleton::getInstance()->boxesTexturePath,
+		FrameworkSingleton::getInstance()->checkedTexturePath,
+		FrameworkSingleton::getInstance()->modelSceneryTexturePath,
+		FrameworkSingleton::getInstance()->modelChaletTexturePath,
+		FrameworkSingleton::getInstance()->topSkyTexturePath,
+		FrameworkSingleton::getInstance()->bottomSkyTexturePath,
+		FrameworkSingleton::getInstance()->leftSkyTexturePath,
+		FrameworkSingleton::getInstance()->rightSkyTexturePath,
+		FrameworkSingleton::getInstance()->frontSkyTexturePath,
+		FrameworkSingleton::getInstance()->backSkyTexturePath,
+		FrameworkSingleton::getInstance()->skyboxCubeMapPath,
+		"shaders/vert.spv",
+		"shaders/packedVert.spv",
+		"shaders/terrainVert.spv",
+		"shaders/frag.spv",
+		"shaders/arrayFrag.spv",
+		"shaders/skyVert.spv",
+		"shaders/packedSkyVert.spv",
+		"shaders/skyFrag.spv",
+		FrameworkSingleton::getInstance()->terrainHeightmapPath
+	};
+
+	// Pack each file that exists along with its model or texture cache - anything missing is left out and read from disk as before
+	std::vector<std::string> packPaths;
+	for (const auto& sourcePath : sourcePaths)
+	{
+		for (const auto& path : { sourcePath, sourcePath + ".meshcache", sourcePath + ".texcache" })
+		{
+			std::ifstream file(path);
+			if (file.good() && std::find(packPaths.begin(), packPaths.end(), path) == packPaths.end())
+			{
+				packPaths.push_back(path);
+			}
+		}
+	}
+
+	std::string error;
+	if (!AssetPack::write(FrameworkSingleton::getInstance()->assetPackPath, packPaths, FrameworkSingleton::getInstance()->compressAssetPack, error))
+	{
+		throw std::runtime_error(error);
+	}
+	std::cout << "Asset pack written: " << FrameworkSingleton::getInstance()->assetPackPath << " with " << packPaths.size() << " files" << std::endl;
+}
+
+// Function which writes the six skybox face images into the skybox cube map - each face is decoded, mipmapped and compressed as it is when it is loaded on its own
+// No device has been picked so the file is built in the format textures are compressed to, which only devices that can sample BC formats load - turn compressTextures off to build one any device loads
+void VulkanManager::buildSkyboxCubeMap()
+{
+	FrameworkSingleton::getInstance()->textureCompressionBCSupported = FrameworkSingleton::getInstance()->compressTextures;
+
+	// The layers of a cube map are its faces in the order +X, -X, +Y, -Y, +Z, -Z
+	std::vector<std::string> facePaths = {
+		FrameworkSingleton::getInstance()->rightSkyTexturePath,
+		FrameworkSingleton::getInstance()->leftSkyTexturePath,
+		FrameworkSingleton::getInstance()->topSkyTexturePath,
+		FrameworkSingleton::getInstance()->bottomSkyTexturePath,
+		FrameworkSingleton::getInstance()->frontSkyTexturePath,
+		FrameworkSingleton::getInstance()->backSkyTexturePath
 	};
+	std::vector<DecodedTexture> faces(facePaths.size());
+	for (size_t face = 0; face < faces.size(); face++)
+	{
+		decodeTexture(facePaths[face], faces[face]);
+		if (!faces[face].error.empty())
+		{
+			throw std::runtime_error(faces[face].error);
+		}
+		const DecodedTexture &first = faces[0];
+		if (faces[face].width != faces[face].height || faces[face].width != first.width || faces[face].format != first.format || faces[face].mipLevels != first.mipLevels || faces[face].generateMipmapsOnGpu != first.generateMipmapsOnGpu)
+		{
+			throw std::runtime_error("failed to build skybox cube map - the faces are not squares of the same size and format!");
+		}
+	}
 
-	// Copy the buffer itself 
-	vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	// Gather each level of every face together - faces whose levels are blitted on the GPU only hold level 0, so that is all the file holds
+	uint32_t levelCount = faces[0].generateMipmapsOnGpu ? 1 : faces[0].mipLevels;
+	std::vector<std::vector<uint8_t>> levels(levelCount);
+	size_t levelOffset = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		size_t levelSize = TextureCompressor::compressedSize(MipmapGenerator::levelExtent(faces[0].width, level), MipmapGenerator::levelExtent(faces[0].height, level), faces[0].format);
+		for (const auto& face : faces)
+		{
+			levels[level].insert(levels[level].end(), face.bytes() + levelOffset, face.bytes() + levelOffset + levelSize);
+		}
+		levelOffset += levelSize;
+	}
 
-	// End the reocrding of the command buffer 
-	endSingleTimeCommands(commandBuffer);
+	std::string error;
+	if (!KtxReader::write(FrameworkSingleton::getInstance()->skyboxCubeMapPath, faces[0].format, faces[0].width, faces[0].height, 6, levels, error))
+	{
+		throw std::runtime_error(error);
+	}
+	std::cout << "Skybox cube map written: " << FrameworkSingleton::getInstance()->skyboxCubeMapPath << " " << faces[0].width << "x" << faces[0].height << " with " << levelCount << " levels" << std::endl;
 }
 
-// Function which beings the recording of the command buffer
-VkCommandBuffer VulkanManager::beginSingleTimeCommands()
+// Function which uploads one level of pixels into an image through the staging ring and leaves it ready for the shaders - the image starts in an undefined layout
+// Each pixel has to be four bytes - RGBA8 or a single 32 bit channel. Every one of arrayLayers layers is given the same pixels
+// Recorded into the upload context and submitted with whatever is submitted next
+void VulkanManager::uploadImage(const void *pixels, VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t arrayLayers)
 {
-	// Struct which temporarily allocates a command buffer to allow for memory transfer operations
-	VkCommandBufferAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO; // Set type to command pool
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // Set to primary to only allow memory transfer
-	allocInfo.commandPool = FrameworkSingleton::getInstance()->commandPool; // Create a command pool to generate command buffers
-	allocInfo.commandBufferCount = 1; // Set the count to one as only one is required
+	VkCommandBuffer commandBuffer = FrameworkSingleton::getInstance()->uploadContext.begin();
+	recordImageLayoutTransition(commandBuffer, image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, arrayLayers);
+	recordStagedLevelUpload(commandBuffer, image, TEXTURE_FORMAT_RGBA8, width, height, 0, arrayLayers, [pixels](uint32_t) { return static_cast<const uint8_t*>(pixels); });
+	recordImageLayoutTransition(commandBuffer, image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1, arrayLayers);
+}
 
-									  // Allocate the command buffer from the command pool in the struct 
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(FrameworkSingleton::getInstance()->device, &allocInfo, &commandBuffer);
+// Function which copies the layers of one mip level into the staging ring and records their copy into an image in the transfer destination layout
+// Layers are copied together for as long as they fit in one region, and a layer larger than a region is copied a band of block rows at a time
+// layerData gives where each layer's level starts in memory
+void VulkanManager::recordStagedLevelUpload(VkCommandBuffer &commandBuffer, VkImage image, TextureFormat format, uint32_t width, uint32_t height, uint32_t level, uint32_t arrayLayers, const std::function<const uint8_t*(uint32_t)> &layerData)
+{
+	uint32_t levelWidth = MipmapGenerator::levelExtent(width, level);
+	uint32_t levelHeight = MipmapGenerator::levelExtent(height, level);
+	VkDeviceSize layerSize = TextureCompressor::compressedSize(levelWidth, levelHeight, format);
+	VkDeviceSize largestRegion = FrameworkSingleton::getInstance()->stagingRing.largestRegion();
 
-	// Start recording the command buffer to record the memory transfer
-	VkCommandBufferBeginInfo beginInfo = {};
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; // Set command buffer to begin
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // Set to one at a time as there is only one command buffer
+	// Struct which specifies the part of the image each chunk is copied to
+	VkBufferImageCopy region = {};
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = level;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { levelWidth, levelHeight, 1 };
 
-																   // Begin recording the Command Buffer
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	if (layerSize <= largestRegion)
+	{
+		uint32_t layersPerChunk = static_cast<uint32_t>(std::min<VkDeviceSize>(largestRegion / layerSize, arrayLayers));
+		for (uint32_t firstLayer = 0; firstLayer < arrayLayers; firstLayer += layersPerChunk)
+		{
+			uint32_t chunkLayers = std::min(layersPerChunk, arrayLayers - firstLayer);
+			StagingRegion staged = stageUpload(commandBuffer, layerSize * chunkLayers);
+			for (uint32_t layer = 0; layer < chunkLayers; layer++)
+			{
+				memcpy(staged.data + layer * layerSize, layerData(firstLayer + layer), static_cast<size_t>(layerSize));
+			}
+			region.bufferOffset = staged.offset;
+			region.imageSubresource.baseArrayLayer = firstLayer;
+			region.imageSubresource.layerCount = chunkLayers;
+			vkCmdCopyBufferToImage(commandBuffer, FrameworkSingleton::getInstance()->stagingRing.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		}
+		return;
+	}
 
-	// Return the Command Buffer
-	return commandBuffer;
+	// Compressed formats are copied in whole rows of 4x4 blocks - only the last band may stop short of a block at the bottom of the image
+	uint32_t blockHeight = format == TEXTURE_FORMAT_RGBA8 ? 1 : 4;
+	VkDeviceSize blockRowSize = TextureCompressor::compressedSize(levelWidth, blockHeight, format);
+	if (blockRowSize > largestRegion)
+	{
+		throw std::runtime_error("failed to stage texture - a row of it is larger than the staging ring!");
+	}
+	uint32_t blockRows = (levelHeight + blockHeight - 1) / blockHeight;
+	uint32_t rowsPerChunk = static_cast<uint32_t>(largestRegion / blockRowSize);
+	region.imageSubresource.layerCount = 1;
+	for (uint32_t layer = 0; layer < arrayLayers; layer++)
+	{
+		const uint8_t *data = layerData(layer);
+		for (uint32_t firstRow = 0; firstRow < blockRows; firstRow += rowsPerChunk)
+		{
+			uint32_t chunkRows = std::min(rowsPerChunk, blockRows - firstRow);
+			StagingRegion staged = stageUpload(commandBuffer, blockRowSize * chunkRows);
+			memcpy(staged.data, data + firstRow * blockRowSize, static_cast<size_t>(blockRowSize * chunkRows));
+			region.bufferOffset = staged.offset;
+			region.imageSubresource.baseArrayLayer = layer;
+			region.imageOffset.y = static_cast<int32_t>(firstRow * blockHeight);
+			region.imageExtent.height = std::min(chunkRows * blockHeight, levelHeight - firstRow * blockHeight);
+			vkCmdCopyBufferToImage(commandBuffer, FrameworkSingleton::getInstance()->stagingRing.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		}
+	}
 }
 
-// Function which ends the recording of the command buffer
-void VulkanManager::endSingleTimeCommands(VkCommandBuffer commandBuffer)
+// Function which records blits that fill every mip level of an image from the level above it - level 0 must already be uploaded
+// Every level starts in the transfer destination layout and ends ready for the shaders to read
+void VulkanManager::recordGenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers)
 {
-	// End the recording of the command bufer
-	vkEndCommandBuffer(commandBuffer);
+	// Barrier reused for each level - only the level and the layouts change
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = arrayLayers;
 
-	// Execute the command buffer to complete the transfer of memory 
-	VkSubmitInfo submitInfo = {};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
+	for (uint32_t level = 1; level < mipLevels; level++)
+	{
+		// Wait for the level above to be written then make it the blit source
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		// Halve the level above into this one with linear filtering - every layer at once
+		VkImageBlit blit = {};
+		blit.srcOffsets[1] = { static_cast<int32_t>(MipmapGenerator::levelExtent(width, level - 1)), static_cast<int32_t>(MipmapGenerator::levelExtent(height, level - 1)), 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.layerCount = arrayLayers;
+		blit.dstOffsets[1] = { static_cast<int32_t>(MipmapGenerator::levelExtent(width, level)), static_cast<int32_t>(MipmapGenerator::levelExtent(height, level)), 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.layerCount = arrayLayers;
+		vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+		// The level above is finished with - hand it to the shaders
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
 
-	// Sumbit the information to the queue and wait until finished
-	vkQueueSubmit(FrameworkSingleton::getInstance()->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(FrameworkSingleton::getInstance()->graphicsQueue);
+	// The last level was only ever written to
+	barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
 
-	// Free the command buffer now transfer is complete 
-	vkFreeCommandBuffers(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->commandPool, 1, &commandBuffer);
+// Function which hands out a region of the staging ring for an upload being recorded into commandBuffer - no larger than the ring's largest region
+// When the ring is held by regions not yet submitted, the upload context submits what has been recorded and commandBuffer is replaced by the one to carry on recording into
+StagingRegion VulkanManager::stageUpload(VkCommandBuffer &commandBuffer, VkDeviceSize size)
+{
+	StagingRegion region;
+	if (FrameworkSingleton::getInstance()->stagingRing.allocate(size, region))
+	{
+		return region;
+	}
+	FrameworkSingleton::getInstance()->uploadContext.flush(commandBuffer);
+	if (!FrameworkSingleton::getInstance()->stagingRing.allocate(size, region))
+	{
+		throw std::runtime_error("failed to stage upload!");
+	}
+	return region;
 }
 
 // Function which is used to create image based on the contents inside the vulkan image object 
-void VulkanManager::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+void VulkanManager::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, uint32_t arrayLayers, VkImageCreateFlags flags)
 {
 	// Struct which specifies image information such as 
 	VkImageCreateInfo imageInfo = {};
@@ -548,8 +2159,9 @@ void VulkanManager::createImage(uint32_t width, uint32_t height, VkFormat format
 	imageInfo.extent.width = width; // Set the width tp the width of the window
 	imageInfo.extent.height = height; // Set the height tp the width of the window
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
-	imageInfo.arrayLayers = 1;
+	imageInfo.mipLevels = mipLevels; // Number of mip levels the image holds
+	imageInfo.arrayLayers = arrayLayers; // Number of layers - more than one for texture arrays and cube maps
+	imageInfo.flags = flags; // Cube compatible for cube maps so the layers can be viewed as the faces of a cube
 	imageInfo.format = format; // Set format to the value passed in
 	imageInfo.tiling = tiling; // Set tiling to the value passed in 
 	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // Set the intial layout to not usable by the GPU and the very first transition will discard the texels
@@ -557,34 +2169,18 @@ void VulkanManager::createImage(uint32_t width, uint32_t height, VkFormat format
 	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-	// Iniate the create image - if unsuccessful throw error
-	if (vkCreateImage(FrameworkSingleton::getInstance()->device, &imageInfo, nullptr, &image) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to create image!");
-	}
-
-	// Specify the memroy requirements required for the image
-	VkMemoryRequirements memRequirements;
-	vkGetImageMemoryRequirements(FrameworkSingleton::getInstance()->device, image, &memRequirements);
-
-	// Struct which is used to store information regarding the allocation of memory 
-	VkMemoryAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-	// Allocate the image memory - if not successful throw an error 
-	if (vkAllocateMemory(FrameworkSingleton::getInstance()->device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+	// Iniate the create image - if unsuccessful throw error
+	if (vkCreateImage(FrameworkSingleton::getInstance()->device, &imageInfo, nullptr, &image) != VK_SUCCESS)
 	{
-		throw std::runtime_error("failed to allocate image memory!");
+		throw std::runtime_error("failed to create image!");
 	}
 
-	// Bind the image and the image memory 
-	vkBindImageMemory(FrameworkSingleton::getInstance()->device, image, imageMemory, 0);
+	// Bind the image to a range of a memory block - if unsuccessful the allocator throws an error
+	FrameworkSingleton::getInstance()->memoryAllocator.bindImage(image, properties);
 }
 
 // Function which is used to create the descriptor sets from the descriptor pool 
-void VulkanManager::createDescriptorSet(VkDescriptorSet &desSet, VkImageView textureImView, VkBuffer uniformBuff)
+void VulkanManager::createDescriptorSet(VkDescriptorSet &desSet, VkImageView textureImView)
 {
 	VkDescriptorSetLayout layouts[] = { FrameworkSingleton::getInstance()->descriptorSetLayout };
 	// Struct which contains information regarding the sets
@@ -600,9 +2196,16 @@ void VulkanManager::createDescriptorSet(VkDescriptorSet &desSet, VkImageView tex
 		throw std::runtime_error("failed to allocate descriptor set!");
 	}
 
-	// Struct specifies the buffer and the region within it that contains the data for the descriptor
+	// Point the set at the uniform arena and texture
+	updateDescriptorSet(desSet, textureImView);
+}
+
+// Function which points a descriptor set at the uniform arena and a texture - command buffers that bind the set have to be recorded again afterwards
+void VulkanManager::updateDescriptorSet(VkDescriptorSet desSet, VkImageView textureImView)
+{
+	// Struct specifies the buffer and the region within it that contains the data for the descriptor - the dynamic offset a draw binds picks its object and frame
 	VkDescriptorBufferInfo bufferInfo = {};
-	bufferInfo.buffer = uniformBuff;
+	bufferInfo.buffer = FrameworkSingleton::getInstance()->uniformArena.buffer;
 	bufferInfo.offset = 0;
 	bufferInfo.range = sizeof(UniformBufferObject);
 
@@ -619,7 +2222,7 @@ void VulkanManager::createDescriptorSet(VkDescriptorSet &desSet, VkImageView tex
 	descriptorWrites[0].dstSet = desSet; // Assign the created descriptor set
 	descriptorWrites[0].dstBinding = 0; // Binding index starts at the first element - 0
 	descriptorWrites[0].dstArrayElement = 0; // Binding index starts at the first element - 0
-	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; //Define the descriptor as uniform buffer 
+	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; //Define the descriptor as uniform buffer read at a dynamic offset
 	descriptorWrites[0].descriptorCount = 1;
 	descriptorWrites[0].pBufferInfo = &bufferInfo; // Set the buffer info
 
@@ -635,22 +2238,115 @@ void VulkanManager::createDescriptorSet(VkDescriptorSet &desSet, VkImageView tex
 	vkUpdateDescriptorSets(FrameworkSingleton::getInstance()->device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
+// Function which points every descriptor set back at the uniform arena once its buffer has been made again - the textures they sample are kept
+void VulkanManager::updateUniformDescriptorSets()
+{
+	std::vector<VkDescriptorSet> desSets = { FrameworkSingleton::getInstance()->textureArrayDescriptorSet };
+	if (!FrameworkSingleton::getInstance()->textureArraysActive)
+	{
+		desSets = { FrameworkSingleton::getInstance()->cubedescriptorSet, FrameworkSingleton::getInstance()->checkedDescriptorSet, FrameworkSingleton::getInstance()->modelSceneryDescriptorSet,
+			FrameworkSingleton::getInstance()->modelChaletDescriptorSet, FrameworkSingleton::getInstance()->skyboxDescriptorSet };
+	}
+
+	VkDescriptorBufferInfo bufferInfo = {};
+	bufferInfo.buffer = FrameworkSingleton::getInstance()->uniformArena.buffer;
+	bufferInfo.offset = 0;
+	bufferInfo.range = sizeof(UniformBufferObject);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites(desSets.size());
+	for (size_t i = 0; i < desSets.size(); i++)
+	{
+		descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[i].dstSet = desSets[i];
+		descriptorWrites[i].dstBinding = 0;
+		descriptorWrites[i].dstArrayElement = 0;
+		descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		descriptorWrites[i].descriptorCount = 1;
+		descriptorWrites[i].pBufferInfo = &bufferInfo;
+	}
+	vkUpdateDescriptorSets(FrameworkSingleton::getInstance()->device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+	if (FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->terrainManager.updateDescriptorSet();
+	}
+}
+
+// Function which creates a descriptor set holding the uniform arena and every texture array - draws pick their texture and uniform buffer object with recordTextureBind
+void VulkanManager::createTextureArrayDescriptorSet(VkDescriptorSet &desSet)
+{
+	VkDescriptorSetLayout layouts[] = { FrameworkSingleton::getInstance()->descriptorSetLayout };
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = FrameworkSingleton::getInstance()->descriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = layouts;
+
+	// Initiate the descriptor sets - if not successful throw error 
+	if (vkAllocateDescriptorSets(FrameworkSingleton::getInstance()->device, &allocInfo, &desSet) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to allocate descriptor set!");
+	}
+
+	VkDescriptorBufferInfo bufferInfo = {};
+	bufferInfo.buffer = FrameworkSingleton::getInstance()->uniformArena.buffer;
+	bufferInfo.offset = 0;
+	bufferInfo.range = sizeof(UniformBufferObject);
+
+	// Every element of the sampler array has to be written - elements past the last array repeat the first one and are never sampled
+	std::array<VkDescriptorImageInfo, maxTextureArrays> imageInfos = {};
+	for (uint32_t a = 0; a < maxTextureArrays; a++)
+	{
+		imageInfos[a].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfos[a].imageView = FrameworkSingleton::getInstance()->textureArrayViews[a < FrameworkSingleton::getInstance()->textureArrayViews.size() ? a : 0];
+		imageInfos[a].sampler = FrameworkSingleton::getInstance()->textureSampler;
+	}
+
+	std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
+
+	descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[0].dstSet = desSet;
+	descriptorWrites[0].dstBinding = 0;
+	descriptorWrites[0].dstArrayElement = 0;
+	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorWrites[0].descriptorCount = 1;
+	descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+	descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[1].dstSet = desSet;
+	descriptorWrites[1].dstBinding = 1;
+	descriptorWrites[1].dstArrayElement = 0;
+	descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrites[1].descriptorCount = maxTextureArrays;
+	descriptorWrites[1].pImageInfo = imageInfos.data();
+
+	vkUpdateDescriptorSets(FrameworkSingleton::getInstance()->device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
 // Function which contains the descriptor pools which is used to allocate a descriptor set - like command buffers
 void VulkanManager::createDescriptorPool()
 {
+	// Every set allocated from the pool holds one uniform buffer read at a dynamic offset and one sampler, so there are enough of each for as many sets as the pool allows
+	uint32_t maxSets = static_cast<uint32_t>(FrameworkSingleton::getInstance()->NUMBEROFSHAPES);
+
 	// Array of descriptor pools 
 	std::array<VkDescriptorPoolSize, 2> poolSizes = {};
-	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; // Pool 0 to uniform buffers
-	poolSizes[0].descriptorCount = 2;
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; // Pool 0 to uniform buffers read at a dynamic offset
+	poolSizes[0].descriptorCount = maxSets;
 	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // Pool 1 to image sampler
-	poolSizes[1].descriptorCount = 2;
+	poolSizes[1].descriptorCount = maxSets;
+	if (FrameworkSingleton::getInstance()->textureArraysActive)
+	{
+		// The texture array set holds a sampler for every array
+		poolSizes[1].descriptorCount = std::max(maxSets, maxTextureArrays);
+	}
 
 	// Struct which contains information regarding the sets in the pool
 	VkDescriptorPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 	poolInfo.pPoolSizes = poolSizes.data();
-	poolInfo.maxSets = FrameworkSingleton::getInstance()->NUMBEROFSHAPES; // THIS MAGIC NUMBER NEEDS INCREASED IF WANTING A NEW TEXTURE
+	poolInfo.maxSets = maxSets; // THIS MAGIC NUMBER NEEDS INCREASED IF WANTING A NEW TEXTURE
 
 									   // Initiate descriptor pool - if fail throw error
 	if (vkCreateDescriptorPool(FrameworkSingleton::getInstance()->device, &poolInfo, nullptr, &FrameworkSingleton::getInstance()->descriptorPool) != VK_SUCCESS)
@@ -661,6 +2357,12 @@ void VulkanManager::createDescriptorPool()
 
 // Function which manage the memory that is used to store the buffers and command buffers are allocated from them
 void VulkanManager::createCommandPool()
+{
+	createCommandPool(FrameworkSingleton::getInstance()->commandPool, 0);
+}
+
+// Function which creates a command pool for the graphics queue family with the flags passed in
+void VulkanManager::createCommandPool(VkCommandPool &pool, VkCommandPoolCreateFlags flags)
 {
 	QueueFamilyIndices queueFamilyIndices = findQueueFamilies(FrameworkSingleton::getInstance()->physicalDevice);
 
@@ -669,20 +2371,21 @@ void VulkanManager::createCommandPool()
 	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	// Select a graphics family queue for drawing commands 
 	poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
-	poolInfo.flags = 0; // Optional
+	poolInfo.flags = flags; // Optional
 
 						// Initalise the command pool - if not successful then throw error 
-	if (vkCreateCommandPool(FrameworkSingleton::getInstance()->device, &poolInfo, nullptr, &FrameworkSingleton::getInstance()->commandPool) != VK_SUCCESS)
+	if (vkCreateCommandPool(FrameworkSingleton::getInstance()->device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to create command pool!");
 	}
 }
 
-// Function which updates the uniform buffer with a new transformation every frame 
-void VulkanManager::createUniformBuffer(VkBuffer &uniformBuff, VkDeviceMemory &uniformBuffMemory)
+// Function which creates the uniform arena with a slice for every swap chain image and gives the normal and rotating uniform buffer objects their place in it
+void VulkanManager::createUniformBuffers()
 {
-	VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-	createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuff, uniformBuffMemory);
+	FrameworkSingleton::getInstance()->uniformArena.create(static_cast<uint32_t>(FrameworkSingleton::getInstance()->swapChainImages.size()));
+	FrameworkSingleton::getInstance()->uniformObject = FrameworkSingleton::getInstance()->uniformArena.allocate(sizeof(UniformBufferObject));
+	FrameworkSingleton::getInstance()->rotatingUniformObject = FrameworkSingleton::getInstance()->uniformArena.allocate(sizeof(UniformBufferObject));
 }
 
 // Function which provides details about every descriptor binding used in the shaders for pipeline creation - MVP
@@ -691,7 +2394,7 @@ void VulkanManager::createDescriptorSetLayout()
 	// Define the biding of the uniform buffer object 
 	VkDescriptorSetLayoutBinding uboLayoutBinding = {};
 	uboLayoutBinding.binding = 0;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; // Each draw binds the offset of its object in the uniform arena
 	uboLayoutBinding.descriptorCount = 1;
 	uboLayoutBinding.pImmutableSamplers = nullptr;
 	// Set the shader stage for the descriptor to vertex 
@@ -700,7 +2403,7 @@ void VulkanManager::createDescriptorSetLayout()
 	// Struct which contains information about the layout binding 
 	VkDescriptorSetLayoutBinding samplerLayoutBinding = {};
 	samplerLayoutBinding.binding = 1;
-	samplerLayoutBinding.descriptorCount = 1;
+	samplerLayoutBinding.descriptorCount = FrameworkSingleton::getInstance()->textureArraysActive ? maxTextureArrays : 1; // One sampler for each texture array when textures are packed into arrays
 	samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	samplerLayoutBinding.pImmutableSamplers = nullptr;
 	samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -721,64 +2424,189 @@ void VulkanManager::createDescriptorSetLayout()
 }
 
 // Function which handles in index buffer - using the vertex data and various buffers to change a triangle to a square
-void VulkanManager::createIndexBuffer(std::vector<uint32_t> shape, VkBuffer &shapeIndexBuffer, VkDeviceMemory &shapeIndexBufferMemory)
+void VulkanManager::createIndexBuffer(std::vector<uint32_t> shape, VkBuffer &shapeIndexBuffer, VkIndexType &shapeIndexType)
 {
-	// Culculate the buffer size based on the number of incidies 
-	VkDeviceSize bufferSize = sizeof(shape[0]) * shape.size();
+	std::vector<uint8_t> indexData;
+	layoutIndices(shape, indexData, shapeIndexType);
+	createDeviceLocalBuffer(indexData.data(), indexData.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, shapeIndexBuffer);
+}
+
+// Function which uploads a mesh into the geometry buffer and points its buffers at the shared ones - a mesh that does not fit, or every mesh when
+// the geometry buffer is not used, is given a vertex and index buffer of its own and a range starting at zero
+void VulkanManager::createMeshBuffers(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range)
+{
+	std::vector<uint8_t> vertexData, indexData;
+	layoutVertices(vertices, vertexData, dequantisation);
+	layoutIndices(indices, indexData, indexType);
+
+	GeometryBuffer &geometryBuffer = FrameworkSingleton::getInstance()->geometryBuffer;
+	if (geometryBuffer.allocate(static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(indices.size()), indexType, range))
+	{
+		copyToDeviceLocalBuffer(vertexData.data(), vertexData.size(), geometryBuffer.vertexBuffer, geometryBuffer.vertexByteOffset(range));
+		copyToDeviceLocalBuffer(indexData.data(), indexData.size(), geometryBuffer.indexBuffer, geometryBuffer.indexByteOffset(range, indexType));
+		vertexBuffer = geometryBuffer.vertexBuffer;
+		indexBuffer = geometryBuffer.indexBuffer;
+		return;
+	}
+
+	range = MeshRange();
+	range.vertexCount = static_cast<uint32_t>(vertices.size());
+	range.indexCount = static_cast<uint32_t>(indices.size());
+	createDeviceLocalBuffer(vertexData.data(), vertexData.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexBuffer);
+	createDeviceLocalBuffer(indexData.data(), indexData.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBuffer);
+}
 
-	// Create a staging buffer which will stage the data 
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+// Function which uploads the vertices of a mesh that draws another mesh's indices - its range takes the index range of the other mesh
+void VulkanManager::createMeshVertexBuffer(const std::vector<Vertex> &vertices, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, const MeshRange &indexRange, MeshRange &range)
+{
+	std::vector<uint8_t> vertexData;
+	layoutVertices(vertices, vertexData, dequantisation);
 
-	// Copying the vertex data to the buffer - done by mapping the buffer memory into the CPU 
-	void* data;
-	vkMapMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory, 0, bufferSize, 0, &data); // Map the data to the memory (logical device, staging buffer memory memory, offset, size, specify flags, data)
-	memcpy(data, shape.data(), (size_t)bufferSize); // Memory copy the indicy data to the mapped memory then unmap the memory
-	vkUnmapMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory);
+	GeometryBuffer &geometryBuffer = FrameworkSingleton::getInstance()->geometryBuffer;
+	if (geometryBuffer.allocate(static_cast<uint32_t>(vertices.size()), 0, VK_INDEX_TYPE_UINT32, range))
+	{
+		copyToDeviceLocalBuffer(vertexData.data(), vertexData.size(), geometryBuffer.vertexBuffer, geometryBuffer.vertexByteOffset(range));
+		vertexBuffer = geometryBuffer.vertexBuffer;
+	}
+	else
+	{
+		range = MeshRange();
+		range.vertexCount = static_cast<uint32_t>(vertices.size());
+		createDeviceLocalBuffer(vertexData.data(), vertexData.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexBuffer);
+	}
+	range.firstIndex = indexRange.firstIndex;
+	range.indexCount = indexRange.indexCount;
+}
 
-	// Create a buffer using the index information
-	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shapeIndexBuffer, shapeIndexBufferMemory);
+// Function which lays vertices out as they are uploaded - packed when the packed layout is used, with the transform pushed to the vertex shader to unpack them
+void VulkanManager::layoutVertices(const std::vector<Vertex> &vertices, std::vector<uint8_t> &vertexData, VertexDequantisation &dequantisation)
+{
+	if (FrameworkSingleton::getInstance()->usePackedVertices)
+	{
+		std::vector<PackedVertex> packedVertices;
+		packVertices(vertices, packedVertices, dequantisation);
+		const uint8_t *packedData = reinterpret_cast<const uint8_t*>(packedVertices.data());
+		vertexData.assign(packedData, packedData + sizeof(PackedVertex) * packedVertices.size());
+	}
+	else
+	{
+		dequantisation.offset = glm::vec4(0.0f);
+		dequantisation.scale = glm::vec4(1.0f);
+		const uint8_t *fullData = reinterpret_cast<const uint8_t*>(vertices.data());
+		vertexData.assign(fullData, fullData + sizeof(Vertex) * vertices.size());
+	}
+}
 
-	// Copy botht the staging and index buffer 
-	copyBuffer(stagingBuffer, shapeIndexBuffer, bufferSize);
+// Function which lays indices out as they are uploaded - 16 bit when every index fits, which halves their size
+void VulkanManager::layoutIndices(const std::vector<uint32_t> &indices, std::vector<uint8_t> &indexData, VkIndexType &indexType)
+{
+	uint32_t largestIndex = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+	if (largestIndex <= 0xFFFF)
+	{
+		std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+		const uint8_t *shortData = reinterpret_cast<const uint8_t*>(shortIndices.data());
+		indexData.assign(shortData, shortData + sizeof(uint16_t) * shortIndices.size());
+		indexType = VK_INDEX_TYPE_UINT16;
+	}
+	else
+	{
+		const uint8_t *fullData = reinterpret_cast<const uint8_t*>(indices.data());
+		indexData.assign(fullData, fullData + sizeof(uint32_t) * indices.size());
+		indexType = VK_INDEX_TYPE_UINT32;
+	}
+}
 
-	// Destroy and free the staging buffers 
-	vkDestroyBuffer(FrameworkSingleton::getInstance()->device, stagingBuffer, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory, nullptr);
+// Function which creates a buffer in device local memory and fills it with the data passed in through a staging buffer
+void VulkanManager::createDeviceLocalBuffer(const void *bufferData, VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkBuffer &buffer)
+{
+	// Create the device local buffer - it is the destination of the copy from the staging buffer
+	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer);
+	copyToDeviceLocalBuffer(bufferData, bufferSize, buffer, 0);
 }
 
-// Buffers in Vulkan are regions of memory used for storing arbitrary data that can be read by the graphics card - in this case, storing vertex data
-void VulkanManager::createVertexBuffer(std::vector<Vertex> vertexInformation, VkBuffer &shapeVertexBuffer, VkDeviceMemory &shapeVertexBufferMemory)
+// Function which copies data into part of a device local buffer through the staging ring - recorded into the upload context, so the copy has finished once the ticket
+// of the next submission has, and the data can be freed straight away
+void VulkanManager::copyToDeviceLocalBuffer(const void *bufferData, VkDeviceSize bufferSize, VkBuffer buffer, VkDeviceSize offset)
 {
-	// Calculate the buffer size based on the number of vertices 
-	VkDeviceSize bufferSize = sizeof(vertexInformation[0]) * vertexInformation.size();
-	// Create a staging buffer which is used for copying the vertex data. 
-	VkBuffer stagingBuffer;
-	// Staging buffer memory which handles the variable memory size of the staging buffer 
-	VkDeviceMemory stagingBufferMemory;
-	// Call the create buffer function pass the required staging information required
-	createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	// Empty meshes have nothing to copy
+	if (bufferSize == 0)
+	{
+		return;
+	}
+
+	VkCommandBuffer commandBuffer = FrameworkSingleton::getInstance()->uploadContext.begin();
+	recordStagedBufferUpload(commandBuffer, bufferData, bufferSize, buffer, offset);
+}
 
-	// Copying the vertex data to the buffer - done by mapping the buffer memory into the CPU 
-	void* data;
-	vkMapMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory, 0, bufferSize, 0, &data); // Map the data to the memory (logical device, VB memory, offset, size, specify flags, data)
-	memcpy(data, vertexInformation.data(), (size_t)bufferSize); // Memory copy the vertex data to the mapped memory then unmap the memory
-	vkUnmapMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory);
+// Function which copies data into the staging ring and records its copy into part of a buffer - in chunks when it is larger than a region of the ring
+// commandBuffer must be the upload context's as it is flushed when the ring fills
+void VulkanManager::recordStagedBufferUpload(VkCommandBuffer &commandBuffer, const void *bufferData, VkDeviceSize bufferSize, VkBuffer buffer, VkDeviceSize offset)
+{
+	const uint8_t *data = static_cast<const uint8_t*>(bufferData);
+	VkDeviceSize largestRegion = FrameworkSingleton::getInstance()->stagingRing.largestRegion();
+	for (VkDeviceSize copied = 0; copied < bufferSize;)
+	{
+		VkDeviceSize chunkSize = std::min(bufferSize - copied, largestRegion);
+		StagingRegion staged = stageUpload(commandBuffer, chunkSize);
+		memcpy(staged.data, data + copied, static_cast<size_t>(chunkSize));
+
+		VkBufferCopy copyRegion = {};
+		copyRegion.srcOffset = staged.offset;
+		copyRegion.dstOffset = offset + copied;
+		copyRegion.size = chunkSize;
+		vkCmdCopyBuffer(commandBuffer, FrameworkSingleton::getInstance()->stagingRing.buffer, buffer, 1, &copyRegion);
+		copied += chunkSize;
+	}
+}
 
-	// Call the create buffer function pass the required vertex information required
-	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shapeVertexBuffer, shapeVertexBufferMemory);
+// Function which records the push constant that unpacks vertex positions - only needed when the packed vertex layout is used
+void VulkanManager::pushVertexDequantisation(VkCommandBuffer commandBuffer, const VertexDequantisation &dequantisation)
+{
+	if (FrameworkSingleton::getInstance()->usePackedVertices)
+	{
+		vkCmdPushConstants(commandBuffer, FrameworkSingleton::getInstance()->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexDequantisation), &dequantisation);
+	}
+}
 
-	// Copy both buffers to the Device Logical buffer
-	copyBuffer(stagingBuffer, shapeVertexBuffer, bufferSize);
+// Function which records what the next draw needs to sample its texture - its layer when textures are packed into arrays, otherwise its own descriptor set -
+// and to read its uniform buffer object from the slice of the uniform arena for the frame drawn into swap chain image frame
+// boundDescriptors is what was last bound in this command buffer so the set is only bound again when it or the object changes
+void VulkanManager::recordTextureBind(VkCommandBuffer commandBuffer, uint32_t frame, VkDescriptorSet desSet, VkDescriptorSet arrayDesSet, uint32_t uniformObject, const TextureLayer &textureLayer, DescriptorBinding &boundDescriptors)
+{
+	VkDescriptorSet neededDesSet = FrameworkSingleton::getInstance()->textureArraysActive ? arrayDesSet : desSet;
+	uint32_t uniformOffset = FrameworkSingleton::getInstance()->uniformArena.dynamicOffset(frame, uniformObject);
+	if (neededDesSet != boundDescriptors.descriptorSet || uniformOffset != boundDescriptors.uniformOffset)
+	{
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->pipelineLayout, 0, 1, &neededDesSet, 1, &uniformOffset);
+		boundDescriptors.descriptorSet = neededDesSet;
+		boundDescriptors.uniformOffset = uniformOffset;
+	}
+	if (FrameworkSingleton::getInstance()->textureArraysActive)
+	{
+		vkCmdPushConstants(commandBuffer, FrameworkSingleton::getInstance()->pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(VertexDequantisation), sizeof(TextureLayer), &textureLayer);
+	}
+}
 
-	// Destory and then free the staging buffer
-	vkDestroyBuffer(FrameworkSingleton::getInstance()->device, stagingBuffer, nullptr);
-	vkFreeMemory(FrameworkSingleton::getInstance()->device, stagingBufferMemory, nullptr);
+// Function which records the vertex and index buffers the next draw reads - boundGeometry is what was last bound in this command buffer
+// so meshes in the geometry buffer only bind it once, and again only to switch index type or after a mesh with buffers of its own
+void VulkanManager::recordGeometryBind(VkCommandBuffer commandBuffer, VkBuffer vertexBuffer, VkBuffer indexBuffer, VkIndexType indexType, GeometryBinding &boundGeometry)
+{
+	if (vertexBuffer != boundGeometry.vertexBuffer)
+	{
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+		boundGeometry.vertexBuffer = vertexBuffer;
+	}
+	if (indexBuffer != boundGeometry.indexBuffer || indexType != boundGeometry.indexType)
+	{
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+		boundGeometry.indexBuffer = indexBuffer;
+		boundGeometry.indexType = indexType;
+	}
 }
 
 // Function which is called apon to create buffers with data passed in such as vertex or fragment
-void VulkanManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+void VulkanManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer)
 {
 	// Struct which contains information about the Vertex Buffer
 	VkBufferCreateInfo bufferInfo = {};
@@ -793,50 +2621,20 @@ void VulkanManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, Vk
 		throw std::runtime_error("failed to create buffer!");
 	}
 
-	// Create an object which defines the memory requirements for the vertex buffer 
-	VkMemoryRequirements memRequirements;
-	// Object which gets buffer memory requirements taking in logical device, vertex buffer object and memReuirements object 
-	vkGetBufferMemoryRequirements(FrameworkSingleton::getInstance()->device, buffer, &memRequirements);
-
-	// With the correct memory determined using findMemoryType function, the actual memory allocation can occur 
-	// Struct which allocates the memory for the vertex buffer
-	VkMemoryAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size; // Define the size which was derived from the memory requirements
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties); // Set the type
-
-	// Initialise the memory for the vertex buffer - if unsuccessful throw an error 
-	if (vkAllocateMemory(FrameworkSingleton::getInstance()->device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to allocate buffer memory!");
-	}
-
-	// Bind the vertex buffer and the memory 
-	vkBindBufferMemory(FrameworkSingleton::getInstance()->device, buffer, bufferMemory, 0);
+	// Bind the buffer to a range of a memory block of the right type - if unsuccessful the allocator throws an error
+	FrameworkSingleton::getInstance()->memoryAllocator.bindBuffer(buffer, properties);
 }
 
-// Function which copies the contents from one buffer to another 
-void VulkanManager::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+// Function which deals with Layout Transitions - recorded into the upload context so it is submitted ahead of the next frame
+void VulkanManager::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
 {
-	// Set the command buffer to start recording - contained in another function 
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-	// Copy the buffer - use a struct to calculate the size
-	VkBufferCopy copyRegion = {};
-	copyRegion.size = size;
-	// Actually copy the buffer
-	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-	// End the recording of the command buffer 
-	endSingleTimeCommands(commandBuffer);
+	// Record the transition
+	recordImageLayoutTransition(FrameworkSingleton::getInstance()->uploadContext.begin(), image, format, oldLayout, newLayout, 1);
 }
 
-// Function which deals with Layout Transitions 
-void VulkanManager::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
+// Function which records an image layout transition into a command buffer that is already recording
+void VulkanManager::recordImageLayoutTransition(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t arrayLayers)
 {
-	// Begin the recording of the command buffer
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
 	// Struct which holds the information about an image memory barrier. 
 	VkImageMemoryBarrier barrier = {};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER; // Set type of struct to image memory barrier
@@ -865,9 +2663,9 @@ void VulkanManager::transitionImageLayout(VkImage image, VkFormat format, VkImag
 	}
 
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.layerCount = arrayLayers;
 
 	// Pipeline flags which store information regarding what stage the pipeline is at 
 	VkPipelineStageFlags sourceStage;
@@ -914,9 +2712,6 @@ void VulkanManager::transitionImageLayout(VkImage image, VkFormat format, VkImag
 		0, nullptr,
 		1, &barrier
 	);
-
-	// End the recording of the command buffer
-	endSingleTimeCommands(commandBuffer);
 }
 
 // Function which defines the memory type as graphics cards can vary on different types of memories they offer 
@@ -952,6 +2747,15 @@ void VulkanManager::createSemaphores()
 	{
 		throw std::runtime_error("failed to create semaphores!");
 	}
+
+	// The frame fence starts signalled so waiting for the last frame before the first has been drawn returns straight away
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	if (vkCreateFence(FrameworkSingleton::getInstance()->device, &fenceInfo, nullptr, &FrameworkSingleton::getInstance()->frameFence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create frame fence!");
+	}
 }
 
 // Function which stores additinal pipeline information such as the framebuffer attachtments - ie how many colour and dpeth buffers there will be 
@@ -1047,7 +2851,7 @@ void VulkanManager::createImageViews()
 	// Loop which iterates over all the swap chain images 
 	for (uint32_t i = 0; i < FrameworkSingleton::getInstance()->swapChainImages.size(); i++)
 	{
-		FrameworkSingleton::getInstance()->swapChainImageViews[i] = createImageView(FrameworkSingleton::getInstance()->swapChainImages[i], FrameworkSingleton::getInstance()->swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, FrameworkSingleton::getInstance()->twoDImageView);
+		FrameworkSingleton::getInstance()->swapChainImageViews[i] = createImageView(FrameworkSingleton::getInstance()->swapChainImages[i], FrameworkSingleton::getInstance()->swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, FrameworkSingleton::getInstance()->twoDImageView);
 	}
 }
 
@@ -1062,13 +2866,35 @@ void VulkanManager::recreateSwapChain()
 
 	// Recreate the Swap Chain itself 
 	createSwapChain();
+	// The uniform arena has a slice for each swap chain image - given more images it is made again with a slice for each and the sets reading it updated
+	if (FrameworkSingleton::getInstance()->uniformArena.resize(static_cast<uint32_t>(FrameworkSingleton::getInstance()->swapChainImages.size())))
+	{
+		updateUniformDescriptorSets();
+	}
+	// So do the level of detail draws and visible index buffers - given a different number of images they are made again with a slice for each
+	if (FrameworkSingleton::getInstance()->swapChainImages.size() != FrameworkSingleton::getInstance()->lodDrawSliceCount)
+	{
+		createLodDrawBuffer();
+		FrameworkSingleton::getInstance()->visibleIndexChaletModelCapacity = 0;
+		FrameworkSingleton::getInstance()->visibleIndexSceneryModelCapacity = 0;
+		createMeshletIndexBuffers();
+	}
+	// And the terrain's patch lists, draw parameters and terrain uniform buffers
+	if (FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->terrainManager.resize(static_cast<uint32_t>(FrameworkSingleton::getInstance()->swapChainImages.size()));
+	}
 	// Recreate the image view because they are based difrectly on the swap chain images
 	createImageViews();
 	// The render pass is recreated because it depends on the format of the swap chain images - rare but check just incase
 	createRenderPass();
 	// Recreate the graphics pipeline due to the fact the viewport and scissor size may have been changed hence rebuilidng is required 
-	createGraphicsPipeline("shaders/vert.spv", "shaders/frag.spv");
-	createSkyboxGraphicsPipeline("shaders/vert.spv", "shaders/frag.spv");
+	createGraphicsPipeline(FrameworkSingleton::getInstance()->usePackedVertices ? "shaders/packedVert.spv" : "shaders/vert.spv", FrameworkSingleton::getInstance()->textureArraysActive ? "shaders/arrayFrag.spv" : "shaders/frag.spv");
+	createSkyboxGraphicsPipeline(FrameworkSingleton::getInstance()->usePackedVertices ? "shaders/packedSkyVert.spv" : "shaders/skyVert.spv", "shaders/skyFrag.spv");
+	if (FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->terrainManager.createPipeline();
+	}
 	// Recreate the depth buffers
 	createDepthResources();
 	// Recreate all buffers as they are based on the swap chain images 
@@ -1185,6 +3011,29 @@ void VulkanManager::createLogicalDevice()
 	VkPhysicalDeviceFeatures deviceFeatures = {};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+	// Enable BC texture compression if the device has it - textures are uploaded uncompressed otherwise
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(FrameworkSingleton::getInstance()->physicalDevice, &supportedFeatures);
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+	FrameworkSingleton::getInstance()->textureCompressionBCSupported = supportedFeatures.textureCompressionBC == VK_TRUE;
+
+	// Texture arrays are picked by a push constant index so the sampler array has to be indexable - streamed textures arrive one at a time and keep their own sets
+	if (FrameworkSingleton::getInstance()->useTextureArrays && !FrameworkSingleton::getInstance()->streamAssets && supportedFeatures.shaderSampledImageArrayDynamicIndexing)
+	{
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+		FrameworkSingleton::getInstance()->textureArraysActive = true;
+	}
+	else if (FrameworkSingleton::getInstance()->useTextureArrays)
+	{
+		std::cout << (FrameworkSingleton::getInstance()->streamAssets ? "Texture arrays not used: turn off streamAssets to pack textures into texture arrays\n" : "Texture arrays not used: the device cannot index sampler arrays\n");
+	}
+
+	// Mip levels can only be blitted on the GPU if uncompressed textures can be linearly filtered when blitting
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(FrameworkSingleton::getInstance()->physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &formatProperties);
+	VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	FrameworkSingleton::getInstance()->textureMipmapBlitSupported = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+
 	// Creation of the logical device 
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -1361,8 +3210,8 @@ void VulkanManager::setupDebugCallback()
 	}
 }
 
-// Function which is called as part of the main loop which updates geometry
-void VulkanManager::updateUniformBuffer(VkDeviceMemory uniformBuffMemory)
+// Function which is called as part of the main loop which updates geometry - writes an object's uniform data for the frame drawn into swap chain image frame
+void VulkanManager::updateUniformObject(uint32_t uniformObject, uint32_t frame)
 {
 	// Start the time in seconds as the rendering has started with floating point accuracy - required for movement - like delta time
 	static auto startTime = std::chrono::high_resolution_clock::now();
@@ -1374,17 +3223,7 @@ void VulkanManager::updateUniformBuffer(VkDeviceMemory uniformBuffMemory)
 	// Struct which contains the Model view projection matrix information stored in the uniform buffer object
 	UniformBufferObject ubo = {};
 
-	// If the uniform buffer is the default uniform buffer then dont rotate
-	if (uniformBuffMemory == FrameworkSingleton::getInstance()->uniformBufferMemory)
-	{
-		ubo.model = glm::rotate(glm::mat4(1.0f), 0.0f, glm::vec3(0.0f, 0.0f, 1.0f)); // Multiple radian * time part by 0.01f to go really really slow 
-		//ubo.model = glm::scale(glm::vec3(4.0f, 4.0f, 4.0f));
-	}
-	else // Else rotate by 90 degrees using delta time
-	{
-		ubo.model = glm::scale(glm::vec3(3.0f, 3.0f, 3.0f));
-		//ubo.model = glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-	}
+	ubo.model = modelMatrix(uniformObject);
 
 	//ubo.view = glm::lookAt(glm::vec3(4.0f, 4.0f, 4.0f), glm::vec3(0,0,0), glm::vec3(0.0f, 0.0f, 1.0f)); // Camera distance, focus point, up axis
 	//ubo.proj = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float)swapChainExtent.height, 0.1f, 10.0f); // 45 degree field of view, aspect ratio, near and far view planes
@@ -1401,16 +3240,196 @@ void VulkanManager::updateUniformBuffer(VkDeviceMemory uniformBuffMemory)
 
 	ubo.proj[1][1] *= -1;
 
-	// Once the MVP is set, copy the uniform data over
-	void* data;
-	vkMapMemory(FrameworkSingleton::getInstance()->device, uniformBuffMemory, 0, sizeof(ubo), 0, &data);
-	memcpy(data, &ubo, sizeof(ubo));
-	vkUnmapMemory(FrameworkSingleton::getInstance()->device, uniformBuffMemory);
+	// Once the MVP is set, copy the uniform data over into this frame's slice of the arena
+	FrameworkSingleton::getInstance()->uniformArena.write(frame, uniformObject, &ubo, sizeof(ubo));
+}
+
+// Function which returns the model matrix used with a uniform buffer object
+glm::mat4 VulkanManager::modelMatrix(uint32_t uniformObject)
+{
+	// If the uniform buffer object is the default one then dont rotate
+	if (uniformObject == FrameworkSingleton::getInstance()->uniformObject)
+	{
+		return glm::rotate(glm::mat4(1.0f), 0.0f, glm::vec3(0.0f, 0.0f, 1.0f)); // Multiple radian * time part by 0.01f to go really really slow 
+		//return glm::scale(glm::vec3(4.0f, 4.0f, 4.0f));
+	}
+	else // Else rotate by 90 degrees using delta time
+	{
+		return glm::scale(glm::vec3(3.0f, 3.0f, 3.0f));
+		//return glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	}
+}
+
+// Function which creates the buffer the models' draws read their index range from, with a slice for every swap chain image, and fills it with the full models
+void VulkanManager::createLodDrawBuffer()
+{
+	if (FrameworkSingleton::getInstance()->lodDrawBuffer != VK_NULL_HANDLE)
+	{
+		FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(FrameworkSingleton::getInstance()->lodDrawBuffer);
+	}
+	FrameworkSingleton::getInstance()->lodDrawSliceCount = static_cast<uint32_t>(FrameworkSingleton::getInstance()->swapChainImages.size());
+	createBuffer(FrameworkSingleton::getInstance()->lodDrawSliceCount * 2 * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, FrameworkSingleton::getInstance()->lodDrawBuffer);
+
+	// The cameras do not exist yet so start with the full models
+	std::array<VkDrawIndexedIndirectCommand, 2> draws = {};
+	draws[0] = modelLodDraw(FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->modelChaletLods, 0, FrameworkSingleton::getInstance()->rangeChaletModel);
+	draws[1] = modelLodDraw(FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->modelSceneryLods, 0, FrameworkSingleton::getInstance()->rangeSceneryModel);
+	uint8_t* data = static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(FrameworkSingleton::getInstance()->lodDrawBuffer));
+	for (uint32_t slice = 0; slice < FrameworkSingleton::getInstance()->lodDrawSliceCount; slice++)
+	{
+		memcpy(data + slice * sizeof(draws), draws.data(), sizeof(draws));
+	}
+}
+
+// Function which creates the host visible index buffer a model's visible meshlets are copied into, with a slice for every swap chain image
+// It is only made again when a larger model arrives or the number of swap chain images changes
+void VulkanManager::createMeshletIndexBuffer(const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, VkBuffer &buffer, uint32_t &capacity)
+{
+	// Models without meshlets, such as the placeholders, keep drawing from their own index buffer
+	if (modelLods.meshletLevels.empty() || modelLods.levels[0].indexCount <= capacity)
+	{
+		return;
+	}
+	if (buffer != VK_NULL_HANDLE)
+	{
+		FrameworkSingleton::getInstance()->memoryAllocator.destroyBuffer(buffer);
+	}
+
+	// No level has more triangles than the full model so it sets the size of each slice
+	capacity = modelLods.levels[0].indexCount;
+	VkDeviceSize sliceSize = sizeof(uint32_t) * capacity;
+	createBuffer(FrameworkSingleton::getInstance()->lodDrawSliceCount * sliceSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer);
+
+	// Start with the full model until the first frame is culled
+	uint8_t* data = static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(buffer));
+	for (uint32_t slice = 0; slice < FrameworkSingleton::getInstance()->lodDrawSliceCount; slice++)
+	{
+		memcpy(data + slice * sliceSize, modelIndices.data() + modelLods.levels[0].firstIndex, static_cast<size_t>(sliceSize));
+	}
+}
+
+// Function which creates the visible index buffers of the models when meshlet culling is used
+void VulkanManager::createMeshletIndexBuffers()
+{
+	if (!FrameworkSingleton::getInstance()->useMeshletCulling)
+	{
+		return;
+	}
+	createMeshletIndexBuffer(FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->modelChaletLods, FrameworkSingleton::getInstance()->visibleIndexChaletModel, FrameworkSingleton::getInstance()->visibleIndexChaletModelCapacity);
+	if (!FrameworkSingleton::getInstance()->useTerrain)
+	{
+		createMeshletIndexBuffer(FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->modelSceneryLods, FrameworkSingleton::getInstance()->visibleIndexSceneryModel, FrameworkSingleton::getInstance()->visibleIndexSceneryModelCapacity);
+	}
+}
+
+// Function which copies the visible meshlets of the chosen level of a model into its visible index buffer from firstIndex on and returns the draw of them
+// The indices are copied as they are so the draw still takes the model's vertices from its range
+VkDrawIndexedIndirectCommand VulkanManager::cullModelMeshlets(const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, size_t level, const MeshRange &range, VkBuffer buffer, uint32_t firstIndex, const glm::mat4 &model, const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition)
+{
+	FrameworkSingleton::getInstance()->meshletCuller.setView(model, viewProjection, cameraPosition);
+
+	uint32_t* data = static_cast<uint32_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(buffer)) + firstIndex;
+	VkDrawIndexedIndirectCommand draw = {};
+	draw.instanceCount = 1;
+	draw.firstIndex = firstIndex;
+	draw.vertexOffset = static_cast<int32_t>(range.firstVertex);
+	draw.indexCount = FrameworkSingleton::getInstance()->meshletCuller.cull(modelLods, level, modelIndices.data(), data);
+	return draw;
+}
+
+// Function which returns the draw parameters of one level of detail of a model - models without levels of detail, such as the placeholders, draw all their indices
+// The level is found within the model's range of its index and vertex buffers
+VkDrawIndexedIndirectCommand VulkanManager::modelLodDraw(const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, size_t level, const MeshRange &range)
+{
+	VkDrawIndexedIndirectCommand draw = {};
+	draw.instanceCount = 1;
+	draw.firstIndex = range.firstIndex;
+	draw.vertexOffset = static_cast<int32_t>(range.firstVertex);
+	if (modelLods.levels.empty())
+	{
+		draw.indexCount = static_cast<uint32_t>(modelIndices.size());
+		return draw;
+	}
+	draw.indexCount = modelLods.levels[level].indexCount;
+	draw.firstIndex += modelLods.levels[level].firstIndex;
+	return draw;
+}
+
+// Function which picks the coarsest level of detail whose error would cover at most lodPixelError pixels on screen
+size_t VulkanManager::selectModelLod(const MeshLods &modelLods, const glm::mat4 &model, const glm::vec3 &cameraPosition, float projectionScale)
+{
+	if (modelLods.levels.size() <= 1)
+	{
+		return 0;
+	}
+
+	// Move the bounding sphere into the world - errors grow with the largest scale of the model matrix
+	glm::vec3 centre = glm::vec3(model * glm::vec4(modelLods.boundsCentre, 1.0f));
+	float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	float distance = glm::length(centre - cameraPosition) - modelLods.boundsRadius * scale;
+
+	// Inside the bounding sphere some part of the model may be right in front of the camera
+	if (distance <= 0.0f)
+	{
+		return 0;
+	}
+
+	// Pixels covered by one world unit at the nearest point of the bounding sphere
+	float pixelsPerUnit = projectionScale / distance;
+	size_t level = 0;
+	while (level + 1 < modelLods.levels.size() && modelLods.levels[level + 1].error * scale * pixelsPerUnit <= FrameworkSingleton::getInstance()->lodPixelError)
+	{
+		level++;
+	}
+	return level;
+}
+
+// Function which chooses the level of detail of every model for this frame and writes their draw parameters into the slices only this image's command buffer reads
+void VulkanManager::updateLodDraws(uint32_t imageIndex)
+{
+	glm::mat4 view, proj;
+	if (FrameworkSingleton::getInstance()->cameraType == 0)
+	{
+		view = FrameworkSingleton::getInstance()->freeCam->get_View();
+		proj = FrameworkSingleton::getInstance()->freeCam->get_Projection();
+	}
+	else
+	{
+		view = FrameworkSingleton::getInstance()->targetCamera->get_View();
+		proj = FrameworkSingleton::getInstance()->targetCamera->get_Projection();
+	}
+	glm::vec3 cameraPosition = glm::vec3(glm::inverse(view)[3]);
+	// proj[1][1] is 1 / tan(fov / 2) so this turns a size at unit distance into pixels
+	float projectionScale = std::abs(proj[1][1]) * FrameworkSingleton::getInstance()->swapChainExtent.height * 0.5f;
+
+	glm::mat4 chaletModel = modelMatrix(FrameworkSingleton::getInstance()->rotatingUniformObject);
+	glm::mat4 sceneryModel = modelMatrix(FrameworkSingleton::getInstance()->uniformObject);
+	size_t chaletLevel = selectModelLod(FrameworkSingleton::getInstance()->modelChaletLods, chaletModel, cameraPosition, projectionScale);
+	size_t sceneryLevel = selectModelLod(FrameworkSingleton::getInstance()->modelSceneryLods, sceneryModel, cameraPosition, projectionScale);
+
+	std::array<VkDrawIndexedIndirectCommand, 2> draws = {};
+	draws[0] = modelLodDraw(FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->modelChaletLods, chaletLevel, FrameworkSingleton::getInstance()->rangeChaletModel);
+	draws[1] = modelLodDraw(FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->modelSceneryLods, sceneryLevel, FrameworkSingleton::getInstance()->rangeSceneryModel);
+	// Models with a visible index buffer draw only the meshlets that survive culling - a model streamed in since the buffers were made keeps its full draw until they are made again
+	if (FrameworkSingleton::getInstance()->visibleIndexChaletModel != VK_NULL_HANDLE && !FrameworkSingleton::getInstance()->modelChaletLods.meshletLevels.empty() && FrameworkSingleton::getInstance()->modelChaletLods.levels[0].indexCount <= FrameworkSingleton::getInstance()->visibleIndexChaletModelCapacity)
+	{
+		draws[0] = cullModelMeshlets(FrameworkSingleton::getInstance()->modelChaletIndices, FrameworkSingleton::getInstance()->modelChaletLods, chaletLevel, FrameworkSingleton::getInstance()->rangeChaletModel, FrameworkSingleton::getInstance()->visibleIndexChaletModel, imageIndex * FrameworkSingleton::getInstance()->visibleIndexChaletModelCapacity, chaletModel, proj * view, cameraPosition);
+	}
+	if (FrameworkSingleton::getInstance()->visibleIndexSceneryModel != VK_NULL_HANDLE && !FrameworkSingleton::getInstance()->modelSceneryLods.meshletLevels.empty() && FrameworkSingleton::getInstance()->modelSceneryLods.levels[0].indexCount <= FrameworkSingleton::getInstance()->visibleIndexSceneryModelCapacity)
+	{
+		draws[1] = cullModelMeshlets(FrameworkSingleton::getInstance()->modelSceneryIndices, FrameworkSingleton::getInstance()->modelSceneryLods, sceneryLevel, FrameworkSingleton::getInstance()->rangeSceneryModel, FrameworkSingleton::getInstance()->visibleIndexSceneryModel, imageIndex * FrameworkSingleton::getInstance()->visibleIndexSceneryModelCapacity, sceneryModel, proj * view, cameraPosition);
+	}
+
+	memcpy(static_cast<uint8_t*>(FrameworkSingleton::getInstance()->memoryAllocator.mappedData(FrameworkSingleton::getInstance()->lodDrawBuffer)) + imageIndex * sizeof(draws), draws.data(), sizeof(draws));
 }
 
 // Method which deals with acquiring an image from the swap chain, execute the command buffer and returns the image to the swap chain for presentation
 void VulkanManager::drawFrame()
 {
+	// Wait for the last frame to finish before anything it uses is touched - its wait on the image available semaphore has then completed so the
+	// semaphore can be signalled again, and its command buffer no longer reads the slices this frame writes
+	waitForFrame();
+
 	uint32_t imageIndex;
 	// Acquire the next image from the swap chain using the logical device, swaphcain, timeout in nanoseconds, the semaphore, handle and reference to image index
 	VkResult result = vkAcquireNextImageKHR(FrameworkSingleton::getInstance()->device, FrameworkSingleton::getInstance()->swapChain, std::numeric_limits<uint64_t>::max(), FrameworkSingleton::getInstance()->imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
@@ -1428,6 +3447,17 @@ void VulkanManager::drawFrame()
 		throw std::runtime_error("failed to acquire swap chain image!");
 	}
 
+	// Update the uniform buffer objects to allow for transforms to take place - written into the slice of the arena only this image's command buffer reads
+	updateUniformObject(FrameworkSingleton::getInstance()->uniformObject, imageIndex);
+	updateUniformObject(FrameworkSingleton::getInstance()->rotatingUniformObject, imageIndex);
+	// Pick each model's level of detail for where the camera is now - written into this image's slices like the uniform buffer objects
+	updateLodDraws(imageIndex);
+	// Pick the terrain patches for where the camera is now - the last frame has finished so nothing is still reading them
+	if (FrameworkSingleton::getInstance()->useTerrain)
+	{
+		FrameworkSingleton::getInstance()->terrainManager.update(imageIndex);
+	}
+
 	// Struct which is used for queue submission and synchronization is configured through parameters
 	VkSubmitInfo submitInfo = {};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1447,8 +3477,13 @@ void VulkanManager::drawFrame()
 	submitInfo.signalSemaphoreCount = 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
-	// Submit the command buffer to the graphics queue - if not successful throw an error 
-	if (vkQueueSubmit(FrameworkSingleton::getInstance()->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+	// Submit the uploads recorded since the last frame first - the frame is queued behind them and they are visible to its draws
+	FrameworkSingleton::getInstance()->uploadContext.submit();
+
+	// Submit the command buffer to the graphics queue with the frame fence - if not successful throw an error 
+	// The fence is only reset right before the submission so it is still signalled if the frame is skipped because the swap chain is recreated
+	vkResetFences(FrameworkSingleton::getInstance()->device, 1, &FrameworkSingleton::getInstance()->frameFence);
+	if (vkQueueSubmit(FrameworkSingleton::getInstance()->graphicsQueue, 1, &submitInfo, FrameworkSingleton::getInstance()->frameFence) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
@@ -1477,9 +3512,13 @@ void VulkanManager::drawFrame()
 	{
 		throw std::runtime_error("failed to present swap chain image!");
 	}
+}
 
-	// Deal with the memory leak - this is due to the validation layers expecting the application to sync with the GPU which doesnt always happen 
-	vkQueueWaitIdle(FrameworkSingleton::getInstance()->presentQueue);
+// Function which waits for the last frame submitted to finish drawing - its fence also covers the uploads submitted before it, but not those submitted since
+// so resources the draw command buffers bind can be replaced without stalling on uploads still in flight
+void VulkanManager::waitForFrame()
+{
+	vkWaitForFences(FrameworkSingleton::getInstance()->device, 1, &FrameworkSingleton::getInstance()->frameFence, VK_TRUE, std::numeric_limits<uint64_t>::max());
 }
 
 // Function which deals with the window resizing 
@@ -1742,22 +3781,18 @@ VkExtent2D VulkanManager::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capab
 // Function which reads in the shaders and puts them into the graphics pipeline
 std::vector<char> VulkanManager::readFile(const std::string& filename)
 {
-	// Get the file name with two flags, ate = start reading at the end of the file, binary = read the file as a binary file 
-	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	// Open the file from the asset pack, or from disk if the pack does not hold it
+	AssetFile file;
 
 	// If file cannot be opened then throw an error 
-	if (!file.is_open())
+	if (!FrameworkSingleton::getInstance()->fileSystem.open(filename, file) || file.data() == nullptr)
 	{
 		throw std::runtime_error("failed to open file!");
 	}
 
-	// By reading from the end of the file with the ate flag (ABOVE), the size can be determined to allocate a buffer
-	size_t fileSize = (size_t)file.tellg();
-	std::vector<char> buffer(fileSize);
-
-	//Return to the start of the file and read all the bytes at once
-	file.seekg(0);
-	file.read(buffer.data(), fileSize);
+	// Copy all the bytes into the buffer at once
+	const char* fileData = reinterpret_cast<const char*>(file.data());
+	std::vector<char> buffer(fileData, fileData + file.size());
 
 	// Close file
 	file.close();
@@ -1796,9 +3831,21 @@ void VulkanManager::createSkyboxGraphicsPipeline(std::string vertPath, std::stri
 	// Attribute description - type of attribute passed to the vertex shader which binding to load them from and the offset 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	// Get the binding and attribute information setup in the vertex struct
-	auto bindingDescription = Vertex::getBindingDescription();
-	auto attributeDescriptions = Vertex::getAttributeDescriptions();
+	// Get the binding and attribute information setup in the vertex struct - the packed struct when the packed layout is used as the skybox is packed too
+	VkVertexInputBindingDescription bindingDescription;
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+	if (FrameworkSingleton::getInstance()->usePackedVertices)
+	{
+		auto packedAttributeDescriptions = PackedVertex::getAttributeDescriptions();
+		bindingDescription = PackedVertex::getBindingDescription();
+		attributeDescriptions.assign(packedAttributeDescriptions.begin(), packedAttributeDescriptions.end());
+	}
+	else
+	{
+		auto vertexAttributeDescriptions = Vertex::getAttributeDescriptions();
+		bindingDescription = Vertex::getBindingDescription();
+		attributeDescriptions.assign(vertexAttributeDescriptions.begin(), vertexAttributeDescriptions.end());
+	}
 
 	vertexInputInfo.vertexBindingDescriptionCount = 1;
 	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -1899,9 +3946,20 @@ void VulkanManager::createSkyboxGraphicsPipeline(std::string vertPath, std::stri
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutInfo.setLayoutCount = 1;
 	pipelineLayoutInfo.pSetLayouts = &FrameworkSingleton::getInstance()->descriptorSetLayout;
+	// Push constant range for the vertex dequantisation - both pipelines share it so their layouts stay compatible
+	std::array<VkPushConstantRange, 2> pushConstantRanges = {};
+	pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRanges[0].offset = 0;
+	pushConstantRanges[0].size = sizeof(VertexDequantisation);
+	// The texture layer follows it when textures are packed into arrays
+	pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	pushConstantRanges[1].offset = sizeof(VertexDequantisation);
+	pushConstantRanges[1].size = sizeof(TextureLayer);
+	pipelineLayoutInfo.pushConstantRangeCount = FrameworkSingleton::getInstance()->textureArraysActive ? 2 : 1;
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
 	// Initiate the pipeline layout using the struct above - if not successful throw error 
-	if (vkCreatePipelineLayout(FrameworkSingleton::getInstance()->device, &pipelineLayoutInfo, nullptr, &FrameworkSingleton::getInstance()->pipelineLayout) != VK_SUCCESS)
+	if (vkCreatePipelineLayout(FrameworkSingleton::getInstance()->device, &pipelineLayoutInfo, nullptr, &FrameworkSingleton::getInstance()->skyboxPipelineLayout) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to create pipeline layout!");
 	}
@@ -1918,7 +3976,7 @@ void VulkanManager::createSkyboxGraphicsPipeline(std::string vertPath, std::stri
 	pipelineInfo.pMultisampleState = &multisampling;
 	pipelineInfo.pDepthStencilState = &depthStencil;
 	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.layout = FrameworkSingleton::getInstance()->pipelineLayout;
+	pipelineInfo.layout = FrameworkSingleton::getInstance()->skyboxPipelineLayout;
 	pipelineInfo.renderPass = FrameworkSingleton::getInstance()->renderPass;
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
@@ -1965,9 +4023,21 @@ void VulkanManager::createGraphicsPipeline(std::string vertPath, std::string fra
 	// Attribute description - type of attribute passed to the vertex shader which binding to load them from and the offset 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	// Get the binding and attribute information setup in the vertex struct
-	auto bindingDescription = Vertex::getBindingDescription();
-	auto attributeDescriptions = Vertex::getAttributeDescriptions();
+	// Get the binding and attribute information setup in the vertex struct - the packed struct when the packed layout is used
+	VkVertexInputBindingDescription bindingDescription;
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+	if (FrameworkSingleton::getInstance()->usePackedVertices)
+	{
+		auto packedAttributeDescriptions = PackedVertex::getAttributeDescriptions();
+		bindingDescription = PackedVertex::getBindingDescription();
+		attributeDescriptions.assign(packedAttributeDescriptions.begin(), packedAttributeDescriptions.end());
+	}
+	else
+	{
+		auto vertexAttributeDescriptions = Vertex::getAttributeDescriptions();
+		bindingDescription = Vertex::getBindingDescription();
+		attributeDescriptions.assign(vertexAttributeDescriptions.begin(), vertexAttributeDescriptions.end());
+	}
 
 	vertexInputInfo.vertexBindingDescriptionCount = 1;
 	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -2068,6 +4138,17 @@ void VulkanManager::createGraphicsPipeline(std::string vertPath, std::string fra
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutInfo.setLayoutCount = 1;
 	pipelineLayoutInfo.pSetLayouts = &FrameworkSingleton::getInstance()->descriptorSetLayout;
+	// Push constant range for the vertex dequantisation - both pipelines share it so their layouts stay compatible
+	std::array<VkPushConstantRange, 2> pushConstantRanges = {};
+	pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRanges[0].offset = 0;
+	pushConstantRanges[0].size = sizeof(VertexDequantisation);
+	// The texture layer follows it when textures are packed into arrays
+	pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	pushConstantRanges[1].offset = sizeof(VertexDequantisation);
+	pushConstantRanges[1].size = sizeof(TextureLayer);
+	pipelineLayoutInfo.pushConstantRangeCount = FrameworkSingleton::getInstance()->textureArraysActive ? 2 : 1;
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
 	// Initiate the pipeline layout using the struct above - if not successful throw error 
 	if (vkCreatePipelineLayout(FrameworkSingleton::getInstance()->device, &pipelineLayoutInfo, nullptr, &FrameworkSingleton::getInstance()->pipelineLayout) != VK_SUCCESS)
@@ -2223,55 +4304,77 @@ void VulkanManager::createCommandBuffers()
 		// Command buffer to record the command to, pipeline object is a graphics pipeline, 
 		vkCmdBindPipeline(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->graphicsPipeline);
 
-		// Get the vertex buffer information convert from vk buffer to vk buffer []
-		VkBuffer vertexBox1Buffers[] = { FrameworkSingleton::getInstance()->vertexBox1 };
-		VkBuffer vertexBox2Buffers[] = { FrameworkSingleton::getInstance()->vertexBox2 };
-		VkBuffer vertexBox3Buffers[] = { FrameworkSingleton::getInstance()->vertexBox3 };
-		VkBuffer vertexSceneryModelBuffers[] = { FrameworkSingleton::getInstance()->vertexSceneryModel };
-		VkBuffer vertexChaletModelBuffers[] = { FrameworkSingleton::getInstance()->vertexChaletModel };
-		VkBuffer vertexSkyboxBuffers[] = { FrameworkSingleton::getInstance()->vertexSkybox };
-		// Specify the offset - not existing in this case
-		VkDeviceSize offsets[] = { 0 };
-
-		// Bind the vertex buffers - commandbuffers, offset, number of bindings, vertexbuffers themselves and offests of the vertex data
-		vkCmdBindVertexBuffers(FrameworkSingleton::getInstance()->commandBuffers[i], 0, 1, vertexBox1Buffers, offsets);
-		// Bind the index buffers
-		vkCmdBindIndexBuffer(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->indexBox, 0, VK_INDEX_TYPE_UINT32);
-		// Bind the descriptor sets 
-		vkCmdBindDescriptorSets(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->pipelineLayout, 0, 1, &FrameworkSingleton::getInstance()->cubedescriptorSet, 0, nullptr);
-		// Draw the command buffers (vertex count, instanceCount, firstVertex, firstInstance)
-		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(cubeIndices.size()), 1, 0, 0, 0);
+		// Descriptor set and uniform buffer object last bound - draws sharing both do not bind them again
+		DescriptorBinding boundDescriptors;
+		// Vertex and index buffers last bound - every mesh in the geometry buffer shares them so they are bound once and each draw picks its range
+		GeometryBinding boundGeometry;
+
+		// Bind the vertex and index buffers - commandbuffers, buffers themselves and the buffers bound so far
+		recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexBox1, FrameworkSingleton::getInstance()->indexBox, FrameworkSingleton::getInstance()->indexBoxType, boundGeometry);
+		// Push the transform which unpacks the vertex positions - does nothing unless the packed vertex layout is used
+		pushVertexDequantisation(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->dequantBox1);
+		// Bind the descriptor sets - or push the texture layer when every texture is in the one set
+		recordTextureBind(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(i), FrameworkSingleton::getInstance()->cubedescriptorSet, FrameworkSingleton::getInstance()->textureArrayDescriptorSet, FrameworkSingleton::getInstance()->uniformObject, FrameworkSingleton::getInstance()->boxesTextureLayer, boundDescriptors);
+		// Draw the command buffers (index count, instanceCount, firstIndex, vertexOffset, firstInstance)
+		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->rangeBox1.indexCount, 1, FrameworkSingleton::getInstance()->rangeBox1.firstIndex, static_cast<int32_t>(FrameworkSingleton::getInstance()->rangeBox1.firstVertex), 0);
 
 		// Render box2
-		vkCmdBindVertexBuffers(FrameworkSingleton::getInstance()->commandBuffers[i], 0, 1, vertexBox2Buffers, offsets);
-		vkCmdBindIndexBuffer(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->indexBox, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdBindDescriptorSets(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->pipelineLayout, 0, 1, &FrameworkSingleton::getInstance()->cubedescriptorSet, 0, nullptr);
-		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(cubeIndices.size()), 1, 0, 0, 0);
+		recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexBox2, FrameworkSingleton::getInstance()->indexBox, FrameworkSingleton::getInstance()->indexBoxType, boundGeometry);
+		pushVertexDequantisation(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->dequantBox2);
+		recordTextureBind(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(i), FrameworkSingleton::getInstance()->cubedescriptorSet, FrameworkSingleton::getInstance()->textureArrayDescriptorSet, FrameworkSingleton::getInstance()->uniformObject, FrameworkSingleton::getInstance()->boxesTextureLayer, boundDescriptors);
+		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->rangeBox2.indexCount, 1, FrameworkSingleton::getInstance()->rangeBox2.firstIndex, static_cast<int32_t>(FrameworkSingleton::getInstance()->rangeBox2.firstVertex), 0);
 
 		// Render box3
-		vkCmdBindVertexBuffers(FrameworkSingleton::getInstance()->commandBuffers[i], 0, 1, vertexBox3Buffers, offsets);
-		vkCmdBindIndexBuffer(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->indexBox, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdBindDescriptorSets(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->pipelineLayout, 0, 1, &FrameworkSingleton::getInstance()->cubedescriptorSet, 0, nullptr);
-		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(cubeIndices.size()), 1, 0, 0, 0);
-
-		// Render Chalet Model
-		vkCmdBindVertexBuffers(FrameworkSingleton::getInstance()->commandBuffers[i], 0, 1, vertexChaletModelBuffers, offsets);
-		vkCmdBindIndexBuffer(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->indexChaletModel, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdBindDescriptorSets(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->pipelineLayout, 0, 1, &FrameworkSingleton::getInstance()->modelChaletDescriptorSet, 0, nullptr);
-		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(FrameworkSingleton::getInstance()->modelChaletIndices.size()), 1, 0, 0, 0);
-
-		// Render Terrain Model
-		vkCmdBindVertexBuffers(FrameworkSingleton::getInstance()->commandBuffers[i], 0, 1, vertexSceneryModelBuffers, offsets);
-		vkCmdBindIndexBuffer(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->indexSceneryModel, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdBindDescriptorSets(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->pipelineLayout, 0, 1, &FrameworkSingleton::getInstance()->modelSceneryDescriptorSet, 0, nullptr);
-		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(FrameworkSingleton::getInstance()->modelSceneryIndices.size()), 1, 0, 0, 0);
-
-		// Skybox Cube
-		vkCmdBindDescriptorSets(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->pipelineLayout, 0, 1, &FrameworkSingleton::getInstance()->skyboxDescriptorSet, 0, nullptr);
-		vkCmdBindVertexBuffers(FrameworkSingleton::getInstance()->commandBuffers[i], 0, 1, vertexSkyboxBuffers, offsets);
-		vkCmdBindIndexBuffer(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->indexSkybox, 0, VK_INDEX_TYPE_UINT32);
-		//vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxGraphicsPipeline);
-		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(skyboxIndices.size()), 1, 0, 0, 0);
+		recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexBox3, FrameworkSingleton::getInstance()->indexBox, FrameworkSingleton::getInstance()->indexBoxType, boundGeometry);
+		pushVertexDequantisation(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->dequantBox3);
+		recordTextureBind(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(i), FrameworkSingleton::getInstance()->cubedescriptorSet, FrameworkSingleton::getInstance()->textureArrayDescriptorSet, FrameworkSingleton::getInstance()->uniformObject, FrameworkSingleton::getInstance()->boxesTextureLayer, boundDescriptors);
+		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->rangeBox3.indexCount, 1, FrameworkSingleton::getInstance()->rangeBox3.firstIndex, static_cast<int32_t>(FrameworkSingleton::getInstance()->rangeBox3.firstVertex), 0);
+
+		// Render Chalet Model - meshlet culling copies the visible triangles into their own 32 bit index buffer each frame
+		if (FrameworkSingleton::getInstance()->visibleIndexChaletModel != VK_NULL_HANDLE)
+		{
+			recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexChaletModel, FrameworkSingleton::getInstance()->visibleIndexChaletModel, VK_INDEX_TYPE_UINT32, boundGeometry);
+		}
+		else
+		{
+			recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexChaletModel, FrameworkSingleton::getInstance()->indexChaletModel, FrameworkSingleton::getInstance()->indexChaletModelType, boundGeometry);
+		}
+		pushVertexDequantisation(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->dequantChaletModel);
+		recordTextureBind(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(i), FrameworkSingleton::getInstance()->modelChaletDescriptorSet, FrameworkSingleton::getInstance()->textureArrayDescriptorSet, FrameworkSingleton::getInstance()->rotatingUniformObject, FrameworkSingleton::getInstance()->modelChaletTextureLayer, boundDescriptors);
+		// Draw whichever level of detail was chosen for this frame
+		vkCmdDrawIndexedIndirect(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->lodDrawBuffer, i * 2 * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+
+		// Render Terrain Model - unless the heightmap terrain replaces it
+		if (!FrameworkSingleton::getInstance()->useTerrain)
+		{
+			if (FrameworkSingleton::getInstance()->visibleIndexSceneryModel != VK_NULL_HANDLE)
+			{
+				recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexSceneryModel, FrameworkSingleton::getInstance()->visibleIndexSceneryModel, VK_INDEX_TYPE_UINT32, boundGeometry);
+			}
+			else
+			{
+				recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModel, FrameworkSingleton::getInstance()->indexSceneryModelType, boundGeometry);
+			}
+			pushVertexDequantisation(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->dequantSceneryModel);
+			recordTextureBind(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(i), FrameworkSingleton::getInstance()->modelSceneryDescriptorSet, FrameworkSingleton::getInstance()->textureArrayDescriptorSet, FrameworkSingleton::getInstance()->uniformObject, FrameworkSingleton::getInstance()->modelSceneryTextureLayer, boundDescriptors);
+			vkCmdDrawIndexedIndirect(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->lodDrawBuffer, (i * 2 + 1) * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+		}
+
+		// Skybox Cube - a cube map is sampled by direction so it needs the skybox pipeline, the faces are sampled like any other texture
+		if (FrameworkSingleton::getInstance()->skyboxCubeMapActive)
+		{
+			vkCmdBindPipeline(FrameworkSingleton::getInstance()->commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, FrameworkSingleton::getInstance()->skyboxGraphicsPipeline);
+		}
+		recordTextureBind(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(i), FrameworkSingleton::getInstance()->skyboxDescriptorSet, FrameworkSingleton::getInstance()->textureArrayDescriptorSet, FrameworkSingleton::getInstance()->uniformObject, FrameworkSingleton::getInstance()->skyboxTextureLayer, boundDescriptors);
+		recordGeometryBind(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->vertexSkybox, FrameworkSingleton::getInstance()->indexSkybox, FrameworkSingleton::getInstance()->indexSkyboxType, boundGeometry);
+		pushVertexDequantisation(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->dequantSkybox);
+		vkCmdDrawIndexed(FrameworkSingleton::getInstance()->commandBuffers[i], FrameworkSingleton::getInstance()->rangeSkybox.indexCount, 1, FrameworkSingleton::getInstance()->rangeSkybox.firstIndex, static_cast<int32_t>(FrameworkSingleton::getInstance()->rangeSkybox.firstVertex), 0);
+
+		// Heightmap terrain - drawn last as it binds a pipeline of its own
+		if (FrameworkSingleton::getInstance()->useTerrain)
+		{
+			FrameworkSingleton::getInstance()->terrainManager.recordDraw(FrameworkSingleton::getInstance()->commandBuffers[i], static_cast<uint32_t>(i));
+		}
 
 		// End the render pass 
 		vkCmdEndRenderPass(FrameworkSingleton::getInstance()->commandBuffers[i]);
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "CleanUpManager.h"
+#include "TextureCompressor.h"
+#include "MeshSimplifier.h"
+#include "KtxReader.h"
+#include "VirtualFileSystem.h"
+#include "GeometryBuffer.h"
+#include "StagingRing.h"
 
 #define GLFW_INCLUDE_VULKAN
 #define GLM_FORCE_RADIANS
@@ -30,13 +36,82 @@
 #include <chrono>
 #include <unordered_map>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <omp.h>
+#include <memory>
 
 struct Vertex;
+struct VertexDequantisation;
 struct SwapChainSupportDetails;
 struct QueueFamilyIndices;
 struct UniformBufferObject;
 
+// Struct which holds a texture once it has been decoded or read from the texture cache and is ready to upload
+struct DecodedTexture
+{
+	TextureFormat format = TEXTURE_FORMAT_RGBA8;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t mipLevels = 1;
+	bool generateMipmapsOnGpu = false; // Set if data only holds level 0 and the other levels are blitted on the GPU
+	std::vector<uint8_t> data; // Pixels or compressed blocks of every mip level, largest first
+	const uint8_t *packedData = nullptr; // Set instead of data when the compressed blocks are read straight out of the mounted asset pack
+	size_t packedSize = 0;
+	uint32_t arrayLayers = 1; // Layers of every level - more than one for a KTX array or cube map
+	bool cubeMap = false; // Set for a KTX cube map - its six faces are the layers, in the order +X, -X, +Y, -Y, +Z, -Z
+	std::vector<KtxLevel> levels; // Set instead of data for a KTX file - each level is copied straight out of the mapped file
+	std::shared_ptr<AssetFile> sourceFile; // Keeps the KTX file mapped until its levels have been copied
+	std::string error; // Set if the texture could not be loaded
+
+	const uint8_t* bytes() const { return packedData ? packedData : data.data(); }
+	size_t byteSize() const
+	{
+		size_t size = packedData ? packedSize : data.size();
+		for (const auto& level : levels)
+		{
+			size += level.size;
+		}
+		return size;
+	}
+};
+
+// Struct which names a texture to load and where to store the image created for it
+struct TextureRequest
+{
+	std::string textureName;
+	VkImage *textureIm;
+	VkFormat *textureFormat;
+};
+
+// Most texture arrays the shared descriptor set can hold - the array fragment shader declares this many samplers
+const uint32_t maxTextureArrays = 8;
+
+// Struct which stores which texture array and which layer of it a draw samples - pushed to the fragment shader after the vertex dequantisation
+struct TextureLayer
+{
+	uint32_t textureArray = 0;
+	uint32_t layer = 0;
+};
+
+// Struct which stores the descriptor set last bound in a command buffer and the dynamic offset of the uniform buffer object it was bound with
+struct DescriptorBinding
+{
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	uint32_t uniformOffset = UINT32_MAX;
+};
+
+// Struct which names a texture to pack into a texture array and where to store the layer it was given
+// The view is a 2D view of just its layer for anything that still samples it on its own - both may be null
+struct TextureLayerRequest
+{
+	std::string textureName;
+	TextureLayer *textureLayer;
+	VkImageView *textureImView;
+	VkFormat *textureFormat;
+};
+
 class VulkanManager
 {
 public:
@@ -46,30 +121,67 @@ public:
 	CleanUpManager cleanUpManager;
 
 	void initVulkan();
-	void loadModel(std::string modelPath, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices);
+	void loadModel(std::string modelPath, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods *modelLods = nullptr);
+	void loadModel(const std::string &modelPath, AssetFile &sourceFile, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods *modelLods = nullptr);
+	void createModelBuffers(const std::string &modelPath, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods &modelLods, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range);
+	void readObjModel(const uint8_t *data, size_t size, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices);
+	void readGltfModel(const uint8_t *data, size_t size, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices);
+	bool loadModelCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices, MeshLods *modelLods);
+	void saveModelCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, const std::vector<Vertex> &modelVertices, const std::vector<uint32_t> &modelIndices, size_t vertexBase, size_t indexBase, const MeshLods *modelLods);
 	void createDepthResources();
 	VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 	VkFormat findDepthFormat();
 	bool hasStencilComponent(VkFormat format);
 	void createTextureSampler();
-	void createTextureImageView(VkImage texture, VkImageView &textureImView, VkImageViewType &imageType);
-	void createCubeTextureImageView(VkImage texture1, VkImage texture2, VkImage texture3, VkImage texture4, VkImage texture5, VkImage texture6, VkImageView &textureImView, VkImageViewType &imageType);
-	VkImageView createCubeImageView(VkImage image1, VkImage image2, VkImage image3, VkImage image4, VkImage image5, VkImage image6, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType &imageType);
-	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType &imageType);
-	void createTextureImage(std::string textureName, VkImage &textureIm, VkDeviceMemory &textureImMemory);
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
-	VkCommandBuffer beginSingleTimeCommands();
-	void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-	void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-	void createDescriptorSet(VkDescriptorSet &desSet, VkImageView textureImView, VkBuffer uniformBuff);
+	void createTextureImageView(VkImage texture, VkFormat textureFormat, VkImageView &textureImView, VkImageViewType &imageType);
+	void createCubeTextureImageView(VkImage texture1, VkImage texture2, VkImage texture3, VkImage texture4, VkImage texture5, VkImage texture6, VkFormat textureFormat, VkImageView &textureImView, VkImageViewType &imageType);
+	void createSkyboxImageView();
+	VkImageView createCubeImageView(VkImage image1, VkImage image2, VkImage image3, VkImage image4, VkImage image5, VkImage image6, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageViewType &imageType);
+	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageViewType &imageType, uint32_t baseArrayLayer = 0, uint32_t arrayLayers = 1);
+	void createTextureImage(std::string textureName, VkImage &textureIm, VkFormat &textureFormat);
+	void createTextureImages(const std::vector<TextureRequest> &requests);
+	void createTextureArrays(const std::vector<TextureLayerRequest> &requests);
+	void decodeTexture(const std::string &textureName, DecodedTexture &texture);
+	void loadKtxTexture(const std::string &textureName, DecodedTexture &texture);
+	void recordTextureUpload(VkCommandBuffer &commandBuffer, DecodedTexture &texture, VkImage &textureIm, VkFormat &textureFormat);
+	VkDeviceSize planTextureBudget();
+	void createPlaceholderResources();
+	void requestStreamedAssets();
+	void streamTexture(const std::string &textureName, int priority, VkImage &textureIm, VkFormat &textureFormat, VkImageView &textureImView, VkDescriptorSet &desSet, std::function<void()> onLoaded = nullptr);
+	void watchAssets();
+	void reloadChangedAssets();
+	bool isSpirvFile(const std::string &path);
+	void reloadPipeline(bool skybox, const std::string &vertPath, const std::string &fragPath);
+	bool loadTextureCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, TextureFormat requestedFormat, TextureFormat &format, uint32_t &width, uint32_t &height, uint32_t &levelCount, std::vector<uint8_t> &blocks, const uint8_t *&packedBlocks, size_t &packedSize);
+	void saveTextureCache(const std::string &cachePath, uint64_t sourceHash, uint64_t sourceSize, TextureFormat requestedFormat, TextureFormat format, uint32_t width, uint32_t height, uint32_t levelCount, const std::vector<uint8_t> &blocks);
+	void buildAssetPack();
+	void buildSkyboxCubeMap();
+	void uploadImage(const void *pixels, VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t arrayLayers = 1);
+	void recordStagedLevelUpload(VkCommandBuffer &commandBuffer, VkImage image, TextureFormat format, uint32_t width, uint32_t height, uint32_t level, uint32_t arrayLayers, const std::function<const uint8_t*(uint32_t)> &layerData);
+	void recordGenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers = 1);
+	StagingRegion stageUpload(VkCommandBuffer &commandBuffer, VkDeviceSize size);
+	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, uint32_t arrayLayers = 1, VkImageCreateFlags flags = 0);
+	void createDescriptorSet(VkDescriptorSet &desSet, VkImageView textureImView);
+	void updateDescriptorSet(VkDescriptorSet desSet, VkImageView textureImView);
+	void updateUniformDescriptorSets();
+	void createTextureArrayDescriptorSet(VkDescriptorSet &desSet);
 	void createDescriptorPool();
-	void createUniformBuffer(VkBuffer &uniformBuff, VkDeviceMemory &uniformBuffMemory);
+	void createUniformBuffers();
 	void createDescriptorSetLayout();
-	void createIndexBuffer(std::vector<uint32_t> shape, VkBuffer &shapeIndexBuffer, VkDeviceMemory &shapeIndexBufferMemory);
-	void createVertexBuffer(std::vector<Vertex> vertexInformation, VkBuffer &shapeVertexBuffer, VkDeviceMemory &shapeVertexBufferMemory);
-	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+	void createIndexBuffer(std::vector<uint32_t> shape, VkBuffer &shapeIndexBuffer, VkIndexType &shapeIndexType);
+	void createMeshBuffers(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, VkBuffer &indexBuffer, VkIndexType &indexType, MeshRange &range);
+	void createMeshVertexBuffer(const std::vector<Vertex> &vertices, VkBuffer &vertexBuffer, VertexDequantisation &dequantisation, const MeshRange &indexRange, MeshRange &range);
+	void layoutVertices(const std::vector<Vertex> &vertices, std::vector<uint8_t> &vertexData, VertexDequantisation &dequantisation);
+	void layoutIndices(const std::vector<uint32_t> &indices, std::vector<uint8_t> &indexData, VkIndexType &indexType);
+	void createDeviceLocalBuffer(const void *bufferData, VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkBuffer &buffer);
+	void copyToDeviceLocalBuffer(const void *bufferData, VkDeviceSize bufferSize, VkBuffer buffer, VkDeviceSize offset);
+	void recordStagedBufferUpload(VkCommandBuffer &commandBuffer, const void *bufferData, VkDeviceSize bufferSize, VkBuffer buffer, VkDeviceSize offset);
+	void pushVertexDequantisation(VkCommandBuffer commandBuffer, const VertexDequantisation &dequantisation);
+	void recordTextureBind(VkCommandBuffer commandBuffer, uint32_t frame, VkDescriptorSet desSet, VkDescriptorSet arrayDesSet, uint32_t uniformObject, const TextureLayer &textureLayer, DescriptorBinding &boundDescriptors);
+	void recordGeometryBind(VkCommandBuffer commandBuffer, VkBuffer vertexBuffer, VkBuffer indexBuffer, VkIndexType indexType, GeometryBinding &boundGeometry);
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer);
 	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+	void recordImageLayoutTransition(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t arrayLayers = 1);
 	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 	void createSemaphores();
 	void createRenderPass();
@@ -84,8 +196,17 @@ public:
 	bool checkDeviceExtensionSupport(VkPhysicalDevice device);
 	void setupDebugCallback();
 	void mainLoop();
-	void updateUniformBuffer(VkDeviceMemory uniformBuffMemory);
+	void updateUniformObject(uint32_t uniformObject, uint32_t frame);
+	glm::mat4 modelMatrix(uint32_t uniformObject);
+	void createLodDrawBuffer();
+	void createMeshletIndexBuffer(const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, VkBuffer &buffer, uint32_t &capacity);
+	void createMeshletIndexBuffers();
+	VkDrawIndexedIndirectCommand cullModelMeshlets(const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, size_t level, const MeshRange &range, VkBuffer buffer, uint32_t firstIndex, const glm::mat4 &model, const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition);
+	VkDrawIndexedIndirectCommand modelLodDraw(const std::vector<uint32_t> &modelIndices, const MeshLods &modelLods, size_t level, const MeshRange &range);
+	size_t selectModelLod(const MeshLods &modelLods, const glm::mat4 &model, const glm::vec3 &cameraPosition, float projectionScale);
+	void updateLodDraws(uint32_t imageIndex);
 	void drawFrame();
+	void waitForFrame();
 	static void onWindowResized(GLFWwindow* window, int width, int height);
 	void createInstance();
 	bool checkValidationLayerSupport();
@@ -102,6 +223,5 @@ public:
 	void createFramebuffers();
 	void createCommandBuffers();
 	void createCommandPool();
-
-	//void modelLoad(std::vector<tinyobj::shape_t> shapes, tinyobj::attrib_t attrib, std::unordered_map<Vertex, uint32_t> uniqueVertices, std::vector<Vertex> &modelVertices, std::vector<uint32_t> &modelIndices);
+	void createCommandPool(VkCommandPool &pool, VkCommandPoolCreateFlags flags);
 };
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// One sampler for each texture array - textures of the same size, format and mip chain are layers of the same array
+layout(binding = 1) uniform sampler2DArray texSamplers[8];
+
+// Texture array and layer the draw samples - pushed after the vertex dequantisation
+layout(push_constant) uniform TextureLayer {
+    layout(offset = 32) uint textureArray;
+    uint layer;
+} textureLayer;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	outColor = vec4(texture(texSamplers[textureLayer.textureArray], vec3(fragTexCoord, textureLayer.layer)).rgb, 1.0);
+}
@@ -1,2 +1,8 @@
 E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V shader.vert
 E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V shader.frag
+E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V packedShader.vert -o packedVert.spv
+E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V terrainShader.vert -o terrainVert.spv
+E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V arrayShader.frag -o arrayFrag.spv
+E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V skyShader.vert -o skyVert.spv
+E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V skyShader.frag -o skyFrag.spv
+E:/Vulkan/1.0.54.0/Bin32/glslangValidator.exe -V packedSkyShader.vert -o packedSkyVert.spv
@@ -0,0 +1,31 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// Bounding box of the mesh being drawn - turns the packed position back into model space
+layout(push_constant) uniform Dequantisation {
+    vec4 offset;
+    vec4 scale;
+} dequant;
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    vec3 position = dequant.offset.xyz + inPosition.xyz * dequant.scale.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = inTexCoord;
+}
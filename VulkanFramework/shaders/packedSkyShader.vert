@@ -0,0 +1,35 @@
+#version 450
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+layout (binding = 0) uniform UBO 
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+// Bounding box of the mesh being drawn - turns the packed position back into model space
+layout (push_constant) uniform Dequantisation
+{
+	vec4 offset;
+	vec4 scale;
+} dequant;
+
+layout (location = 0) in vec4 inPos;
+
+layout (location = 0) out vec3 outUVW;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+
+void main() 
+{
+	vec3 position = dequant.offset.xyz + inPos.xyz * dequant.scale.xyz;
+	outUVW = position;
+	gl_Position = ubo.projection * ubo.view * ubo.model * vec4(position, 1.0);
+}
\ No newline at end of file
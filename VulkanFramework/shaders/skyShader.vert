@@ -7,9 +7,9 @@ layout (location = 0) in vec3 inPos;
 
 layout (binding = 0) uniform UBO 
 {
-	mat4 projection;
-	mat4 view;
 	mat4 model;
+	mat4 view;
+	mat4 projection;
 } ubo;
 
 layout (location = 0) out vec3 outUVW;
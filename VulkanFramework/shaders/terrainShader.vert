@@ -0,0 +1,67 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// Camera and layout of the terrain - positions are in terrain space, before the model matrix
+layout(binding = 2) uniform TerrainUniformBufferObject {
+    vec4 cameraPosition;
+    vec4 origin; // xyz = position of the first height sample, w = distance between height samples
+    vec4 size; // x = height samples along each side less one
+    vec4 morphRanges[8]; // x = distance a level starts to morph into the next coarser level, y = distance it has fully morphed
+} terrain;
+
+layout(binding = 3) uniform sampler2D heightMap;
+
+// Grid position of the vertex within the patch
+layout(location = 0) in vec2 inGridPosition;
+// Patch picked by the quadtree - xy = first height sample, z = height samples between grid vertices, w = level of detail
+layout(location = 1) in vec4 inPatchNode;
+// Part of the grid drawn - vertices outside it collapse onto its edge
+layout(location = 2) in vec4 inPatchQuadrant;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+// Float textures are not filtered so blend the four nearest samples here
+float sampleHeight(vec2 samplePosition) {
+    vec2 base = floor(samplePosition);
+    vec2 weight = samplePosition - base;
+    ivec2 texel = ivec2(base);
+    ivec2 last = ivec2(terrain.size.x);
+    float h00 = texelFetch(heightMap, min(texel, last), 0).r;
+    float h10 = texelFetch(heightMap, min(texel + ivec2(1, 0), last), 0).r;
+    float h01 = texelFetch(heightMap, min(texel + ivec2(0, 1), last), 0).r;
+    float h11 = texelFetch(heightMap, min(texel + ivec2(1, 1), last), 0).r;
+    return mix(mix(h00, h10, weight.x), mix(h01, h11, weight.x), weight.y);
+}
+
+vec3 terrainPosition(vec2 samplePosition) {
+    return terrain.origin.xyz + vec3(samplePosition.x * terrain.origin.w, sampleHeight(samplePosition), samplePosition.y * terrain.origin.w);
+}
+
+void main() {
+    vec2 gridPosition = clamp(inGridPosition, inPatchQuadrant.xy, inPatchQuadrant.zw);
+    float spacing = inPatchNode.z;
+    vec2 morphRange = terrain.morphRanges[int(inPatchNode.w)].xy;
+
+    // The further the vertex is into the end of its level's range, the closer it moves to where the next coarser level has it
+    vec3 position = terrainPosition(inPatchNode.xy + gridPosition * spacing);
+    float morph = clamp((distance(position, terrain.cameraPosition.xyz) - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+    // Odd grid vertices slide onto their even neighbour so a fully morphed patch has the grid of the next level
+    gridPosition -= fract(gridPosition * 0.5) * 2.0 * morph;
+    vec2 samplePosition = inPatchNode.xy + gridPosition * spacing;
+    position = terrainPosition(samplePosition);
+
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = samplePosition / terrain.size.x;
+}